@@ -0,0 +1,77 @@
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+namespace
+{
+  std::atomic<uint64_t> g_Allocations{0};
+}  // namespace
+
+// only the bench binary replaces these, so counting allocations costs the tests nothing
+void*
+operator new(std::size_t sz)
+{
+  g_Allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto ptr = std::malloc(sz ? sz : 1))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace llarp::bench
+{
+  uint64_t
+  Allocations()
+  {
+    return g_Allocations.load(std::memory_order_relaxed);
+  }
+
+  nlohmann::json
+  Result::ToJSON() const
+  {
+    const double secs = elapsed.count();
+    nlohmann::json obj{
+        {"name", name},
+        {"iterations", iterations},
+        {"seconds", secs},
+        {"ns_per_op", secs * 1e9 / iterations},
+        {"ops_per_sec", iterations / secs},
+        {"allocs_per_op", double(allocations) / iterations}};
+    if (bytesPerOp)
+      obj["bytes_per_sec"] = double(bytesPerOp) * iterations / secs;
+    return obj;
+  }
+
+  void
+  Runner::Add(Result result)
+  {
+    // progress goes to stderr so stdout stays clean json
+    const auto ns = result.elapsed.count() * 1e9 / result.iterations;
+    std::cerr << std::left << std::setw(48) << result.name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(14) << ns << " ns/op";
+    if (result.bytesPerOp)
+    {
+      const auto mib = double(result.bytesPerOp) * result.iterations / result.elapsed.count()
+          / (1024 * 1024);
+      std::cerr << std::setw(12) << mib << " MiB/s";
+    }
+    std::cerr << std::setw(10) << double(result.allocations) / result.iterations << " allocs/op";
+    std::cerr << std::endl;
+    m_Results.emplace_back(std::move(result));
+  }
+}  // namespace llarp::bench
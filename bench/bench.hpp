@@ -0,0 +1,132 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace llarp::bench
+{
+  /// keep the compiler from throwing away a result we only compute to time it
+  template <typename T>
+  inline void
+  DoNotOptimize(const T& value)
+  {
+#ifdef _MSC_VER
+    const volatile auto* sink = &value;
+    (void)sink;
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+  }
+
+  /// heap allocations this process made so far, counted by the operator new of the bench binary
+  uint64_t
+  Allocations();
+
+  struct Result
+  {
+    std::string name;
+    uint64_t iterations;
+    std::chrono::duration<double> elapsed;
+    /// bytes each iteration works on, 0 if throughput makes no sense for it
+    uint64_t bytesPerOp;
+    /// heap allocations made over all iterations
+    uint64_t allocations = 0;
+
+    nlohmann::json
+    ToJSON() const;
+  };
+
+  class Runner
+  {
+   public:
+    using Clock_t = std::chrono::steady_clock;
+
+    Runner(std::string filter, std::chrono::duration<double> minTime)
+        : m_Filter{std::move(filter)}, m_MinTime{minTime}
+    {}
+
+    /// determine if the benchmark called name was asked for
+    bool
+    Selected(std::string_view name) const
+    {
+      return name.find(m_Filter) != std::string_view::npos;
+    }
+
+    /// time calling f() over and over, growing the number of calls until one run of them takes
+    /// at least the minimum time
+    template <typename Func>
+    void
+    Run(std::string name, Func&& f, uint64_t bytesPerOp = 0)
+    {
+      if (not Selected(name))
+        return;
+      uint64_t iterations = 1;
+      for (;;)
+      {
+        const auto allocations = Allocations();
+        const auto started = Clock_t::now();
+        for (uint64_t idx = 0; idx < iterations; ++idx)
+          f();
+        const std::chrono::duration<double> elapsed = Clock_t::now() - started;
+        if (elapsed >= m_MinTime or iterations >= MaxIterations)
+        {
+          Add(Result{
+              std::move(name), iterations, elapsed, bytesPerOp, Allocations() - allocations});
+          return;
+        }
+        // aim a bit past the minimum time going by how long this run took
+        const double scale =
+            elapsed.count() > 0 ? std::min(100.0, 1.2 * m_MinTime / elapsed) : 100.0;
+        iterations = std::max(iterations * 2, uint64_t(iterations * scale));
+      }
+    }
+
+    /// record a benchmark that did its own timing
+    void
+    Add(Result result);
+
+    const std::vector<Result>&
+    Results() const
+    {
+      return m_Results;
+    }
+
+    std::chrono::duration<double>
+    MinTime() const
+    {
+      return m_MinTime;
+    }
+
+    static constexpr uint64_t MaxIterations = uint64_t{1} << 32;
+
+   private:
+    const std::string m_Filter;
+    const std::chrono::duration<double> m_MinTime;
+    std::vector<Result> m_Results;
+  };
+
+  // the suites, each adds its benchmarks to the runner
+  void
+  BenchCrypto(Runner& runner);
+
+  void
+  BenchBencode(Runner& runner);
+
+  void
+  BenchNodeDB(Runner& runner);
+
+  void
+  BenchIWP(Runner& runner);
+
+  void
+  BenchDNS(Runner& runner);
+
+  void
+  BenchIPPacket(Runner& runner);
+}  // namespace llarp::bench
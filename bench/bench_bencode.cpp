@@ -0,0 +1,148 @@
+#include "bench.hpp"
+
+#include <llarp/constants/version.hpp>
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/messages/relay.hpp>
+#include <llarp/messages/relay_commit.hpp>
+#include <llarp/router_contact.hpp>
+#include <llarp/service/protocol.hpp>
+
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace llarp::bench
+{
+  namespace
+  {
+    /// time encoding msg and decoding what that gives back into a cleared T
+    template <typename T>
+    void
+    EncodeDecode(Runner& runner, const std::string& name, const T& msg)
+    {
+      std::vector<byte_t> storage(MAX_LINK_MSG_SIZE * 2);
+      llarp_buffer_t buf{storage};
+      if (not msg.BEncode(&buf))
+        throw std::runtime_error{"failed to encode " + name};
+      const size_t encoded = buf.cur - buf.base;
+
+      runner.Run(
+          "bencode/" + name + "/encode",
+          [&]() {
+            buf.cur = buf.base;
+            DoNotOptimize(msg.BEncode(&buf));
+          },
+          encoded);
+
+      llarp_buffer_t wire{storage.data(), encoded};
+      T decoded;
+      if (not decoded.BDecode(&wire))
+        throw std::runtime_error{"failed to decode " + name};
+      runner.Run(
+          "bencode/" + name + "/decode",
+          [&]() {
+            wire.cur = wire.base;
+            decoded.Clear();
+            DoNotOptimize(decoded.BDecode(&wire));
+          },
+          encoded);
+    }
+
+    /// time decoding msg the way we did before bencode::Reader, one DecodeKey callback per key
+    /// with a separate pass to find the version first
+    template <typename T>
+    void
+    LegacyDecode(Runner& runner, const std::string& name, const T& msg)
+    {
+      static constexpr bool link = std::is_base_of_v<ILinkMessage, T>;
+      std::vector<byte_t> storage(MAX_LINK_MSG_SIZE * 2);
+      llarp_buffer_t buf{storage};
+      if (not msg.BEncode(&buf))
+        throw std::runtime_error{"failed to encode " + name};
+      const size_t encoded = buf.cur - buf.base;
+
+      llarp_buffer_t wire{storage.data(), encoded};
+      T decoded;
+      const auto decode = [&]() {
+        wire.cur = wire.base;
+        decoded.Clear();
+        if constexpr (link)
+        {
+          uint64_t v = 0;
+          if (BEncodeSeekDictVersion(v, &wire, 'v'))
+            decoded.version = v;
+        }
+        return bencode_read_dict(
+            [&decoded](llarp_buffer_t* buffer, llarp_buffer_t* key) {
+              if (key == nullptr)
+                return true;
+              // the link message parser used to eat the message type itself
+              if (link and *key == "a")
+                return bencode_read_string(buffer, nullptr);
+              return decoded.DecodeKey(*key, buffer);
+            },
+            &wire);
+      };
+      if (not decode())
+        throw std::runtime_error{"failed to decode " + name};
+      runner.Run(
+          "bencode/" + name + "/decode_legacy", [&]() { DoNotOptimize(decode()); }, encoded);
+    }
+
+    void
+    Random(std::vector<byte_t>& data)
+    {
+      llarp_buffer_t buf{data};
+      CryptoManager::instance()->randomize(buf);
+    }
+  }  // namespace
+
+  void
+  BenchBencode(Runner& runner)
+  {
+    std::vector<byte_t> payload(1024);
+    Random(payload);
+
+    RelayUpstreamMessage upstream;
+    upstream.pathid.Randomize();
+    upstream.X = llarp_buffer_t{payload};
+    upstream.Y.Randomize();
+    EncodeDecode(runner, "RelayUpstreamMessage", upstream);
+    LegacyDecode(runner, "RelayUpstreamMessage", upstream);
+
+    LR_CommitMessage commit;
+    for (auto& frame : commit.frames)
+      frame.Randomize();
+    EncodeDecode(runner, "LR_CommitMessage", commit);
+
+    SecretKey identity;
+    CryptoManager::instance()->identity_keygen(identity);
+    SecretKey encryption;
+    CryptoManager::instance()->encryption_keygen(encryption);
+    RouterContact rc;
+    rc.pubkey = identity.toPublic();
+    rc.enckey = encryption.toPublic();
+    rc.routerVersion = RouterVersion(llarp::VERSION, LLARP_PROTO_VERSION);
+    rc.SetNick("benchmark");
+    AddressInfo ai;
+    ai.rank = 1;
+    ai.dialect = "iwp";
+    ai.pubkey = rc.enckey;
+    ai.ip.s6_addr[15] = 1;
+    ai.port = 1090;
+    rc.addrs.emplace_back(std::move(ai));
+    if (not rc.Sign(identity))
+      throw std::runtime_error{"failed to sign rc"};
+    EncodeDecode(runner, "RouterContact", rc);
+
+    service::ProtocolFrame frame;
+    frame.C.Randomize();
+    frame.D = llarp_buffer_t{payload};
+    frame.N.Randomize();
+    frame.Z.Randomize();
+    frame.F.Randomize();
+    frame.T.Randomize();
+    EncodeDecode(runner, "ProtocolFrame", frame);
+    LegacyDecode(runner, "ProtocolFrame", frame);
+  }
+}  // namespace llarp::bench
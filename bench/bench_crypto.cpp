@@ -0,0 +1,79 @@
+#include "bench.hpp"
+
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/crypto/types.hpp>
+
+#include <vector>
+
+namespace llarp::bench
+{
+  void
+  BenchCrypto(Runner& runner)
+  {
+    auto* crypto = CryptoManager::instance();
+
+    SharedSecret shared;
+    shared.Randomize();
+    TunnelNonce nonce;
+    nonce.Randomize();
+
+    for (const size_t size : {64, 1024, 8192})
+    {
+      std::vector<byte_t> data(size);
+      llarp_buffer_t buf{data};
+      crypto->randomize(buf);
+      const auto suffix = "/" + std::to_string(size);
+
+      runner.Run(
+          "crypto/xchacha20" + suffix,
+          [&]() { DoNotOptimize(crypto->xchacha20(buf, shared, nonce)); },
+          size);
+
+      ShortHash hash;
+      runner.Run(
+          "crypto/hmac" + suffix,
+          [&]() {
+            crypto->hmac(hash.data(), buf, shared);
+            DoNotOptimize(hash);
+          },
+          size);
+    }
+
+    SecretKey identity;
+    crypto->identity_keygen(identity);
+    const auto identityPub = identity.toPublic();
+    std::vector<byte_t> signedData(1024);
+    llarp_buffer_t signedBuf{signedData};
+    crypto->randomize(signedBuf);
+    Signature sig;
+    crypto->sign(sig, identity, signedBuf);
+
+    runner.Run(
+        "crypto/sign/1024",
+        [&]() {
+          crypto->sign(sig, identity, signedBuf);
+          DoNotOptimize(sig);
+        },
+        signedData.size());
+    runner.Run(
+        "crypto/verify/1024",
+        [&]() { DoNotOptimize(crypto->verify(identityPub, signedBuf, sig)); },
+        signedData.size());
+
+    SecretKey ours, theirs;
+    crypto->encryption_keygen(ours);
+    crypto->encryption_keygen(theirs);
+    const auto theirsPub = theirs.toPublic();
+    const auto oursPub = ours.toPublic();
+    SharedSecret result;
+
+    runner.Run("crypto/dh_client", [&]() {
+      crypto->dh_client(result, theirsPub, ours, nonce);
+      DoNotOptimize(result);
+    });
+    runner.Run("crypto/dh_server", [&]() {
+      crypto->dh_server(result, oursPub, theirs, nonce);
+      DoNotOptimize(result);
+    });
+  }
+}  // namespace llarp::bench
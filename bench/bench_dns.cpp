@@ -0,0 +1,62 @@
+#include "bench.hpp"
+
+#include <llarp/dns/dns.hpp>
+#include <llarp/dns/message.hpp>
+#include <llarp/dns/wire.hpp>
+#include <llarp/net/net_int.hpp>
+
+#include <array>
+#include <stdexcept>
+
+namespace llarp::bench
+{
+  void
+  BenchDNS(Runner& runner)
+  {
+    // a reply the way we give them for a .loki lookup
+    dns::MessageHeader hdr{};
+    hdr.id = 0x1234;
+    hdr.qd_count = 1;
+    dns::Message reply{hdr};
+    reply.questions[0].qname = "kcpyawm9se7trdbzncimdi5t7st4p5mh9i1mg7gkpuubi4k4ku1y.loki.";
+    reply.questions[0].qtype = dns::qTypeA;
+    reply.questions[0].qclass = dns::qClassIN;
+    reply.AddINReply(huint128_t{0x0a000001}, false, 300);
+
+    std::array<byte_t, 1500> storage;
+    llarp_buffer_t buf{storage};
+    if (not reply.Encode(&buf))
+      throw std::runtime_error{"failed to encode dns reply"};
+    const size_t encoded = buf.cur - buf.base;
+
+    runner.Run(
+        "dns/Message/encode",
+        [&]() {
+          buf.cur = buf.base;
+          DoNotOptimize(reply.Encode(&buf));
+        },
+        encoded);
+
+    llarp_buffer_t wire{storage.data(), encoded};
+    runner.Run(
+        "dns/Message/decode",
+        [&]() {
+          wire.cur = wire.base;
+          dns::MessageHeader decodedHdr;
+          if (not decodedHdr.Decode(&wire))
+            return;
+          dns::Message decoded{decodedHdr};
+          DoNotOptimize(decoded.Decode(&wire));
+        },
+        encoded);
+
+    runner.Run(
+        "dns/MessageView/parse",
+        [&]() {
+          dns::MessageView view;
+          DoNotOptimize(view.Parse(wire));
+          DoNotOptimize(view.FirstQuestion());
+        },
+        encoded);
+  }
+}  // namespace llarp::bench
@@ -0,0 +1,144 @@
+#include "bench.hpp"
+
+#include <llarp/net/ip_packet.hpp>
+#include <llarp/net/net_bits.hpp>
+#include <llarp/net/net_int.hpp>
+#include <llarp/util/endian.hpp>
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace llarp::bench
+{
+  namespace
+  {
+    /// ipchksum as it was before it summed wide words, 16 bits at a time into 32
+    uint16_t
+    LegacyIPChecksum(const byte_t* buf, size_t sz, uint32_t sum = 0)
+    {
+      while (sz > 1)
+      {
+        uint16_t word;
+        std::memcpy(&word, buf, sizeof(word));
+        sum += word;
+        sz -= sizeof(uint16_t);
+        buf += sizeof(uint16_t);
+      }
+      if (sz != 0)
+      {
+        uint16_t x = 0;
+        *(byte_t*)&x = *buf;
+        sum += x;
+      }
+      sum = (sum & 0xFFff) + (sum >> 16);
+      sum += sum >> 16;
+      return uint16_t((~sum) & 0xFFff);
+    }
+
+#define ADD32CS(x) ((uint32_t)(x & 0xFFff) + (uint32_t)(x >> 16))
+#define SUB32CS(x) ((uint32_t)((~x) & 0xFFff) + (uint32_t)((~x) >> 16))
+
+    nuint16_t
+    LegacyDeltaIPv4Checksum(
+        nuint16_t old_sum,
+        nuint32_t old_src_ip,
+        nuint32_t old_dst_ip,
+        nuint32_t new_src_ip,
+        nuint32_t new_dst_ip)
+    {
+      uint32_t sum = uint32_t(old_sum.n) + ADD32CS(old_src_ip.n) + ADD32CS(old_dst_ip.n)
+          + SUB32CS(new_src_ip.n) + SUB32CS(new_dst_ip.n);
+      sum = (sum & 0xFFff) + (sum >> 16);
+      sum += sum >> 16;
+      return nuint16_t{uint16_t(sum & 0xFFff)};
+    }
+
+#undef ADD32CS
+#undef SUB32CS
+
+    /// UpdateIPv4Address on an unfragmented udp packet as it was before the address delta was
+    /// shared, worked out from scratch for the ip header and again for the udp checksum
+    void
+    LegacyUpdateIPv4Address(net::IPPacket& pkt, nuint32_t nSrcIP, nuint32_t nDstIP)
+    {
+      auto* hdr = pkt.Header();
+      const nuint32_t oSrcIP{hdr->saddr};
+      const nuint32_t oDstIP{hdr->daddr};
+      auto* udpsum = reinterpret_cast<nuint16_t*>(pkt.buf + hdr->ihl * 4 + 6);
+      if (udpsum->n != 0)
+        *udpsum = LegacyDeltaIPv4Checksum(*udpsum, oSrcIP, oDstIP, nSrcIP, nDstIP);
+      hdr->check = LegacyDeltaIPv4Checksum(nuint16_t{hdr->check}, oSrcIP, oDstIP, nSrcIP, nDstIP).n;
+      hdr->saddr = nSrcIP.n;
+      hdr->daddr = nDstIP.n;
+    }
+  }  // namespace
+
+  void
+  BenchIPPacket(Runner& runner)
+  {
+    // a full sized udp datagram, the common case for traffic off the tun
+    std::vector<byte_t> payload(1400, 0x5a);
+    const nuint32_t src = ToNet(ipaddr_ipv4_bits(10, 0, 0, 1));
+    const nuint32_t dst = ToNet(ipaddr_ipv4_bits(10, 0, 0, 2));
+    auto v4 = net::IPPacket::UDP(
+        src, ToNet(huint16_t{1234}), dst, ToNet(huint16_t{53}), llarp_buffer_t{payload});
+
+    // swap between two address pairs so every pass rewrites the checksums for real
+    bool flip = false;
+    runner.Run(
+        "ip/UpdateIPv4Address",
+        [&]() {
+          flip = not flip;
+          v4.UpdateIPv4Address(flip ? dst : src, flip ? src : dst);
+          DoNotOptimize(v4.buf);
+        },
+        v4.sz);
+
+    auto legacy = net::IPPacket::UDP(
+        src, ToNet(huint16_t{1234}), dst, ToNet(huint16_t{53}), llarp_buffer_t{payload});
+    runner.Run(
+        "ip/UpdateIPv4Address_legacy",
+        [&]() {
+          flip = not flip;
+          LegacyUpdateIPv4Address(legacy, flip ? dst : src, flip ? src : dst);
+          DoNotOptimize(legacy.buf);
+        },
+        legacy.sz);
+
+    net::IPPacket v6;
+    const size_t v6Payload = 1400;
+    v6.sz = sizeof(ipv6_header) + v6Payload;
+    std::memset(v6.buf, 0, v6.sz);
+    auto* hdr = v6.HeaderV6();
+    hdr->preamble.preamble.version = 6;
+    hdr->payload_len = htons(v6Payload);
+    hdr->proto = 0x11;  // udp
+    hdr->hoplimit = 64;
+    // udp length, the checksum is left zero and gets fixed up by the rewrite
+    htobe16buf(v6.buf + sizeof(ipv6_header) + 4, v6Payload);
+
+    const huint128_t src6{uint128_t{0xfd00000000000000UL, 1}};
+    const huint128_t dst6{uint128_t{0xfd00000000000000UL, 2}};
+    runner.Run(
+        "ip/UpdateIPv6Address",
+        [&]() {
+          flip = not flip;
+          v6.UpdateIPv6Address(flip ? dst6 : src6, flip ? src6 : dst6);
+          DoNotOptimize(v6.buf);
+        },
+        v6.sz);
+
+    runner.Run(
+        "ip/ipchksum/1500",
+        [&]() { DoNotOptimize(net::ipchksum(v4.buf, 1500)); },
+        1500);
+
+    if (LegacyIPChecksum(v4.buf, 1500) != net::ipchksum(v4.buf, 1500))
+      throw std::runtime_error{"legacy ipchksum disagrees"};
+    runner.Run(
+        "ip/ipchksum_legacy/1500",
+        [&]() { DoNotOptimize(LegacyIPChecksum(v4.buf, 1500)); },
+        1500);
+  }
+}  // namespace llarp::bench
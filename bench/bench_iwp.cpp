@@ -0,0 +1,211 @@
+#include "bench.hpp"
+
+#include <llarp/config/key_manager.hpp>
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/ev/ev.hpp>
+#include <llarp/iwp/iwp.hpp>
+#include <llarp/messages/discard.hpp>
+#include <llarp/messages/link_message_parser.hpp>
+#include <llarp/net/net_if.hpp>
+#include <llarp/router_contact.hpp>
+#include <llarp/util/meta/memfn.hpp>
+#include <llarp/util/metrics.hpp>
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace llarp::bench
+{
+  namespace
+  {
+    constexpr size_t MessageSize = 4000;
+    constexpr int MaxInFlight = 128;
+
+    /// packets and bytes put on the wire by every iwp session in the process, both directions
+    struct WireTotals
+    {
+      uint64_t packets = 0;
+      uint64_t bytes = 0;
+
+      static WireTotals
+      Now()
+      {
+        const metrics::Labels labels{{"link", "iwp"}};
+        auto& registry = metrics::Registry::Instance();
+        return WireTotals{
+            registry.GetCounter("lokinet_link_packets_tx", "", labels).Value(),
+            registry.GetCounter("lokinet_link_bytes_tx", "", labels).Value()};
+      }
+    };
+
+    /// one side of the loopback session pair
+    struct Endpoint
+    {
+      RouterContact rc;
+      std::shared_ptr<KeyManager> keyManager = std::make_shared<KeyManager>();
+      LinkMessageParser parser{nullptr};
+      LinkLayer_ptr link;
+
+      Endpoint()
+      {
+        CryptoManager::instance()->identity_keygen(keyManager->identityKey);
+        CryptoManager::instance()->encryption_keygen(keyManager->encryptionKey);
+        CryptoManager::instance()->encryption_keygen(keyManager->transportKey);
+        rc.pubkey = keyManager->identityKey.toPublic();
+        rc.enckey = keyManager->encryptionKey.toPublic();
+      }
+
+      bool
+      HandleMessage(ILinkSession* from, const llarp_buffer_t& buf)
+      {
+        return parser.ProcessFrom(from, buf);
+      }
+
+      void
+      Init(
+          const EventLoop_ptr& loop,
+          bool inbound,
+          uint16_t port,
+          std::function<void(ILinkSession*)> established)
+      {
+        auto make = inbound ? &iwp::NewInboundLink : &iwp::NewOutboundLink;
+        link = make(
+            keyManager,
+            loop,
+            [this]() -> const RouterContact& { return rc; },
+            util::memFn(&Endpoint::HandleMessage, this),
+            [this](Signature& sig, const llarp_buffer_t& buf) {
+              return CryptoManager::instance()->sign(sig, keyManager->identityKey, buf);
+            },
+            nullptr,
+            [established](ILinkSession* s, bool) {
+              established(s);
+              return true;
+            },
+            [](RouterContact, RouterContact) { return true; },
+            [loop](ILinkSession*) { loop->stop(); },
+            [](RouterID) {},
+            []() {},
+            [loop](Work_t work) { loop->call_soon(std::move(work)); });
+        if (not link->Configure(loop, net::LoopbackInterfaceName(), AF_INET, port))
+          throw std::runtime_error{"failed to configure iwp link"};
+        if (inbound)
+        {
+          rc.addrs.emplace_back();
+          if (not link->GetOurAddressInfo(rc.addrs.back()))
+            throw std::runtime_error{"no address info on iwp link"};
+        }
+        if (not rc.Sign(keyManager->identityKey))
+          throw std::runtime_error{"failed to sign rc"};
+      }
+    };
+  }  // namespace
+
+  void
+  BenchIWP(Runner& runner)
+  {
+    // this one times itself, a whole handshake per iteration would swamp what we want to see
+    const std::string name = "iwp/session/loopback/" + std::to_string(MessageSize) + "/packet";
+    if (not runner.Selected(name))
+      return;
+
+    auto oldBlockBogons = RouterContact::BlockBogons;
+    RouterContact::BlockBogons = false;
+
+    auto loop = EventLoop::create();
+    Endpoint alice, bob;
+
+    struct State
+    {
+      ILinkSession* session = nullptr;
+      uint64_t inFlight = 0;
+      uint64_t delivered = 0;
+      bool sending = true;
+      std::chrono::steady_clock::time_point startedAt;
+      std::chrono::steady_clock::time_point endedAt;
+      uint64_t allocationsAtStart = 0;
+      uint64_t allocationsAtEnd = 0;
+      WireTotals wireAtStart;
+      WireTotals wireAtEnd;
+      std::function<void(void)> sendNext;
+    } state;
+
+    const auto minTime = runner.MinTime();
+    state.sendNext = [&state, &loop, minTime]() {
+      if (state.sending and std::chrono::steady_clock::now() - state.startedAt >= minTime)
+        state.sending = false;
+      if (not state.sending)
+      {
+        if (state.inFlight == 0)
+        {
+          state.endedAt = std::chrono::steady_clock::now();
+          state.allocationsAtEnd = Allocations();
+          state.wireAtEnd = WireTotals::Now();
+          loop->stop();
+        }
+        return;
+      }
+      DiscardMessage msg;
+      std::vector<byte_t> msgBuff(MessageSize);
+      llarp_buffer_t buf{msgBuff};
+      CryptoManager::instance()->randomize(buf);
+      msg.BEncode(&buf);
+      ++state.inFlight;
+      state.session->SendMessageBuffer(std::move(msgBuff), [&state, &loop](auto status) {
+        --state.inFlight;
+        if (status == ILinkSession::DeliveryStatus::eDeliverySuccess)
+          ++state.delivered;
+        loop->call_soon([&state] { state.sendNext(); });
+      });
+    };
+
+    alice.Init(loop, false, 32101, [&state, &loop](ILinkSession* session) {
+      state.session = session;
+      loop->call_soon([&state] {
+        state.startedAt = std::chrono::steady_clock::now();
+        state.allocationsAtStart = Allocations();
+        state.wireAtStart = WireTotals::Now();
+        for (int idx = 0; idx < MaxInFlight; ++idx)
+          state.sendNext();
+      });
+    });
+    bob.Init(loop, true, 32102, [](ILinkSession*) {});
+
+    if (not(alice.link->Start() and bob.link->Start()))
+      throw std::runtime_error{"failed to start iwp links"};
+    loop->call([&alice, &bob]() {
+      if (not alice.link->TryEstablishTo(bob.rc))
+        std::cerr << "iwp: failed to establish session" << std::endl;
+    });
+    // give up on a wedged session instead of hanging forever
+    loop->call_later(
+        std::chrono::duration_cast<llarp_time_t>(minTime * 10) + std::chrono::seconds{10},
+        [&loop] { loop->stop(); });
+    loop->run();
+
+    alice.link->Stop();
+    bob.link->Stop();
+    RouterContact::BlockBogons = oldBlockBogons;
+
+    if (state.endedAt == std::chrono::steady_clock::time_point{})
+    {
+      std::cerr << "iwp: session never finished, skipping " << name << std::endl;
+      return;
+    }
+    // an op is one packet on the wire, fragments and acks alike, so allocations are per packet
+    const uint64_t packets = state.wireAtEnd.packets - state.wireAtStart.packets;
+    if (packets == 0)
+    {
+      std::cerr << "iwp: no packets were sent, skipping " << name << std::endl;
+      return;
+    }
+    runner.Add(Result{
+        name,
+        packets,
+        state.endedAt - state.startedAt,
+        (state.wireAtEnd.bytes - state.wireAtStart.bytes) / packets,
+        state.allocationsAtEnd - state.allocationsAtStart});
+  }
+}  // namespace llarp::bench
@@ -0,0 +1,53 @@
+#include "bench.hpp"
+
+#include <llarp/dht/key.hpp>
+#include <llarp/nodedb.hpp>
+#include <llarp/router_contact.hpp>
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+namespace llarp::bench
+{
+  void
+  BenchNodeDB(Runner& runner)
+  {
+    for (const size_t entries : {2000, 10000, 50000})
+    {
+      const auto suffix = "/" + std::to_string(entries);
+      const std::array<std::string, 3> names{
+          "nodedb/GetRandom" + suffix,
+          "nodedb/GetRandom/picky" + suffix,
+          "nodedb/FindManyClosestTo" + suffix};
+      // filling a big nodedb takes a while, skip it when nothing here is going to run
+      if (std::none_of(names.begin(), names.end(), [&runner](const auto& name) {
+            return runner.Selected(name);
+          }))
+        continue;
+
+      // in memory, nothing touches the disk
+      NodeDB db;
+      for (size_t idx = 0; idx < entries; ++idx)
+      {
+        RouterContact rc;
+        rc.pubkey.Randomize();
+        db.Put(rc);
+      }
+
+      runner.Run(names[0], [&]() {
+        DoNotOptimize(db.GetRandom([](const auto&) { return true; }));
+      });
+      // a filter that turns down all but about one in 256
+      runner.Run(names[1], [&]() {
+        DoNotOptimize(db.GetRandom([](const auto& rc) { return rc.pubkey[0] == 0; }));
+      });
+
+      dht::Key_t location;
+      runner.Run(names[2], [&]() {
+        location.Randomize();
+        DoNotOptimize(db.FindManyClosestTo(location, 4));
+      });
+    }
+  }
+}  // namespace llarp::bench
@@ -0,0 +1,302 @@
+#include <llarp/config/config.hpp>
+#include <llarp/ev/ev_vnet.hpp>
+#include <llarp/messages/relay_status.hpp>
+#include <llarp/router_contact.hpp>
+#include <llarp/tooling/path_event.hpp>
+#include <llarp/tooling/router_hive.hpp>
+#include <llarp/util/fs.hpp>
+#include <llarp/util/logging/logger.hpp>
+
+#include <cxxopts.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+namespace
+{
+  using Clock_t = std::chrono::steady_clock;
+
+  struct BenchOptions
+  {
+    size_t relays = 20;
+    size_t clients = 10;
+    std::chrono::seconds warmup = 10s;
+    std::chrono::seconds duration = 60s;
+    llarp::vnet::LinkParams link;
+    uint64_t seed = 0;
+    fs::path dir = "/tmp/lokinet-hive-bench";
+    std::string netid = "hive";
+  };
+
+  std::sig_atomic_t g_Stop = 0;
+
+  std::shared_ptr<llarp::Config>
+  MakeConfig(
+      const BenchOptions& opts,
+      const fs::path& dir,
+      std::optional<uint16_t> port,
+      const std::optional<llarp::RouterContact>& bootstrap)
+  {
+    fs::create_directories(dir / "nodedb");
+    auto conf = std::make_shared<llarp::Config>(dir);
+    conf->Load(std::nullopt, port.has_value());
+
+    conf->router.m_dataDir = dir;
+    conf->router.m_netId = opts.netid;
+    conf->router.m_blockBogons = false;
+    conf->network.m_enableProfiling = false;
+    conf->network.m_endpointType = "null";
+    conf->api.m_enableRPCServer = false;
+    conf->lokid.whitelistRouters = false;
+
+    llarp::LinksConfig::LinkInfo link;
+    link.interface = "lo";
+    link.addressFamily = AF_INET;
+    link.port = 0;
+    conf->links.m_OutboundLink = link;
+    if (port)
+    {
+      conf->router.m_nickname = "Router" + std::to_string(*port);
+      conf->router.m_publicAddress = llarp::IpAddress{"127.0.0.1:" + std::to_string(*port)};
+      link.port = *port;
+      conf->links.m_InboundLinks.push_back(link);
+    }
+    else
+    {
+      // everyone is on 127.0.0.1 so hops can't be picked from different netblocks
+      conf->paths.m_UniqueHopsNetmaskSize = 0;
+    }
+
+    if (bootstrap)
+      conf->bootstrap.routers.insert(*bootstrap);
+    else
+      conf->bootstrap.seednode = true;
+    return conf;
+  }
+
+  /// run the first relay alone until it has written the rc everyone else bootstraps from
+  std::optional<llarp::RouterContact>
+  MakeSeed(const BenchOptions& opts)
+  {
+    tooling::RouterHive hive;
+    hive.network = std::make_shared<llarp::vnet::Network>(opts.seed);
+    const auto dir = opts.dir / "relays" / "0";
+    hive.AddRelay(MakeConfig(opts, dir, 30000, std::nullopt));
+    hive.StartRelays();
+    std::this_thread::sleep_for(2s);
+    hive.StopRouters();
+
+    llarp::RouterContact rc;
+    if (not rc.Read(dir / "self.signed"))
+      return std::nullopt;
+    return rc;
+  }
+
+  /// value at percentile p of sorted samples
+  double
+  Percentile(const std::vector<double>& sorted, double p)
+  {
+    if (sorted.empty())
+      return 0;
+    const auto idx = std::min(sorted.size() - 1, size_t(p / 100 * sorted.size()));
+    return sorted[idx];
+  }
+
+  /// follows path builds through the hive events, keyed on the owner and the id of its first hop
+  struct PathBuildTracker
+  {
+    std::map<std::pair<llarp::RouterID, llarp::PathID_t>, Clock_t::time_point> pending;
+    std::vector<double> latenciesMS;
+    size_t attempts = 0;
+    size_t rejected = 0;
+    size_t failed = 0;
+
+    void
+    Handle(const tooling::RouterEvent& ev)
+    {
+      if (auto attempt = dynamic_cast<const tooling::PathAttemptEvent*>(&ev))
+      {
+        ++attempts;
+        pending.emplace(std::make_pair(attempt->routerID, attempt->pathid), ev.timestamp);
+      }
+      else if (auto status = dynamic_cast<const tooling::PathStatusReceivedEvent*>(&ev))
+      {
+        // transit hops see status messages too, only the owner has a pending build for the id
+        auto itr = pending.find({status->routerID, status->rxid});
+        if (itr == pending.end())
+          return;
+        if (status->status & llarp::LR_StatusRecord::SUCCESS)
+        {
+          latenciesMS.push_back(
+              std::chrono::duration<double, std::milli>{ev.timestamp - itr->second}.count());
+        }
+        else
+          ++failed;
+        pending.erase(itr);
+      }
+      else if (auto reject = dynamic_cast<const tooling::PathBuildRejectedEvent*>(&ev))
+      {
+        ++rejected;
+        pending.erase({reject->routerID, reject->rxid});
+      }
+    }
+  };
+
+  void
+  Report(
+      const BenchOptions& opts,
+      PathBuildTracker& paths,
+      const llarp::vnet::NetworkStats& before,
+      const llarp::vnet::NetworkStats& after,
+      std::chrono::duration<double> elapsed)
+  {
+    auto& lat = paths.latenciesMS;
+    std::sort(lat.begin(), lat.end());
+    const auto secs = elapsed.count();
+    const auto datagrams = after.delivered - before.delivered;
+    const auto bytes = after.bytesDelivered - before.bytesDelivered;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << opts.relays << " relays, " << opts.clients << " clients, "
+              << opts.link.latency.count() / 1000.0 << "ms link latency, "
+              << opts.link.bytesPerSecond << " B/s link bandwidth (0 is unlimited), "
+              << opts.link.loss * 100 << "% loss, " << secs << "s measured" << std::endl;
+    std::cout << "path builds: " << paths.attempts << " attempted, " << lat.size()
+              << " succeeded, " << paths.rejected << " rejected, " << paths.failed
+              << " failed, " << paths.pending.size() << " unanswered" << std::endl;
+    std::cout << "path build rate: " << lat.size() / secs << "/s" << std::endl;
+    std::cout << "path build latency ms: p50 " << Percentile(lat, 50) << " p90 "
+              << Percentile(lat, 90) << " p99 " << Percentile(lat, 99) << " max "
+              << (lat.empty() ? 0 : lat.back()) << std::endl;
+    std::cout << "relay throughput: " << datagrams / secs << " datagrams/s, "
+              << bytes / secs / 1024 << " KiB/s, "
+              << (after.dropped - before.dropped) << " datagrams dropped" << std::endl;
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  cxxopts::Options cli(
+      "lokinet-hive-bench", "runs relays and clients on a virtual network in one process");
+
+  // clang-format off
+  cli.add_options()
+    ("h,help", "help", cxxopts::value<bool>())
+    ("v,verbose", "log at info instead of warn", cxxopts::value<bool>())
+    ("relays", "number of relays", cxxopts::value<size_t>())
+    ("clients", "number of clients", cxxopts::value<size_t>())
+    ("warmup", "seconds to let the clients settle before measuring", cxxopts::value<int64_t>())
+    ("duration", "seconds to measure for", cxxopts::value<int64_t>())
+    ("latency", "one way link latency in milliseconds", cxxopts::value<double>())
+    ("bandwidth", "link bytes per second, 0 for unlimited", cxxopts::value<uint64_t>())
+    ("loss", "chance in [0, 1] a datagram is lost", cxxopts::value<double>())
+    ("seed", "seed for link loss", cxxopts::value<uint64_t>())
+    ("dir", "where the routers keep their data", cxxopts::value<std::string>())
+    ;
+  // clang-format on
+
+  BenchOptions opts;
+  opts.link.latency = 20ms;
+  try
+  {
+    const auto result = cli.parse(argc, argv);
+    if (result.count("help"))
+    {
+      std::cout << cli.help() << std::endl;
+      return 0;
+    }
+    llarp::SetLogLevel(result.count("verbose") ? llarp::eLogInfo : llarp::eLogWarn);
+    if (result.count("relays"))
+      opts.relays = std::max(size_t{1}, result["relays"].as<size_t>());
+    if (result.count("clients"))
+      opts.clients = result["clients"].as<size_t>();
+    if (result.count("warmup"))
+      opts.warmup = std::chrono::seconds{result["warmup"].as<int64_t>()};
+    if (result.count("duration"))
+      opts.duration = std::chrono::seconds{result["duration"].as<int64_t>()};
+    if (result.count("latency"))
+    {
+      opts.link.latency = std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::duration<double, std::milli>{result["latency"].as<double>()});
+    }
+    if (result.count("bandwidth"))
+      opts.link.bytesPerSecond = result["bandwidth"].as<uint64_t>();
+    if (result.count("loss"))
+      opts.link.loss = result["loss"].as<double>();
+    if (result.count("seed"))
+      opts.seed = result["seed"].as<uint64_t>();
+    if (result.count("dir"))
+      opts.dir = result["dir"].as<std::string>();
+  }
+  catch (const cxxopts::option_not_exists_exception& ex)
+  {
+    std::cerr << ex.what() << std::endl << cli.help() << std::endl;
+    return 1;
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+
+  std::signal(SIGINT, [](int) { g_Stop = 1; });
+
+  // start from fresh identities every run
+  fs::remove_all(opts.dir / "relays");
+  fs::remove_all(opts.dir / "clients");
+  const auto seed = MakeSeed(opts);
+  if (not seed)
+  {
+    std::cerr << "seed relay did not write its rc to " << opts.dir << std::endl;
+    return 1;
+  }
+
+  tooling::RouterHive hive;
+  hive.network = std::make_shared<llarp::vnet::Network>(opts.seed);
+  hive.network->SetDefaultLink(opts.link);
+  for (size_t idx = 0; idx < opts.relays; ++idx)
+  {
+    const auto dir = opts.dir / "relays" / std::to_string(idx);
+    hive.AddRelay(MakeConfig(opts, dir, 30000 + idx, idx == 0 ? std::nullopt : seed));
+  }
+  for (size_t idx = 0; idx < opts.clients; ++idx)
+  {
+    const auto dir = opts.dir / "clients" / std::to_string(idx);
+    hive.AddClient(MakeConfig(opts, dir, std::nullopt, seed));
+  }
+
+  hive.StartRelays();
+  std::this_thread::sleep_for(2s);
+  hive.StartClients();
+
+  PathBuildTracker paths;
+  const auto sleepUntil = [&hive](Clock_t::time_point until, auto onEvent) {
+    while (not g_Stop and Clock_t::now() < until)
+    {
+      std::this_thread::sleep_for(100ms);
+      for (const auto& ev : hive.GetAllEvents())
+        onEvent(*ev);
+    }
+  };
+
+  sleepUntil(Clock_t::now() + opts.warmup, [](const auto&) {});
+  const auto before = hive.network->Stats();
+  const auto started = Clock_t::now();
+  sleepUntil(started + opts.duration, [&paths](const auto& ev) { paths.Handle(ev); });
+  const auto after = hive.network->Stats();
+  const auto elapsed = Clock_t::now() - started;
+
+  hive.StopRouters();
+  Report(opts, paths, before, after, elapsed);
+  return 0;
+}
@@ -0,0 +1,81 @@
+#include "bench.hpp"
+
+#include <llarp/constants/version.hpp>
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/crypto/crypto_libsodium.hpp>
+#include <llarp/util/logging/logger.hpp>
+
+#include <cxxopts.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <optional>
+
+int
+main(int argc, char* argv[])
+{
+  cxxopts::Options cli("lokinet-bench", "micro benchmarks for lokinet hot paths");
+
+  // clang-format off
+  cli.add_options()
+    ("h,help", "help", cxxopts::value<bool>())
+    ("f,filter", "only run benchmarks with this in their name", cxxopts::value<std::string>())
+    ("t,min-time", "seconds each benchmark runs for at least", cxxopts::value<double>())
+    ("o,out", "write the json results here instead of stdout", cxxopts::value<std::string>())
+    ;
+  // clang-format on
+
+  std::string filter;
+  double minTime = 0.5;
+  std::optional<std::string> out;
+  try
+  {
+    const auto result = cli.parse(argc, argv);
+    if (result.count("help"))
+    {
+      std::cout << cli.help() << std::endl;
+      return 0;
+    }
+    if (result.count("filter"))
+      filter = result["filter"].as<std::string>();
+    if (result.count("min-time"))
+      minTime = result["min-time"].as<double>();
+    if (result.count("out"))
+      out = result["out"].as<std::string>();
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl << cli.help() << std::endl;
+    return 1;
+  }
+
+  llarp::SetLogLevel(llarp::eLogError);
+  llarp::sodium::CryptoLibSodium crypto;
+  llarp::CryptoManager manager{&crypto};
+
+  llarp::bench::Runner runner{filter, std::chrono::duration<double>{minTime}};
+  llarp::bench::BenchCrypto(runner);
+  llarp::bench::BenchBencode(runner);
+  llarp::bench::BenchNodeDB(runner);
+  llarp::bench::BenchDNS(runner);
+  llarp::bench::BenchIPPacket(runner);
+  llarp::bench::BenchIWP(runner);
+
+  nlohmann::json results{{"version", llarp::VERSION_FULL}, {"benchmarks", nlohmann::json::array()}};
+  for (const auto& result : runner.Results())
+    results["benchmarks"].push_back(result.ToJSON());
+
+  if (out)
+  {
+    std::ofstream f{*out};
+    f << results.dump(2) << std::endl;
+    if (not f)
+    {
+      std::cerr << "failed to write " << *out << std::endl;
+      return 1;
+    }
+  }
+  else
+    std::cout << results.dump(2) << std::endl;
+  return 0;
+}
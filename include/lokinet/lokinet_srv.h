@@ -42,6 +42,44 @@ extern "C"
       struct lokinet_srv_lookup_result* result,
       struct lokinet_context* ctx);
 
+  /// called on lokinet's event loop thread once an async srv lookup is done, error in the result
+  /// is set the same as lokinet_srv_lookup would return
+  /// caller MUST still call lokinet_srv_lookup_done on the result, the callback must not block
+  typedef void (*lokinet_srv_lookup_callback)(struct lokinet_srv_lookup_result*, void*);
+
+  /// an srv lookup for lokinet_srv_lookups_async to do
+  struct lokinet_srv_request
+  {
+    const char* host;
+    const char* service;
+    /// where the records go, must stay around until callback is called
+    struct lokinet_srv_lookup_result* result;
+    /// called exactly once when the lookup is done
+    lokinet_srv_lookup_callback callback;
+    /// passed into callback as void *
+    void* user;
+  };
+
+  /// do many srv lookups without waiting
+  /// all of the requests are handed to lokinet's event loop in one go
+  /// returns 0 if the lookups were queued and each callback will be called later
+  /// returns nonzero errno if nothing was queued in which case no callbacks are called
+  int EXPORT
+  lokinet_srv_lookups_async(
+      const struct lokinet_srv_request* requests, size_t num_requests, struct lokinet_context* ctx);
+
+  /// async variant of lokinet_srv_lookup
+  /// returns 0 if the lookup was queued and callback will be called later
+  /// returns nonzero errno if it was not queued in which case callback is not called
+  int EXPORT
+  lokinet_srv_lookup_async(
+      const char* host,
+      const char* service,
+      struct lokinet_srv_lookup_result* result,
+      lokinet_srv_lookup_callback callback,
+      void* user,
+      struct lokinet_context* ctx);
+
   /// a hook function to handle each srv record in a srv lookup result
   /// passes in NULL when we are at the end of iteration
   /// passes in void * user data
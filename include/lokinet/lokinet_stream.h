@@ -35,6 +35,44 @@ extern "C"
       const char* localAddr,
       struct lokinet_context* context);
 
+  /// called with the result of an async stream mapping attempt on lokinet's event loop thread
+  /// the result is only valid for the duration of the call and the callback must not block
+  typedef void (*lokinet_stream_callback)(const struct lokinet_stream_result*, void*);
+
+  /// an outbound stream for lokinet_outbound_streams_async to open
+  struct lokinet_stream_request
+  {
+    /// in the form of "name:port"
+    const char* remote_addr;
+    /// either NULL for any or in the form of "ip:port" to bind to an explicit address
+    const char* local_addr;
+    /// called exactly once with the result of this request
+    lokinet_stream_callback callback;
+    /// passed into callback as void *
+    void* user;
+  };
+
+  /// connect out to many remote endpoints without waiting
+  /// all of the requests are handed to lokinet's event loop in one go
+  /// returns 0 if the requests were queued and each callback will be called later
+  /// returns nonzero errno if nothing was queued in which case no callbacks are called
+  int EXPORT
+  lokinet_outbound_streams_async(
+      const struct lokinet_stream_request* requests,
+      size_t num_requests,
+      struct lokinet_context* context);
+
+  /// async variant of lokinet_outbound_stream
+  /// returns 0 if the request was queued and callback will be called later
+  /// returns nonzero errno if it was not queued in which case callback is not called
+  int EXPORT
+  lokinet_outbound_stream_async(
+      const char* remoteAddr,
+      const char* localAddr,
+      lokinet_stream_callback callback,
+      void* user,
+      struct lokinet_context* context);
+
   /// stream accept filter determines if we should accept a stream or not
   /// return 0 to accept
   /// return -1 to explicitly reject
@@ -15,6 +15,8 @@ extern "C"
 #include <sys/uio.h>
 #endif
 
+#include <time.h>
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -71,12 +73,15 @@ extern "C"
       int exposedPort,
       char* srv,
       char* localAddr,
-      struct lokinet_udp_listen_result* result,
+      struct lokinet_udp_bind_result* result,
       struct lokinet_context* ctx);
 
   /// poll many udp sockets for activity
+  /// waits until at least one of the sockets has packets for lokinet_udp_recvmmsg or timeout
+  /// passes, a NULL timeout waits forever
   /// returns 0 on sucess
   ///
+  /// returns ETIMEDOUT if nothing came in before the timeout
   /// returns non zero errno on error
   int EXPORT
   lokinet_udp_poll(
@@ -93,12 +98,35 @@ extern "C"
   };
 
   /// analog to recvmmsg
+  /// drains up to max_events queued packets without blocking, each packet is copied into the
+  /// buffer its event's pkt points at and pkt.iov_len is set to how much was copied, packets
+  /// larger than the buffer are truncated.
+  /// returns the number of events filled in, 0 if nothing is queued
+  /// returns -1 if the socket does not exist
   ssize_t EXPORT
   lokinet_udp_recvmmsg(
       int socket_id,
       struct lokinet_udp_pkt* events,
       size_t max_events,
-      struct lokient_context* ctx);
+      struct lokinet_context* ctx);
+
+  /// analog to sendmmsg
+  /// queue up num_events packets to send and return without waiting for them to go out.
+  /// remote_addr and remote_port of each event are ignored on sockets made by
+  /// lokinet_udp_establish and the flow's remote is used instead.
+  /// returns the number of packets queued, this stops short of num_events at the first packet
+  /// that can't be queued because the send queue is full, it is too big or its remote is invalid
+  /// returns -1 if the socket does not exist
+  ssize_t EXPORT
+  lokinet_udp_sendmmsg(
+      int socket_id,
+      const struct lokinet_udp_pkt* events,
+      size_t num_events,
+      struct lokinet_context* ctx);
+
+  /// close a udp socket made by lokinet_udp_bind or lokinet_udp_establish
+  void EXPORT
+  lokinet_udp_close(int socket_id, struct lokinet_context* ctx);
 
 #ifdef __cplusplus
 }
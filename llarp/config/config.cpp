@@ -939,6 +939,37 @@ namespace llarp
             "Recommend localhost-only for security purposes.",
         });
 
+    conf.defineOption<std::string>(
+        "api",
+        "metrics-bind",
+        [this](std::string arg) {
+          if (arg.empty())
+            return;
+          m_metricsBindAddr = SockAddr{std::move(arg)};
+          if (not m_metricsBindAddr->getPort())
+            throw std::invalid_argument{"[api]:metrics-bind needs a port"};
+        },
+        Comment{
+            "IP address and port to serve metrics on over http in the OpenMetrics format,",
+            "for prometheus and the like to scrape from /metrics. Disabled if not given.",
+            "Recommend localhost-only for security purposes.",
+        });
+
+    conf.defineOption<int>(
+        "api",
+        "trace-sample-rate",
+        Default{16},
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("trace-sample-rate must be >= 0");
+          m_traceSampleRate = arg;
+        },
+        Comment{
+            "Path builds and hidden service session setups are traced stage by stage. Every one",
+            "of them feeds the per stage latencies of the rpc traces command, one in this many",
+            "also keeps its spans for the rpc trace_export command, 0 keeps none.",
+        });
+
     conf.defineOption<std::string>("api", "authkey", Deprecated);
 
     // TODO: this was from pre-refactor:
@@ -1082,6 +1113,49 @@ namespace llarp
             "left empty then logging is printed as standard output rather than written to a",
             "file.",
         });
+
+    conf.defineOption<bool>(
+        "logging",
+        "async",
+        Default{true},
+        AssignmentAcceptor(m_logAsync),
+        Comment{
+            "Format log statements on a background thread rather than on the thread logging",
+            "them.",
+        });
+
+    conf.defineOption<std::string>(
+        "logging",
+        "subsystem-level",
+        MultiValue,
+        [this](std::string arg) {
+          const auto pos = arg.find(':');
+          if (pos == std::string::npos)
+            throw std::invalid_argument{"subsystem-level must look like subsystem:level"};
+          std::optional<LogLevel> level = LogLevelFromString(arg.substr(pos + 1));
+          if (not level)
+            throw std::invalid_argument(stringify("invalid log level value: ", arg));
+          m_subsystemLevels[arg.substr(0, pos)] = *level;
+        },
+        Comment{
+            "Log one subsystem at a level other than the one given by level=, as",
+            "subsystem:level. The subsystem is the source directory the code lives in, for",
+            "example iwp:debug or path:trace. May be given more than once.",
+        });
+
+    conf.defineOption<int>(
+        "logging",
+        "crash-dump-records",
+        Default{256},
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("crash-dump-records must be >= 0");
+          m_crashDumpRecords = arg;
+        },
+        Comment{
+            "How many of the most recent log records to print to stderr if lokinet crashes.",
+            "Only used with async=true, 0 turns the crash dump off.",
+        });
   }
 
   void
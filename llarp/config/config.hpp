@@ -24,6 +24,7 @@
 #include <utility>
 #include <vector>
 #include <unordered_set>
+#include <unordered_map>
 
 #include <oxenmq/address.h>
 
@@ -175,6 +176,10 @@ namespace llarp
   {
     bool m_enableRPCServer = false;
     std::string m_rpcBindAddr;
+    /// where to serve metrics over http, not at all if unset
+    std::optional<SockAddr> m_metricsBindAddr;
+    /// keep the spans of one in this many traced operations, 0 for none
+    uint32_t m_traceSampleRate = 16;
 
     void
     defineConfigOptions(ConfigDefinition& conf, const ConfigGenParameters& params);
@@ -204,6 +209,9 @@ namespace llarp
     LogType m_logType = LogType::Unknown;
     LogLevel m_logLevel = eLogNone;
     std::string m_logFile;
+    bool m_logAsync = true;
+    size_t m_crashDumpRecords = 256;
+    std::unordered_map<std::string, LogLevel> m_subsystemLevels;
 
     void
     defineConfigOptions(ConfigDefinition& conf, const ConfigGenParameters& params);
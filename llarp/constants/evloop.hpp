@@ -4,4 +4,7 @@ namespace llarp
 {
   /// default queue length for logic jobs
   constexpr std::size_t event_loop_queue_size = 1024;
+
+  /// most packets we read off a network interface before handing them over in one batch
+  constexpr std::size_t network_interface_read_batch = 64;
 }  // namespace llarp
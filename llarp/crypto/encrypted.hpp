@@ -15,6 +15,9 @@ namespace llarp
   template <size_t bufsz = MAX_LINK_MSG_SIZE>
   struct Encrypted
   {
+    /// the most we can hold
+    static constexpr size_t MaxSize = bufsz;
+
     Encrypted(Encrypted&& other)
     {
       _sz = std::move(other._sz);
@@ -0,0 +1,164 @@
+#include "answer_cache.hpp"
+
+#include "dns.hpp"
+#include "name.hpp"
+#include <llarp/net/ip.hpp>
+#include <llarp/util/endian.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+
+namespace llarp::dns
+{
+  AnswerCache::AnswerCache(size_t maxEntries) : m_MaxEntries{maxEntries}
+  {}
+
+  AnswerCache::Key
+  AnswerCache::MakeKey(const Question& question)
+  {
+    Key k{question.qname, question.qtype, question.qclass};
+    std::transform(k.name.begin(), k.name.end(), k.name.begin(), [](unsigned char ch) {
+      return std::tolower(ch);
+    });
+    return k;
+  }
+
+  llarp_time_t
+  AnswerCache::TTLFor(const Message& reply)
+  {
+    const auto rcode = reply.hdr_fields & 0x0f;
+    if (rcode == flags_RCODENameError)
+      return NegativeTTL;
+    if (rcode != flags_RCODENoError)
+      return 0s;
+    if (reply.answers.empty())
+      return NegativeTTL;
+    RR_TTL_t ttl = std::numeric_limits<RR_TTL_t>::max();
+    for (const auto& rr : reply.answers)
+      ttl = std::min(ttl, rr.ttl);
+    // a ttl of a second or less means the answer is not meant to stick around
+    if (ttl <= 1)
+      return 0s;
+    return std::min(llarp_time_t{std::chrono::seconds{ttl}}, MaxTTL);
+  }
+
+  void
+  AnswerCache::Put(const Message& reply, const llarp_buffer_t& wire, llarp_time_t now)
+  {
+    if (reply.questions.size() != 1 or wire.sz < MessageHeader::Size)
+      return;
+    const auto ttl = TTLFor(reply);
+    if (ttl == 0s)
+      return;
+    auto key = MakeKey(reply.questions[0]);
+    if (m_Entries.size() >= m_MaxEntries and m_Entries.find(key) == m_Entries.end())
+    {
+      Decay(now);
+      if (m_Entries.size() >= m_MaxEntries)
+      {
+        // still full, make room by dropping whatever would expire first
+        m_Entries.erase(std::min_element(
+            m_Entries.begin(), m_Entries.end(), [](const auto& a, const auto& b) {
+              return a.second.expiresAt < b.second.expiresAt;
+            }));
+      }
+    }
+    MessageView view;
+    if (not view.Parse(wire))
+      return;
+    Entry entry{};
+    entry.reply.wire.assign(wire.base, wire.base + wire.sz);
+    entry.storedAt = now;
+    entry.expiresAt = now + ttl;
+    const bool ok = view.ForEachRR([&entry](const RRView& rr) {
+      // the ttl sits right before the rdata length
+      entry.ttls.emplace_back(rr.rdataOffset - 6, rr.ttl);
+      if (rr.rr_type == qTypeA and rr.rdataLen == 4)
+        entry.reply.addrs.push_back(
+            net::ExpandV4(huint32_t{bufbe32toh(rr.packet + rr.rdataOffset)}));
+      else if (rr.rr_type == qTypeAAAA and rr.rdataLen == 16)
+      {
+        in6_addr addr;
+        std::copy_n(rr.packet + rr.rdataOffset, 16, addr.s6_addr);
+        entry.reply.addrs.push_back(net::In6ToHUInt(addr));
+      }
+    });
+    if (not ok)
+      return;
+    if (huint128_t ip; reply.questions[0].qtype == qTypePTR
+        and DecodePTR(reply.questions[0].qname, ip))
+      entry.reply.addrs.push_back(ip);
+    m_Entries[std::move(key)] = std::move(entry);
+  }
+
+  const AnswerCache::Reply*
+  AnswerCache::Get(const Question& question, MsgID_t id, llarp_time_t now)
+  {
+    return Find(MakeKey(question), id, now);
+  }
+
+  const AnswerCache::Reply*
+  AnswerCache::Get(const QuestionView& question, MsgID_t id, llarp_time_t now)
+  {
+    m_Scratch.name.clear();
+    question.name.ForEachLabel([&name = m_Scratch.name](std::string_view label) {
+      for (unsigned char ch : label)
+        name += std::tolower(ch);
+      name += '.';
+    });
+    m_Scratch.type = question.qtype;
+    m_Scratch.cls = question.qclass;
+    return Find(m_Scratch, id, now);
+  }
+
+  const AnswerCache::Reply*
+  AnswerCache::Find(const Key& key, MsgID_t id, llarp_time_t now)
+  {
+    auto itr = m_Entries.find(key);
+    if (itr == m_Entries.end())
+      return nullptr;
+    auto& entry = itr->second;
+    if (entry.expiresAt <= now)
+    {
+      m_Entries.erase(itr);
+      return nullptr;
+    }
+    auto& wire = entry.reply.wire;
+    htobe16buf(wire.data(), id);
+    // whoever gets this should not keep it for longer than we would have
+    const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - entry.storedAt);
+    const auto left = std::chrono::ceil<std::chrono::seconds>(entry.expiresAt - now);
+    for (const auto& [offset, ttl] : entry.ttls)
+    {
+      const auto remaining = std::max<int64_t>(ttl - elapsed.count(), 1);
+      htobe32buf(wire.data() + offset, std::min<int64_t>(remaining, left.count()));
+    }
+    return &entry.reply;
+  }
+
+  void
+  AnswerCache::RemoveAddress(huint128_t ip)
+  {
+    for (auto itr = m_Entries.begin(); itr != m_Entries.end();)
+    {
+      const auto& addrs = itr->second.reply.addrs;
+      if (std::find(addrs.begin(), addrs.end(), ip) != addrs.end())
+        itr = m_Entries.erase(itr);
+      else
+        ++itr;
+    }
+  }
+
+  void
+  AnswerCache::Decay(llarp_time_t now)
+  {
+    for (auto itr = m_Entries.begin(); itr != m_Entries.end();)
+    {
+      if (itr->second.expiresAt <= now)
+        itr = m_Entries.erase(itr);
+      else
+        ++itr;
+    }
+  }
+}  // namespace llarp::dns
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "message.hpp"
+#include "wire.hpp"
+#include <llarp/util/types.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace llarp::dns
+{
+  /// encoded replies to queries we answered ourselves, keyed by question, kept for as long as
+  /// their answers' ttl says. a hit only needs the transaction id and ttls patched before it is
+  /// sent. the addresses a reply is about are kept with it so replies naming an address can be
+  /// dropped once that address is given to someone else.
+  class AnswerCache
+  {
+   public:
+    struct Reply
+    {
+      std::vector<byte_t> wire;
+      /// addresses in its A and AAAA answers, or the address a PTR query asked about
+      std::vector<huint128_t> addrs;
+    };
+
+    static constexpr size_t DefaultMaxEntries = 1024;
+    /// how long we remember NXDOMAIN and empty answers
+    static constexpr llarp_time_t NegativeTTL = 5s;
+    /// longest we keep anything
+    static constexpr llarp_time_t MaxTTL = 10min;
+
+    explicit AnswerCache(size_t maxEntries = DefaultMaxEntries);
+
+    /// remember reply to the question it has, wire is reply as encoded
+    void
+    Put(const Message& reply, const llarp_buffer_t& wire, llarp_time_t now);
+
+    /// get the cached reply to question with its id set to id and its ttls counted down to what
+    /// is left of them, nullptr if we have none. the pointer is good until the next Put
+    const Reply*
+    Get(const Question& question, MsgID_t id, llarp_time_t now);
+
+    /// same as above straight off the wire
+    const Reply*
+    Get(const QuestionView& question, MsgID_t id, llarp_time_t now);
+
+    /// drop every reply that is about ip
+    void
+    RemoveAddress(huint128_t ip);
+
+    /// drop everything that expired
+    void
+    Decay(llarp_time_t now);
+
+    size_t
+    Size() const
+    {
+      return m_Entries.size();
+    }
+
+   private:
+    struct Key
+    {
+      std::string name;
+      QType_t type;
+      QClass_t cls;
+
+      bool
+      operator==(const Key& other) const
+      {
+        return type == other.type and cls == other.cls and name == other.name;
+      }
+    };
+
+    struct KeyHash
+    {
+      size_t
+      operator()(const Key& k) const
+      {
+        return std::hash<std::string>{}(k.name) ^ (size_t{k.type} << 16 | k.cls);
+      }
+    };
+
+    struct Entry
+    {
+      Reply reply;
+      llarp_time_t storedAt;
+      llarp_time_t expiresAt;
+      /// where each record's ttl is in the wire and what it was when stored
+      std::vector<std::pair<size_t, RR_TTL_t>> ttls;
+    };
+
+    static Key
+    MakeKey(const Question& question);
+
+    /// how long reply can be cached, 0 if it should not be
+    static llarp_time_t
+    TTLFor(const Message& reply);
+
+    const Reply*
+    Find(const Key& key, MsgID_t id, llarp_time_t now);
+
+    const size_t m_MaxEntries;
+    /// reused to look up questions straight off the wire without allocating
+    Key m_Scratch;
+    std::unordered_map<Key, Entry, KeyHash> m_Entries;
+  };
+}  // namespace llarp::dns
@@ -2,6 +2,7 @@
 
 #include "dns.hpp"
 #include "srv_data.hpp"
+#include "wire.hpp"
 #include <llarp/util/buffer.hpp>
 #include <llarp/util/endian.hpp>
 #include <llarp/util/logging/logger.hpp>
@@ -85,15 +86,16 @@ namespace llarp
       hdr.ns_count = 0;
       hdr.ar_count = 0;
 
-      if (!hdr.Encode(buf))
+      WireWriter writer{*buf};
+      if (!writer.Header(hdr))
         return false;
 
       for (const auto& question : questions)
-        if (!question.Encode(buf))
+        if (!writer.Question(question))
           return false;
 
       for (const auto& answer : answers)
-        if (!answer.Encode(buf))
+        if (!writer.Record(answer))
           return false;
 
       return true;
@@ -1,12 +1,51 @@
 #include "server.hpp"
 #include "dns.hpp"
 #include <llarp/crypto/crypto.hpp>
+#include <llarp/util/metrics.hpp>
 #include <array>
+#include <chrono>
 #include <utility>
 #include <llarp/ev/udp_handle.hpp>
 
 namespace llarp::dns
 {
+  namespace
+  {
+    metrics::Counter&
+    QueryCounter(std::string kind)
+    {
+      return metrics::Registry::Instance().GetCounter(
+          "lokinet_dns_queries",
+          "dns queries by how we answered them",
+          {{"kind", std::move(kind)}});
+    }
+
+    auto& QueriesInvalid = QueryCounter("invalid");
+    auto& QueriesCached = QueryCounter("cached");
+    auto& QueriesHooked = QueryCounter("hooked");
+    auto& QueriesUpstream = QueryCounter("upstream");
+    auto& QueriesServFail = QueryCounter("servfail");
+    auto& QueriesDoHCanary = QueryCounter("doh_canary");
+    auto& HookedLatency = metrics::Registry::Instance().GetHistogram(
+        "lokinet_dns_hooked_reply_seconds", "time taken to answer queries for lokinet names");
+
+    /// room for any reply we make, they go out as a single udp datagram
+    using ReplyBuffer = std::array<byte_t, 1500>;
+
+    /// encode msg into tmp, returns how much of it was used or 0 if it did not fit
+    size_t
+    EncodeReply(const Message& msg, ReplyBuffer& tmp)
+    {
+      llarp_buffer_t buf{tmp};
+      if (not msg.Encode(&buf))
+      {
+        llarp::LogWarn("cannot encode dns message");
+        return 0;
+      }
+      return buf.cur - buf.base;
+    }
+  }  // namespace
+
   PacketHandler::PacketHandler(EventLoop_ptr loop, IQueryHandler* h)
       : m_QueryHandler{h}, m_Loop{std::move(loop)}
   {}
@@ -60,7 +99,7 @@ namespace llarp::dns
     auto failFunc = [self = weak_from_this()](
                         const SockAddr& from, const SockAddr& to, Message msg) {
       if (auto this_ptr = self.lock())
-        this_ptr->SendServerMessageBufferTo(from, to, msg.ToBuffer());
+        this_ptr->SendServerMessageTo(from, to, msg);
     };
 
     auto replyFunc = [self = weak_from_this()](auto&&... args) {
@@ -101,23 +140,25 @@ namespace llarp::dns
       llarp::LogError("dns reply failed");
   }
 
+  void
+  PacketHandler::SendServerMessageTo(const SockAddr& from, const SockAddr& to, const Message& msg)
+  {
+    ReplyBuffer tmp;
+    if (const auto sz = EncodeReply(msg, tmp))
+      SendServerMessageBufferTo(from, to, llarp_buffer_t{tmp.data(), sz});
+  }
+
   bool
   PacketHandler::ShouldHandlePacket(
       const SockAddr& to, [[maybe_unused]] const SockAddr& from, llarp_buffer_t buf) const
   {
-    MessageHeader hdr;
-    if (not hdr.Decode(&buf))
+    MessageView msg;
+    if (not msg.Parse(buf))
     {
       return false;
     }
 
-    Message msg{hdr};
-    if (not msg.Decode(&buf))
-    {
-      return false;
-    }
-
-    if (m_QueryHandler and m_QueryHandler->ShouldHookDNSMessage(msg))
+    if (m_QueryHandler and m_QueryHandler->ShouldHookDNSQuery(msg))
       return true;
 
     if (m_Resolvers.find(to) != m_Resolvers.end())
@@ -127,45 +168,84 @@ namespace llarp::dns
     return true;
   }
 
+  void
+  PacketHandler::ForgetAddress(huint128_t ip)
+  {
+    m_AnswerCache.RemoveAddress(ip);
+  }
+
   void
   PacketHandler::HandlePacket(const SockAddr& resolver, const SockAddr& from, llarp_buffer_t buf)
   {
-    MessageHeader hdr;
-    if (not hdr.Decode(&buf))
+    MessageView view;
+    if (not view.Parse(buf))
     {
+      QueriesInvalid.Inc();
       llarp::LogWarn("failed to parse dns header from ", from);
       return;
     }
 
-    Message msg(hdr);
-    if (not msg.Decode(&buf))
-    {
-      llarp::LogWarn("failed to parse dns message from ", from);
-      return;
-    }
-
     // we don't provide a DoH resolver because it requires verified TLS
     // TLS needs X509/ASN.1-DER and opting into the Root CA Cabal
     // thankfully mozilla added a backdoor that allows ISPs to turn it off
     // so we disable DoH for firefox using mozilla's ISP backdoor
     // see: https://github.com/loki-project/loki-network/issues/832
-    for (const auto& q : msg.questions)
-    {
+    bool isDoHCanary = false;
+    view.ForEachQuestion([&isDoHCanary](const QuestionView& q) {
       // is this firefox looking for their backdoor record?
-      if (q.IsName("use-application-dns.net"))
+      if (q.name.IsName("use-application-dns.net"))
+        isDoHCanary = true;
+    });
+
+    // hooked queries we answered before are served straight from the wire
+    const bool hooked = not isDoHCanary and m_QueryHandler
+        and m_QueryHandler->ShouldHookDNSQuery(view);
+    if (hooked and view.Header().qd_count == 1)
+    {
+      if (const auto* cached =
+              m_AnswerCache.Get(*view.FirstQuestion(), view.Header().id, m_Loop->time_now()))
       {
-        // yea it is, let's turn off DoH because god is dead.
-        msg.AddNXReply();
-        // press F to pay respects
-        SendServerMessageBufferTo(resolver, from, msg.ToBuffer());
+        QueriesCached.Inc();
+        m_QueryHandler->HandleCachedDNSReply(cached->addrs);
+        SendServerMessageBufferTo(resolver, from, llarp_buffer_t{cached->wire});
         return;
       }
     }
 
-    if (m_QueryHandler && m_QueryHandler->ShouldHookDNSMessage(msg))
+    auto maybe_msg = view.ToMessage();
+    if (not maybe_msg)
+    {
+      QueriesInvalid.Inc();
+      llarp::LogWarn("failed to parse dns message from ", from);
+      return;
+    }
+    Message& msg = *maybe_msg;
+
+    if (isDoHCanary)
+    {
+      // yea it is, let's turn off DoH because god is dead.
+      QueriesDoHCanary.Inc();
+      msg.AddNXReply();
+      // press F to pay respects
+      SendServerMessageTo(resolver, from, msg);
+      return;
+    }
+
+    if (hooked)
     {
-      auto reply = [self = shared_from_this(), to = from, resolver](dns::Message msg) {
-        self->SendServerMessageBufferTo(resolver, to, msg.ToBuffer());
+      QueriesHooked.Inc();
+      auto reply = [self = shared_from_this(),
+                    to = from,
+                    resolver,
+                    startedAt = std::chrono::steady_clock::now()](dns::Message msg) {
+        HookedLatency.Observe(std::chrono::steady_clock::now() - startedAt);
+        ReplyBuffer tmp;
+        const auto sz = EncodeReply(msg, tmp);
+        if (sz == 0)
+          return;
+        const llarp_buffer_t wire{tmp.data(), sz};
+        self->m_AnswerCache.Put(msg, wire, self->m_Loop->time_now());
+        self->SendServerMessageBufferTo(resolver, to, llarp_buffer_t{tmp.data(), sz});
       };
       if (!m_QueryHandler->HandleHookedDNSMessage(std::move(msg), reply))
       {
@@ -176,11 +256,13 @@ namespace llarp::dns
     {
       // no upstream resolvers
       // let's serv fail it
+      QueriesServFail.Inc();
       msg.AddServFail();
-      SendServerMessageBufferTo(resolver, from, msg.ToBuffer());
+      SendServerMessageTo(resolver, from, msg);
     }
     else
     {
+      QueriesUpstream.Inc();
       m_UnboundResolver->Lookup(resolver, from, std::move(msg));
     }
   }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "answer_cache.hpp"
 #include "message.hpp"
+#include "wire.hpp"
 #include <llarp/ev/ev.hpp>
 #include <llarp/net/net.hpp>
 #include "unbound_resolver.hpp"
@@ -17,13 +19,19 @@ namespace llarp
      public:
       virtual ~IQueryHandler() = default;
 
-      /// return true if we should hook this message
+      /// return true if we should hook this message, peeking at the packet where it is
       virtual bool
-      ShouldHookDNSMessage(const Message& msg) const = 0;
+      ShouldHookDNSQuery(const MessageView& msg) const = 0;
 
       /// handle a hooked message
       virtual bool
       HandleHookedDNSMessage(Message query, std::function<void(Message)> sendReply) = 0;
+
+      /// a cached reply to a hooked query went out again without asking us, addrs are the
+      /// addresses it is about
+      virtual void
+      HandleCachedDNSReply(const std::vector<huint128_t>&)
+      {}
     };
 
     // Base class for DNS lookups
@@ -52,6 +60,10 @@ namespace llarp
       bool
       ShouldHandlePacket(const SockAddr& to, const SockAddr& from, llarp_buffer_t buf) const;
 
+      /// stop answering from cache with replies about ip, for when it now belongs to someone else
+      void
+      ForgetAddress(huint128_t ip);
+
      protected:
       virtual void
       SendServerMessageBufferTo(const SockAddr& from, const SockAddr& to, llarp_buffer_t buf) = 0;
@@ -60,10 +72,16 @@ namespace llarp
       void
       HandleUpstreamFailure(const SockAddr& from, const SockAddr& to, Message msg);
 
+      /// encode msg on the stack and send it
+      void
+      SendServerMessageTo(const SockAddr& from, const SockAddr& to, const Message& msg);
+
       bool
       SetupUnboundResolver(std::vector<SockAddr> resolvers, std::vector<fs::path> hostfiles);
 
       IQueryHandler* const m_QueryHandler;
+      /// replies to hooked queries we can send again without asking the handler
+      AnswerCache m_AnswerCache;
       std::set<SockAddr> m_Resolvers;
       std::shared_ptr<UnboundResolver> m_UnboundResolver;
       EventLoop_ptr m_Loop;
@@ -5,6 +5,8 @@
 #include <sstream>
 #include <llarp/util/str.hpp>
 
+#include <uvw/poll.h>
+
 namespace llarp::dns
 {
   struct PendingUnboundLookup
@@ -25,6 +27,11 @@ namespace llarp::dns
   UnboundResolver::Reset()
   {
     started = false;
+    if (m_Poller)
+    {
+      m_Poller->close();
+      m_Poller.reset();
+    }
     if (runner)
     {
       runner->join();
@@ -39,6 +46,7 @@ namespace llarp::dns
 
   UnboundResolver::UnboundResolver(EventLoop_ptr loop, ReplyFunction reply, FailFunction fail)
       : unboundContext(nullptr)
+      , m_Loop(loop)
       , started(false)
       , replyFunc(loop->make_caller(std::move(reply)))
       , failFunc(loop->make_caller(std::move(fail)))
@@ -94,6 +102,10 @@ namespace llarp::dns
     }
 
     ub_ctx_async(unboundContext, 1);
+    started = true;
+    if (StartPolling())
+      return true;
+
     runner = std::make_unique<std::thread>([&]() {
       while (started)
       {
@@ -102,10 +114,35 @@ namespace llarp::dns
         std::this_thread::sleep_for(25ms);
       }
     });
-    started = true;
     return true;
   }
 
+  bool
+  UnboundResolver::StartPolling()
+  {
+#ifdef _WIN32
+    // ub_fd is a pipe there which the event loop cannot poll
+    return false;
+#else
+    auto loop = m_Loop.lock();
+    if (not loop)
+      return false;
+    auto uvloop = loop->MaybeGetUVWLoop();
+    if (not uvloop)
+      return false;
+    m_Poller = uvloop->resource<uvw::PollHandle>(ub_fd(unboundContext));
+    if (not m_Poller)
+      return false;
+    m_Poller->on<uvw::PollEvent>([self = weak_from_this()](const auto&, auto&) {
+      // answers are handed to Callback from in here, on the event loop
+      if (auto this_ptr = self.lock(); this_ptr and this_ptr->unboundContext)
+        ub_process(this_ptr->unboundContext);
+    });
+    m_Poller->start(uvw::PollHandle::Event::READABLE);
+    return true;
+#endif
+  }
+
   bool
   UnboundResolver::AddUpstreamResolver(const SockAddr& upstreamResolver)
   {
@@ -11,9 +11,12 @@
 
 #include "message.hpp"
 
-#ifdef _WIN32
 #include <thread>
-#endif
+
+namespace uvw
+{
+  class PollHandle;
+}
 
 namespace llarp::dns
 {
@@ -27,7 +30,12 @@ namespace llarp::dns
    private:
     ub_ctx* unboundContext;
 
+    std::weak_ptr<EventLoop> m_Loop;
+    /// readable when unbound has answers for us, we process them right on the event loop
+    std::shared_ptr<uvw::PollHandle> m_Poller;
+
     std::atomic<bool> started;
+    /// polls unbound for answers where we cannot watch its fd on the event loop
     std::unique_ptr<std::thread> runner;
 
     ReplyFunction replyFunc;
@@ -36,13 +44,17 @@ namespace llarp::dns
     void
     Reset();
 
+    /// watch unbound's fd on the event loop, returns false if the event loop cannot do that
+    bool
+    StartPolling();
+
    public:
     UnboundResolver(EventLoop_ptr loop, ReplyFunction replyFunc, FailFunction failFunc);
 
     static void
     Callback(void* data, int err, ub_result* result);
 
-    // stop resolver thread
+    // stop resolving and stop watching for answers
     void
     Stop();
 
@@ -0,0 +1,273 @@
+#include "wire.hpp"
+
+#include "dns.hpp"
+#include <llarp/util/endian.hpp>
+
+namespace llarp::dns
+{
+  std::optional<size_t>
+  NameView::WireSize() const
+  {
+    size_t pos = m_Offset;
+    while (pos < m_PacketLen)
+    {
+      const byte_t len = m_Packet[pos];
+      if ((len & 0xc0) == 0xc0)
+      {
+        if (pos + 2 > m_PacketLen)
+          return std::nullopt;
+        return pos + 2 - m_Offset;
+      }
+      if (len == 0)
+        return pos + 1 - m_Offset;
+      pos += len + 1;
+    }
+    return std::nullopt;
+  }
+
+  bool
+  NameView::HasTLD(std::string_view tld) const
+  {
+    if (not tld.empty() and tld.front() == '.')
+      tld.remove_prefix(1);
+    std::string_view last;
+    size_t labels = 0;
+    const bool ok = ForEachLabel([&](std::string_view label) {
+      last = label;
+      ++labels;
+    });
+    return ok and labels > 1 and last == tld;
+  }
+
+  bool
+  NameView::IsName(std::string_view name) const
+  {
+    if (not name.empty() and name.back() == '.')
+      name.remove_suffix(1);
+    bool match = true;
+    const bool ok = ForEachLabel([&](std::string_view label) {
+      if (not match)
+        return;
+      if (name.substr(0, label.size()) != label)
+      {
+        match = false;
+        return;
+      }
+      name.remove_prefix(label.size());
+      if (name.empty())
+        return;
+      if (name.front() != '.')
+      {
+        match = false;
+        return;
+      }
+      name.remove_prefix(1);
+      // a trailing label we have not seen yet has to be there
+      if (name.empty())
+        match = false;
+    });
+    return ok and match and name.empty();
+  }
+
+  std::string
+  NameView::ToString() const
+  {
+    std::string name;
+    ForEachLabel([&name](std::string_view label) {
+      name += label;
+      name += '.';
+    });
+    return name;
+  }
+
+  Question
+  QuestionView::ToQuestion() const
+  {
+    Question q;
+    q.qname = name.ToString();
+    q.qtype = qtype;
+    q.qclass = qclass;
+    return q;
+  }
+
+  bool
+  RRView::HasCNameForTLD(std::string_view tld) const
+  {
+    return rr_type == qTypeCNAME and RDataName().HasTLD(tld);
+  }
+
+  ResourceRecord
+  RRView::ToRecord() const
+  {
+    ResourceRecord rr;
+    rr.rr_name = name.ToString();
+    rr.rr_type = rr_type;
+    rr.rr_class = rr_class;
+    rr.ttl = ttl;
+    rr.rData.assign(packet + rdataOffset, packet + rdataOffset + rdataLen);
+    return rr;
+  }
+
+  bool
+  MessageView::Parse(const llarp_buffer_t& buf)
+  {
+    if (buf.sz < MessageHeader::Size)
+      return false;
+    m_Packet = buf.base;
+    m_PacketLen = buf.sz;
+    llarp_buffer_t hdr{buf.base, MessageHeader::Size};
+    if (not m_Header.Decode(&hdr))
+      return false;
+    size_t pos = MessageHeader::Size;
+    QuestionView q;
+    for (Count_t idx = 0; idx < m_Header.qd_count; ++idx)
+    {
+      const auto next = ReadQuestion(pos, q);
+      if (not next)
+        return false;
+      pos = *next;
+    }
+    m_RecordsOffset = pos;
+    return true;
+  }
+
+  std::optional<QuestionView>
+  MessageView::FirstQuestion() const
+  {
+    if (m_Header.qd_count == 0)
+      return std::nullopt;
+    QuestionView q;
+    ReadQuestion(MessageHeader::Size, q);
+    return q;
+  }
+
+  std::optional<size_t>
+  MessageView::ReadQuestion(size_t pos, QuestionView& q) const
+  {
+    q.name = NameView{m_Packet, m_PacketLen, pos};
+    const auto namelen = q.name.WireSize();
+    if (not namelen or not q.name.ForEachLabel([](auto) {}))
+      return std::nullopt;
+    pos += *namelen;
+    if (pos + 4 > m_PacketLen)
+      return std::nullopt;
+    q.qtype = bufbe16toh(m_Packet + pos);
+    q.qclass = bufbe16toh(m_Packet + pos + 2);
+    return pos + 4;
+  }
+
+  std::optional<size_t>
+  MessageView::ReadRecord(size_t pos, RRView& rr) const
+  {
+    rr.name = NameView{m_Packet, m_PacketLen, pos};
+    const auto namelen = rr.name.WireSize();
+    if (not namelen)
+      return std::nullopt;
+    pos += *namelen;
+    if (pos + 10 > m_PacketLen)
+      return std::nullopt;
+    rr.rr_type = bufbe16toh(m_Packet + pos);
+    rr.rr_class = bufbe16toh(m_Packet + pos + 2);
+    rr.ttl = bufbe32toh(m_Packet + pos + 4);
+    rr.rdataLen = bufbe16toh(m_Packet + pos + 8);
+    rr.rdataOffset = pos + 10;
+    rr.packet = m_Packet;
+    rr.packetLen = m_PacketLen;
+    if (rr.rdataOffset + rr.rdataLen > m_PacketLen)
+      return std::nullopt;
+    return rr.rdataOffset + rr.rdataLen;
+  }
+
+  std::optional<Message>
+  MessageView::ToMessage() const
+  {
+    MessageHeader hdr = m_Header;
+    hdr.qd_count = 0;
+    hdr.an_count = 0;
+    hdr.ns_count = 0;
+    hdr.ar_count = 0;
+    Message msg{hdr};
+    msg.questions.reserve(m_Header.qd_count);
+    ForEachQuestion([&msg](const QuestionView& q) { msg.questions.emplace_back(q.ToQuestion()); });
+
+    const size_t an = m_Header.an_count;
+    const size_t ns = an + m_Header.ns_count;
+    const size_t ar = ns + m_Header.ar_count;
+    msg.answers.reserve(m_Header.an_count);
+    const bool ok = ForEachRecord(ar, [&](size_t idx, const RRView& rr) {
+      if (not rr.name.ForEachLabel([](auto) {}))
+        return;
+      if (idx < an)
+        msg.answers.emplace_back(rr.ToRecord());
+      else if (idx < ns)
+        msg.authorities.emplace_back(rr.ToRecord());
+      else
+        msg.additional.emplace_back(rr.ToRecord());
+    });
+    if (not ok or msg.answers.size() != m_Header.an_count)
+      return std::nullopt;
+    return msg;
+  }
+
+  bool
+  WireWriter::Header(const MessageHeader& hdr)
+  {
+    return hdr.Encode(&m_Buf);
+  }
+
+  std::optional<uint16_t>
+  WireWriter::FindName(std::string_view name) const
+  {
+    for (size_t idx = 0; idx < m_NumNames; ++idx)
+    {
+      if (NameView{m_Start, Size(), m_Names[idx]}.IsName(name))
+        return m_Names[idx];
+    }
+    return std::nullopt;
+  }
+
+  bool
+  WireWriter::Name(std::string_view name)
+  {
+    if (not name.empty() and name.back() == '.')
+      name.remove_suffix(1);
+    if (name.size() + 2 > NameView::MaxNameSize)
+      return false;
+    while (not name.empty())
+    {
+      if (const auto offset = FindName(name))
+      {
+        if (m_Buf.size_left() < 2)
+          return false;
+        return m_Buf.put_uint16(0xc000 | *offset);
+      }
+      const auto dot = name.find('.');
+      const auto label = name.substr(0, dot);
+      if (label.empty() or label.size() > 63 or m_Buf.size_left() < label.size() + 1)
+        return false;
+      if (m_NumNames < MaxNames and Size() <= MaxPointer)
+        m_Names[m_NumNames++] = Size();
+      *m_Buf.cur++ = label.size();
+      std::copy_n(label.data(), label.size(), m_Buf.cur);
+      m_Buf.cur += label.size();
+      name.remove_prefix(dot == std::string_view::npos ? name.size() : dot + 1);
+    }
+    if (m_Buf.size_left() < 1)
+      return false;
+    *m_Buf.cur++ = 0;
+    return true;
+  }
+
+  bool
+  WireWriter::Question(const dns::Question& q)
+  {
+    return Name(q.qname) and m_Buf.put_uint16(q.qtype) and m_Buf.put_uint16(q.qclass);
+  }
+
+  bool
+  WireWriter::Record(const ResourceRecord& rr)
+  {
+    return Name(rr.rr_name) and m_Buf.put_uint16(rr.rr_type) and m_Buf.put_uint16(rr.rr_class)
+        and m_Buf.put_uint32(rr.ttl) and EncodeRData(&m_Buf, rr.rData);
+  }
+}  // namespace llarp::dns
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "message.hpp"
+
+#include <array>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace llarp::dns
+{
+  /// a name inside a dns packet, read in place. compression pointers are followed as the labels
+  /// are walked, nothing is copied until ToString is called.
+  class NameView
+  {
+   public:
+    NameView() = default;
+
+    NameView(const byte_t* packet, size_t packetLen, size_t offset)
+        : m_Packet{packet}, m_PacketLen{packetLen}, m_Offset{offset}
+    {}
+
+    /// call visit(std::string_view) with each label in order, false if the name is malformed
+    template <typename Visit_t>
+    bool
+    ForEachLabel(Visit_t visit) const
+    {
+      size_t pos = m_Offset;
+      size_t total = 0;
+      while (pos < m_PacketLen)
+      {
+        const byte_t len = m_Packet[pos];
+        if ((len & 0xc0) == 0xc0)
+        {
+          if (pos + 1 >= m_PacketLen)
+            return false;
+          const size_t target = (size_t{len & 0x3fu} << 8) | m_Packet[pos + 1];
+          // only ever jump backwards so we can't loop
+          if (target >= pos)
+            return false;
+          pos = target;
+          continue;
+        }
+        // extended label types are long dead
+        if (len & 0xc0)
+          return false;
+        if (len == 0)
+          return true;
+        total += len + 1;
+        if (total > MaxNameSize or pos + 1 + len > m_PacketLen)
+          return false;
+        visit(std::string_view{reinterpret_cast<const char*>(m_Packet + pos + 1), len});
+        pos += len + 1;
+      }
+      return false;
+    }
+
+    /// number of bytes the name takes up where it is, not counting what pointers point at
+    /// nullopt if it runs off the end of the packet
+    std::optional<size_t>
+    WireSize() const;
+
+    /// determine if the last label is tld, which may have a leading dot. like
+    /// Question::HasTLD a bare tld does not count.
+    bool
+    HasTLD(std::string_view tld) const;
+
+    /// determine if we are this dotted name, the trailing dot is optional
+    bool
+    IsName(std::string_view name) const;
+
+    /// dotted name with a trailing dot, the way DecodeName gives it
+    std::string
+    ToString() const;
+
+    static constexpr size_t MaxNameSize = 255;
+
+   private:
+    const byte_t* m_Packet = nullptr;
+    size_t m_PacketLen = 0;
+    size_t m_Offset = 0;
+  };
+
+  struct QuestionView
+  {
+    NameView name;
+    QType_t qtype;
+    QClass_t qclass;
+
+    Question
+    ToQuestion() const;
+  };
+
+  struct RRView
+  {
+    NameView name;
+    RRType_t rr_type;
+    RRClass_t rr_class;
+    RR_TTL_t ttl;
+    /// offset of rdata in the packet
+    size_t rdataOffset;
+    uint16_t rdataLen;
+    /// the packet we are in, for names in rdata
+    const byte_t* packet;
+    size_t packetLen;
+
+    /// name rdata holds, for CNAME and friends
+    NameView
+    RDataName() const
+    {
+      return NameView{packet, packetLen, rdataOffset};
+    }
+
+    /// determine if we are a CNAME pointing into tld
+    bool
+    HasCNameForTLD(std::string_view tld) const;
+
+    ResourceRecord
+    ToRecord() const;
+  };
+
+  /// a dns packet read lazily in place. Parse reads the header and checks the questions, the
+  /// records are only looked at when something asks for them. the packet must outlive the view.
+  class MessageView
+  {
+   public:
+    /// false if buf does not hold a header and well formed questions
+    bool
+    Parse(const llarp_buffer_t& buf);
+
+    const MessageHeader&
+    Header() const
+    {
+      return m_Header;
+    }
+
+    /// call visit(const QuestionView&) for each question
+    template <typename Visit_t>
+    void
+    ForEachQuestion(Visit_t visit) const
+    {
+      size_t pos = MessageHeader::Size;
+      QuestionView q;
+      for (Count_t idx = 0; idx < m_Header.qd_count; ++idx)
+      {
+        // Parse made sure these are all there
+        pos = *ReadQuestion(pos, q);
+        visit(q);
+      }
+    }
+
+    /// call visit(const RRView&) for each answer, false if the answers are malformed
+    template <typename Visit_t>
+    bool
+    ForEachAnswer(Visit_t visit) const
+    {
+      return ForEachRecord(m_Header.an_count, [&](size_t, const RRView& rr) { visit(rr); });
+    }
+
+    /// call visit(const RRView&) for every record in every section, false if any is malformed
+    template <typename Visit_t>
+    bool
+    ForEachRR(Visit_t visit) const
+    {
+      const size_t num = size_t{m_Header.an_count} + m_Header.ns_count + m_Header.ar_count;
+      return ForEachRecord(num, [&](size_t, const RRView& rr) { visit(rr); });
+    }
+
+    std::optional<QuestionView>
+    FirstQuestion() const;
+
+    /// decode everything into a Message
+    std::optional<Message>
+    ToMessage() const;
+
+   private:
+    std::optional<size_t>
+    ReadQuestion(size_t pos, QuestionView& q) const;
+
+    std::optional<size_t>
+    ReadRecord(size_t pos, RRView& rr) const;
+
+    /// visit(idx, rr) the first num records after the questions
+    template <typename Visit_t>
+    bool
+    ForEachRecord(size_t num, Visit_t visit) const
+    {
+      size_t pos = m_RecordsOffset;
+      RRView rr;
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        const auto next = ReadRecord(pos, rr);
+        if (not next)
+          return false;
+        visit(idx, rr);
+        pos = *next;
+      }
+      return true;
+    }
+
+    const byte_t* m_Packet = nullptr;
+    size_t m_PacketLen = 0;
+    MessageHeader m_Header{};
+    size_t m_RecordsOffset = 0;
+  };
+
+  /// writes a dns message into a caller provided buffer starting at its cursor. names are
+  /// compressed against the ones written before them, the table of those lives on the stack.
+  class WireWriter
+  {
+   public:
+    explicit WireWriter(llarp_buffer_t& buf) : m_Buf{buf}, m_Start{buf.cur}
+    {}
+
+    bool
+    Header(const MessageHeader& hdr);
+
+    /// write a dotted name, the trailing dot is optional
+    bool
+    Name(std::string_view name);
+
+    bool
+    Question(const dns::Question& q);
+
+    bool
+    Record(const ResourceRecord& rr);
+
+    /// bytes written so far
+    size_t
+    Size() const
+    {
+      return m_Buf.cur - m_Start;
+    }
+
+   private:
+    /// offset of an earlier written name that is the same as dotted name
+    std::optional<uint16_t>
+    FindName(std::string_view name) const;
+
+    static constexpr size_t MaxNames = 32;
+    /// pointers can only reach this far
+    static constexpr size_t MaxPointer = 0x3fff;
+
+    llarp_buffer_t& m_Buf;
+    byte_t* const m_Start;
+    /// where each name suffix we wrote starts
+    std::array<uint16_t, MaxNames> m_Names;
+    size_t m_NumNames = 0;
+  };
+}  // namespace llarp::dns
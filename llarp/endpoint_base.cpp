@@ -23,6 +23,20 @@ namespace llarp
     return false;
   }
 
+  bool
+  EndpointBase::SendManyToOrQueue(
+      service::ConvoTag tag, std::vector<std::vector<byte_t>>& payloads, service::ProtocolType t)
+  {
+    bool sent = true;
+    for (auto& payload : payloads)
+    {
+      sent = SendToOrQueue(tag, llarp_buffer_t{payload}, t) and sent;
+      m_PayloadPool.Release(std::move(payload));
+    }
+    payloads.clear();
+    return sent;
+  }
+
   std::set<dns::SRVData>
   EndpointBase::SRVRecords() const
   {
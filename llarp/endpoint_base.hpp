@@ -6,6 +6,7 @@
 #include "router_id.hpp"
 #include "llarp/ev/ev.hpp"
 #include "llarp/dns/srv_data.hpp"
+#include "llarp/util/buffer_pool.hpp"
 
 #include <functional>
 #include <memory>
@@ -14,6 +15,7 @@
 #include <optional>
 #include <unordered_set>
 #include <set>
+#include <vector>
 #include "oxenmq/variant.h"
 
 namespace llarp
@@ -27,6 +29,13 @@ namespace llarp
   {
     std::unordered_set<dns::SRVData> m_SRVRecords;
 
+    /// big enough for a full ip packet
+    static constexpr size_t PayloadBufferSize = 1500;
+    static constexpr size_t MinPayloadBufferSize = 128;
+    static constexpr size_t MaxSparePayloadBytes = 256 * PayloadBufferSize;
+
+    util::BufferPool m_PayloadPool{MinPayloadBufferSize, PayloadBufferSize, MaxSparePayloadBytes};
+
    public:
     virtual ~EndpointBase() = default;
 
@@ -124,6 +133,22 @@ namespace llarp
     SendToOrQueue(
         service::ConvoTag tag, const llarp_buffer_t& payload, service::ProtocolType t) = 0;
 
+    /// send several payloads on one convo tag in one go, in order. the default just sends them
+    /// one at a time. the buffers are moved out of payloads and handed back to PayloadPool once
+    /// sent, payloads is left empty but keeps its capacity for the next batch.
+    virtual bool
+    SendManyToOrQueue(
+        service::ConvoTag tag,
+        std::vector<std::vector<byte_t>>& payloads,
+        service::ProtocolType t);
+
+    /// where to get buffers for payloads given to SendManyToOrQueue
+    util::BufferPool&
+    PayloadPool()
+    {
+      return m_PayloadPool;
+    }
+
     /// lookup srv records async
     virtual void
     LookupServiceAsync(
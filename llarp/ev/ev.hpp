@@ -10,6 +10,7 @@
 #include <list>
 #include <future>
 #include <utility>
+#include <vector>
 
 namespace uvw
 {
@@ -177,10 +178,12 @@ namespace llarp
       };
     }
 
+    /// packetHandler is called with batches of packets that were ready to read off the
+    /// interface, the handler may move the packets out of the batch
     virtual bool
     add_network_interface(
         std::shared_ptr<vpn::NetworkInterface> netif,
-        std::function<void(net::IPPacket)> packetHandler) = 0;
+        std::function<void(std::vector<net::IPPacket>&)> packetHandler) = 0;
 
     virtual bool
     add_ticker(std::function<void(void)> ticker) = 0;
@@ -242,7 +242,7 @@ namespace llarp::uv
   bool
   Loop::add_network_interface(
       std::shared_ptr<llarp::vpn::NetworkInterface> netif,
-      std::function<void(llarp::net::IPPacket)> handler)
+      std::function<void(std::vector<llarp::net::IPPacket>&)> handler)
   {
 #ifndef _WIN32
     using event_t = uvw::PollEvent;
@@ -254,13 +254,27 @@ namespace llarp::uv
     if (!handle)
       return false;
 
-    handle->on<event_t>([netif = std::move(netif), handler = std::move(handler)](
-                            const event_t&, [[maybe_unused]] auto& handle) {
-      for (auto pkt = netif->ReadNextPacket(); pkt.sz > 0; pkt = netif->ReadNextPacket())
+    handle->on<event_t>([netif = std::move(netif),
+                         handler = std::move(handler),
+                         pkts = std::vector<llarp::net::IPPacket>{}](
+                            const event_t&, [[maybe_unused]] auto& handle) mutable {
+      bool more = true;
+      while (more)
       {
-        LogDebug("got packet ", pkt.sz);
-        if (handler)
-          handler(std::move(pkt));
+        pkts.clear();
+        while (pkts.size() < network_interface_read_batch)
+        {
+          auto pkt = netif->ReadNextPacket();
+          if (pkt.sz == 0)
+          {
+            more = false;
+            break;
+          }
+          LogDebug("got packet ", pkt.sz);
+          pkts.emplace_back(std::move(pkt));
+        }
+        if (handler and not pkts.empty())
+          handler(pkts);
       }
     });
 
@@ -49,7 +49,7 @@ namespace llarp::uv
     bool
     add_network_interface(
         std::shared_ptr<llarp::vpn::NetworkInterface> netif,
-        std::function<void(llarp::net::IPPacket)> handler) override;
+        std::function<void(std::vector<llarp::net::IPPacket>&)> handler) override;
 
     void
     call_soon(std::function<void(void)> f) override;
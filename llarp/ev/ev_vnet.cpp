@@ -0,0 +1,354 @@
+#include "ev_vnet.hpp"
+
+#include <llarp/util/logging/logger.hpp>
+
+#include <algorithm>
+
+namespace llarp::vnet
+{
+  namespace
+  {
+    bool
+    IsUnspecified(const SockAddr& addr)
+    {
+      return addr.isIPv4() ? addr.asIPv4() == huint32_t{0} : addr.asIPv6() == huint128_t{0};
+    }
+  }  // namespace
+
+  Network::Network(uint64_t seed) : m_Rng{seed}
+  {}
+
+  void
+  Network::SetDefaultLink(LinkParams params)
+  {
+    std::lock_guard lock{m_Access};
+    m_DefaultLink = params;
+  }
+
+  void
+  Network::SetLink(const SockAddr& from, const SockAddr& to, LinkParams params)
+  {
+    std::lock_guard lock{m_Access};
+    m_Links[{ToEndpoint(from), ToEndpoint(to)}].params = params;
+  }
+
+  NetworkStats
+  Network::Stats() const
+  {
+    NetworkStats stats;
+    stats.sent = m_Sent;
+    stats.delivered = m_Delivered;
+    stats.dropped = m_Dropped;
+    stats.bytesDelivered = m_BytesDelivered;
+    return stats;
+  }
+
+  Network::Endpoint
+  Network::ToEndpoint(const SockAddr& addr)
+  {
+    if (IsUnspecified(addr))
+      return {huint128_t{0}, addr.getPort()};
+    return {addr.asIPv6(), addr.getPort()};
+  }
+
+  UDPHandle*
+  Network::Find(const Endpoint& ep) const
+  {
+    if (auto itr = m_Bound.find(ep); itr != m_Bound.end())
+      return itr->second;
+    if (auto itr = m_Bound.find(Endpoint{huint128_t{0}, ep.port}); itr != m_Bound.end())
+      return itr->second;
+    return nullptr;
+  }
+
+  std::optional<SockAddr>
+  Network::Attach(UDPHandle* handle, const SockAddr& addr)
+  {
+    std::lock_guard lock{m_Access};
+    SockAddr bound{addr};
+    auto ep = ToEndpoint(addr);
+    if (ep.port == 0)
+    {
+      // walk the ephemeral range once looking for a free port
+      for (size_t tries = 0; tries < 16384; ++tries)
+      {
+        ep.port = m_NextPort;
+        m_NextPort = m_NextPort == 65535 ? 49152 : m_NextPort + 1;
+        if (m_Bound.count(ep) == 0)
+          break;
+      }
+      bound.setPort(ep.port);
+    }
+    if (not m_Bound.emplace(ep, handle).second)
+    {
+      LogError("virtual network address ", bound, " is already in use");
+      return std::nullopt;
+    }
+    // datagrams from a handle bound on the any address come from loopback, like they would
+    if (IsUnspecified(bound))
+    {
+      if (bound.isIPv4())
+        bound = SockAddr{127, 0, 0, 1, huint16_t{ep.port}};
+      else
+        bound = SockAddr{huint128_t{1}, huint16_t{ep.port}};
+    }
+    return bound;
+  }
+
+  void
+  Network::Detach(UDPHandle* handle, const SockAddr& addr)
+  {
+    std::lock_guard lock{m_Access};
+    // the address we hand out for the any address is not the one we are bound under
+    for (const auto ep : {ToEndpoint(addr), Endpoint{huint128_t{0}, addr.getPort()}})
+    {
+      if (auto itr = m_Bound.find(ep); itr != m_Bound.end() and itr->second == handle)
+      {
+        m_Bound.erase(itr);
+        return;
+      }
+    }
+  }
+
+  bool
+  Network::Send(const SockAddr& from, const SockAddr& to, const llarp_buffer_t& buf)
+  {
+    ++m_Sent;
+    const auto now = Clock_t::now();
+    const auto dst = ToEndpoint(to);
+
+    std::lock_guard lock{m_Access};
+    auto* handle = Find(dst);
+    auto& link = m_Links[{ToEndpoint(from), dst}];
+    const auto& params = link.params ? *link.params : m_DefaultLink;
+    if (handle == nullptr or (params.loss > 0.0 and m_Loss(m_Rng) < params.loss))
+    {
+      ++m_Dropped;
+      return false;
+    }
+    // datagrams queue up behind each other on a link with limited bandwidth
+    auto sentAt = now;
+    if (params.bytesPerSecond)
+    {
+      sentAt = std::max(now, link.nextFree)
+          + std::chrono::duration_cast<Clock_t::duration>(
+                   std::chrono::duration<double>{double(buf.sz) / params.bytesPerSecond});
+      link.nextFree = sentAt;
+    }
+
+    UDPHandle::Datagram dgram;
+    dgram.deliverAt = sentAt + params.latency;
+    dgram.from = from;
+    dgram.data = std::make_unique<byte_t[]>(buf.sz);
+    dgram.sz = buf.sz;
+    std::copy_n(buf.base, buf.sz, dgram.data.get());
+    handle->Enqueue(std::move(dgram));
+    return true;
+  }
+
+  UDPHandle::UDPHandle(std::shared_ptr<Network> net, EventLoop_ptr loop, ReceiveFunc rf)
+      : llarp::UDPHandle{std::move(rf)}, m_Net{std::move(net)}, m_Loop{std::move(loop)}
+  {}
+
+  UDPHandle::~UDPHandle()
+  {
+    close();
+  }
+
+  void
+  UDPHandle::Init()
+  {
+    m_Waker = m_Loop->make_waker([self = weak_from_this()]() {
+      if (auto ptr = self.lock())
+        ptr->Drain();
+    });
+  }
+
+  bool
+  UDPHandle::listen(const SockAddr& addr)
+  {
+    close();
+    m_Addr = m_Net->Attach(this, addr);
+    return m_Addr.has_value();
+  }
+
+  bool
+  UDPHandle::send(const SockAddr& dest, const llarp_buffer_t& buf)
+  {
+    if (not m_Addr and not listen(SockAddr{dest.isIPv4() ? "0.0.0.0:0" : "[::]:0"}))
+      return false;
+    // a datagram lost on the wire still went out as far as the sender can tell
+    m_Net->Send(*m_Addr, dest, buf);
+    return true;
+  }
+
+  void
+  UDPHandle::close()
+  {
+    if (not m_Addr)
+      return;
+    m_Net->Detach(this, *m_Addr);
+    m_Addr.reset();
+    std::lock_guard lock{m_InboxAccess};
+    m_Net->m_Dropped += m_Inbox.size();
+    m_Inbox = decltype(m_Inbox){};
+  }
+
+  void
+  UDPHandle::Enqueue(Datagram dgram)
+  {
+    const auto at = dgram.deliverAt;
+    std::lock_guard lock{m_InboxAccess};
+    m_Inbox.push(std::move(dgram));
+    // a timer that fires before this is due will pick it up, triggers coalesce otherwise
+    if (not m_TimerAt or at < *m_TimerAt)
+      m_Waker->Trigger();
+  }
+
+  void
+  UDPHandle::Drain()
+  {
+    std::vector<Datagram> due;
+    std::optional<Network::Clock_t::duration> wait;
+    {
+      std::lock_guard lock{m_InboxAccess};
+      const auto now = Network::Clock_t::now();
+      while (not m_Inbox.empty() and m_Inbox.top().deliverAt <= now)
+      {
+        // top() is const so the datagram has to be moved out from under the queue
+        due.emplace_back(std::move(const_cast<Datagram&>(m_Inbox.top())));
+        m_Inbox.pop();
+      }
+      if (not m_Inbox.empty())
+      {
+        const auto next = m_Inbox.top().deliverAt;
+        if (not m_TimerAt or next < *m_TimerAt)
+        {
+          m_TimerAt = next;
+          wait = next - now;
+        }
+      }
+      else
+        m_TimerAt.reset();
+    }
+    if (wait)
+    {
+      // loop timers only do milliseconds, rounding up means we never deliver early
+      const auto delay = std::chrono::ceil<std::chrono::milliseconds>(*wait);
+      m_Loop->call_later(delay, [self = weak_from_this()]() {
+        if (auto ptr = self.lock())
+        {
+          {
+            std::lock_guard lock{ptr->m_InboxAccess};
+            ptr->m_TimerAt.reset();
+          }
+          ptr->Drain();
+        }
+      });
+    }
+    for (auto& dgram : due)
+    {
+      ++m_Net->m_Delivered;
+      m_Net->m_BytesDelivered += dgram.sz;
+      on_recv(*this, dgram.from, OwnedBuffer{std::move(dgram.data), dgram.sz});
+    }
+  }
+
+  Loop::Loop(EventLoop_ptr impl, std::shared_ptr<Network> net)
+      : m_Impl{std::move(impl)}, m_Net{std::move(net)}
+  {}
+
+  void
+  Loop::run()
+  {
+    m_Impl->run();
+  }
+
+  bool
+  Loop::running() const
+  {
+    return m_Impl->running();
+  }
+
+  llarp_time_t
+  Loop::time_now() const
+  {
+    return m_Impl->time_now();
+  }
+
+  void
+  Loop::wakeup()
+  {
+    m_Impl->wakeup();
+  }
+
+  void
+  Loop::call_soon(std::function<void(void)> f)
+  {
+    m_Impl->call_soon(std::move(f));
+  }
+
+  void
+  Loop::call_later(llarp_time_t delay_ms, std::function<void(void)> callback)
+  {
+    m_Impl->call_later(delay_ms, std::move(callback));
+  }
+
+  bool
+  Loop::add_network_interface(
+      std::shared_ptr<vpn::NetworkInterface> netif,
+      std::function<void(std::vector<net::IPPacket>&)> packetHandler)
+  {
+    return m_Impl->add_network_interface(std::move(netif), std::move(packetHandler));
+  }
+
+  bool
+  Loop::add_ticker(std::function<void(void)> ticker)
+  {
+    return m_Impl->add_ticker(std::move(ticker));
+  }
+
+  void
+  Loop::stop()
+  {
+    m_Impl->stop();
+  }
+
+  std::shared_ptr<llarp::UDPHandle>
+  Loop::make_udp(UDPReceiveFunc on_recv)
+  {
+    auto udp = std::make_shared<UDPHandle>(m_Net, m_Impl, std::move(on_recv));
+    udp->Init();
+    return udp;
+  }
+
+  void
+  Loop::set_pump_function(std::function<void(void)> pumpll)
+  {
+    m_Impl->set_pump_function(std::move(pumpll));
+  }
+
+  std::shared_ptr<EventLoopWakeup>
+  Loop::make_waker(std::function<void()> callback)
+  {
+    return m_Impl->make_waker(std::move(callback));
+  }
+
+  std::shared_ptr<EventLoopRepeater>
+  Loop::make_repeater()
+  {
+    return m_Impl->make_repeater();
+  }
+
+  bool
+  Loop::inEventLoop() const
+  {
+    return m_Impl->inEventLoop();
+  }
+
+  std::shared_ptr<uvw::Loop>
+  Loop::MaybeGetUVWLoop()
+  {
+    return m_Impl->MaybeGetUVWLoop();
+  }
+}  // namespace llarp::vnet
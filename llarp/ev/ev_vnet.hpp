@@ -0,0 +1,235 @@
+#pragma once
+#include "ev.hpp"
+#include "udp_handle.hpp"
+#include <llarp/net/net_int.hpp>
+#include <llarp/net/sock_addr.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
+#include <vector>
+
+/// an in-process virtual network for running many routers in one process. datagrams are handed
+/// between the udp handles of each router's loop through in memory queues instead of the kernel,
+/// and every link can be given its own latency, bandwidth and loss.
+namespace llarp::vnet
+{
+  /// how one direction of a link between two addresses behaves
+  struct LinkParams
+  {
+    /// one way delay added to every datagram
+    std::chrono::microseconds latency{0};
+    /// how fast the link drains, 0 for no limit
+    uint64_t bytesPerSecond = 0;
+    /// chance in [0, 1] that a datagram is dropped
+    double loss = 0.0;
+  };
+
+  struct NetworkStats
+  {
+    uint64_t sent = 0;
+    uint64_t delivered = 0;
+    /// lost to link loss or sent to an address nobody is bound on
+    uint64_t dropped = 0;
+    uint64_t bytesDelivered = 0;
+  };
+
+  class UDPHandle;
+
+  /// the wire every virtual udp handle is attached to, shared between all the loops using it
+  class Network
+  {
+   public:
+    using Clock_t = std::chrono::steady_clock;
+
+    explicit Network(uint64_t seed = 0);
+
+    /// params used by links that have not been given their own
+    void
+    SetDefaultLink(LinkParams params);
+
+    /// set the params of the link from one address to another, one direction only
+    void
+    SetLink(const SockAddr& from, const SockAddr& to, LinkParams params);
+
+    NetworkStats
+    Stats() const;
+
+    /// bind handle to addr, a zero port picks a free one. returns the address bound to.
+    std::optional<SockAddr>
+    Attach(UDPHandle* handle, const SockAddr& addr);
+
+    void
+    Detach(UDPHandle* handle, const SockAddr& addr);
+
+    /// put a datagram on the wire, queueing it for whoever is bound on to. false if it was
+    /// dropped right away.
+    bool
+    Send(const SockAddr& from, const SockAddr& to, const llarp_buffer_t& buf);
+
+   private:
+    struct Endpoint
+    {
+      huint128_t ip;
+      uint16_t port;
+
+      bool
+      operator<(const Endpoint& other) const
+      {
+        return ip < other.ip or (ip == other.ip and port < other.port);
+      }
+    };
+
+    struct LinkState
+    {
+      std::optional<LinkParams> params;
+      /// when the link is done putting out what it was already given
+      Clock_t::time_point nextFree;
+    };
+
+    static Endpoint
+    ToEndpoint(const SockAddr& addr);
+
+    /// the handle a datagram for ep lands on, falling back to one bound on the any address
+    UDPHandle*
+    Find(const Endpoint& ep) const;
+
+    mutable std::mutex m_Access;
+    std::map<Endpoint, UDPHandle*> m_Bound;
+    std::map<std::pair<Endpoint, Endpoint>, LinkState> m_Links;
+    LinkParams m_DefaultLink;
+    std::mt19937_64 m_Rng;
+    std::uniform_real_distribution<double> m_Loss{0.0, 1.0};
+    uint16_t m_NextPort = 49152;
+
+    std::atomic<uint64_t> m_Sent{0};
+    std::atomic<uint64_t> m_Delivered{0};
+    std::atomic<uint64_t> m_Dropped{0};
+    std::atomic<uint64_t> m_BytesDelivered{0};
+
+    friend class UDPHandle;
+  };
+
+  /// a udp handle on a virtual network. received datagrams are queued until they are due and
+  /// then handed to the receive function on the owning loop.
+  class UDPHandle final : public llarp::UDPHandle, public std::enable_shared_from_this<UDPHandle>
+  {
+   public:
+    UDPHandle(std::shared_ptr<Network> net, EventLoop_ptr loop, ReceiveFunc rf);
+
+    ~UDPHandle() override;
+
+    bool
+    listen(const SockAddr& addr) override;
+
+    bool
+    send(const SockAddr& dest, const llarp_buffer_t& buf) override;
+
+    void
+    close() override;
+
+   private:
+    friend class Network;
+    friend class Loop;
+
+    struct Datagram
+    {
+      Network::Clock_t::time_point deliverAt;
+      SockAddr from;
+      std::unique_ptr<byte_t[]> data;
+      size_t sz;
+
+      bool
+      operator>(const Datagram& other) const
+      {
+        return deliverAt > other.deliverAt;
+      }
+    };
+
+    /// set up the waker, needs to be done once we are owned by a shared_ptr
+    void
+    Init();
+
+    /// called by the network with its lock held, from any thread
+    void
+    Enqueue(Datagram dgram);
+
+    /// hand everything that is due to the receive function, on our loop
+    void
+    Drain();
+
+    const std::shared_ptr<Network> m_Net;
+    const EventLoop_ptr m_Loop;
+    std::shared_ptr<EventLoopWakeup> m_Waker;
+    std::optional<SockAddr> m_Addr;
+
+    std::mutex m_InboxAccess;
+    std::priority_queue<Datagram, std::vector<Datagram>, std::greater<>> m_Inbox;
+    /// when the timer for the next datagram that is not due yet fires, if there is one
+    std::optional<Network::Clock_t::time_point> m_TimerAt;
+  };
+
+  /// wraps a real event loop so the udp handles it makes are on a virtual network, everything
+  /// else goes to the wrapped loop
+  class Loop final : public llarp::EventLoop
+  {
+   public:
+    Loop(EventLoop_ptr impl, std::shared_ptr<Network> net);
+
+    void
+    run() override;
+
+    bool
+    running() const override;
+
+    llarp_time_t
+    time_now() const override;
+
+    void
+    wakeup() override;
+
+    void
+    call_soon(std::function<void(void)> f) override;
+
+    void
+    call_later(llarp_time_t delay_ms, std::function<void(void)> callback) override;
+
+    bool
+    add_network_interface(
+        std::shared_ptr<vpn::NetworkInterface> netif,
+        std::function<void(std::vector<net::IPPacket>&)> packetHandler) override;
+
+    bool
+    add_ticker(std::function<void(void)> ticker) override;
+
+    void
+    stop() override;
+
+    std::shared_ptr<llarp::UDPHandle>
+    make_udp(UDPReceiveFunc on_recv) override;
+
+    void
+    set_pump_function(std::function<void(void)> pumpll) override;
+
+    std::shared_ptr<EventLoopWakeup>
+    make_waker(std::function<void()> callback) override;
+
+    std::shared_ptr<EventLoopRepeater>
+    make_repeater() override;
+
+    bool
+    inEventLoop() const override;
+
+    std::shared_ptr<uvw::Loop>
+    MaybeGetUVWLoop() override;
+
+   private:
+    const EventLoop_ptr m_Impl;
+    const std::shared_ptr<Network> m_Net;
+  };
+}  // namespace llarp::vnet
@@ -150,7 +150,7 @@ namespace llarp
         return false;
       if (auto* rid = std::get_if<RouterID>(&addr))
       {
-        if (m_SNodeKeys.count(PubKey{*rid}) or m_Router->PathToRouterAllowed(*rid))
+        if (IsSNodeKey(PubKey{*rid}) or m_Router->PathToRouterAllowed(*rid))
         {
           ObtainSNodeSession(
               *rid, [hook, routerID = *rid](std::shared_ptr<exit::BaseSession> session) {
@@ -186,6 +186,7 @@ namespace llarp
         exitsObj[item.first.ToString()] = item.second->ExtractStatus();
       }
       obj["exits"] = exitsObj;
+      obj["inetQueue"] = m_InetToNetwork.ExtractStatus();
       return obj;
     }
 
@@ -196,24 +197,24 @@ namespace llarp
     }
 
     bool
-    ExitEndpoint::ShouldHookDNSMessage(const dns::Message& msg) const
+    ExitEndpoint::ShouldHookDNSQuery(const dns::MessageView& msg) const
     {
-      if (msg.questions.size() == 0)
+      const auto q = msg.FirstQuestion();
+      if (not q)
         return false;
       // always hook ptr for ranges we own
-      if (msg.questions[0].qtype == dns::qTypePTR)
+      if (q->qtype == dns::qTypePTR)
       {
         huint128_t ip;
-        if (!dns::DecodePTR(msg.questions[0].qname, ip))
+        if (!dns::DecodePTR(q->name.ToString(), ip))
           return false;
         return m_OurRange.Contains(ip);
       }
-      if (msg.questions[0].qtype == dns::qTypeA || msg.questions[0].qtype == dns::qTypeCNAME
-          || msg.questions[0].qtype == dns::qTypeAAAA)
+      if (q->qtype == dns::qTypeA || q->qtype == dns::qTypeCNAME || q->qtype == dns::qTypeAAAA)
       {
-        if (msg.questions[0].IsName("localhost.loki"))
+        if (q->name.IsName("localhost.loki"))
           return true;
-        if (msg.questions[0].HasTLD(".snode"))
+        if (q->name.HasTLD(".snode"))
           return true;
       }
       return false;
@@ -234,10 +235,10 @@ namespace llarp
         }
         else
         {
-          auto itr = m_IPToKey.find(ip);
-          if (itr != m_IPToKey.end() && m_SNodeKeys.find(itr->second) != m_SNodeKeys.end())
+          const auto* entry = m_AddrMap.FindByIP(ip);
+          if (entry and entry->snode)
           {
-            RouterID them = itr->second;
+            RouterID them = entry->ident;
             msg.AddAReply(them.ToString());
           }
           else
@@ -271,9 +272,13 @@ namespace llarp
           RouterID random;
           if (GetRouter()->GetRandomGoodRouter(random))
           {
-            msg.AddCNAMEReply(random.ToString(), 1);
-            auto ip = ObtainServiceNodeIP(random);
-            msg.AddINReply(ip, false);
+            if (const auto ip = ObtainServiceNodeIP(random))
+            {
+              msg.AddCNAMEReply(random.ToString(), 1);
+              msg.AddINReply(*ip, false);
+            }
+            else
+              msg.AddServFail();
           }
           else
             msg.AddNXReply();
@@ -296,16 +301,17 @@ namespace llarp
           {
             msg.hdr_fields |= dns::flags_QR | dns::flags_AA | dns::flags_RA;
           }
-          else if (m_SNodeKeys.find(pubKey) == m_SNodeKeys.end())
+          else if (not IsSNodeKey(pubKey))
           {
             // we do not have it mapped, async obtain it
             ObtainSNodeSession(
                 r,
-                [&, msg = std::make_shared<dns::Message>(msg), reply](
+                [&, pubKey, msg = std::make_shared<dns::Message>(msg), reply](
                     std::shared_ptr<exit::BaseSession> session) {
-                  if (session && session->IsReady())
+                  const auto* entry = m_AddrMap.FindByIdent(pubKey);
+                  if (session && session->IsReady() && entry)
                   {
-                    msg->AddINReply(m_KeyToIP[pubKey], isV6);
+                    msg->AddINReply(entry->ip, isV6);
                   }
                   else
                   {
@@ -318,10 +324,9 @@ namespace llarp
           else
           {
             // we have it mapped already as a service node
-            auto itr = m_KeyToIP.find(pubKey);
-            if (itr != m_KeyToIP.end())
+            if (const auto* entry = m_AddrMap.FindByIdent(pubKey))
             {
-              ip = itr->second;
+              ip = entry->ip;
               msg.AddINReply(ip, isV6);
             }
             else  // fallback case that should never happen (probably)
@@ -338,12 +343,12 @@ namespace llarp
     void
     ExitEndpoint::ObtainSNodeSession(const RouterID& router, exit::SessionReadyFunc obtainCb)
     {
-      if (not m_Router->rcLookupHandler().SessionIsAllowed(router))
+      if (not m_Router->rcLookupHandler().SessionIsAllowed(router)
+          or not ObtainServiceNodeIP(router))
       {
         obtainCb(nullptr);
         return;
       }
-      ObtainServiceNodeIP(router);
       m_SNodeSessions[router]->AddReadyHook(obtainCb);
     }
 
@@ -374,18 +379,20 @@ namespace llarp
     {
       m_InetToNetwork.Process([&](Pkt_t& pkt) {
         PubKey pk;
+        bool isSNode;
         {
-          auto itr = m_IPToKey.find(pkt.dstv6());
-          if (itr == m_IPToKey.end())
+          const auto* entry = m_AddrMap.FindByIP(pkt.dstv6());
+          if (entry == nullptr)
           {
             // drop
             LogWarn(Name(), " dropping packet, has no session at ", pkt.dstv6());
             return;
           }
-          pk = itr->second;
+          pk = entry->ident;
+          isSNode = entry->snode;
         }
         // check if this key is a service node
-        if (m_SNodeKeys.count(pk))
+        if (isSNode)
         {
           // check if it's a service node session we made and queue it via our
           // snode session that we made otherwise use an inbound session that
@@ -451,10 +458,7 @@ namespace llarp
       // map our address
       const PubKey us(m_Router->pubkey());
       const huint128_t ip = GetIfAddr();
-      m_KeyToIP[us] = ip;
-      m_IPToKey[ip] = us;
-      m_IPActivity[ip] = std::numeric_limits<llarp_time_t>::max();
-      m_SNodeKeys.insert(us);
+      m_AddrMap.Map(ip, us, true, Now(), true);
       if (m_ShouldInitTun)
       {
         vpn::InterfaceInfo info;
@@ -467,8 +471,9 @@ namespace llarp
           llarp::LogError("Could not create interface");
           return false;
         }
+        m_InetFlushWaker = GetRouter()->loop()->make_waker([this]() { Flush(); });
         if (not GetRouter()->loop()->add_network_interface(
-                m_NetIf, [this](net::IPPacket pkt) { OnInetPacket(std::move(pkt)); }))
+                m_NetIf, [this](std::vector<net::IPPacket>& pkts) { OnInetPackets(pkts); }))
         {
           llarp::LogWarn("Could not create tunnel for exit endpoint");
           return false;
@@ -514,66 +519,35 @@ namespace llarp
     bool
     ExitEndpoint::HasLocalMappedAddrFor(const PubKey& pk) const
     {
-      return m_KeyToIP.find(pk) != m_KeyToIP.end();
+      return m_AddrMap.HasIdent(pk);
     }
 
-    huint128_t
-    ExitEndpoint::GetIPForIdent(const PubKey pk)
+    bool
+    ExitEndpoint::IsSNodeKey(const PubKey& pk) const
     {
-      huint128_t found{};
-      if (!HasLocalMappedAddrFor(pk))
-      {
-        // allocate and map
-        found = AllocateNewAddress();
-        if (!m_KeyToIP.emplace(pk, found).second)
-        {
-          LogError(Name(), "failed to map ", pk, " to ", found);
-          return found;
-        }
-        if (!m_IPToKey.emplace(found, pk).second)
-        {
-          LogError(Name(), "failed to map ", found, " to ", pk);
-          return found;
-        }
-        if (HasLocalMappedAddrFor(pk))
-          LogInfo(Name(), " mapping ", pk, " to ", found);
-        else
-          LogError(Name(), "failed to map ", pk, " to ", found);
-      }
-      else
-        found = m_KeyToIP[pk];
-
-      MarkIPActive(found);
-      m_KeyToIP.rehash(0);
-      assert(HasLocalMappedAddrFor(pk));
-      return found;
+      const auto* entry = m_AddrMap.FindByIdent(pk);
+      return entry and entry->snode;
     }
 
-    huint128_t
-    ExitEndpoint::AllocateNewAddress()
+    std::optional<huint128_t>
+    ExitEndpoint::GetIPForIdent(const PubKey pk)
     {
-      if (m_NextAddr < m_HigestAddr)
-        return ++m_NextAddr;
-
-      // find oldest activity ip address
-      huint128_t found = {0};
-      llarp_time_t min = std::numeric_limits<llarp_time_t>::max();
-      auto itr = m_IPActivity.begin();
-      while (itr != m_IPActivity.end())
+      const bool isNew = not HasLocalMappedAddrFor(pk);
+      // allocate and map, kicking the least recently active ident off the exit if we are full
+      // and it has been idle long enough
+      const auto maybe = m_AddrMap.Obtain(pk, false, Now(), [this](const AddrMap_t::Entry& old) {
+        KickIdentOffExit(old.ident);
+        if (m_Resolver)
+          m_Resolver->ForgetAddress(old.ip);
+      });
+      if (not maybe)
       {
-        if (itr->second < min)
-        {
-          found.h = itr->first.h;
-          min = itr->second;
-        }
-        ++itr;
+        LogError(Name(), " failed to map ", pk, ", no addresses left");
+        return std::nullopt;
       }
-      // kick old ident off exit
-      // TODO: DoS
-      PubKey pk = m_IPToKey[found];
-      KickIdentOffExit(pk);
-
-      return found;
+      if (isNew)
+        LogInfo(Name(), " mapping ", pk, " to ", *maybe);
+      return *maybe;
     }
 
     EndpointBase::AddressVariant_t
@@ -637,9 +611,6 @@ namespace llarp
     ExitEndpoint::KickIdentOffExit(const PubKey& pk)
     {
       LogInfo(Name(), " kicking ", pk, " off exit");
-      huint128_t ip = m_KeyToIP[pk];
-      m_KeyToIP.erase(pk);
-      m_IPToKey.erase(ip);
       auto range = m_ActiveExits.equal_range(pk);
       auto exit_itr = range.first;
       while (exit_itr != range.second)
@@ -647,9 +618,17 @@ namespace llarp
     }
 
     void
-    ExitEndpoint::MarkIPActive(huint128_t ip)
+    ExitEndpoint::ReleaseAddressIfUnused(const PubKey& pk)
     {
-      m_IPActivity[ip] = GetRouter()->Now();
+      if (m_ActiveExits.count(pk) or m_SNodeSessions.count(RouterID{pk.as_array()}))
+        return;
+      if (const auto* entry = m_AddrMap.FindByIdent(pk); entry and not entry->pinned)
+      {
+        LogInfo(Name(), " releasing ", entry->ip, " of ", pk);
+        if (m_Resolver)
+          m_Resolver->ForgetAddress(entry->ip);
+        m_AddrMap.RemoveIdent(pk);
+      }
     }
 
     void
@@ -658,6 +637,15 @@ namespace llarp
       m_InetToNetwork.Emplace(std::move(pkt));
     }
 
+    void
+    ExitEndpoint::OnInetPackets(std::vector<net::IPPacket>& pkts)
+    {
+      for (auto& pkt : pkts)
+        m_InetToNetwork.Emplace(std::move(pkt));
+      if (m_InetFlushWaker)
+        m_InetFlushWaker->Trigger();
+    }
+
     bool
     ExitEndpoint::QueueSNodePacket(const llarp_buffer_t& buf, huint128_t from)
     {
@@ -743,8 +731,9 @@ namespace llarp
       const auto host_str = m_OurRange.BaseAddressString();
       // string, or just a plain char array?
       m_IfAddr = m_OurRange.addr;
-      m_NextAddr = m_IfAddr;
-      m_HigestAddr = m_OurRange.HighestAddr();
+      m_AddrMap.SetRange(m_IfAddr, m_OurRange.HighestAddr());
+      // a client keeps its address for at least as long as the path it got it over
+      m_AddrMap.SetMinIdle(path::default_lifetime);
       m_UseV6 = not m_OurRange.IsV4();
 
       m_ifname = networkConfig.m_ifname;
@@ -766,7 +755,7 @@ namespace llarp
       //       (which weren't originally implemented)
     }
 
-    huint128_t
+    std::optional<huint128_t>
     ExitEndpoint::ObtainServiceNodeIP(const RouterID& other)
     {
       const PubKey pubKey{other};
@@ -775,12 +764,16 @@ namespace llarp
       if (pubKey == us)
         return m_IfAddr;
 
-      huint128_t ip = GetIPForIdent(pubKey);
-      if (m_SNodeKeys.emplace(pubKey).second)
+      const auto ip = GetIPForIdent(pubKey);
+      if (not ip)
+        return std::nullopt;
+      auto* entry = m_AddrMap.FindByIdent(pubKey);
+      if (entry and not entry->snode)
       {
+        entry->snode = true;
         auto session = std::make_shared<exit::SNodeSession>(
             other,
-            std::bind(&ExitEndpoint::QueueSNodePacket, this, std::placeholders::_1, ip),
+            std::bind(&ExitEndpoint::QueueSNodePacket, this, std::placeholders::_1, *ip),
             GetRouter(),
             2,
             1,
@@ -807,15 +800,21 @@ namespace llarp
           m_Router->pathContext().GetByUpstream(m_Router->pubkey(), path);
       if (handler == nullptr)
         return false;
-      auto ip = GetIPForIdent(pk);
+      const auto ip = GetIPForIdent(pk);
+      if (not ip)
+      {
+        LogWarn(Name(), " refusing exit for ", pk, ", no addresses left");
+        return false;
+      }
       if (GetRouter()->pathContext().TransitHopPreviousIsRouter(path, pk.as_array()))
       {
         // we think this path belongs to a service node
         // mark it as such so we don't make an outbound session to them
-        m_SNodeKeys.emplace(pk.as_array());
+        if (auto* entry = m_AddrMap.FindByIdent(pk))
+          entry->snode = true;
       }
       m_ActiveExits.emplace(
-          pk, std::make_unique<exit::Endpoint>(pk, handler, !wantInternet, ip, this));
+          pk, std::make_unique<exit::Endpoint>(pk, handler, !wantInternet, *ip, this));
 
       m_Paths[path] = pk;
 
@@ -860,7 +859,11 @@ namespace llarp
         while (itr != m_SNodeSessions.end())
         {
           if (itr->second->IsExpired(now))
+          {
+            const PubKey pk{itr->first};
             itr = m_SNodeSessions.erase(itr);
+            ReleaseAddressIfUnused(pk);
+          }
           else
           {
             itr->second->Tick(now);
@@ -874,7 +877,11 @@ namespace llarp
         while (itr != m_ActiveExits.end())
         {
           if (itr->second->IsExpired(now))
+          {
+            const PubKey pk{itr->first};
             itr = m_ActiveExits.erase(itr);
+            ReleaseAddressIfUnused(pk);
+          }
           else
             ++itr;
         }
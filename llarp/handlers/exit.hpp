@@ -66,7 +66,7 @@ namespace llarp
       SupportsV6() const;
 
       bool
-      ShouldHookDNSMessage(const dns::Message& msg) const override;
+      ShouldHookDNSQuery(const dns::MessageView& msg) const override;
 
       bool
       HandleHookedDNSMessage(dns::Message msg, std::function<void(dns::Message)>) override;
@@ -93,6 +93,10 @@ namespace llarp
       void
       OnInetPacket(net::IPPacket buf);
 
+      /// handle a batch of ip packets from outside, moves out of them
+      void
+      OnInetPackets(std::vector<net::IPPacket>& pkts);
+
       AbstractRouter*
       GetRouter();
 
@@ -151,29 +155,32 @@ namespace llarp
       quic::TunnelManager*
       GetQUICTunnel() override;
 
-      huint128_t
+      /// get the ip mapped to pk, mapping it if needed, nullopt if we have none to give it
+      std::optional<huint128_t>
       GetIPForIdent(const PubKey pk);
       /// async obtain snode session and call callback when it's ready to send
       void
       ObtainSNodeSession(const RouterID& router, exit::SessionReadyFunc obtainCb);
 
      private:
-      huint128_t
-      AllocateNewAddress();
+      /// return true if we treat this key as a service node
+      bool
+      IsSNodeKey(const PubKey& pk) const;
 
       /// obtain ip for service node session, creates a new session if one does
-      /// not existing already
-      huint128_t
+      /// not existing already, nullopt if we have no address for it
+      std::optional<huint128_t>
       ObtainServiceNodeIP(const RouterID& router);
 
       bool
       QueueSNodePacket(const llarp_buffer_t& buf, huint128_t from);
 
       void
-      MarkIPActive(huint128_t ip);
+      KickIdentOffExit(const PubKey& pk);
 
+      /// give pk's address back once it has no exit or snode session left
       void
-      KickIdentOffExit(const PubKey& pk);
+      ReleaseAddressIfUnused(const PubKey& pk);
 
       AbstractRouter* m_Router;
       std::shared_ptr<dns::Proxy> m_Resolver;
@@ -186,29 +193,18 @@ namespace llarp
 
       std::unordered_multimap<PubKey, std::unique_ptr<exit::Endpoint>> m_ActiveExits;
 
-      using KeyMap_t = std::unordered_map<PubKey, huint128_t>;
-
-      KeyMap_t m_KeyToIP;
-
-      using SNodes_t = std::set<PubKey>;
-      /// set of pubkeys we treat as snodes
-      SNodes_t m_SNodeKeys;
+      using AddrMap_t = net::IPAddressMap<PubKey>;
+      /// maps ip to pubkey and back, entries are flagged if we treat the key as a service node
+      AddrMap_t m_AddrMap;
 
       using SNodeSessions_t = std::unordered_map<RouterID, std::shared_ptr<exit::SNodeSession>>;
       /// snode sessions we are talking to directly
       SNodeSessions_t m_SNodeSessions;
 
-      std::unordered_map<huint128_t, PubKey> m_IPToKey;
-
       huint128_t m_IfAddr;
-      huint128_t m_HigestAddr;
-
-      huint128_t m_NextAddr;
       IPRange m_OurRange;
       std::string m_ifname;
 
-      std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
-
       std::shared_ptr<vpn::NetworkInterface> m_NetIf;
 
       SockAddr m_LocalResolverAddr;
@@ -217,17 +213,19 @@ namespace llarp
       std::shared_ptr<quic::TunnelManager> m_QUIC;
 
       using Pkt_t = net::IPPacket;
-      using PacketQueue_t = util::CoDelQueue<
+      /// per flow fair queue so one bulk flow does not hold up everyone else's traffic
+      using PacketQueue_t = util::FQCoDelQueue<
           Pkt_t,
           Pkt_t::GetTime,
           Pkt_t::PutTime,
-          Pkt_t::CompareOrder,
-          Pkt_t::GetNow,
-          util::NullMutex,
-          util::NullLock>;
+          Pkt_t::GetFlow,
+          Pkt_t::GetSize,
+          Pkt_t::GetNow>;
 
       /// internet to llarp packet queue
       PacketQueue_t m_InetToNetwork;
+      /// idempotent wakeup for flushing m_InetToNetwork once a batch is queued
+      std::shared_ptr<EventLoopWakeup> m_InetFlushWaker;
       bool m_UseV6;
     };
   }  // namespace handlers
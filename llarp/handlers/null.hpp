@@ -5,6 +5,7 @@
 #include <llarp/quic/tunnel.hpp>
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/ev/ev.hpp>
+#include "udp_handlers.hpp"
 
 namespace llarp
 {
@@ -31,6 +32,8 @@ namespace llarp
         {
           return true;
         }
+        if (t == service::ProtocolType::TrafficV4)
+          return m_UDPHandlers.Dispatch(tag, buf);
         if (t != service::ProtocolType::QUIC)
           return false;
 
@@ -76,9 +79,9 @@ namespace llarp
       void
       SendPacketToRemote(const llarp_buffer_t&, service::ProtocolType) override{};
 
-      huint128_t ObtainIPForAddr(std::variant<service::Address, RouterID>) override
+      std::optional<huint128_t> ObtainIPForAddr(std::variant<service::Address, RouterID>) override
       {
-        return {0};
+        return std::nullopt;
       }
 
       std::optional<std::variant<service::Address, RouterID>> ObtainAddrForIP(
@@ -86,6 +89,31 @@ namespace llarp
       {
         return std::nullopt;
       }
+
+      using UDPHandler = UDPPortHandlers::Handler;
+
+      /// hand udp packets sent to localport to handler, false if something already has it
+      bool
+      AddUDPHandler(nuint16_t localport, UDPHandler handler)
+      {
+        return m_UDPHandlers.Add(localport, std::move(handler));
+      }
+
+      void
+      RemoveUDPHandler(nuint16_t localport)
+      {
+        m_UDPHandlers.Remove(localport);
+      }
+
+      /// pick an ephemeral local port nothing is handling yet, for outbound flows
+      std::optional<nuint16_t>
+      AllocateUDPPort()
+      {
+        return m_UDPHandlers.Allocate();
+      }
+
+     private:
+      UDPPortHandlers m_UDPHandlers;
     };
   }  // namespace handlers
 }  // namespace llarp
@@ -73,7 +73,8 @@ namespace llarp
         Pump(Now());
       });
       m_PacketRouter = std::make_unique<vpn::PacketRouter>(
-          [this](net::IPPacket pkt) { HandleGotUserPacket(std::move(pkt)); });
+          [this](net::IPPacket pkt) { HandleGotUserPacket(std::move(pkt)); },
+          [this](std::vector<net::IPPacket>& pkts) { HandleGotUserPackets(pkts); });
 #ifdef ANDROID
       m_Resolver = std::make_shared<DnsInterceptor>(r, this);
       m_PacketRouter->AddUDPHandler(huint16_t{53}, [&](net::IPPacket pkt) {
@@ -85,8 +86,8 @@ namespace llarp
         const SockAddr laddr{src, nuint16_t{*reinterpret_cast<const uint16_t*>(ptr)}};
         const SockAddr raddr{dst, nuint16_t{*reinterpret_cast<const uint16_t*>(ptr + 2)}};
 
-        OwnedBuffer buf{pkt.sz - (8 + ip_header_size)};
-        std::copy_n(ptr + 8, buf.sz, buf.buf.get());
+        // read the query where it is in the packet instead of copying it out
+        const llarp_buffer_t buf{ptr + 8, pkt.sz - (8 + ip_header_size)};
         if (m_Resolver->ShouldHandlePacket(raddr, laddr, buf))
           m_Resolver->HandlePacket(raddr, laddr, buf);
         else
@@ -109,23 +110,21 @@ namespace llarp
       obj["ustreamResolvers"] = resolvers;
       obj["localResolver"] = m_LocalResolverAddr.toString();
       util::StatusObject ips{};
-      for (const auto& item : m_IPActivity)
-      {
-        util::StatusObject ipObj{{"lastActive", to_json(item.second)}};
+      m_AddrMap.ForEach([&ips](const auto& entry) {
+        util::StatusObject ipObj{{"lastActive", to_json(entry.lastActive)}};
         std::string remoteStr;
-        AlignedBuffer<32> addr = m_IPToAddr.at(item.first);
-        if (m_SNodes.at(addr))
-          remoteStr = RouterID(addr.as_array()).ToString();
+        if (entry.snode)
+          remoteStr = RouterID(entry.ident.as_array()).ToString();
         else
-          remoteStr = service::Address(addr.as_array()).ToString();
+          remoteStr = service::Address(entry.ident.as_array()).ToString();
         ipObj["remote"] = remoteStr;
-        std::string ipaddr = item.first.ToString();
-        ips[ipaddr] = ipObj;
-      }
+        ips[entry.ip.ToString()] = ipObj;
+      });
       obj["addrs"] = ips;
       obj["ourIP"] = m_OurIP.ToString();
-      obj["nextIP"] = m_NextIP.ToString();
-      obj["maxIP"] = m_MaxIP.ToString();
+      obj["nextIP"] = m_AddrMap.NextIP().ToString();
+      obj["maxIP"] = m_AddrMap.MaxIP().ToString();
+      obj["sendQueue"] = m_UserToNetworkPktQueue.ExtractStatus();
       return obj;
     }
 
@@ -209,124 +208,141 @@ namespace llarp
       m_OurIP = m_OurRange.addr;
       m_UseV6 = false;
 
+      m_AddrMap.SetRange(m_OurIP, m_OurRange.HighestAddr());
+      // clients may hold on to an address for as long as a dns answer we gave for it lives
+      m_AddrMap.SetMinIdle(dns::AnswerCache::MaxTTL);
+
       m_PersistAddrMapFile = conf.m_AddrMapPersistFile;
       if (m_PersistAddrMapFile)
+        LoadAddrMap(*m_PersistAddrMapFile);
+
+      if (auto* quic = GetQUICTunnel())
       {
-        const auto& file = *m_PersistAddrMapFile;
-        if (fs::exists(file))
+        quic->listen([this](std::string_view, uint16_t port) {
+          return llarp::SockAddr{net::TruncateV6(GetIfAddr()), huint16_t{port}};
+        });
+      }
+
+      return Endpoint::Configure(conf, dnsConf);
+    }
+
+    void
+    TunEndpoint::LoadAddrMap(const fs::path& file)
+    {
+      if (fs::exists(file))
+      {
+        bool shouldLoadFile = true;
         {
-          bool shouldLoadFile = true;
+          constexpr auto LastModifiedWindow = 1min;
+          const auto lastmodified = fs::last_write_time(file);
+          const auto now = decltype(lastmodified)::clock::now();
+          if (now < lastmodified or now - lastmodified > LastModifiedWindow)
           {
-            constexpr auto LastModifiedWindow = 1min;
-            const auto lastmodified = fs::last_write_time(file);
-            const auto now = decltype(lastmodified)::clock::now();
-            if (now < lastmodified or now - lastmodified > LastModifiedWindow)
-            {
-              shouldLoadFile = false;
-            }
+            shouldLoadFile = false;
           }
-          std::vector<char> data;
-          if (auto maybe = util::OpenFileStream<fs::ifstream>(file, std::ios_base::binary);
-              maybe and shouldLoadFile)
+        }
+        std::vector<char> data;
+        if (auto maybe = util::OpenFileStream<fs::ifstream>(file, std::ios_base::binary);
+            maybe and shouldLoadFile)
+        {
+          LogInfo(Name(), " loading address map file from ", file);
+          maybe->seekg(0, std::ios_base::end);
+          const size_t len = maybe->tellg();
+          maybe->seekg(0, std::ios_base::beg);
+          data.resize(len);
+          LogInfo(Name(), " reading ", len, " bytes");
+          maybe->read(data.data(), data.size());
+        }
+        else
+        {
+          if (shouldLoadFile)
           {
-            LogInfo(Name(), " loading address map file from ", file);
-            maybe->seekg(0, std::ios_base::end);
-            const size_t len = maybe->tellg();
-            maybe->seekg(0, std::ios_base::beg);
-            data.resize(len);
-            LogInfo(Name(), " reading ", len, " bytes");
-            maybe->read(data.data(), data.size());
+            LogInfo(Name(), " address map file ", file, " does not exist, so we won't load it");
           }
           else
+            LogInfo(Name(), " address map file ", file, " not loaded because it's stale");
+        }
+        if (not data.empty())
+        {
+          std::string_view bdata{data.data(), data.size()};
+          LogDebug(Name(), " parsing address map data: ", bdata);
+          const auto parsed = oxenmq::bt_deserialize<oxenmq::bt_dict>(bdata);
+          const auto now = Now();
+          for (const auto& [key, value] : parsed)
           {
-            if (shouldLoadFile)
+            huint128_t ip{};
+            if (not ip.FromString(key))
             {
-              LogInfo(Name(), " address map file ", file, " does not exist, so we won't load it");
+              LogWarn(Name(), " malformed IP in addr map data: ", key);
+              continue;
             }
-            else
-              LogInfo(Name(), " address map file ", file, " not loaded because it's stale");
-          }
-          if (not data.empty())
-          {
-            std::string_view bdata{data.data(), data.size()};
-            LogDebug(Name(), " parsing address map data: ", bdata);
-            const auto parsed = oxenmq::bt_deserialize<oxenmq::bt_dict>(bdata);
-            for (const auto& [key, value] : parsed)
+            if (m_OurIP == ip)
+              continue;
+            if (not m_OurRange.Contains(ip))
             {
-              huint128_t ip{};
-              if (not ip.FromString(key))
-              {
-                LogWarn(Name(), " malformed IP in addr map data: ", key);
-                continue;
-              }
-              if (m_OurIP == ip)
-                continue;
-              if (not m_OurRange.Contains(ip))
-              {
-                LogWarn(Name(), " out of range IP in addr map data: ", ip);
-                continue;
-              }
-              EndpointBase::AddressVariant_t addr;
+              LogWarn(Name(), " out of range IP in addr map data: ", ip);
+              continue;
+            }
+            EndpointBase::AddressVariant_t addr;
 
-              if (const auto* str = std::get_if<std::string>(&value))
+            if (const auto* str = std::get_if<std::string>(&value))
+            {
+              if (auto maybe = service::ParseAddress(*str))
               {
-                if (auto maybe = service::ParseAddress(*str))
-                {
-                  addr = *maybe;
-                }
-                else
-                {
-                  LogWarn(Name(), " invalid address in addr map: ", *str);
-                  continue;
-                }
+                addr = *maybe;
               }
               else
               {
-                LogWarn(Name(), " invalid first entry in addr map, not a string");
+                LogWarn(Name(), " invalid address in addr map: ", *str);
                 continue;
               }
-              if (const auto* loki = std::get_if<service::Address>(&addr))
-              {
-                m_IPToAddr.emplace(ip, loki->data());
-                m_AddrToIP.emplace(loki->data(), ip);
-                m_SNodes[*loki] = false;
-                LogInfo(Name(), " remapped ", ip, " to ", *loki);
-              }
-              if (const auto* snode = std::get_if<RouterID>(&addr))
-              {
-                m_IPToAddr.emplace(ip, snode->data());
-                m_AddrToIP.emplace(snode->data(), ip);
-                m_SNodes[*snode] = true;
-                LogInfo(Name(), " remapped ", ip, " to ", *snode);
-              }
-              if (m_NextIP < ip)
-                m_NextIP = ip;
-              // make sure we dont unmap this guy
-              MarkIPActive(ip);
             }
+            else
+            {
+              LogWarn(Name(), " invalid first entry in addr map, not a string");
+              continue;
+            }
+            const bool snode = std::holds_alternative<RouterID>(addr);
+            // map them as active now to make sure we dont unmap this guy
+            var::visit(
+                [&](auto&& remote) {
+                  if (m_AddrMap.Map(ip, AlignedBuffer<32>{remote.data()}, snode, now))
+                    LogInfo(Name(), " remapped ", ip, " to ", remote);
+                },
+                addr);
           }
         }
-        else
-        {
-          LogInfo(
-              Name(), " skipping loading addr map at ", file, " as it does not currently exist");
-        }
       }
+      else
+      {
+        LogInfo(
+            Name(), " skipping loading addr map at ", file, " as it does not currently exist");
+      }
+    }
 
-      if (auto* quic = GetQUICTunnel())
+    void
+    TunEndpoint::SaveAddrMap(const fs::path& file) const
+    {
+      LogInfo(Name(), " saving address map to ", file);
+      if (auto maybe = util::OpenFileStream<fs::ofstream>(file, std::ios_base::binary))
       {
-        quic->listen([this](std::string_view, uint16_t port) {
-          return llarp::SockAddr{net::TruncateV6(GetIfAddr()), huint16_t{port}};
+        std::map<std::string, std::string> addrmap;
+        m_AddrMap.ForEach([&](const auto& entry) {
+          if (entry.snode)
+            return;
+          const service::Address a{entry.ident.as_array()};
+          if (HasInboundConvo(a))
+            addrmap[entry.ip.ToString()] = a.ToString();
         });
+        const auto data = oxenmq::bt_serialize(addrmap);
+        maybe->write(data.data(), data.size());
       }
-
-      return Endpoint::Configure(conf, dnsConf);
     }
 
     bool
     TunEndpoint::HasLocalIP(const huint128_t& ip) const
     {
-      return m_IPToAddr.find(ip) != m_IPToAddr.end();
+      return m_AddrMap.HasIP(ip);
     }
 
     void
@@ -373,25 +389,41 @@ namespace llarp
     std::optional<std::variant<service::Address, RouterID>>
     TunEndpoint::ObtainAddrForIP(huint128_t ip) const
     {
-      auto itr = m_IPToAddr.find(ip);
-      if (itr == m_IPToAddr.end())
+      const auto* entry = m_AddrMap.FindByIP(ip);
+      if (entry == nullptr)
         return std::nullopt;
-      if (m_SNodes.at(itr->second))
-        return RouterID{itr->second.as_array()};
+      if (entry->snode)
+        return RouterID{entry->ident.as_array()};
       else
-        return service::Address{itr->second.as_array()};
+        return service::Address{entry->ident.as_array()};
+    }
+
+    dns::RR_TTL_t
+    TunEndpoint::DNSReplyTTL(service::OutboundContext* ctx) const
+    {
+      const auto now = Now();
+      const auto expiresAt = ctx->GetCurrentIntroSet().GetNewestIntroExpiration();
+      if (expiresAt <= now)
+        return 1;
+      const auto left = std::min(expiresAt - now, dns::AnswerCache::MaxTTL);
+      return std::chrono::duration_cast<std::chrono::seconds>(left).count();
     }
 
     bool
     TunEndpoint::HandleHookedDNSMessage(dns::Message msg, std::function<void(dns::Message)> reply)
     {
       auto ReplyToSNodeDNSWhenReady = [this, reply](RouterID snode, auto msg, bool isV6) -> bool {
-        return EnsurePathToSNode(
-            snode,
-            [this, snode, msg, reply, isV6](
-                const RouterID&, exit::BaseSession_ptr s, [[maybe_unused]] service::ConvoTag tag) {
-              SendDNSReply(snode, s, msg, reply, isV6);
-            });
+        if (EnsurePathToSNode(
+                snode,
+                [this, snode, msg, reply, isV6](
+                    const RouterID&, exit::BaseSession_ptr s, service::ConvoTag) {
+                  SendDNSReply(snode, s, msg, reply, isV6);
+                }))
+          return true;
+        // we have no address to give it
+        msg->AddServFail();
+        reply(*msg);
+        return true;
       };
       auto ReplyToLokiDNSWhenReady = [this, reply, timeout = PathAlignmentTimeout()](
                                          service::Address addr, auto msg, bool isV6) -> bool {
@@ -775,54 +807,44 @@ namespace llarp
       return m_UseV6;
     }
 
-    // FIXME: pass in which question it should be addressing
     bool
-    TunEndpoint::ShouldHookDNSMessage(const dns::Message& msg) const
+    TunEndpoint::ShouldHookDNSQuery(const dns::MessageView& msg) const
     {
-      llarp::service::Address addr;
-      if (msg.questions.size() == 1)
+      if (msg.Header().qd_count == 1)
       {
-        /// hook every .loki
-        if (msg.questions[0].HasTLD(".loki"))
-          return true;
-        /// hook every .snode
-        if (msg.questions[0].HasTLD(".snode"))
+        const auto q = *msg.FirstQuestion();
+        /// hook every .loki and .snode
+        if (q.name.HasTLD(".loki") or q.name.HasTLD(".snode"))
           return true;
         // hook any ranges we own
-        if (msg.questions[0].qtype == llarp::dns::qTypePTR)
+        if (q.qtype == llarp::dns::qTypePTR)
         {
           huint128_t ip = {0};
-          if (!dns::DecodePTR(msg.questions[0].qname, ip))
+          if (!dns::DecodePTR(q.name.ToString(), ip))
             return false;
           return m_OurRange.Contains(ip);
         }
       }
-      for (const auto& answer : msg.answers)
-      {
-        if (answer.HasCNameForTLD(".loki"))
-          return true;
-        if (answer.HasCNameForTLD(".snode"))
-          return true;
-      }
-      return false;
+      bool hook = false;
+      msg.ForEachAnswer([&hook](const dns::RRView& answer) {
+        if (answer.HasCNameForTLD(".loki") or answer.HasCNameForTLD(".snode"))
+          hook = true;
+      });
+      return hook;
     }
 
     bool
     TunEndpoint::MapAddress(const service::Address& addr, huint128_t ip, bool SNode)
     {
-      auto itr = m_IPToAddr.find(ip);
-      if (itr != m_IPToAddr.end())
+      if (const auto* entry = m_AddrMap.FindByIP(ip))
       {
         llarp::LogWarn(
-            ip, " already mapped to ", service::Address(itr->second.as_array()).ToString());
+            ip, " already mapped to ", service::Address(entry->ident.as_array()).ToString());
         return false;
       }
       llarp::LogInfo(Name() + " map ", addr.ToString(), " to ", ip);
 
-      m_IPToAddr[ip] = addr;
-      m_AddrToIP[addr] = ip;
-      m_SNodes[addr] = SNode;
-      MarkIPActiveForever(ip);
+      m_AddrMap.Map(ip, addr, SNode, Now(), true);
       MarkAddressOutbound(addr);
       return true;
     }
@@ -858,10 +880,9 @@ namespace llarp
     bool
     TunEndpoint::SetupTun()
     {
-      m_NextIP = m_OurIP;
-      m_MaxIP = m_OurRange.HighestAddr();
       llarp::LogInfo(Name(), " set ", m_IfName, " to have address ", m_OurIP);
-      llarp::LogInfo(Name(), " allocated up to ", m_MaxIP, " on range ", m_OurRange);
+      llarp::LogInfo(
+          Name(), " allocated up to ", m_AddrMap.MaxIP(), " on range ", m_OurRange);
 
       const service::Address ourAddr = m_Identity.pub.Addr();
 
@@ -902,9 +923,10 @@ namespace llarp
       m_IfName = m_NetIf->IfName();
       LogInfo(Name(), " got network interface ", m_IfName);
 
-      if (not Router()->loop()->add_network_interface(m_NetIf, [this](net::IPPacket pkt) {
-            m_PacketRouter->HandleIPPacket(std::move(pkt));
-          }))
+      if (not Router()->loop()->add_network_interface(
+              m_NetIf, [this](std::vector<net::IPPacket>& pkts) {
+                m_PacketRouter->HandleIPPackets(pkts);
+              }))
       {
         LogError(Name(), " failed to add network interface");
         return false;
@@ -975,25 +997,7 @@ namespace llarp
     {
       // save address map if applicable
       if (m_PersistAddrMapFile)
-      {
-        const auto& file = *m_PersistAddrMapFile;
-        LogInfo(Name(), " saving address map to ", file);
-        if (auto maybe = util::OpenFileStream<fs::ofstream>(file, std::ios_base::binary))
-        {
-          std::map<std::string, std::string> addrmap;
-          for (const auto& [ip, addr] : m_IPToAddr)
-          {
-            if (not m_SNodes.at(addr))
-            {
-              const service::Address a{addr.as_array()};
-              if (HasInboundConvo(a))
-                addrmap[ip.ToString()] = a.ToString();
-            }
-          }
-          const auto data = oxenmq::bt_serialize(addrmap);
-          maybe->write(data.data(), data.size());
-        }
-      }
+        SaveAddrMap(*m_PersistAddrMapFile);
       if (m_Resolver)
         m_Resolver->Stop();
       return llarp::service::Endpoint::Stop();
@@ -1023,12 +1027,12 @@ namespace llarp
         if (dst == ipv6_multicast_all_nodes and m_state->m_ExitEnabled)
         {
           // send ipv6 multicast
-          for (const auto& [ip, addr] : m_IPToAddr)
-          {
-            (void)ip;
+          m_AddrMap.ForEach([&](const auto& entry) {
             SendToOrQueue(
-                service::Address{addr.as_array()}, pkt.ConstBuffer(), service::ProtocolType::Exit);
-          }
+                service::Address{entry.ident.as_array()},
+                pkt.ConstBuffer(),
+                service::ProtocolType::Exit);
+          });
           return;
         }
 
@@ -1037,8 +1041,8 @@ namespace llarp
         {
           dst = net::ExpandV4(net::TruncateV6(dst));
         }
-        auto itr = m_IPToAddr.find(dst);
-        if (itr == m_IPToAddr.end())
+        auto* entry = m_AddrMap.FindByIP(dst);
+        if (entry == nullptr)
         {
           // find all ranges that match the destination ip
           const auto exitEntries = m_ExitMap.FindAllEntries(dst);
@@ -1085,14 +1089,14 @@ namespace llarp
         }
         std::variant<service::Address, RouterID> to;
         service::ProtocolType type;
-        if (m_SNodes.at(itr->second))
+        if (entry->snode)
         {
-          to = RouterID{itr->second.as_array()};
+          to = RouterID{entry->ident.as_array()};
           type = service::ProtocolType::TrafficV4;
         }
         else
         {
-          to = service::Address{itr->second.as_array()};
+          to = service::Address{entry->ident.as_array()};
           type = m_state->m_ExitEnabled and src != m_OurIP ? service::ProtocolType::Exit
                                                            : pkt.ServiceProtocol();
         }
@@ -1113,7 +1117,7 @@ namespace llarp
         {
           if (SendToOrQueue(*maybe, pkt.ConstBuffer(), type))
           {
-            MarkIPActive(dst);
+            m_AddrMap.MarkActive(*entry, Now());
             return;
           }
         }
@@ -1209,7 +1213,10 @@ namespace llarp
         if (not ShouldAllowTraffic(pkt))
           return false;
 
-        src = ObtainIPForAddr(addr);
+        if (const auto maybe = ObtainIPForAddr(addr))
+          src = *maybe;
+        else
+          return false;
         if (t == service::ProtocolType::Exit)
         {
           if (pkt.IsV4())
@@ -1269,7 +1276,10 @@ namespace llarp
       else
       {
         // snapp traffic
-        src = ObtainIPForAddr(addr);
+        if (const auto maybe = ObtainIPForAddr(addr))
+          src = *maybe;
+        else
+          return false;
         dst = m_OurIP;
       }
       HandleWriteIPPacket(buf, src, dst, seqno);
@@ -1309,99 +1319,55 @@ namespace llarp
       return m_OurIP;
     }
 
-    huint128_t
+    std::optional<huint128_t>
     TunEndpoint::ObtainIPForAddr(std::variant<service::Address, RouterID> addr)
     {
-      llarp_time_t now = Now();
-      huint128_t nextIP = {0};
       AlignedBuffer<32> ident{};
-      bool snode = false;
-
       var::visit([&ident](auto&& val) { ident = val.data(); }, addr);
-
-      if (std::get_if<RouterID>(&addr))
-      {
-        snode = true;
-      }
-
-      {
-        // previously allocated address
-        auto itr = m_AddrToIP.find(ident);
-        if (itr != m_AddrToIP.end())
-        {
-          // mark ip active
-          MarkIPActive(itr->second);
-          return itr->second;
-        }
-      }
-      // allocate new address
-      if (m_NextIP < m_MaxIP)
+      const bool snode = std::holds_alternative<RouterID>(addr);
+
+      const bool isNew = not m_AddrMap.HasIdent(ident);
+      const auto maybe =
+          m_AddrMap.Obtain(ident, snode, Now(), [this](const AddrMap_t::Entry& evicted) {
+            LogInfo(Name(), " recycling ", evicted.ip, " as we are full");
+            // answers we gave out for the old owner must not point anyone at the new one
+            if (m_Resolver)
+              m_Resolver->ForgetAddress(evicted.ip);
+          });
+      if (not maybe)
       {
-        do
-        {
-          nextIP = ++m_NextIP;
-        } while (m_IPToAddr.find(nextIP) != m_IPToAddr.end() && m_NextIP < m_MaxIP);
-        if (nextIP < m_MaxIP)
-        {
-          m_AddrToIP[ident] = nextIP;
-          m_IPToAddr[nextIP] = ident;
-          m_SNodes[ident] = snode;
-          var::visit(
-              [&](auto&& remote) { llarp::LogInfo(Name(), " mapped ", remote, " to ", nextIP); },
-              addr);
-          MarkIPActive(nextIP);
-          return nextIP;
-        }
+        LogError(Name(), " cannot allocate an address, every address is pinned or in use");
+        return std::nullopt;
       }
-
-      // we are full
-      // expire least active ip
-      // TODO: prevent DoS
-      std::pair<huint128_t, llarp_time_t> oldest = {huint128_t{0}, 0s};
-
-      // find oldest entry
-      auto itr = m_IPActivity.begin();
-      while (itr != m_IPActivity.end())
+      if (isNew)
       {
-        if (itr->second <= now)
-        {
-          if ((now - itr->second) > oldest.second)
-          {
-            oldest.first = itr->first;
-            oldest.second = itr->second;
-          }
-        }
-        ++itr;
+        var::visit(
+            [&](auto&& remote) { llarp::LogInfo(Name(), " mapped ", remote, " to ", *maybe); },
+            addr);
       }
-      // remap address
-      m_IPToAddr[oldest.first] = ident;
-      m_AddrToIP[ident] = oldest.first;
-      m_SNodes[ident] = snode;
-      nextIP = oldest.first;
-
-      // mark ip active
-      m_IPActivity[nextIP] = std::max(m_IPActivity[nextIP], now);
-
-      return nextIP;
+      return *maybe;
     }
 
     bool
     TunEndpoint::HasRemoteForIP(huint128_t ip) const
     {
-      return m_IPToAddr.find(ip) != m_IPToAddr.end();
+      return m_AddrMap.HasIP(ip);
     }
 
     void
     TunEndpoint::MarkIPActive(huint128_t ip)
     {
       llarp::LogDebug(Name(), " address ", ip, " is active");
-      m_IPActivity[ip] = std::max(Now(), m_IPActivity[ip]);
+      if (auto* entry = m_AddrMap.FindByIP(ip))
+        m_AddrMap.MarkActive(*entry, Now());
     }
 
     void
-    TunEndpoint::MarkIPActiveForever(huint128_t ip)
+    TunEndpoint::HandleCachedDNSReply(const std::vector<huint128_t>& addrs)
     {
-      m_IPActivity[ip] = std::numeric_limits<llarp_time_t>::max();
+      // someone is still looking these up, keep them from being recycled
+      for (const auto& ip : addrs)
+        MarkIPActive(ip);
     }
 
     void
@@ -1411,6 +1377,14 @@ namespace llarp
       m_MessageSendWaker->Trigger();
     }
 
+    void
+    TunEndpoint::HandleGotUserPackets(std::vector<net::IPPacket>& pkts)
+    {
+      for (auto& pkt : pkts)
+        m_UserToNetworkPktQueue.Emplace(std::move(pkt));
+      m_MessageSendWaker->Trigger();
+    }
+
     TunEndpoint::~TunEndpoint() = default;
 
   }  // namespace handlers
@@ -4,10 +4,11 @@
 #include <llarp/ev/ev.hpp>
 #include <llarp/ev/vpn.hpp>
 #include <llarp/net/ip.hpp>
+#include <llarp/net/ip_address_map.hpp>
 #include <llarp/net/ip_packet.hpp>
 #include <llarp/net/net.hpp>
 #include <llarp/service/endpoint.hpp>
-#include <llarp/util/codel.hpp>
+#include <llarp/util/fq_codel.hpp>
 #include <llarp/util/thread/threading.hpp>
 #include <llarp/vpn/packet_router.hpp>
 
@@ -65,12 +66,15 @@ namespace llarp
       SupportsV6() const override;
 
       bool
-      ShouldHookDNSMessage(const dns::Message& msg) const override;
+      ShouldHookDNSQuery(const dns::MessageView& msg) const override;
 
       bool
       HandleHookedDNSMessage(
           dns::Message query, std::function<void(dns::Message)> sendreply) override;
 
+      void
+      HandleCachedDNSReply(const std::vector<huint128_t>& addrs) override;
+
       void
       TickTun(llarp_time_t now);
 
@@ -115,6 +119,10 @@ namespace llarp
       void
       HandleGotUserPacket(llarp::net::IPPacket pkt);
 
+      /// we got a batch of packets from the user, pkts is left with moved from packets
+      void
+      HandleGotUserPackets(std::vector<llarp::net::IPPacket>& pkts);
+
       /// get the local interface's address
       huint128_t
       GetIfAddr() const override;
@@ -160,11 +168,11 @@ namespace llarp
       bool
       HasAddress(const AlignedBuffer<32>& addr) const
       {
-        return m_AddrToIP.find(addr) != m_AddrToIP.end();
+        return m_AddrMap.HasIdent(addr);
       }
 
       /// get ip address for key unconditionally
-      huint128_t
+      std::optional<huint128_t>
       ObtainIPForAddr(std::variant<service::Address, RouterID> addr) override;
 
       /// flush network traffic
@@ -175,11 +183,14 @@ namespace llarp
       ResetInternalState() override;
 
      protected:
-      using PacketQueue_t = llarp::util::CoDelQueue<
+      /// per flow fair queue so one bulk flow does not hold up interactive traffic behind it,
+      /// util::SPSCCoDelQueue is the cheaper single fifo alternative
+      using PacketQueue_t = llarp::util::FQCoDelQueue<
           net::IPPacket,
           net::IPPacket::GetTime,
           net::IPPacket::PutTime,
-          net::IPPacket::CompareOrder,
+          net::IPPacket::GetFlow,
+          net::IPPacket::GetSize,
           net::IPPacket::GetNow>;
 
       /// queue for sending packets over the network from us
@@ -207,10 +218,6 @@ namespace llarp
       void
       MarkIPActive(huint128_t ip);
 
-      /// mark this address as active forever
-      void
-      MarkIPActiveForever(huint128_t ip);
-
       /// flush ip packets
       virtual void
       FlushSend();
@@ -219,14 +226,11 @@ namespace llarp
       void
       FlushWrite();
 
-      /// maps ip to key (host byte order)
-      std::unordered_map<huint128_t, AlignedBuffer<32>> m_IPToAddr;
-      /// maps key to ip (host byte order)
-      std::unordered_map<AlignedBuffer<32>, huint128_t> m_AddrToIP;
+      using AddrMap_t = net::IPAddressMap<AlignedBuffer<32>>;
 
-      /// maps key to true if key is a service node, maps key to false if key is
-      /// a hidden service
-      std::unordered_map<AlignedBuffer<32>, bool> m_SNodes;
+      /// maps ip (host byte order) to key and back, entries are flagged if the key is a service
+      /// node and recycled in least recently active order
+      AddrMap_t m_AddrMap;
 
      private:
       template <typename Addr_t, typename Endpoint_t>
@@ -240,28 +244,44 @@ namespace llarp
       {
         if (ctx)
         {
-          huint128_t ip = ObtainIPForAddr(addr);
           query->answers.clear();
-          query->AddINReply(ip, sendIPv6);
+          if (const auto ip = ObtainIPForAddr(addr))
+            query->AddINReply(*ip, sendIPv6, DNSReplyTTL(ctx));
+          else
+            query->AddServFail();
         }
         else
           query->AddNXReply();
         reply(*query);
       }
+
+      /// ttl for dns replies about a hidden service, good for as long as its introset is
+      dns::RR_TTL_t
+      DNSReplyTTL(service::OutboundContext* ctx) const;
+
+      /// ttl for dns replies about anything else we reach, so far those are not cached
+      template <typename Endpoint_t>
+      dns::RR_TTL_t
+      DNSReplyTTL(const Endpoint_t&) const
+      {
+        return 1;
+      }
       /// our dns resolver
       std::shared_ptr<dns::PacketHandler> m_Resolver;
 
-      /// maps ip address to timestamp last active
-      std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
+      /// load the persisted address map from m_PersistAddrMapFile
+      void
+      LoadAddrMap(const fs::path& file);
+
+      /// write the address map of inbound convos to m_PersistAddrMapFile
+      void
+      SaveAddrMap(const fs::path& file) const;
+
       /// our ip address (host byte order)
       huint128_t m_OurIP;
       /// our network interface's ipv6 address
       huint128_t m_OurIPv6;
 
-      /// next ip address to allocate (host byte order)
-      huint128_t m_NextIP;
-      /// highest ip address to allocate (host byte order)
-      huint128_t m_MaxIP;
       /// our ip range we are using
       llarp::IPRange m_OurRange;
       /// upstream dns resolver list
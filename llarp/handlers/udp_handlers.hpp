@@ -0,0 +1,87 @@
+#pragma once
+
+#include <llarp/net/ip_packet.hpp>
+#include <llarp/service/convotag.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace handlers
+  {
+    /// who takes inbound udp packets for which local port on an endpoint without a tun
+    struct UDPPortHandlers
+    {
+      /// called with each inbound udp packet for a local port and the convo it came in on
+      using Handler = std::function<void(service::ConvoTag, net::IPPacket)>;
+
+      /// first port we hand out from Allocate
+      static constexpr uint16_t FirstEphemeralPort = 49152;
+
+      /// hand udp packets sent to localport to handler, false if something already has it
+      bool
+      Add(nuint16_t localport, Handler handler)
+      {
+        if (Find(localport) != m_Handlers.end())
+          return false;
+        m_Handlers.emplace_back(localport, std::move(handler));
+        return true;
+      }
+
+      void
+      Remove(nuint16_t localport)
+      {
+        if (auto itr = Find(localport); itr != m_Handlers.end())
+          m_Handlers.erase(itr);
+      }
+
+      /// pick an ephemeral local port nothing is handling yet, for outbound flows
+      std::optional<nuint16_t>
+      Allocate()
+      {
+        for (uint32_t tries = 0; tries < 65536 - FirstEphemeralPort; ++tries)
+        {
+          const nuint16_t port{ToNet(huint16_t{m_NextPort})};
+          m_NextPort = m_NextPort == 65535 ? FirstEphemeralPort : m_NextPort + 1;
+          if (Find(port) == m_Handlers.end())
+            return port;
+        }
+        return std::nullopt;
+      }
+
+      /// give a udp packet to whoever has its destination port, false if it is not a udp packet
+      /// or nobody does
+      bool
+      Dispatch(service::ConvoTag tag, const llarp_buffer_t& buf)
+      {
+        net::IPPacket pkt;
+        if (not pkt.Load(buf) or not pkt.UDPPayload())
+          return false;
+        auto itr = Find(*pkt.DstPort());
+        if (itr == m_Handlers.end())
+          return false;
+        itr->second(tag, std::move(pkt));
+        return true;
+      }
+
+     private:
+      using Handlers_t = std::vector<std::pair<nuint16_t, Handler>>;
+
+      Handlers_t::iterator
+      Find(nuint16_t localport)
+      {
+        return std::find_if(m_Handlers.begin(), m_Handlers.end(), [localport](const auto& item) {
+          return item.first == localport;
+        });
+      }
+
+      /// we only ever have a handful of local ports so a flat list beats hashing
+      Handlers_t m_Handlers;
+      uint16_t m_NextPort = FirstEphemeralPort;
+    };
+  }  // namespace handlers
+}  // namespace llarp
@@ -0,0 +1,179 @@
+#include "congestion.hpp"
+
+#include <llarp/util/time.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// window we start with and never go under, in segments
+    static constexpr size_t InitialWindow = 32;
+    static constexpr size_t MinWindow = 4;
+    static constexpr size_t MaxWindow = 4096;
+    /// most segments pacing lets out back to back
+    static constexpr size_t PacingBurst = 8;
+    /// cubic parameters from rfc 8312
+    static constexpr double CubicC = 0.4;
+    static constexpr double CubicBeta = 0.7;
+    /// most times we double the rto without a new rtt sample
+    static constexpr unsigned MaxBackoff = 3;
+
+    CongestionControl::CongestionControl(size_t segment, llarp_time_t maxRTO)
+        : m_Segment{segment}
+        , m_MaxRTO{maxRTO}
+        , m_CWND{InitialWindow * segment}
+        , m_SSThresh{MaxWindow * segment}
+        , m_PaceBudget{double(PacingBurst * segment)}
+    {}
+
+    void
+    CongestionControl::OnRTTSample(llarp_time_t rtt)
+    {
+      if (not m_HasSample)
+      {
+        m_SRTT = rtt;
+        m_RTTVar = rtt / 2;
+        m_HasSample = true;
+      }
+      else
+      {
+        const auto delta = m_SRTT > rtt ? m_SRTT - rtt : rtt - m_SRTT;
+        m_RTTVar = (m_RTTVar * 3 + delta) / 4;
+        m_SRTT = (m_SRTT * 7 + rtt) / 8;
+      }
+      m_Backoff = 0;
+    }
+
+    llarp_time_t
+    CongestionControl::RTO() const
+    {
+      llarp_time_t rto = m_MaxRTO;
+      if (m_HasSample)
+        rto = m_SRTT + std::max(llarp_time_t{1ms}, m_RTTVar * 4);
+      rto *= (1 << m_Backoff);
+      return std::clamp(rto, MinRTO, m_MaxRTO);
+    }
+
+    void
+    CongestionControl::OnAck(size_t bytes, llarp_time_t now)
+    {
+      if (bytes == 0)
+        return;
+      if (m_CWND < m_SSThresh)
+      {
+        // slow start
+        m_CWND += bytes;
+      }
+      else
+      {
+        const double cwnd = double(m_CWND) / m_Segment;
+        const double acked = double(bytes) / m_Segment;
+        if (m_EpochStart == 0s)
+        {
+          m_EpochStart = now;
+          m_WMax = std::max(m_WMax, cwnd);
+        }
+        const double t = std::chrono::duration<double>(now - m_EpochStart + SRTT()).count();
+        const double K = std::cbrt(m_WMax * (1 - CubicBeta) / CubicC);
+        const double target = CubicC * std::pow(t - K, 3) + m_WMax;
+        double inc = target > cwnd ? (target - cwnd) / cwnd * acked : 0;
+        // never grow slower than reno would
+        inc = std::max(inc, acked / cwnd);
+        m_CWND += size_t(inc * m_Segment);
+      }
+      m_CWND = std::min(m_CWND, MaxWindow * m_Segment);
+    }
+
+    void
+    CongestionControl::OnLoss(llarp_time_t now)
+    {
+      if (now < m_RecoveryUntil)
+        return;
+      ++m_LossEvents;
+      m_WMax = double(m_CWND) / m_Segment;
+      m_CWND = std::max(MinWindow * m_Segment, size_t(m_CWND * CubicBeta));
+      m_SSThresh = m_CWND;
+      m_EpochStart = 0s;
+      m_RecoveryUntil = now + SRTT();
+    }
+
+    void
+    CongestionControl::OnRTOExpired(llarp_time_t now)
+    {
+      m_Backoff = std::min(m_Backoff + 1, MaxBackoff);
+      OnLoss(now);
+    }
+
+    bool
+    CongestionControl::CanSend(size_t inflight, size_t sz) const
+    {
+      // always let one packet out so we can never stall completely
+      return inflight == 0 or inflight + sz <= m_CWND;
+    }
+
+    double
+    CongestionControl::PacingRate() const
+    {
+      // pace faster than the window drains so pacing never is what limits us
+      const double gain = m_CWND < m_SSThresh ? 2.0 : 1.25;
+      const auto srtt = std::max(SRTT(), llarp_time_t{1ms});
+      return gain * m_CWND / srtt.count();
+    }
+
+    bool
+    CongestionControl::PacingAllows(llarp_time_t now)
+    {
+      if (now > m_LastPaceAt)
+      {
+        m_PaceBudget = std::min(
+            m_PaceBudget + (now - m_LastPaceAt).count() * PacingRate(),
+            double(PacingBurst * m_Segment));
+        m_LastPaceAt = now;
+      }
+      return m_PaceBudget > 0;
+    }
+
+    llarp_time_t
+    CongestionControl::NextSendAt() const
+    {
+      if (m_PaceBudget > 0)
+        return m_LastPaceAt;
+      return m_LastPaceAt + llarp_time_t{1 + int64_t(-m_PaceBudget / PacingRate())};
+    }
+
+    void
+    CongestionControl::OnSent(size_t sz, bool retransmit)
+    {
+      ++m_SentFragments;
+      if (retransmit)
+        ++m_Retransmits;
+      m_PaceBudget -= sz;
+    }
+
+    double
+    CongestionControl::LossRate() const
+    {
+      if (m_SentFragments == 0)
+        return 0;
+      return double(m_Retransmits) / m_SentFragments;
+    }
+
+    util::StatusObject
+    CongestionControl::ExtractStatus() const
+    {
+      return {
+          {"cwnd", m_CWND},
+          {"ssthresh", m_SSThresh},
+          {"rtt", to_json(SRTT())},
+          {"rttvar", to_json(m_RTTVar)},
+          {"rto", to_json(RTO())},
+          {"pacingRate", uint64_t(PacingRate() * 1000)},
+          {"loss", LossRate()},
+          {"lossEvents", m_LossEvents},
+          {"retransmits", m_Retransmits}};
+    }
+  }  // namespace iwp
+}  // namespace llarp
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <llarp/util/status.hpp>
+#include <llarp/util/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// smallest retransmission timeout we use
+    static constexpr llarp_time_t MinRTO = 50ms;
+    /// rtt we assume until we have a sample
+    static constexpr llarp_time_t InitialRTT = 100ms;
+
+    /// per session rtt estimation (rfc 6298) and a cubic congestion window with pacing.
+    /// the window is in bytes of data fragments sent and not yet acked.
+    struct CongestionControl
+    {
+      /// segment is the fragment size we send, maxRTO caps the retransmission timeout
+      CongestionControl(size_t segment, llarp_time_t maxRTO);
+
+      /// feed in the time between sending a fragment and getting it acked, only for fragments
+      /// that were never retransmitted
+      void
+      OnRTTSample(llarp_time_t rtt);
+
+      /// bytes got acked
+      void
+      OnAck(size_t bytes, llarp_time_t now);
+
+      /// we had to retransmit, shrinks the window at most once per round trip
+      void
+      OnLoss(llarp_time_t now);
+
+      /// the retransmission timer fired, back off the timeout until the next rtt sample
+      void
+      OnRTOExpired(llarp_time_t now);
+
+      /// can we put sz more bytes in flight on top of inflight
+      bool
+      CanSend(size_t inflight, size_t sz) const;
+
+      /// do we have pacing budget to send a packet now
+      bool
+      PacingAllows(llarp_time_t now);
+
+      /// when pacing will allow the next packet
+      llarp_time_t
+      NextSendAt() const;
+
+      /// the fragment size we send changed
+      void
+      SetSegmentSize(size_t segment)
+      {
+        m_Segment = segment;
+      }
+
+      /// we sent sz bytes of data
+      void
+      OnSent(size_t sz, bool retransmit);
+
+      llarp_time_t
+      SRTT() const
+      {
+        return m_HasSample ? m_SRTT : InitialRTT;
+      }
+
+      llarp_time_t
+      RTTVar() const
+      {
+        return m_RTTVar;
+      }
+
+      llarp_time_t
+      RTO() const;
+
+      size_t
+      Window() const
+      {
+        return m_CWND;
+      }
+
+      size_t
+      SlowStartThreshold() const
+      {
+        return m_SSThresh;
+      }
+
+      /// fraction of data fragments we had to send again
+      double
+      LossRate() const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      /// bytes per ms we pace at
+      double
+      PacingRate() const;
+
+      size_t m_Segment;
+      const llarp_time_t m_MaxRTO;
+
+      bool m_HasSample = false;
+      llarp_time_t m_SRTT = InitialRTT;
+      llarp_time_t m_RTTVar = InitialRTT / 2;
+      unsigned m_Backoff = 0;
+
+      size_t m_CWND;
+      size_t m_SSThresh;
+      /// window before the last reduction, in segments
+      double m_WMax = 0;
+      /// start of the current cubic growth epoch, 0 if not started
+      llarp_time_t m_EpochStart = 0s;
+      /// no further window reductions before this
+      llarp_time_t m_RecoveryUntil = 0s;
+
+      double m_PaceBudget;
+      llarp_time_t m_LastPaceAt = 0s;
+
+      uint64_t m_SentFragments = 0;
+      uint64_t m_Retransmits = 0;
+      uint64_t m_LossEvents = 0;
+    };
+  }  // namespace iwp
+}  // namespace llarp
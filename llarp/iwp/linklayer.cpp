@@ -113,6 +113,12 @@ namespace llarp::iwp
       m_PlaintextRecv[ptr->GetRemoteEndpoint()] = session;
   }
 
+  void
+  LinkLayer::CallLater(llarp_time_t delay, std::function<void(void)> f)
+  {
+    m_Loop->call_later(delay, std::move(f));
+  }
+
   void
   LinkLayer::WakeupPlaintext()
   {
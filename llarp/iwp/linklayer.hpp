@@ -56,6 +56,10 @@ namespace llarp::iwp
     void
     AddWakeup(std::weak_ptr<Session> peer);
 
+    /// call f from the event loop once delay passed
+    void
+    CallLater(llarp_time_t delay, std::function<void(void)> f);
+
     std::string
     PrintableName() const;
 
@@ -10,22 +10,23 @@ namespace llarp
         uint64_t msgid,
         ILinkSession::Message_t msg,
         llarp_time_t now,
-        ILinkSession::CompletionHandler handler)
+        ILinkSession::CompletionHandler handler,
+        size_t fragsz)
         : m_Data{std::move(msg)}
         , m_MsgID{msgid}
+        , m_FragmentSize{fragsz}
         , m_Completed{handler}
         , m_LastFlush{now}
         , m_StartedAt{now}
     {
       const llarp_buffer_t buf(m_Data);
       CryptoManager::instance()->shorthash(m_Digest, buf);
-      m_Acks.set(0);
     }
 
     ILinkSession::Packet_t
     OutboundMessage::XMIT() const
     {
-      size_t extra = std::min(m_Data.size(), FragmentSize);
+      size_t extra = std::min(m_Data.size(), m_FragmentSize);
       auto xmit = CreatePacket(Command::eXMIT, 10 + 32 + extra, 0, 0);
       htobe16buf(xmit.data() + CommandOverhead + PacketOverhead, m_Data.size());
       htobe64buf(xmit.data() + 2 + CommandOverhead + PacketOverhead, m_MsgID);
@@ -46,51 +47,109 @@ namespace llarp
     }
 
     bool
-    OutboundMessage::ShouldFlush(llarp_time_t now) const
+    OutboundMessage::ShouldFlush(llarp_time_t now, llarp_time_t rto) const
     {
-      return now - m_LastFlush >= TXFlushInterval;
+      return now - m_LastFlush >= rto and InflightBytes() > 0;
     }
 
-    void
+    size_t
     OutboundMessage::Ack(byte_t bitmask)
     {
-      m_Acks = std::bitset<8>(bitmask);
+      const auto inflight = InflightBytes();
+      m_Acks |= decltype(m_Acks){bitmask};
+      return inflight - InflightBytes();
     }
 
-    void
-    OutboundMessage::FlushUnAcked(
-        std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now)
+    size_t
+    OutboundMessage::NumFragments() const
+    {
+      return std::max(size_t{1}, (m_Data.size() + m_FragmentSize - 1) / m_FragmentSize);
+    }
+
+    size_t
+    OutboundMessage::FragmentBytes(size_t idx) const
+    {
+      const size_t offset = idx * m_FragmentSize;
+      return std::min(m_FragmentSize, m_Data.size() - offset);
+    }
+
+    size_t
+    OutboundMessage::NextUnsent() const
     {
+      const auto num = NumFragments();
+      size_t idx = 0;
+      while (idx < num and (m_Sent[idx] or m_Acks[idx]))
+        ++idx;
+      return idx;
+    }
+
+    ILinkSession::Packet_t
+    OutboundMessage::Fragment(size_t idx) const
+    {
+      if (idx == 0)
+        return XMIT();
       /// overhead for a data packet in plaintext
       static constexpr size_t Overhead = 10;
-      uint16_t idx = 0;
-      const auto datasz = m_Data.size();
-      while (idx < datasz)
+      const size_t offset = idx * m_FragmentSize;
+      const size_t fragsz = FragmentBytes(idx);
+      auto frag = CreatePacket(Command::eDATA, fragsz + Overhead, 0, 0);
+      htobe16buf(frag.data() + 2 + PacketOverhead, offset);
+      htobe64buf(frag.data() + 4 + PacketOverhead, m_MsgID);
+      std::copy_n(m_Data.begin() + offset, fragsz, frag.data() + PacketOverhead + Overhead + 2);
+      return frag;
+    }
+
+    bool
+    OutboundMessage::MarkSent(size_t idx, llarp_time_t now)
+    {
+      m_Sent.set(idx);
+      m_LastFlush = now;
+      const bool resend = m_Resend[idx];
+      m_Resend.reset(idx);
+      return resend;
+    }
+
+    size_t
+    OutboundMessage::InflightBytes() const
+    {
+      size_t bytes = 0;
+      const auto num = NumFragments();
+      for (size_t idx = 0; idx < num; ++idx)
       {
-        if (not m_Acks[idx / FragmentSize])
-        {
-          const size_t fragsz = idx + FragmentSize < datasz ? FragmentSize : datasz - idx;
-          auto frag = CreatePacket(Command::eDATA, fragsz + Overhead, 0, 0);
-          htobe16buf(frag.data() + 2 + PacketOverhead, idx);
-          htobe64buf(frag.data() + 4 + PacketOverhead, m_MsgID);
-          std::copy(
-              m_Data.begin() + idx,
-              m_Data.begin() + idx + fragsz,
-              frag.data() + PacketOverhead + Overhead + 2);
-          sendpkt(std::move(frag));
-        }
-        idx += FragmentSize;
+        if (m_Sent[idx] and not m_Acks[idx])
+          bytes += FragmentBytes(idx);
       }
-      m_LastFlush = now;
+      return bytes;
+    }
+
+    size_t
+    OutboundMessage::ResendUnAcked()
+    {
+      const auto inflight = InflightBytes();
+      m_Resend |= m_Sent & ~m_Acks;
+      m_Sent &= m_Acks;
+      m_Retransmitted = true;
+      return inflight;
+    }
+
+    size_t
+    OutboundMessage::Resend(size_t idx)
+    {
+      if (not m_Sent[idx] or m_Acks[idx])
+        return 0;
+      m_Sent.reset(idx);
+      m_Resend.set(idx);
+      m_Retransmitted = true;
+      return FragmentBytes(idx);
     }
 
     bool
     OutboundMessage::IsTransmitted() const
     {
-      const auto sz = m_Data.size();
-      for (uint16_t idx = 0; idx < sz; idx += FragmentSize)
+      const auto num = NumFragments();
+      for (size_t idx = 0; idx < num; ++idx)
       {
-        if (not m_Acks.test(idx / FragmentSize))
+        if (not m_Acks.test(idx))
           return false;
       }
       return true;
@@ -113,22 +172,27 @@ namespace llarp
       m_Completed = nullptr;
     }
 
-    InboundMessage::InboundMessage(uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now)
-        : m_Data(size_t{sz}), m_Digset{std::move(h)}, m_MsgID(msgid), m_LastActiveAt{now}
+    InboundMessage::InboundMessage(
+        uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now, size_t fragsz)
+        : m_Data(size_t{sz})
+        , m_Digset{std::move(h)}
+        , m_MsgID(msgid)
+        , m_FragmentSize{fragsz}
+        , m_LastActiveAt{now}
     {}
 
     void
     InboundMessage::HandleData(uint16_t idx, const llarp_buffer_t& buf, llarp_time_t now)
     {
-      if (idx + buf.sz > m_Data.size())
+      if (idx + buf.sz > m_Data.size() or idx % m_FragmentSize)
       {
         LogWarn("invalid fragment offset ", idx);
         return;
       }
       byte_t* dst = m_Data.data() + idx;
       std::copy_n(buf.base, buf.sz, dst);
-      m_Acks.set(idx / FragmentSize);
-      LogTrace("got fragment ", idx / FragmentSize);
+      m_Acks.set(idx / m_FragmentSize);
+      LogTrace("got fragment ", idx / m_FragmentSize);
       m_LastActiveAt = now;
     }
 
@@ -151,9 +215,9 @@ namespace llarp
     InboundMessage::IsCompleted() const
     {
       const auto sz = m_Data.size();
-      for (size_t idx = 0; idx < sz; idx += FragmentSize)
+      for (size_t idx = 0; idx < sz; idx += m_FragmentSize)
       {
-        if (not m_Acks.test(idx / FragmentSize))
+        if (not m_Acks.test(idx / m_FragmentSize))
           return false;
       }
       return true;
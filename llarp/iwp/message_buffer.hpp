@@ -28,8 +28,11 @@ namespace llarp
       eCLOS = 0xff,
     };
 
-    /// max size of data fragments
+    /// size of data fragments until the remote confirmed a larger path mtu, also the smallest
+    /// fragment size we accept so a whole message always fits in the 8 bit ack mask
     static constexpr size_t FragmentSize = 1024;
+    /// largest data fragment, a whole message in one packet
+    static constexpr size_t MaxFragmentSize = MAX_LINK_MSG_SIZE;
     /// plaintext header overhead size
     static constexpr size_t CommandOverhead = 2;
 
@@ -40,27 +43,71 @@ namespace llarp
           uint64_t msgid,
           ILinkSession::Message_t data,
           llarp_time_t now,
-          ILinkSession::CompletionHandler handler);
+          ILinkSession::CompletionHandler handler,
+          size_t fragsz = FragmentSize);
 
       ILinkSession::Message_t m_Data;
       uint64_t m_MsgID = 0;
+      /// size of the fragments we send this message in
+      size_t m_FragmentSize = FragmentSize;
       std::bitset<MAX_LINK_MSG_SIZE / FragmentSize> m_Acks;
+      /// fragments we sent that are not acked yet or were acked since
+      std::bitset<MAX_LINK_MSG_SIZE / FragmentSize> m_Sent;
+      /// fragments we gave up on and have to send again
+      std::bitset<MAX_LINK_MSG_SIZE / FragmentSize> m_Resend;
       ILinkSession::CompletionHandler m_Completed;
+      /// when we last sent a fragment of this message
       llarp_time_t m_LastFlush = 0s;
       ShortHash m_Digest;
       llarp_time_t m_StartedAt = 0s;
+      /// did we ever send a fragment again, if so acks give us no rtt sample
+      bool m_Retransmitted = false;
+      /// is there an rto timer for this message
+      bool m_RTOArmed = false;
 
       ILinkSession::Packet_t
       XMIT() const;
 
-      void
+      /// returns how many bytes sent in flight got acked by this
+      size_t
       Ack(byte_t bitmask);
 
-      void
-      FlushUnAcked(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now);
+      /// number of fragments the message goes out in, the first one is in the XMIT
+      size_t
+      NumFragments() const;
+
+      /// payload bytes of fragment idx
+      size_t
+      FragmentBytes(size_t idx) const;
+
+      /// first fragment not sent and not acked, NumFragments() if there is none
+      size_t
+      NextUnsent() const;
+
+      /// the packet carrying fragment idx
+      ILinkSession::Packet_t
+      Fragment(size_t idx) const;
+
+      /// returns true if this was fragment idx going out again
+      bool
+      MarkSent(size_t idx, llarp_time_t now);
+
+      /// payload bytes sent and not acked yet
+      size_t
+      InflightBytes() const;
+
+      /// forget that we sent whatever is not acked yet so it goes out again,
+      /// returns how many bytes are no longer in flight
+      size_t
+      ResendUnAcked();
+
+      /// same as ResendUnAcked for just fragment idx
+      size_t
+      Resend(size_t idx);
 
+      /// nothing got acked for an rto since we last sent
       bool
-      ShouldFlush(llarp_time_t now) const;
+      ShouldFlush(llarp_time_t now, llarp_time_t rto) const;
 
       void
       Completed();
@@ -78,11 +125,14 @@ namespace llarp
     struct InboundMessage
     {
       InboundMessage() = default;
-      InboundMessage(uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now);
+      InboundMessage(
+          uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now, size_t fragsz = FragmentSize);
 
       ILinkSession::Message_t m_Data;
       ShortHash m_Digset;
       uint64_t m_MsgID = 0;
+      /// size of the fragments the remote sends this message in, the size of the XMIT payload
+      size_t m_FragmentSize = FragmentSize;
       llarp_time_t m_LastACKSent = 0s;
       llarp_time_t m_LastActiveAt = 0s;
       std::bitset<MAX_LINK_MSG_SIZE / FragmentSize> m_Acks;
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// table of in flight messages indexed directly by message id.
+    /// message ids are handed out sequentially so the ids alive at any time sit in a window that
+    /// maps onto distinct slots of a power of two ring, a lookup is a single index and compare.
+    /// the ring doubles, up to maxSize slots, once it is half full and ids start to collide, and
+    /// goes back to its initial size once empty. an id whose slot is taken by an older message
+    /// that is still around, e.g. one stuck waiting on a retransmit, goes into a side table
+    /// instead so it never holds up anything else.
+    ///
+    /// growing moves the messages, pointers from Find are only good until the next Emplace.
+    template <typename Msg_t>
+    struct MessageRing
+    {
+      explicit MessageRing(size_t maxSize) : m_MaxSize{maxSize}, m_Slots(InitialSize)
+      {}
+
+      Msg_t*
+      Find(uint64_t id)
+      {
+        auto& slot = SlotFor(id);
+        if (slot.msg and slot.id == id)
+          return &*slot.msg;
+        return FindOverflow(id);
+      }
+
+      const Msg_t*
+      Find(uint64_t id) const
+      {
+        return const_cast<MessageRing*>(this)->Find(id);
+      }
+
+      /// put a message in, returns nullptr if id is taken
+      template <typename... Args>
+      Msg_t*
+      Emplace(uint64_t id, Args&&... args)
+      {
+        if (Find(id))
+          return nullptr;
+        if (SlotFor(id).msg and m_Slots.size() < m_MaxSize and m_Size * 2 >= m_Slots.size())
+          Resize(m_Slots.size() * 2);
+        ++m_Size;
+        auto& slot = SlotFor(id);
+        if (slot.msg)
+          return &m_Overflow.try_emplace(id, std::forward<Args>(args)...).first->second;
+        slot.id = id;
+        slot.msg.emplace(std::forward<Args>(args)...);
+        return &*slot.msg;
+      }
+
+      /// remove a message and hand it back
+      std::optional<Msg_t>
+      Take(uint64_t id)
+      {
+        std::optional<Msg_t> msg;
+        if (auto& slot = SlotFor(id); slot.msg and slot.id == id)
+        {
+          msg = std::move(slot.msg);
+          slot.msg.reset();
+        }
+        else if (auto itr = m_Overflow.find(id); itr != m_Overflow.end())
+        {
+          msg = std::move(itr->second);
+          m_Overflow.erase(itr);
+        }
+        else
+          return std::nullopt;
+        Removed();
+        return msg;
+      }
+
+      void
+      Erase(uint64_t id)
+      {
+        if (auto& slot = SlotFor(id); slot.msg and slot.id == id)
+          slot.msg.reset();
+        else if (m_Overflow.erase(id) == 0)
+          return;
+        Removed();
+      }
+
+      /// visit every message as visit(id, msg), must not add or remove messages
+      template <typename Visit_t>
+      void
+      ForEach(Visit_t visit)
+      {
+        for (auto& slot : m_Slots)
+        {
+          if (slot.msg)
+            visit(slot.id, *slot.msg);
+        }
+        for (auto& [id, msg] : m_Overflow)
+          visit(id, msg);
+      }
+
+      size_t
+      Size() const
+      {
+        return m_Size;
+      }
+
+      bool
+      Empty() const
+      {
+        return m_Size == 0;
+      }
+
+     private:
+      static constexpr size_t InitialSize = 16;
+
+      struct Slot
+      {
+        uint64_t id = 0;
+        std::optional<Msg_t> msg;
+      };
+
+      Slot&
+      SlotFor(uint64_t id)
+      {
+        return m_Slots[id & (m_Slots.size() - 1)];
+      }
+
+      Msg_t*
+      FindOverflow(uint64_t id)
+      {
+        if (m_Overflow.empty())
+          return nullptr;
+        const auto itr = m_Overflow.find(id);
+        return itr == m_Overflow.end() ? nullptr : &itr->second;
+      }
+
+      void
+      Removed()
+      {
+        if (--m_Size == 0 and m_Slots.size() > InitialSize)
+          m_Slots = std::vector<Slot>(InitialSize);
+      }
+
+      /// move everything into a ring of size slots, what still collides goes to the side table
+      void
+      Resize(size_t size)
+      {
+        auto old = std::exchange(m_Slots, std::vector<Slot>(size));
+        auto overflow = std::exchange(m_Overflow, {});
+        const auto place = [this](uint64_t id, Msg_t&& msg) {
+          auto& slot = SlotFor(id);
+          if (slot.msg)
+          {
+            m_Overflow.try_emplace(id, std::move(msg));
+            return;
+          }
+          slot.id = id;
+          slot.msg.emplace(std::move(msg));
+        };
+        for (auto& slot : old)
+        {
+          if (slot.msg)
+            place(slot.id, std::move(*slot.msg));
+        }
+        for (auto& [id, msg] : overflow)
+          place(id, std::move(msg));
+      }
+
+      const size_t m_MaxSize;
+      std::vector<Slot> m_Slots;
+      /// messages whose slot was taken when they came in
+      std::unordered_map<uint64_t, Msg_t> m_Overflow;
+      size_t m_Size = 0;
+    };
+  }  // namespace iwp
+}  // namespace llarp
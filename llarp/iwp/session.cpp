@@ -2,7 +2,13 @@
 
 #include <llarp/messages/link_intro.hpp>
 #include <llarp/messages/discard.hpp>
+#include <llarp/net/net.hpp>
 #include <llarp/util/meta/memfn.hpp>
+#include <llarp/util/metrics.hpp>
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
 
 namespace llarp
 {
@@ -26,7 +32,65 @@ namespace llarp
       return pkt;
     }
 
+    namespace
+    {
+      const metrics::Labels LinkLabels{{"link", "iwp"}};
+      auto& PacketsRX = metrics::Registry::Instance().GetCounter(
+          "lokinet_link_packets_rx", "packets received by the link layer", LinkLabels);
+      auto& PacketsTX = metrics::Registry::Instance().GetCounter(
+          "lokinet_link_packets_tx", "packets sent by the link layer", LinkLabels);
+      auto& BytesRX = metrics::Registry::Instance().GetCounter(
+          "lokinet_link_bytes_rx", "bytes received by the link layer", LinkLabels);
+      auto& BytesTX = metrics::Registry::Instance().GetCounter(
+          "lokinet_link_bytes_tx", "bytes sent by the link layer", LinkLabels);
+      auto& MessagesQueued = metrics::Registry::Instance().GetCounter(
+          "lokinet_link_messages",
+          "link messages by what became of them",
+          {{"link", "iwp"}, {"result", "queued"}});
+      auto& MessagesRejected = metrics::Registry::Instance().GetCounter(
+          "lokinet_link_messages",
+          "link messages by what became of them",
+          {{"link", "iwp"}, {"result", "rejected"}});
+      auto& MessagesAcked = metrics::Registry::Instance().GetCounter(
+          "lokinet_link_messages",
+          "link messages by what became of them",
+          {{"link", "iwp"}, {"result", "acked"}});
+      auto& MessagesTimedOut = metrics::Registry::Instance().GetCounter(
+          "lokinet_link_messages",
+          "link messages by what became of them",
+          {{"link", "iwp"}, {"result", "timeout"}});
+    }  // namespace
+
     constexpr size_t PlaintextQueueSize = 32;
+    /// packets a fresh crypto batch has room for
+    constexpr size_t CryptoBatchReserve = 64;
+    /// spare batches we keep per session, the pump and the workers double buffer each direction
+    constexpr size_t MaxSpareBatches = 4;
+
+    /// pings starting with this are pmtu probes or acks for them, plain pings have random padding
+    /// there
+    static constexpr std::string_view PMTUMagic = "iwp-pmtu";
+    enum PMTUKind : byte_t
+    {
+      ePMTUProbe = 0,
+      ePMTUAck = 1,
+    };
+    /// plaintext size of a pmtu ping: magic, kind and probe size
+    static constexpr size_t PMTUBodySize = PMTUMagic.size() + 1 + sizeof(uint16_t);
+
+    /// probes get padded to exactly sz bytes on the wire, acks carry the size of the probe we got
+    static ILinkSession::Packet_t
+    CreatePMTUPacket(PMTUKind kind, size_t sz)
+    {
+      const size_t unpadded = PacketOverhead + CommandOverhead + PMTUBodySize;
+      auto pkt = kind == ePMTUProbe ? CreatePacket(Command::ePING, PMTUBodySize, sz - unpadded, 0)
+                                    : CreatePacket(Command::ePING, PMTUBodySize);
+      byte_t* ptr = pkt.data() + PacketOverhead + CommandOverhead;
+      ptr = std::copy(PMTUMagic.begin(), PMTUMagic.end(), ptr);
+      *ptr++ = kind;
+      htobe16buf(ptr, sz);
+      return pkt;
+    }
 
     Session::Session(LinkLayer* p, const RouterContact& rc, const AddressInfo& ai)
         : m_State{State::Initial}
@@ -41,6 +105,8 @@ namespace llarp
       token.Zero();
       GotLIM = util::memFn(&Session::GotOutboundLIM, this);
       CryptoManager::instance()->shorthash(m_SessionKey, llarp_buffer_t(rc.pubkey));
+      m_EncryptNext.reserve(CryptoBatchReserve);
+      m_DecryptNext.reserve(CryptoBatchReserve);
     }
 
     Session::Session(LinkLayer* p, const SockAddr& from)
@@ -55,6 +121,8 @@ namespace llarp
       GotLIM = util::memFn(&Session::GotInboundLIM, this);
       const PubKey pk = m_Parent->GetOurRC().pubkey;
       CryptoManager::instance()->shorthash(m_SessionKey, llarp_buffer_t(pk));
+      m_EncryptNext.reserve(CryptoBatchReserve);
+      m_DecryptNext.reserve(CryptoBatchReserve);
     }
 
     void
@@ -65,6 +133,8 @@ namespace llarp
       m_Parent->SendTo_LL(m_RemoteAddr, pkt);
       m_LastTX = time_now_ms();
       m_TXRate += sz;
+      PacketsTX.Inc();
+      BytesTX.Inc(sz);
     }
 
     bool
@@ -138,9 +208,36 @@ namespace llarp
       m_EncryptNext.emplace_back(std::move(data));
       if (!IsEstablished())
       {
-        EncryptWorker(std::move(m_EncryptNext));
-        m_EncryptNext = CryptoQueue_t{};
+        EncryptWorker(std::exchange(m_EncryptNext, TakeBatch()));
+      }
+      else if (m_EncryptNext.size() == 1)
+        m_Parent->WakeSession(shared_from_this());
+    }
+
+    Session::CryptoQueue_t
+    Session::TakeBatch()
+    {
+      {
+        util::Lock lock{m_SpareBatchesMutex};
+        if (not m_SpareBatches.empty())
+        {
+          auto batch = std::move(m_SpareBatches.back());
+          m_SpareBatches.pop_back();
+          return batch;
+        }
       }
+      CryptoQueue_t batch;
+      batch.reserve(CryptoBatchReserve);
+      return batch;
+    }
+
+    void
+    Session::RecycleBatch(CryptoQueue_t batch)
+    {
+      batch.clear();
+      util::Lock lock{m_SpareBatchesMutex};
+      if (m_SpareBatches.size() < MaxSpareBatches)
+        m_SpareBatches.emplace_back(std::move(batch));
     }
 
     void
@@ -160,6 +257,7 @@ namespace llarp
         CryptoManager::instance()->hmac(pkt.data(), pktbuf, m_SessionKey);
         Send_LL(pkt.data(), pkt.size());
       }
+      RecycleBatch(std::move(msgs));
     }
 
     void
@@ -179,22 +277,20 @@ namespace llarp
     Session::SendMessageBuffer(
         ILinkSession::Message_t buf, ILinkSession::CompletionHandler completed)
     {
-      if (m_TXMsgs.size() >= MaxSendQueueSize)
+      const auto now = m_Parent->Now();
+      const auto msgid = m_TXID;
+      if (m_TXMsgs.Size() >= MaxSendQueueSize
+          or not m_TXMsgs.Emplace(msgid, msgid, std::move(buf), now, completed, m_FragmentSize))
       {
+        MessagesRejected.Inc();
         if (completed)
           completed(ILinkSession::DeliveryStatus::eDeliveryDropped);
         return false;
       }
-      const auto now = m_Parent->Now();
-      const auto msgid = m_TXID++;
-      const auto bufsz = buf.size();
-      auto& msg = m_TXMsgs.emplace(msgid, OutboundMessage{msgid, std::move(buf), now, completed})
-                      .first->second;
-      EncryptAndSend(msg.XMIT());
-      if (bufsz > FragmentSize)
-      {
-        msg.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
-      }
+      MessagesQueued.Inc();
+      m_TXExpiry.emplace(now + DeliveryTimeout + 1ms, msgid);
+      ++m_TXID;
+      TransmitPending(now);
       m_Stats.totalInFlightTX++;
       LogDebug("send message ", msgid, " to ", m_RemoteAddr);
       return true;
@@ -226,41 +322,170 @@ namespace llarp
     }
 
     void
-    Session::Pump()
+    Session::TransmitPending(llarp_time_t now)
     {
-      const auto now = m_Parent->Now();
-      if (m_State == State::Ready || m_State == State::LinkIntro)
+      // everything under the cursor is fully sent, acked or gone
+      for (; m_TXSendCursor < m_TXID; ++m_TXSendCursor)
       {
-        if (ShouldPing())
-          SendKeepAlive();
-        for (auto& item : m_RXMsgs)
+        auto* msg = m_TXMsgs.Find(m_TXSendCursor);
+        if (msg == nullptr)
+          continue;
+        for (auto idx = msg->NextUnsent(); idx < msg->NumFragments(); idx = msg->NextUnsent())
         {
-          if (item.second.ShouldSendACKS(now))
+          const auto sz = msg->FragmentBytes(idx);
+          if (not m_CC.CanSend(m_InflightBytes, sz))
+            return;
+          if (not m_CC.PacingAllows(now))
+          {
+            if (not m_PumpScheduled)
+            {
+              m_PumpScheduled = true;
+              m_Parent->CallLater(m_CC.NextSendAt() - now, [self = weak_from_this()] {
+                if (auto ptr = self.lock())
+                {
+                  ptr->m_PumpScheduled = false;
+                  ptr->Pump();
+                }
+              });
+            }
+            return;
+          }
+          if (not msg->m_RTOArmed)
           {
-            item.second.SendACKS(util::memFn(&Session::EncryptAndSend, this), now);
+            msg->m_RTOArmed = true;
+            m_TXTimers.emplace(now + m_CC.RTO(), m_TXSendCursor);
           }
+          EncryptAndSend(msg->Fragment(idx));
+          m_CC.OnSent(sz, msg->MarkSent(idx, now));
+          m_InflightBytes += sz;
         }
-        for (auto& item : m_TXMsgs)
+      }
+    }
+
+    void
+    Session::ProcessTimers(llarp_time_t now)
+    {
+      while (not m_RXTimers.empty() and m_RXTimers.top().first <= now)
+      {
+        const auto rxid = m_RXTimers.top().second;
+        m_RXTimers.pop();
+        auto* msg = m_RXMsgs.Find(rxid);
+        if (msg == nullptr)
+          continue;
+        if (msg->ShouldSendACKS(now))
+          msg->SendACKS(util::memFn(&Session::EncryptAndSend, this), now);
+        m_RXTimers.emplace(msg->m_LastACKSent + ACKResendInterval + 1ms, rxid);
+      }
+      const auto rto = m_CC.RTO();
+      while (not m_TXTimers.empty() and m_TXTimers.top().first <= now)
+      {
+        const auto txid = m_TXTimers.top().second;
+        m_TXTimers.pop();
+        auto* msg = m_TXMsgs.Find(txid);
+        if (msg == nullptr)
+          continue;
+        msg->m_RTOArmed = false;
+        if (msg->InflightBytes() == 0)
+          continue;
+        if (msg->ShouldFlush(now, rto))
         {
-          if (item.second.ShouldFlush(now))
-          {
-            item.second.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
-          }
+          LogTrace("rto expired for txid=", txid, " to ", m_RemoteAddr);
+          m_InflightBytes -= msg->ResendUnAcked();
+          m_CC.OnRTOExpired(now);
+          m_TXSendCursor = std::min(m_TXSendCursor, txid);
+        }
+        else
+        {
+          msg->m_RTOArmed = true;
+          m_TXTimers.emplace(msg->m_LastFlush + rto, txid);
         }
       }
+    }
+
+    void
+    Session::MaybeProbePMTU(llarp_time_t now)
+    {
+      if (m_State != State::Ready or now < m_NextProbeAt)
+        return;
+      // jumbo sizes only go out to lan and loopback, elsewhere they would just end up as ip
+      // fragments
+      const size_t numProbes = IsBogon(m_RemoteAddr.asIPv6()) ? PMTUProbeSizes.size() : 1;
+      if (m_ProbeIdx >= numProbes)
+      {
+        m_NextProbeAt = now + PMTUReprobeInterval;
+        return;
+      }
+      if (m_ProbeTries >= PMTUProbeTries)
+      {
+        LogDebug("pmtu probe of ", PMTUProbeSizes[m_ProbeIdx], " to ", m_RemoteAddr, " got lost");
+        m_ProbeTries = 0;
+        m_NextProbeAt = now + PMTUReprobeInterval;
+        return;
+      }
+      const auto sz = PMTUProbeSizes[m_ProbeIdx];
+      ++m_ProbeTries;
+      m_NextProbeAt = now + PMTUProbeTimeout;
+      EncryptAndSend(CreatePMTUPacket(ePMTUProbe, sz));
+    }
+
+    void
+    Session::HandlePMTUAck(size_t sz, llarp_time_t now)
+    {
+      if (m_ProbeIdx >= PMTUProbeSizes.size() or sz != PMTUProbeSizes[m_ProbeIdx])
+        return;
+      m_PathMTU = sz;
+      m_FragmentSize = std::min(MaxFragmentSize, m_PathMTU - XMITOverhead);
+      m_CC.SetSegmentSize(m_FragmentSize);
+      LogDebug("pmtu to ", m_RemoteAddr, " is at least ", sz, ", using ", m_FragmentSize, " bytes");
+      // go for the next size right away
+      ++m_ProbeIdx;
+      m_ProbeTries = 0;
+      m_NextProbeAt = now;
+    }
+
+    void
+    Session::TXMessageCompleted(OutboundMessage& msg, llarp_time_t now)
+    {
+      const auto inflight = msg.InflightBytes();
+      m_InflightBytes -= inflight;
+      m_CC.OnAck(inflight, now);
+      // karn: an ack for something we sent more than once does not tell us which send it was for
+      if (not msg.m_Retransmitted)
+        m_CC.OnRTTSample(now - msg.m_LastFlush);
+      MessagesAcked.Inc();
+      msg.Completed();
+    }
+
+    void
+    Session::Pump()
+    {
+      const auto now = m_Parent->Now();
+      if (m_State == State::Ready || m_State == State::LinkIntro)
+      {
+        if (ShouldPing())
+          SendKeepAlive();
+        ProcessTimers(now);
+        TransmitPending(now);
+        MaybeProbePMTU(now);
+      }
+      SchedulePump(now);
+      if (m_EncryptNext.empty() and m_DecryptNext.empty())
+        return;
       auto self = shared_from_this();
       assert(self.use_count() > 1);
       if (not m_EncryptNext.empty())
       {
-        m_Parent->QueueWork([self, data = m_EncryptNext] { self->EncryptWorker(data); });
-        m_EncryptNext.clear();
+        m_Parent->QueueWork([self, data = std::exchange(m_EncryptNext, TakeBatch())]() mutable {
+          self->EncryptWorker(std::move(data));
+        });
       }
 
       if (not m_DecryptNext.empty())
       {
         m_Parent->AddWakeup(weak_from_this());
-        m_Parent->QueueWork([self, data = m_DecryptNext] { self->DecryptWorker(data); });
-        m_DecryptNext.clear();
+        m_Parent->QueueWork([self, data = std::exchange(m_DecryptNext, TakeBatch())]() mutable {
+          self->DecryptWorker(std::move(data));
+        });
       }
     }
 
@@ -317,27 +542,60 @@ namespace llarp
           {"state", StateToString(m_State)},
           {"inbound", m_Inbound},
           {"replayFilter", m_ReplayFilter.size()},
-          {"txMsgQueueSize", m_TXMsgs.size()},
-          {"rxMsgQueueSize", m_RXMsgs.size()},
+          {"txMsgQueueSize", m_TXMsgs.Size()},
+          {"txInflightBytes", m_InflightBytes},
+          {"congestion", m_CC.ExtractStatus()},
+          {"pathMTU", m_PathMTU},
+          {"fragmentSize", m_FragmentSize},
+          {"rxMsgQueueSize", m_RXMsgs.Size()},
           {"remoteAddr", m_RemoteAddr.toString()},
           {"remoteRC", m_RemoteRC.ExtractStatus()},
           {"created", to_json(m_CreatedAt)},
           {"uptime", to_json(now - m_CreatedAt)}};
     }
 
+    llarp_time_t
+    Session::AliveTimeout() const
+    {
+      return m_Inbound and not m_RemoteRC.IsPublicRouter() ? DefaultLinkSessionLifetime
+                                                          : SessionAliveTimeout;
+    }
+
     bool
     Session::TimedOut(llarp_time_t now) const
     {
       if (m_State == State::Ready || m_State == State::LinkIntro)
       {
-        return now > m_LastRX
-            && now - m_LastRX
-            > (m_Inbound and not m_RemoteRC.IsPublicRouter() ? DefaultLinkSessionLifetime
-                                                             : SessionAliveTimeout);
+        return now > m_LastRX && now - m_LastRX > AliveTimeout();
       }
       return now - m_CreatedAt >= LinkLayerConnectTimeout;
     }
 
+    std::optional<llarp_time_t>
+    Session::NextPumpAt() const
+    {
+      if (m_State == State::Closed)
+        return std::nullopt;
+      if (m_State != State::Ready and m_State != State::LinkIntro)
+        return m_CreatedAt + LinkLayerConnectTimeout;
+      auto at = m_LastRX + AliveTimeout() + 1ms;
+      if (m_State == State::Ready)
+        at = std::min({at, m_LastTX + PingInterval + 1ms, m_NextProbeAt});
+      if (not m_RXTimers.empty())
+        at = std::min(at, m_RXTimers.top().first);
+      if (not m_TXTimers.empty())
+        at = std::min(at, m_TXTimers.top().first);
+      return at;
+    }
+
+    void
+    Session::SchedulePump(llarp_time_t now)
+    {
+      // whatever is due now was just handled or is waiting on a worker, look again next ms
+      if (const auto at = NextPumpAt())
+        m_Parent->SchedulePump(shared_from_this(), std::max(*at, now + 1ms));
+    }
+
     bool
     Session::ShouldResetRates(llarp_time_t now) const
     {
@@ -363,35 +621,52 @@ namespace llarp
       }
       // remove pending outbound messsages that timed out
       // inform waiters
+      while (not m_TXExpiry.empty() and m_TXExpiry.top().first <= now)
       {
-        auto itr = m_TXMsgs.begin();
-        while (itr != m_TXMsgs.end())
+        const auto msgid = m_TXExpiry.top().second;
+        m_TXExpiry.pop();
+        // acked messages are already gone, started at is fixed so the deadline was exact
+        const auto* pending = m_TXMsgs.Find(msgid);
+        if (pending == nullptr or not pending->IsTimedOut(now))
+          continue;
+        // take it out first, the waiter might queue another message right away
+        if (auto msg = m_TXMsgs.Take(msgid))
         {
-          if (itr->second.IsTimedOut(now))
+          m_Stats.totalDroppedTX++;
+          m_Stats.totalInFlightTX--;
+          MessagesTimedOut.Inc();
+          LogTrace("Dropped unacked packet to ", m_RemoteAddr);
+          m_InflightBytes -= msg->InflightBytes();
+          if (msg->m_FragmentSize > FragmentSize and m_FragmentSize > FragmentSize)
           {
-            m_Stats.totalDroppedTX++;
-            m_Stats.totalInFlightTX--;
-            LogTrace("Dropped unacked packet to ", m_RemoteAddr);
-            itr->second.InformTimeout();
-            itr = m_TXMsgs.erase(itr);
+            // our larger fragments might be getting black holed, go back to the safe size
+            LogDebug("falling back to ", FragmentSize, " byte fragments to ", m_RemoteAddr);
+            m_FragmentSize = FragmentSize;
+            m_CC.SetSegmentSize(FragmentSize);
+            m_PathMTU = 0;
+            m_ProbeIdx = 0;
+            m_ProbeTries = 0;
+            m_NextProbeAt = now + PMTUReprobeInterval;
           }
-          else
-            ++itr;
+          msg->InformTimeout();
         }
       }
+      // remove pending inbound messages that timed out
+      while (not m_RXExpiry.empty() and m_RXExpiry.top().first <= now)
       {
-        // remove pending inbound messages that timed out
-        auto itr = m_RXMsgs.begin();
-        while (itr != m_RXMsgs.end())
+        const auto rxid = m_RXExpiry.top().second;
+        m_RXExpiry.pop();
+        const auto* msg = m_RXMsgs.Find(rxid);
+        if (msg == nullptr)
+          continue;
+        if (not msg->IsTimedOut(now))
         {
-          if (itr->second.IsTimedOut(now))
-          {
-            m_ReplayFilter.emplace(itr->first, now);
-            itr = m_RXMsgs.erase(itr);
-          }
-          else
-            ++itr;
+          // it got more fragments since, look again once it could have timed out
+          m_RXExpiry.emplace(msg->m_LastActiveAt + DeliveryTimeout + 1ms, rxid);
+          continue;
         }
+        m_ReplayFilter.emplace(rxid, now);
+        m_RXMsgs.Erase(rxid);
       }
       {
         // decay replay window
@@ -607,36 +882,36 @@ namespace llarp
       if (m_Inbound)
         return;
       GenerateAndSendIntro();
+      SchedulePump(m_Parent->Now());
     }
 
     void
     Session::HandleSessionData(Packet_t pkt)
     {
       m_DecryptNext.emplace_back(std::move(pkt));
+      if (m_DecryptNext.size() == 1)
+        m_Parent->WakeSession(shared_from_this());
     }
 
     void
     Session::DecryptWorker(CryptoQueue_t msgs)
     {
-      auto itr = msgs.begin();
-      while (itr != msgs.end())
-      {
-        auto& pkt = *itr;
+      // compact the good packets to the front so dropping one never shifts the whole batch
+      auto end = std::remove_if(msgs.begin(), msgs.end(), [this](Packet_t& pkt) {
         if (not DecryptMessageInPlace(pkt))
         {
-          itr = msgs.erase(itr);
           LogError("failed to decrypt session data from ", m_RemoteAddr);
-          continue;
+          return true;
         }
         if (pkt[PacketOverhead] != LLARP_PROTO_VERSION)
         {
           LogError(
               "protocol version mismatch ", int(pkt[PacketOverhead]), " != ", LLARP_PROTO_VERSION);
-          itr = msgs.erase(itr);
-          continue;
+          return true;
         }
-        ++itr;
-      }
+        return false;
+      });
+      msgs.erase(end, msgs.end());
       m_PlaintextRecv.tryPushBack(std::move(msgs));
       m_Parent->WakeupPlaintext();
     }
@@ -677,6 +952,7 @@ namespace llarp
               LogError("invalid command ", int(result[PacketOverhead + 1]), " from ", m_RemoteAddr);
           }
         }
+        RecycleBatch(std::move(queue));
       }
       SendMACK();
       Pump();
@@ -697,18 +973,17 @@ namespace llarp
         return;
       }
       LogTrace("got ", int(numAcks), " mack from ", m_RemoteAddr);
+      const auto now = m_Parent->Now();
       byte_t* ptr = data.data() + CommandOverhead + PacketOverhead + 1;
       while (numAcks > 0)
       {
         uint64_t acked = bufbe64toh(ptr);
         LogTrace("mack containing txid=", acked, " from ", m_RemoteAddr);
-        auto itr = m_TXMsgs.find(acked);
-        if (itr != m_TXMsgs.end())
+        if (auto msg = m_TXMsgs.Take(acked))
         {
           m_Stats.totalAckedTX++;
           m_Stats.totalInFlightTX--;
-          itr->second.Completed();
-          m_TXMsgs.erase(itr);
+          TXMessageCompleted(*msg, now);
         }
         else
         {
@@ -729,20 +1004,20 @@ namespace llarp
       }
       uint64_t txid = bufbe64toh(data.data() + CommandOverhead + PacketOverhead);
       LogTrace("got nack on ", txid, " from ", m_RemoteAddr);
-      auto itr = m_TXMsgs.find(txid);
-      if (itr != m_TXMsgs.end())
+      const auto now = m_Parent->Now();
+      if (auto* msg = m_TXMsgs.Find(txid))
       {
-        EncryptAndSend(itr->second.XMIT());
+        // they never got our XMIT, it goes out again on the next pump
+        m_InflightBytes -= msg->Resend(0);
+        m_CC.OnLoss(now);
+        m_TXSendCursor = std::min(m_TXSendCursor, txid);
       }
-      m_LastRX = m_Parent->Now();
+      m_LastRX = now;
     }
 
     void
     Session::HandleXMIT(Packet_t data)
     {
-      static constexpr size_t XMITOverhead =
-          (CommandOverhead + PacketOverhead + sizeof(uint16_t) + sizeof(uint64_t)
-           + ShortHash::SIZE);
       if (data.size() < XMITOverhead)
       {
         LogError("short XMIT from ", m_RemoteAddr);
@@ -766,30 +1041,36 @@ namespace llarp
       }
       {
         const auto now = m_Parent->Now();
-        auto itr = m_RXMsgs.find(rxid);
-        if (itr == m_RXMsgs.end())
+        if (m_RXMsgs.Find(rxid) == nullptr)
         {
-          itr =
-              m_RXMsgs.emplace(rxid, InboundMessage{rxid, sz, std::move(h), m_Parent->Now()}).first;
-          sz = std::min(sz, uint16_t{FragmentSize});
-          if ((data.size() - XMITOverhead) == sz)
+          // the XMIT carries the first fragment, which tells us the fragment size the remote uses
+          const size_t extra = data.size() - XMITOverhead;
+          if (sz > MAX_LINK_MSG_SIZE or extra > sz or (extra < sz and extra < FragmentSize))
           {
-            {
-              const llarp_buffer_t buf(data.data() + (data.size() - sz), sz);
-              itr->second.HandleData(0, buf, now);
-              if (not itr->second.IsCompleted())
-              {
-                return;
-              }
-
-              if (not itr->second.Verify())
-              {
-                LogError("bad short xmit hash from ", m_RemoteAddr);
-                return;
-              }
-            }
-            HandleRecvMsgCompleted(itr->second);
+            LogError("bad xmit fragment size ", extra, " for ", sz, " bytes from ", m_RemoteAddr);
+            return;
+          }
+          const size_t fragsz = std::max(extra, FragmentSize);
+          auto* msg = m_RXMsgs.Size() < MaxSendQueueSize
+              ? m_RXMsgs.Emplace(rxid, rxid, sz, std::move(h), now, fragsz)
+              : nullptr;
+          if (msg == nullptr)
+          {
+            LogWarn("too many inbound messages from ", m_RemoteAddr, ", dropping rxid=", rxid);
+            return;
+          }
+          m_RXTimers.emplace(now, rxid);
+          m_RXExpiry.emplace(now + DeliveryTimeout + 1ms, rxid);
+          const llarp_buffer_t buf(data.data() + XMITOverhead, extra);
+          msg->HandleData(0, buf, now);
+          if (not msg->IsCompleted())
+            return;
+          if (not msg->Verify())
+          {
+            LogError("bad short xmit hash from ", m_RemoteAddr);
+            return;
           }
+          HandleRecvMsgCompleted(*msg);
         }
         else
           LogTrace("got duplicate xmit on ", rxid, " from ", m_RemoteAddr);
@@ -807,8 +1088,8 @@ namespace llarp
       m_LastRX = m_Parent->Now();
       uint16_t sz = bufbe16toh(data.data() + CommandOverhead + PacketOverhead);
       uint64_t rxid = bufbe64toh(data.data() + CommandOverhead + sizeof(uint16_t) + PacketOverhead);
-      auto itr = m_RXMsgs.find(rxid);
-      if (itr == m_RXMsgs.end())
+      auto* msg = m_RXMsgs.Find(rxid);
+      if (msg == nullptr)
       {
         if (m_ReplayFilter.find(rxid) == m_ReplayFilter.end())
         {
@@ -828,18 +1109,18 @@ namespace llarp
       {
         const llarp_buffer_t buf(
             data.data() + PacketOverhead + 12, data.size() - (PacketOverhead + 12));
-        itr->second.HandleData(sz, buf, m_Parent->Now());
+        msg->HandleData(sz, buf, m_Parent->Now());
       }
 
-      if (itr->second.IsCompleted())
+      if (msg->IsCompleted())
       {
-        if (itr->second.Verify())
+        if (msg->Verify())
         {
-          HandleRecvMsgCompleted(itr->second);
+          HandleRecvMsgCompleted(*msg);
         }
         else
         {
-          LogError("hash mismatch for message ", itr->first);
+          LogError("hash mismatch for message ", rxid);
         }
       }
     }
@@ -854,7 +1135,7 @@ namespace llarp
         EncryptAndSend(msg.ACKS());
         LogDebug("recv'd message ", rxid, " from ", m_RemoteAddr);
       }
-      m_RXMsgs.erase(rxid);
+      m_RXMsgs.Erase(rxid);
     }
 
     void
@@ -868,23 +1149,22 @@ namespace llarp
       const auto now = m_Parent->Now();
       m_LastRX = now;
       uint64_t txid = bufbe64toh(data.data() + 2 + PacketOverhead);
-      auto itr = m_TXMsgs.find(txid);
-      if (itr == m_TXMsgs.end())
+      auto* msg = m_TXMsgs.Find(txid);
+      if (msg == nullptr)
       {
         LogTrace("no txid=", txid, " for ", m_RemoteAddr);
         return;
       }
-      itr->second.Ack(data[10 + PacketOverhead]);
+      const auto acked = msg->Ack(data[10 + PacketOverhead]);
+      m_InflightBytes -= acked;
+      m_CC.OnAck(acked, now);
 
-      if (itr->second.IsTransmitted())
+      if (msg->IsTransmitted())
       {
-        LogDebug("sent message ", itr->first, " to ", m_RemoteAddr);
-        itr->second.Completed();
-        itr = m_TXMsgs.erase(itr);
-      }
-      else
-      {
-        itr->second.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+        LogDebug("sent message ", txid, " to ", m_RemoteAddr);
+        // take it out first, the completion handler may queue more messages
+        auto done = m_TXMsgs.Take(txid);
+        TXMessageCompleted(*done, now);
       }
     }
 
@@ -894,9 +1174,21 @@ namespace llarp
       Close();
     }
 
-    void Session::HandlePING(Packet_t)
+    void Session::HandlePING(Packet_t data)
     {
-      m_LastRX = m_Parent->Now();
+      const auto now = m_Parent->Now();
+      m_LastRX = now;
+      if (data.size() < PacketOverhead + CommandOverhead + PMTUBodySize)
+        return;
+      const byte_t* ptr = data.data() + PacketOverhead + CommandOverhead;
+      if (not std::equal(PMTUMagic.begin(), PMTUMagic.end(), ptr))
+        return;
+      ptr += PMTUMagic.size();
+      const byte_t kind = *ptr++;
+      if (kind == ePMTUProbe)
+        EncryptAndSend(CreatePMTUPacket(ePMTUAck, data.size()));
+      else if (kind == ePMTUAck)
+        HandlePMTUAck(bufbe16toh(ptr), now);
     }
 
     bool
@@ -920,6 +1212,8 @@ namespace llarp
     Session::Recv_LL(ILinkSession::Packet_t data)
     {
       m_RXRate += data.size();
+      PacketsRX.Inc();
+      BytesRX.Inc(data.size());
 
       // TODO: differentiate between good and bad RX packets here
       m_Stats.totalPacketsRX++;
@@ -959,6 +1253,7 @@ namespace llarp
           HandleSessionData(std::move(data));
           break;
       }
+      SchedulePump(m_Parent->Now());
       return true;
     }
 
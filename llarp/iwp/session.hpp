@@ -1,16 +1,22 @@
 #pragma once
 
 #include <llarp/link/session.hpp>
+#include "congestion.hpp"
 #include "linklayer.hpp"
 #include "message_buffer.hpp"
+#include "message_ring.hpp"
 #include <llarp/net/ip_address.hpp>
 
-#include <map>
+#include <array>
+#include <unordered_map>
 #include <unordered_set>
 #include <deque>
+#include <optional>
 #include <queue>
 
+#include <llarp/util/thread/annotations.hpp>
 #include <llarp/util/thread/queue.hpp>
+#include <llarp/util/thread/threading.hpp>
 
 namespace llarp
 {
@@ -35,6 +41,19 @@ namespace llarp
     static constexpr std::chrono::milliseconds PingInterval = 5s;
     /// How long we wait for a session to die with no tx from them
     static constexpr auto SessionAliveTimeout = PingInterval * 5;
+    /// wire size of an XMIT without its fragment
+    static constexpr size_t XMITOverhead = PacketOverhead + CommandOverhead + sizeof(uint16_t)
+        + sizeof(uint64_t) + ShortHash::SIZE;
+    /// udp payload sizes we probe the path for, smallest first. the first fits a 1500 byte mtu
+    /// with ipv6 headers, the second fits a whole message in one XMIT and is only tried on lan or
+    /// loopback
+    static constexpr std::array<size_t, 2> PMTUProbeSizes{1452, MaxFragmentSize + XMITOverhead};
+    /// How long we wait for a pmtu probe to be acked
+    static constexpr auto PMTUProbeTimeout = 1s;
+    /// How many times we send a pmtu probe before deciding that size does not get through
+    static constexpr unsigned PMTUProbeTries = 3;
+    /// How long until we probe again after a probe failed or our fragments got black holed
+    static constexpr auto PMTUReprobeInterval = 10min;
 
     struct Session : public ILinkSession, public std::enable_shared_from_this<Session>
     {
@@ -102,7 +121,7 @@ namespace llarp
       size_t
       SendQueueBacklog() const override
       {
-        return m_TXMsgs.size();
+        return m_TXMsgs.Size();
       }
 
       ILinkLayer*
@@ -185,8 +204,39 @@ namespace llarp
       void
       ResetRates();
 
-      std::map<uint64_t, InboundMessage> m_RXMsgs;
-      std::map<uint64_t, OutboundMessage> m_TXMsgs;
+      MessageRing<InboundMessage> m_RXMsgs{MaxSendQueueSize};
+      MessageRing<OutboundMessage> m_TXMsgs{MaxSendQueueSize};
+      /// lowest tx message id that might still have fragments to send
+      uint64_t m_TXSendCursor = 0;
+
+      /// (deadline, message id) min heap, stale entries are skipped when they come up
+      using MessageTimers_t = std::priority_queue<
+          std::pair<llarp_time_t, uint64_t>,
+          std::vector<std::pair<llarp_time_t, uint64_t>>,
+          std::greater<std::pair<llarp_time_t, uint64_t>>>;
+      /// when rx messages are due for their next ACKS
+      MessageTimers_t m_RXTimers;
+      /// when tx messages with fragments in flight are due for an rto check
+      MessageTimers_t m_TXTimers;
+      /// when rx messages give up waiting for the rest of their fragments
+      MessageTimers_t m_RXExpiry;
+      /// when tx messages give up waiting to be acked
+      MessageTimers_t m_TXExpiry;
+
+      CongestionControl m_CC{FragmentSize, TXFlushInterval};
+      /// payload bytes of tx messages sent and not acked
+      size_t m_InflightBytes = 0;
+      /// did we ask the link layer to pump us once pacing lets us send again
+      bool m_PumpScheduled = false;
+
+      /// largest udp payload the remote confirmed getting from us, 0 if none
+      size_t m_PathMTU = 0;
+      /// fragment size we send new messages in
+      size_t m_FragmentSize = FragmentSize;
+      /// index into PMTUProbeSizes of the size we probe next
+      size_t m_ProbeIdx = 0;
+      unsigned m_ProbeTries = 0;
+      llarp_time_t m_NextProbeAt = 0s;
 
       /// maps rxid to time recieved
       std::unordered_map<uint64_t, llarp_time_t> m_ReplayFilter;
@@ -200,6 +250,20 @@ namespace llarp
 
       llarp::thread::Queue<CryptoQueue_t> m_PlaintextRecv;
 
+      /// emptied batches handed back by the crypto workers and the plaintext handler, batches are
+      /// only ever moved between the pump, the workers and here so they keep their capacity and
+      /// steady state dispatch neither copies nor allocates
+      mutable util::Mutex m_SpareBatchesMutex;
+      std::vector<CryptoQueue_t> m_SpareBatches GUARDED_BY(m_SpareBatchesMutex);
+
+      /// an empty batch to fill next, recycled if we have one
+      CryptoQueue_t
+      TakeBatch();
+
+      /// give back a batch we are done with, called from any thread
+      void
+      RecycleBatch(CryptoQueue_t batch);
+
       void
       EncryptWorker(CryptoQueue_t msgs);
 
@@ -227,6 +291,38 @@ namespace llarp
       void
       SendMACK();
 
+      /// send fragments of tx messages while the congestion window and pacing let us
+      void
+      TransmitPending(llarp_time_t now);
+
+      /// send ACKS and retransmit for the messages whose timers are up
+      void
+      ProcessTimers(llarp_time_t now);
+
+      /// how long we go without hearing from the remote before we time out once established
+      llarp_time_t
+      AliveTimeout() const;
+
+      /// the earliest a timer, a ping or timing out needs a Pump, nullopt once closed
+      std::optional<llarp_time_t>
+      NextPumpAt() const;
+
+      /// have the link layer pump us at NextPumpAt
+      void
+      SchedulePump(llarp_time_t now);
+
+      /// send the next pmtu probe if one is due
+      void
+      MaybeProbePMTU(llarp_time_t now);
+
+      /// the remote got a probe of sz bytes from us
+      void
+      HandlePMTUAck(size_t sz, llarp_time_t now);
+
+      /// a tx message got fully acked
+      void
+      TXMessageCompleted(OutboundMessage& msg, llarp_time_t now);
+
       void
       HandleRecvMsgCompleted(const InboundMessage& msg);
 
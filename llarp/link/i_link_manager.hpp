@@ -47,6 +47,10 @@ namespace llarp
     virtual std::optional<bool>
     SessionIsClient(RouterID remote) const = 0;
 
+    /// how many messages our session with this peer has queued to send, 0 if we have none
+    virtual size_t
+    SendQueueBacklog(const RouterID& remote) const = 0;
+
     virtual void
     PumpLinks() = 0;
 
@@ -85,6 +85,20 @@ namespace llarp
     return std::nullopt;
   }
 
+  size_t
+  LinkManager::SendQueueBacklog(const RouterID& remote) const
+  {
+    auto link = GetLinkWithSessionTo(remote);
+    if (link == nullptr)
+      return 0;
+    size_t backlog = 0;
+    link->VisitSessionByPubkey(remote, [&backlog](ILinkSession* session) {
+      backlog = session->SendQueueBacklog();
+      return true;
+    });
+    return backlog;
+  }
+
   void
   LinkManager::DeregisterPeer(RouterID remote)
   {
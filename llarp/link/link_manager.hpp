@@ -39,6 +39,9 @@ namespace llarp
     std::optional<bool>
     SessionIsClient(RouterID remote) const override;
 
+    size_t
+    SendQueueBacklog(const RouterID& remote) const override;
+
     void
     DeregisterPeer(RouterID remote) override;
 
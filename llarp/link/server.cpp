@@ -3,6 +3,7 @@
 #include <llarp/ev/udp_handle.hpp>
 #include <llarp/crypto/crypto.hpp>
 #include <llarp/config/key_manager.hpp>
+#include <algorithm>
 #include <memory>
 #include <llarp/util/fs.hpp>
 #include <utility>
@@ -167,50 +168,60 @@ namespace llarp
     return true;
   }
 
+  void
+  ILinkLayer::WakeSession(const std::shared_ptr<ILinkSession>& s)
+  {
+    if (s->m_PumpQueued)
+      return;
+    s->m_PumpQueued = true;
+    m_PumpNow.emplace_back(s);
+  }
+
+  void
+  ILinkLayer::SchedulePump(const std::shared_ptr<ILinkSession>& s, llarp_time_t at)
+  {
+    if (s->m_PumpDeadline != 0s and s->m_PumpDeadline <= at)
+      return;
+    s->m_PumpDeadline = at;
+    m_PumpDeadlines.push(PumpDeadline{at, s});
+  }
+
   void
   ILinkLayer::Pump()
   {
-    std::unordered_set<RouterID> closedSessions;
-    std::vector<std::shared_ptr<ILinkSession>> closedPending;
-    auto _now = Now();
+    const auto _now = Now();
+    // collect first, pumping a session can wake or schedule it again
+    std::vector<std::shared_ptr<ILinkSession>> due;
+    for (const auto& weak : m_PumpNow)
     {
-      Lock_t l(m_AuthedLinksMutex);
-      auto itr = m_AuthedLinks.begin();
-      while (itr != m_AuthedLinks.end())
-      {
-        if (not itr->second->TimedOut(_now))
-        {
-          itr->second->Pump();
-          ++itr;
-        }
-        else
-        {
-          llarp::LogInfo("session to ", RouterID(itr->second->GetPubKey()), " timed out");
-          itr->second->Close();
-          closedSessions.emplace(itr->first);
-          itr = m_AuthedLinks.erase(itr);
-        }
-      }
+      if (auto s = weak.lock())
+        due.emplace_back(std::move(s));
     }
+    m_PumpNow.clear();
+    while (not m_PumpDeadlines.empty() and m_PumpDeadlines.top().at <= _now)
     {
-      Lock_t l(m_PendingMutex);
+      auto s = m_PumpDeadlines.top().session.lock();
+      const auto at = m_PumpDeadlines.top().at;
+      m_PumpDeadlines.pop();
+      if (s == nullptr or s->m_PumpDeadline != at)
+        continue;
+      s->m_PumpDeadline = 0s;
+      if (not s->m_PumpQueued)
+        due.emplace_back(std::move(s));
+    }
+    if (due.empty())
+      return;
+    for (const auto& s : due)
+      s->m_PumpQueued = false;
 
-      auto itr = m_Pending.begin();
-      while (itr != m_Pending.end())
-      {
-        if (not itr->second->TimedOut(_now))
-        {
-          itr->second->Pump();
-          ++itr;
-        }
-        else
-        {
-          LogInfo("pending session at ", itr->first, " timed out");
-          // defer call so we can acquire mutexes later
-          closedPending.emplace_back(std::move(itr->second));
-          itr = m_Pending.erase(itr);
-        }
-      }
+    std::unordered_set<RouterID> closedSessions;
+    std::vector<std::shared_ptr<ILinkSession>> closedPending;
+    for (const auto& s : due)
+    {
+      if (s->TimedOut(_now))
+        RemoveTimedOut(s, closedSessions, closedPending);
+      else
+        s->Pump();
     }
     {
       Lock_t l(m_AuthedLinksMutex);
@@ -230,6 +241,36 @@ namespace llarp
     }
   }
 
+  void
+  ILinkLayer::RemoveTimedOut(
+      const std::shared_ptr<ILinkSession>& s,
+      std::unordered_set<RouterID>& closedSessions,
+      std::vector<std::shared_ptr<ILinkSession>>& closedPending)
+  {
+    {
+      Lock_t l(m_AuthedLinksMutex);
+      const RouterID remote{s->GetPubKey()};
+      auto [itr, end] = m_AuthedLinks.equal_range(remote);
+      itr = std::find_if(itr, end, [&s](const auto& item) { return item.second == s; });
+      if (itr != end)
+      {
+        llarp::LogInfo("session to ", remote, " timed out");
+        s->Close();
+        closedSessions.emplace(remote);
+        m_AuthedLinks.erase(itr);
+        return;
+      }
+    }
+    Lock_t l(m_PendingMutex);
+    const auto itr = m_Pending.find(s->GetRemoteEndpoint());
+    if (itr == m_Pending.end() or itr->second != s)
+      return;
+    LogInfo("pending session at ", itr->first, " timed out");
+    // defer call so we can acquire mutexes later
+    closedPending.emplace_back(s);
+    m_Pending.erase(itr);
+  }
+
   bool
   ILinkLayer::MapAddr(const RouterID& pk, ILinkSession* s)
   {
@@ -11,7 +11,10 @@
 
 #include <list>
 #include <memory>
+#include <queue>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace llarp
 {
@@ -117,9 +120,19 @@ namespace llarp
     std::shared_ptr<ILinkSession>
     FindSessionByPubkey(RouterID pk);
 
+    /// pump the sessions that were woken or whose deadline is up, time out the ones that timed
+    /// out. sessions with nothing due are not looked at.
     virtual void
     Pump();
 
+    /// have the next Pump pump s
+    void
+    WakeSession(const std::shared_ptr<ILinkSession>& s);
+
+    /// have Pump pump s once at is reached, unless it is already due before then
+    void
+    SchedulePump(const std::shared_ptr<ILinkSession>& s, llarp_time_t at);
+
     virtual void
     RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt) = 0;
 
@@ -254,7 +267,31 @@ namespace llarp
     std::unordered_map<SockAddr, llarp_time_t> m_RecentlyClosed;
 
    private:
+    /// take s out of the session maps as it timed out
+    void
+    RemoveTimedOut(
+        const std::shared_ptr<ILinkSession>& s,
+        std::unordered_set<RouterID>& closedSessions,
+        std::vector<std::shared_ptr<ILinkSession>>& closedPending);
+
     std::shared_ptr<int> m_repeater_keepalive;
+
+    struct PumpDeadline
+    {
+      llarp_time_t at;
+      std::weak_ptr<ILinkSession> session;
+
+      bool
+      operator>(const PumpDeadline& other) const
+      {
+        return at > other.at;
+      }
+    };
+    /// when sessions are next due, an entry is stale once its session got an earlier deadline
+    std::priority_queue<PumpDeadline, std::vector<PumpDeadline>, std::greater<PumpDeadline>>
+        m_PumpDeadlines;
+    /// sessions to pump on the next Pump no matter what
+    std::vector<std::weak_ptr<ILinkSession>> m_PumpNow;
   };
 
   using LinkLayer_ptr = std::shared_ptr<ILinkLayer>;
@@ -42,7 +42,8 @@ namespace llarp
     virtual void
     OnLinkEstablished(ILinkLayer*){};
 
-    /// called every event loop tick
+    /// called when the link layer has us due, see ILinkLayer::WakeSession and
+    /// ILinkLayer::SchedulePump
     virtual void
     Pump() = 0;
 
@@ -130,5 +131,12 @@ namespace llarp
 
     virtual util::StatusObject
     ExtractStatus() const = 0;
+
+   private:
+    friend struct ILinkLayer;
+    /// link layer bookkeeping, the deadline it has us queued for, 0 if none, and if we are
+    /// queued to be pumped right away
+    llarp_time_t m_PumpDeadline = 0s;
+    bool m_PumpQueued = false;
   };
 }  // namespace llarp
@@ -7,9 +7,20 @@
 
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/service/context.hpp>
+#include <llarp/service/name.hpp>
 #include <llarp/quic/tunnel.hpp>
 #include <llarp/nodedb.hpp>
+#include <llarp/handlers/null.hpp>
+#include <llarp/ev/udp_handle.hpp>
+#include <llarp/util/codel.hpp>
 
+#include <oxenmq/variant.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <map>
 #include <mutex>
 
 #ifdef _WIN32
@@ -28,6 +39,423 @@ namespace
       return std::make_shared<llarp::NodeDB>();
     }
   };
+
+  using AddressVariant_t = llarp::EndpointBase::AddressVariant_t;
+
+  /// how long we wait for the event loop to set up a udp socket
+  constexpr auto UDPSetupTimeout = 10s;
+  /// how long a udp flow waits for a path to its remote, less than UDPSetupTimeout so the flow
+  /// gives up before the caller does
+  constexpr auto UDPPathTimeout = 8s;
+
+  /// a udp packet sitting in one of a udp socket's rings, remote is who it is from or to
+  struct UDPDatagram
+  {
+    llarp::net::IPPacket pkt;
+    AddressVariant_t remote;
+
+    UDPDatagram(llarp::net::IPPacket p, AddressVariant_t r)
+        : pkt{std::move(p)}, remote{std::move(r)}
+    {}
+
+    struct GetTime
+    {
+      llarp_time_t
+      operator()(const UDPDatagram& dgram) const
+      {
+        return dgram.pkt.timestamp;
+      }
+    };
+
+    struct PutTime
+    {
+      llarp::EventLoop_ptr loop;
+
+      void
+      operator()(UDPDatagram& dgram) const
+      {
+        dgram.pkt.timestamp = loop->time_now();
+      }
+    };
+  };
+
+  /// wakes up lokinet_udp_poll callers when packets come in on any udp socket
+  struct UDPPoller
+  {
+    std::mutex m_Access;
+    std::condition_variable m_Cond;
+    std::atomic<int> m_Waiters{0};
+
+    /// event loop side, called after a packet was put in a ring
+    void
+    Notify()
+    {
+      // pairs with the increment of m_Waiters so either we see the waiter or it sees the packet
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (m_Waiters.load(std::memory_order_relaxed) == 0)
+        return;
+      std::lock_guard lock{m_Access};
+      m_Cond.notify_all();
+    }
+
+    /// wait until ready() is true or timeout passes, false on timeout. a null timeout waits
+    /// forever.
+    template <typename Pred>
+    bool
+    Wait(const timespec* timeout, Pred ready)
+    {
+      m_Waiters.fetch_add(1);
+      bool result = true;
+      {
+        std::unique_lock lock{m_Access};
+        if (timeout)
+          result = m_Cond.wait_for(
+              lock,
+              std::chrono::seconds{timeout->tv_sec} + std::chrono::nanoseconds{timeout->tv_nsec},
+              ready);
+        else
+          m_Cond.wait(lock, ready);
+      }
+      m_Waiters.fetch_sub(1);
+      return result;
+    }
+  };
+
+  /// a udp socket made by lokinet_udp_bind or lokinet_udp_establish.
+  /// the event loop puts inbound packets in m_Inbound for lokinet_udp_recvmmsg to drain and
+  /// lokinet_udp_sendmmsg puts outbound packets in m_Outbound for the event loop to drain, both
+  /// are lock free rings so neither side waits on the other per packet.
+  /// if the socket forwards to a local address the rings are not used.
+  class UDPSocket : public std::enable_shared_from_this<UDPSocket>
+  {
+   public:
+    static constexpr size_t RingSize = 512;
+
+    UDPSocket(
+        std::shared_ptr<llarp::handlers::NullEndpoint> ep,
+        std::shared_ptr<UDPPoller> poller,
+        llarp::nuint16_t localport)
+        : m_Endpoint{ep}
+        , m_Loop{ep->Loop()}
+        , m_Poller{std::move(poller)}
+        , m_LocalPort{localport}
+        , m_Inbound{"udp inbound", UDPDatagram::PutTime{m_Loop}, m_Loop, RingSize}
+        , m_Outbound{"udp outbound", UDPDatagram::PutTime{m_Loop}, m_Loop, RingSize}
+    {}
+
+    /// event loop side, only take packets from port on remote and send everything there
+    void
+    Connect(AddressVariant_t remote, llarp::nuint16_t port)
+    {
+      m_Remote = std::move(remote);
+      m_RemotePort = port;
+    }
+
+    /// event loop side, hand inbound packets to a local udp socket on addr instead of the ring.
+    /// a flow listens on addr and sends whatever comes in to its remote, a bound socket sends
+    /// each remote's packets to addr from a udp socket of its own.
+    bool
+    Forward(const llarp::SockAddr& addr)
+    {
+      if (not m_Remote)
+      {
+        m_ForwardTo = addr;
+        return true;
+      }
+      m_Local = m_Loop->make_udp(
+          [self = weak_from_this()](auto&, llarp::SockAddr src, llarp::OwnedBuffer buf) {
+            auto ptr = self.lock();
+            if (not ptr)
+              return;
+            ptr->m_LocalPeer = src;
+            ptr->SendToRemote(*ptr->m_Remote, ptr->m_RemotePort, buf);
+          });
+      return m_Local->listen(addr);
+    }
+
+    /// event loop side, start taking packets for our local port. false if something else has it
+    bool
+    Start()
+    {
+      auto ep = m_Endpoint.lock();
+      if (not ep)
+        return false;
+      m_Waker = m_Loop->make_waker([self = weak_from_this()]() {
+        if (auto ptr = self.lock())
+          ptr->DrainOutbound();
+      });
+      return ep->AddUDPHandler(
+          m_LocalPort, [self = weak_from_this()](auto tag, llarp::net::IPPacket pkt) {
+            if (auto ptr = self.lock())
+              ptr->HandleInbound(tag, std::move(pkt));
+          });
+    }
+
+    /// event loop side, stop taking and sending packets
+    void
+    Stop()
+    {
+      if (auto ep = m_Endpoint.lock())
+      {
+        ep->RemoveUDPHandler(m_LocalPort);
+        if (m_SRV)
+          ep->DelSRVRecordIf([srv = *m_SRV](const auto& other) { return other == srv; });
+      }
+      m_Local.reset();
+      m_Forwards.clear();
+      std::lock_guard lock{m_SendAccess};
+      m_Waker.reset();
+    }
+
+    /// event loop side, advertise an srv record for our local port until we stop
+    void
+    AddSRV(std::string service)
+    {
+      auto ep = m_Endpoint.lock();
+      if (not ep)
+        return;
+      m_SRV = llarp::dns::SRVData::fromTuple(
+          std::make_tuple("_" + service + "._udp", 1, 1, llarp::ToHost(m_LocalPort).h, ""));
+      ep->PutSRVRecord(*m_SRV);
+    }
+
+    /// caller side, true if lokinet_udp_recvmmsg has something to get
+    bool
+    Readable() const
+    {
+      return m_Inbound.Size() > 0;
+    }
+
+    /// caller side, drain up to max packets into events
+    size_t
+    Recv(lokinet_udp_pkt* events, size_t max)
+    {
+      std::lock_guard lock{m_RecvAccess};
+      size_t num = 0;
+      m_Inbound.Process(
+          [events, &num](UDPDatagram& dgram) {
+            auto& ev = events[num++];
+            const auto addr = var::visit([](const auto& a) { return a.ToString(); }, dgram.remote);
+            const auto addrlen = std::min(addr.size(), sizeof(ev.remote_addr) - 1);
+            std::copy_n(addr.data(), addrlen, ev.remote_addr);
+            ev.remote_addr[addrlen] = 0;
+            ev.remote_port = llarp::ToHost(*dgram.pkt.SrcPort()).h;
+            const auto [ptr, sz] = *dgram.pkt.UDPPayload();
+            ev.pkt.iov_len = std::min(sz, ev.pkt.iov_len);
+            std::copy_n(ptr, ev.pkt.iov_len, static_cast<byte_t*>(ev.pkt.iov_base));
+          },
+          [max, &num](UDPDatagram&) { return num >= max; });
+      return num;
+    }
+
+    /// caller side, queue up packets and wake the event loop once for all of them
+    size_t
+    Send(const lokinet_udp_pkt* events, size_t num)
+    {
+      std::lock_guard lock{m_SendAccess};
+      if (not m_Waker)
+        return 0;
+      size_t queued = 0;
+      for (; queued < num; ++queued)
+      {
+        const auto& ev = events[queued];
+        const auto* remote = m_Remote ? &*m_Remote : ParseRemote(ev.remote_addr);
+        if (remote == nullptr)
+          break;
+        llarp::nuint16_t port = m_RemotePort;
+        if (not m_Remote)
+        {
+          if (ev.remote_port <= 0 or ev.remote_port > 65535)
+            break;
+          port = llarp::ToNet(llarp::huint16_t{static_cast<uint16_t>(ev.remote_port)});
+        }
+        auto pkt = llarp::net::IPPacket::UDP(
+            llarp::nuint32_t{0},
+            m_LocalPort,
+            llarp::nuint32_t{0},
+            port,
+            llarp_buffer_t{static_cast<const byte_t*>(ev.pkt.iov_base), ev.pkt.iov_len});
+        if (pkt.sz == 0 or not m_Outbound.Emplace(std::move(pkt), *remote))
+          break;
+      }
+      if (queued)
+        m_Waker->Trigger();
+      return queued;
+    }
+
+    const std::optional<AddressVariant_t>&
+    Remote() const
+    {
+      return m_Remote;
+    }
+
+    llarp::nuint16_t
+    RemotePort() const
+    {
+      return m_RemotePort;
+    }
+
+    llarp::nuint16_t
+    LocalPort() const
+    {
+      return m_LocalPort;
+    }
+
+   private:
+    using Ring_t = llarp::util::SPSCCoDelQueue<
+        UDPDatagram,
+        UDPDatagram::GetTime,
+        UDPDatagram::PutTime,
+        llarp::net::IPPacket::GetNow>;
+
+    /// caller side, the last remote we parsed is kept around as most sends go to the same one
+    const AddressVariant_t*
+    ParseRemote(const char* remote_addr)
+    {
+      const std::string_view addr{remote_addr, strnlen(remote_addr, 256)};
+      if (m_LastRemote and addr == m_LastRemoteAddr)
+        return &*m_LastRemote;
+      m_LastRemote = llarp::service::ParseAddress(addr);
+      m_LastRemoteAddr = addr;
+      return m_LastRemote ? &*m_LastRemote : nullptr;
+    }
+
+    /// event loop side
+    void
+    HandleInbound(llarp::service::ConvoTag tag, llarp::net::IPPacket pkt)
+    {
+      auto ep = m_Endpoint.lock();
+      if (not ep)
+        return;
+      auto from = ep->GetEndpointWithConvoTag(tag);
+      if (not from)
+        return;
+      // the endpoint only hands us whole udp packets
+      const auto srcport = *pkt.SrcPort();
+      // a flow only hears from its remote
+      if (m_Remote and (*m_Remote != *from or m_RemotePort.n != srcport.n))
+        return;
+      if (m_Local)
+      {
+        const auto [ptr, sz] = *pkt.UDPPayload();
+        if (m_LocalPeer)
+          m_Local->send(*m_LocalPeer, llarp_buffer_t{ptr, sz});
+        return;
+      }
+      if (m_ForwardTo)
+      {
+        const auto [ptr, sz] = *pkt.UDPPayload();
+        ForwardFor(*from, srcport).send(*m_ForwardTo, llarp_buffer_t{ptr, sz});
+        return;
+      }
+      if (m_Inbound.Emplace(std::move(pkt), std::move(*from)))
+        m_Poller->Notify();
+    }
+
+    /// event loop side, the local udp socket we forward remote's packets from
+    llarp::UDPHandle&
+    ForwardFor(const AddressVariant_t& remote, llarp::nuint16_t port)
+    {
+      auto& handle = m_Forwards[{remote, port.n}];
+      if (not handle)
+      {
+        handle = m_Loop->make_udp(
+            [self = weak_from_this(), remote, port](auto&, auto, llarp::OwnedBuffer buf) {
+              if (auto ptr = self.lock())
+                ptr->SendToRemote(remote, port, buf);
+            });
+      }
+      return *handle;
+    }
+
+    /// event loop side, send one packet right away
+    void
+    SendToRemote(
+        const AddressVariant_t& remote, llarp::nuint16_t port, const llarp_buffer_t& payload)
+    {
+      auto ep = m_Endpoint.lock();
+      if (not ep)
+        return;
+      const auto pkt = llarp::net::IPPacket::UDP(
+          llarp::nuint32_t{0}, m_LocalPort, llarp::nuint32_t{0}, port, payload);
+      if (pkt.sz == 0)
+        return;
+      if (auto tag = ep->GetBestConvoTagFor(remote))
+        ep->SendToOrQueue(*tag, pkt.ConstBuffer(), llarp::service::ProtocolType::TrafficV4);
+      else
+        EnsurePath(*ep, remote);
+    }
+
+    /// event loop side, send everything queued by Send. runs of packets to the same remote go
+    /// to the endpoint in one batch.
+    void
+    DrainOutbound()
+    {
+      auto ep = m_Endpoint.lock();
+      if (not ep)
+        return;
+      std::optional<AddressVariant_t> to;
+      std::optional<llarp::service::ConvoTag> tag;
+      std::vector<std::vector<byte_t>> batch;
+      const auto flush = [&]() {
+        if (tag and not batch.empty())
+          ep->SendManyToOrQueue(*tag, batch, llarp::service::ProtocolType::TrafficV4);
+        batch.clear();
+      };
+      m_Outbound.Process([&](UDPDatagram& dgram) {
+        if (not to or *to != dgram.remote)
+        {
+          flush();
+          to = dgram.remote;
+          tag = ep->GetBestConvoTagFor(*to);
+          if (not tag)
+            EnsurePath(*ep, *to);
+        }
+        if (tag)
+        {
+          auto& payload = batch.emplace_back(ep->PayloadPool().Acquire(dgram.pkt.sz));
+          payload.assign(dgram.pkt.buf, dgram.pkt.buf + dgram.pkt.sz);
+        }
+      });
+      flush();
+    }
+
+    /// event loop side, we have no session with remote so packets to it are dropped until we
+    /// get one
+    static void
+    EnsurePath(llarp::handlers::NullEndpoint& ep, const AddressVariant_t& remote)
+    {
+      ep.MarkAddressOutbound(remote);
+      ep.EnsurePathTo(remote, [](auto) {}, UDPPathTimeout);
+    }
+
+    std::weak_ptr<llarp::handlers::NullEndpoint> m_Endpoint;
+    llarp::EventLoop_ptr m_Loop;
+    std::shared_ptr<UDPPoller> m_Poller;
+    const llarp::nuint16_t m_LocalPort;
+
+    /// set on flows, these never change once the socket is handed out
+    std::optional<AddressVariant_t> m_Remote;
+    llarp::nuint16_t m_RemotePort{0};
+
+    Ring_t m_Inbound;
+    Ring_t m_Outbound;
+
+    /// callers take these so more than one thread can use a socket, the event loop never does
+    /// except for m_SendAccess when the socket stops
+    std::mutex m_RecvAccess;
+    std::mutex m_SendAccess;
+    std::shared_ptr<llarp::EventLoopWakeup> m_Waker;
+    std::string m_LastRemoteAddr;
+    std::optional<AddressVariant_t> m_LastRemote;
+
+    /// event loop side
+    std::optional<llarp::dns::SRVData> m_SRV;
+    std::shared_ptr<llarp::UDPHandle> m_Local;
+    std::optional<llarp::SockAddr> m_LocalPeer;
+    std::optional<llarp::SockAddr> m_ForwardTo;
+    std::map<std::pair<AddressVariant_t, uint16_t>, std::shared_ptr<llarp::UDPHandle>> m_Forwards;
+  };
 }  // namespace
 
 struct lokinet_context
@@ -46,6 +474,7 @@ struct lokinet_context
   {
     if (runner)
       runner->join();
+    udp_closed.clear();
   }
 
   /// acquire mutex for accessing this context
@@ -61,19 +490,74 @@ struct lokinet_context
     return impl->router->hiddenServiceContext().GetEndpointByName(name);
   }
 
+  /// streams are added to on the event loop, which must never take m_access
+  std::mutex m_stream_access;
   std::unordered_map<int, bool> streams;
 
   void
   inbound_stream(int id)
   {
+    std::lock_guard lock{m_stream_access};
     streams[id] = true;
   }
 
   void
   outbound_stream(int id)
   {
+    std::lock_guard lock{m_stream_access};
     streams[id] = false;
   }
+
+  /// throws std::out_of_range if we don't have stream id
+  bool
+  stream_is_inbound(int id)
+  {
+    std::lock_guard lock{m_stream_access};
+    return streams.at(id);
+  }
+
+  std::shared_ptr<UDPPoller> udp_poller = std::make_shared<UDPPoller>();
+  std::unordered_map<int, std::shared_ptr<UDPSocket>> udp_sockets;
+  int next_udp_socket_id = 1;
+
+  int
+  add_udp_socket(std::shared_ptr<UDPSocket> sock)
+  {
+    const int id = next_udp_socket_id++;
+    udp_sockets.emplace(id, std::move(sock));
+    return id;
+  }
+
+  std::shared_ptr<UDPSocket>
+  udp_socket(int id) const
+  {
+    if (auto itr = udp_sockets.find(id); itr != udp_sockets.end())
+      return itr->second;
+    return nullptr;
+  }
+
+  /// udp sockets closed while the event loop was not taking calls, they are dropped once it has
+  /// exited so their handles are never touched from another thread
+  std::vector<std::shared_ptr<UDPSocket>> udp_closed;
+
+  /// stop every udp socket on the event loop before it goes away and wait for that to happen
+  void
+  stop_udp_sockets()
+  {
+    if (udp_sockets.empty() or not impl->IsUp())
+      return;
+    std::vector<std::shared_ptr<UDPSocket>> socks;
+    for (const auto& [id, sock] : udp_sockets)
+      socks.push_back(sock);
+    auto stopped = std::make_shared<std::promise<void>>();
+    auto future = stopped->get_future();
+    if (impl->CallSafe([socks = std::move(socks), stopped]() {
+          for (const auto& sock : socks)
+            sock->Stop();
+          stopped->set_value();
+        }))
+      future.wait_for(UDPSetupTimeout);
+  }
 };
 
 namespace
@@ -130,6 +614,215 @@ namespace
     return -1;
   }
 
+  using StreamDone = std::function<void(const lokinet_stream_result&)>;
+
+  /// an outbound stream waiting for the event loop to open it
+  struct PendingStream
+  {
+    /// set if the request was bad before it got to the event loop
+    int error = 0;
+    std::string remotehost;
+    int remoteport = 0;
+    llarp::SockAddr localAddr;
+    StreamDone done;
+  };
+
+  /// caller side, check a stream request over before it goes to the event loop
+  PendingStream
+  make_pending_stream(const char* remote, const char* local, StreamDone done)
+  {
+    PendingStream stream;
+    stream.done = std::move(done);
+    if (remote == nullptr)
+    {
+      stream.error = EINVAL;
+      return stream;
+    }
+    try
+    {
+      std::tie(stream.remotehost, stream.remoteport) = split_host_port(remote);
+    }
+    catch (int err)
+    {
+      stream.error = err;
+      return stream;
+    }
+    try
+    {
+      stream.localAddr = llarp::SockAddr{local ? std::string{local} : "127.0.0.1:0"};
+    }
+    catch (std::exception& ex)
+    {
+      stream.error = EINVAL;
+    }
+    return stream;
+  }
+
+  /// event loop side
+  void
+  open_stream(lokinet_context* ctx, const PendingStream& stream)
+  {
+    lokinet_stream_result result;
+    auto ep = ctx->endpoint();
+    auto* quic = ep ? ep->GetQUICTunnel() : nullptr;
+    if (stream.error)
+      stream_error(&result, stream.error);
+    else if (quic == nullptr)
+      stream_error(&result, ENOTSUP);
+    else
+    {
+      try
+      {
+        auto [addr, id] = quic->open(
+            stream.remotehost, stream.remoteport, [](auto) {}, stream.localAddr);
+        auto [host, port] = split_host_port(addr.toString());
+        ctx->outbound_stream(id);
+        stream_okay(&result, host, port, id);
+      }
+      catch (std::exception& ex)
+      {
+        llarp::LogError("failed to open stream to ", stream.remotehost, ": ", ex.what());
+        stream_error(&result, ECANCELED);
+      }
+      catch (int err)
+      {
+        stream_error(&result, err);
+      }
+    }
+    stream.done(result);
+  }
+
+  /// hand all of streams to the event loop in one go, returns an errno if none were queued
+  int
+  queue_streams(lokinet_context* ctx, std::vector<PendingStream> streams)
+  {
+    auto lock = ctx->acquire();
+    if (not ctx->impl->IsUp())
+      return EHOSTDOWN;
+    const bool queued = ctx->impl->CallSafe([ctx, streams = std::move(streams)]() {
+      for (const auto& stream : streams)
+      {
+        // we dont want the mainloop to die in case a callback throws
+        try
+        {
+          open_stream(ctx, stream);
+        }
+        catch (...)
+        {}
+      }
+    });
+    // the loop is going down and dropped them, none of the callbacks will run
+    return queued ? 0 : EHOSTDOWN;
+  }
+
+  /// an srv lookup waiting for the event loop
+  struct PendingSRVLookup
+  {
+    std::string host;
+    std::string service;
+    lokinet_srv_lookup_result* result;
+    lokinet_srv_lookup_callback callback;
+    void* user;
+  };
+
+  using UDPSetupResult = std::pair<int, std::shared_ptr<UDPSocket>>;
+  using UDPSetupDone = std::function<void(int, std::shared_ptr<UDPSocket>)>;
+
+  /// run setup on the event loop with the null endpoint and wait for it to call done with an
+  /// errno and the socket it made
+  UDPSetupResult
+  setup_udp_socket(
+      lokinet_context* ctx,
+      std::function<void(std::shared_ptr<llarp::handlers::NullEndpoint>, UDPSetupDone)> setup)
+  {
+    auto promise = std::make_shared<std::promise<UDPSetupResult>>();
+    auto future = promise->get_future();
+    // whichever of us and done gets here second cleans up after the other, so a socket made
+    // after we gave up waiting is stopped instead of holding its port forever
+    enum State : int
+    {
+      Pending,
+      Done,
+      GaveUp
+    };
+    auto state = std::make_shared<std::atomic<int>>(Pending);
+    {
+      auto lock = ctx->acquire();
+      if (not ctx->impl->IsUp())
+        return {EHOSTDOWN, nullptr};
+      const bool queued = ctx->impl->CallSafe([ctx, setup = std::move(setup), promise, state]() {
+        auto ep = std::dynamic_pointer_cast<llarp::handlers::NullEndpoint>(ctx->endpoint());
+        if (ep == nullptr)
+        {
+          state->store(Done);
+          promise->set_value({ENOTSUP, nullptr});
+          return;
+        }
+        setup(std::move(ep), [promise, state](int err, std::shared_ptr<UDPSocket> sock) {
+          if (state->exchange(Done) == GaveUp)
+          {
+            if (sock)
+              sock->Stop();
+            return;
+          }
+          promise->set_value({err, std::move(sock)});
+        });
+      });
+      if (not queued)
+        return {EHOSTDOWN, nullptr};
+    }
+    if (future.wait_for(UDPSetupTimeout) != std::future_status::ready
+        and state->exchange(GaveUp) == Pending)
+      return {ETIMEDOUT, nullptr};
+    return future.get();
+  }
+
+  /// find host and make sure we have a path to it
+  void
+  resolve_udp_remote(
+      std::shared_ptr<llarp::handlers::NullEndpoint> ep,
+      std::string host,
+      std::function<void(std::optional<AddressVariant_t>)> done)
+  {
+    auto ensure = [ep, done](AddressVariant_t remote) {
+      if (ep->GetBestConvoTagFor(remote))
+      {
+        done(remote);
+        return;
+      }
+      ep->MarkAddressOutbound(remote);
+      ep->EnsurePathTo(
+          remote,
+          [remote, done](auto maybe_tag) {
+            done(maybe_tag ? std::optional<AddressVariant_t>{remote} : std::nullopt);
+          },
+          UDPPathTimeout);
+    };
+    if (auto maybe = llarp::service::ParseAddress(host))
+      ensure(*maybe);
+    else if (llarp::service::NameIsValid(host))
+      ep->LookupNameAsync(host, [ensure, done](auto maybe) {
+        if (maybe)
+          ensure(*maybe);
+        else
+          done(std::nullopt);
+      });
+    else
+      done(std::nullopt);
+  }
+
+  /// the best of the srv records we got back, lowest priority then highest weight
+  std::optional<llarp::dns::SRVData>
+  best_srv(const std::vector<llarp::dns::SRVData>& records)
+  {
+    auto itr = std::min_element(records.begin(), records.end(), [](const auto& a, const auto& b) {
+      return a.priority < b.priority or (a.priority == b.priority and a.weight > b.weight);
+    });
+    if (itr == records.end() or itr->target == ".")
+      return std::nullopt;
+    return *itr;
+  }
+
   std::optional<lokinet_srv_record>
   SRVFromData(const llarp::dns::SRVData& data, std::string name)
   {
@@ -145,37 +838,42 @@ struct lokinet_srv_lookup_private
 {
   std::vector<lokinet_srv_record> results;
 
+  /// event loop side, look up service on host and call done with an errno once we have
+  void
+  LookupSRVAsync(
+      std::string host, std::string service, lokinet_context* ctx, std::function<void(int)> done)
+  {
+    auto ep = ctx->endpoint();
+    if (ep == nullptr)
+    {
+      done(ENOTSUP);
+      return;
+    }
+    ep->LookupServiceAsync(host, service, [self = this, host, done](auto results) {
+      for (const auto& result : results)
+      {
+        if (auto maybe = SRVFromData(result, host))
+          self->results.emplace_back(*maybe);
+      }
+      done(0);
+    });
+  }
+
   int
   LookupSRV(std::string host, std::string service, lokinet_context* ctx)
   {
-    std::promise<int> promise;
+    auto promise = std::make_shared<std::promise<int>>();
+    auto future = promise->get_future();
     {
       auto lock = ctx->acquire();
-      if (ctx->impl and ctx->impl->IsUp())
-      {
-        ctx->impl->CallSafe([host, service, &promise, ctx, self = this]() {
-          auto ep = ctx->endpoint();
-          if (ep == nullptr)
-          {
-            promise.set_value(ENOTSUP);
-            return;
-          }
-          ep->LookupServiceAsync(host, service, [self, &promise, host](auto results) {
-            for (const auto& result : results)
-            {
-              if (auto maybe = SRVFromData(result, host))
-                self->results.emplace_back(*maybe);
-            }
-            promise.set_value(0);
-          });
-        });
-      }
-      else
-      {
-        promise.set_value(EHOSTDOWN);
-      }
+      if (not(ctx->impl and ctx->impl->IsUp()))
+        return EHOSTDOWN;
+      if (not ctx->impl->CallSafe([host, service, promise, ctx, self = this]() {
+            self->LookupSRVAsync(
+                host, service, ctx, [promise](int err) { promise->set_value(err); });
+          }))
+        return EHOSTDOWN;
     }
-    auto future = promise.get_future();
     return future.get();
   }
 
@@ -311,20 +1009,31 @@ extern "C"
   {
     if (ctx == nullptr)
       return -1;
-    auto lock = ctx->acquire();
-    auto ep = ctx->endpoint();
-    int iterations = ms / 10;
-    if (iterations <= 0)
-    {
+    if (ms <= 0)
       ms = 10;
-      iterations = 1;
+    const std::chrono::milliseconds timeout{ms};
+    auto promise = std::make_shared<std::promise<bool>>();
+    auto future = promise->get_future();
+    {
+      auto lock = ctx->acquire();
+      if (not ctx->impl->IsUp())
+        return -1;
+      ctx->impl->CallSafe([ctx, promise, timeout]() {
+        if (auto ep = ctx->endpoint())
+          ep->CallWhenReady([promise](bool ready) { promise->set_value(ready); }, timeout);
+      });
     }
-    while (not ep->IsReady() and iterations > 0)
+    if (future.wait_for(timeout) != std::future_status::ready)
+      return -1;
+    try
     {
-      std::this_thread::sleep_for(std::chrono::milliseconds{ms / 10});
-      iterations--;
+      return future.get() ? 0 : -1;
+    }
+    catch (std::future_error&)
+    {
+      // the endpoint went away before it was ready
+      return -1;
     }
-    return ep->IsReady() ? 0 : -1;
   }
 
   void EXPORT
@@ -334,6 +1043,8 @@ extern "C"
       return;
     auto lock = ctx->acquire();
 
+    ctx->stop_udp_sockets();
+
     if (not ctx->impl->IsStopping())
     {
       ctx->impl->CloseAsync();
@@ -344,6 +1055,7 @@ extern "C"
       ctx->runner->join();
 
     ctx->runner.reset();
+    ctx->udp_closed.clear();
   }
 
   void EXPORT
@@ -358,115 +1070,62 @@ extern "C"
       stream_error(result, EHOSTDOWN);
       return;
     }
-    std::promise<void> promise;
-
+    auto promise = std::make_shared<std::promise<lokinet_stream_result>>();
+    auto future = promise->get_future();
+    std::vector<PendingStream> streams;
+    streams.emplace_back(make_pending_stream(
+        remote, local, [promise](const auto& result) { promise->set_value(result); }));
+    if (streams[0].error)
     {
-      auto lock = ctx->acquire();
-
-      if (not ctx->impl->IsUp())
-      {
-        stream_error(result, EHOSTDOWN);
-        return;
-      }
-      std::string remotehost;
-      int remoteport;
-      try
-      {
-        auto [h, p] = split_host_port(remote);
-        remotehost = h;
-        remoteport = p;
-      }
-      catch (int err)
-      {
-        stream_error(result, err);
-        return;
-      }
-      // TODO: make configurable (?)
-      std::string endpoint{"default"};
-
-      llarp::SockAddr localAddr;
-      try
-      {
-        if (local)
-          localAddr = llarp::SockAddr{std::string{local}};
-        else
-          localAddr = llarp::SockAddr{"127.0.0.1:0"};
-      }
-      catch (std::exception& ex)
-      {
-        stream_error(result, EINVAL);
-        return;
-      }
-      auto call = [&promise,
-                   ctx,
-                   result,
-                   router = ctx->impl->router,
-                   remotehost,
-                   remoteport,
-                   endpoint,
-                   localAddr]() {
-        auto ep = ctx->endpoint();
-        if (ep == nullptr)
-        {
-          stream_error(result, ENOTSUP);
-          promise.set_value();
-          return;
-        }
-        auto* quic = ep->GetQUICTunnel();
-        if (quic == nullptr)
-        {
-          stream_error(result, ENOTSUP);
-          promise.set_value();
-          return;
-        }
-        try
-        {
-          auto [addr, id] = quic->open(
-              remotehost, remoteport, [](auto) {}, localAddr);
-          auto [host, port] = split_host_port(addr.toString());
-          ctx->outbound_stream(id);
-          stream_okay(result, host, port, id);
-        }
-        catch (std::exception& ex)
-        {
-          std::cout << ex.what() << std::endl;
-          stream_error(result, ECANCELED);
-        }
-        catch (int err)
-        {
-          stream_error(result, err);
-        }
-        promise.set_value();
-      };
-
-      ctx->impl->CallSafe([call]() {
-        // we dont want the mainloop to die in case setting the value on the promise fails
-        try
-        {
-          call();
-        }
-        catch (...)
-        {}
-      });
+      stream_error(result, streams[0].error);
+      return;
     }
-
-    auto future = promise.get_future();
-    try
+    if (auto err = queue_streams(ctx, std::move(streams)))
     {
-      if (auto status = future.wait_for(std::chrono::seconds{10});
-          status == std::future_status::ready)
-      {
-        future.get();
-      }
-      else
-      {
-        stream_error(result, ETIMEDOUT);
-      }
+      stream_error(result, err);
+      return;
     }
-    catch (std::exception& ex)
+    if (future.wait_for(std::chrono::seconds{10}) == std::future_status::ready)
+      *result = future.get();
+    else
+      stream_error(result, ETIMEDOUT);
+  }
+
+  int EXPORT
+  lokinet_outbound_streams_async(
+      const struct lokinet_stream_request* requests,
+      size_t num_requests,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (requests == nullptr and num_requests > 0))
+      return EINVAL;
+    std::vector<PendingStream> streams;
+    streams.reserve(num_requests);
+    for (size_t idx = 0; idx < num_requests; ++idx)
     {
-      stream_error(result, EBADF);
+      const auto& req = requests[idx];
+      if (req.callback == nullptr)
+        return EINVAL;
+      streams.emplace_back(make_pending_stream(
+          req.remote_addr,
+          req.local_addr,
+          [callback = req.callback, user = req.user](const auto& result) {
+            callback(&result, user);
+          }));
     }
+    return queue_streams(ctx, std::move(streams));
+  }
+
+  int EXPORT
+  lokinet_outbound_stream_async(
+      const char* remote,
+      const char* local,
+      lokinet_stream_callback callback,
+      void* user,
+      struct lokinet_context* ctx)
+  {
+    const lokinet_stream_request req{remote, local, callback, user};
+    return lokinet_outbound_streams_async(&req, 1, ctx);
   }
 
   int EXPORT
@@ -535,7 +1194,7 @@ extern "C"
     try
     {
       std::promise<void> promise;
-      bool inbound = ctx->streams.at(stream_id);
+      bool inbound = ctx->stream_is_inbound(stream_id);
       ctx->impl->CallSafe([stream_id, inbound, ctx, &promise]() {
         auto ep = ctx->endpoint();
         auto* quic = ep->GetQUICTunnel();
@@ -572,6 +1231,59 @@ extern "C"
     return result->internal->LookupSRV(host, service, ctx);
   }
 
+  int EXPORT
+  lokinet_srv_lookups_async(
+      const struct lokinet_srv_request* requests, size_t num_requests, struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (requests == nullptr and num_requests > 0))
+      return EINVAL;
+    std::vector<PendingSRVLookup> lookups;
+    lookups.reserve(num_requests);
+    for (size_t idx = 0; idx < num_requests; ++idx)
+    {
+      const auto& req = requests[idx];
+      if (req.host == nullptr or req.service == nullptr or req.result == nullptr
+          or req.callback == nullptr)
+        return EINVAL;
+      lookups.push_back({req.host, req.service, req.result, req.callback, req.user});
+    }
+    auto lock = ctx->acquire();
+    if (not ctx->impl->IsUp())
+      return EHOSTDOWN;
+    for (auto& lookup : lookups)
+    {
+      // sanity check, if the caller has not free()'d internals yet free them
+      delete lookup.result->internal;
+      lookup.result->internal = new lokinet_srv_lookup_private{};
+      lookup.result->error = 0;
+    }
+    const bool queued = ctx->impl->CallSafe([ctx, lookups = std::move(lookups)]() {
+      for (const auto& lookup : lookups)
+      {
+        lookup.result->internal->LookupSRVAsync(
+            lookup.host, lookup.service, ctx, [lookup](int err) {
+              lookup.result->error = err;
+              lookup.callback(lookup.result, lookup.user);
+            });
+      }
+    });
+    // the loop is going down and dropped them, none of the callbacks will run
+    return queued ? 0 : EHOSTDOWN;
+  }
+
+  int EXPORT
+  lokinet_srv_lookup_async(
+      const char* host,
+      const char* service,
+      struct lokinet_srv_lookup_result* result,
+      lokinet_srv_lookup_callback callback,
+      void* user,
+      struct lokinet_context* ctx)
+  {
+    const lokinet_srv_request req{host, service, result, callback, user};
+    return lokinet_srv_lookups_async(&req, 1, ctx);
+  }
+
   void EXPORT
   lokinet_for_each_srv_record(
       struct lokinet_srv_lookup_result* result, lokinet_srv_record_iterator iter, void* user)
@@ -594,4 +1306,231 @@ extern "C"
     delete result->internal;
     result->internal = nullptr;
   }
+
+  int EXPORT
+  lokinet_udp_bind(
+      int exposedPort,
+      char* srv,
+      char* localAddr,
+      struct lokinet_udp_bind_result* result,
+      struct lokinet_context* ctx)
+  {
+    if (result == nullptr or ctx == nullptr or exposedPort <= 0 or exposedPort > 65535)
+      return EINVAL;
+    std::optional<llarp::SockAddr> forward;
+    try
+    {
+      if (localAddr)
+        forward = llarp::SockAddr{std::string{localAddr}};
+    }
+    catch (std::exception& ex)
+    {
+      return EINVAL;
+    }
+    std::optional<std::string> service;
+    if (srv)
+      service = srv;
+    const llarp::nuint16_t port{llarp::ToNet(llarp::huint16_t{static_cast<uint16_t>(exposedPort)})};
+    auto [err, sock] = setup_udp_socket(
+        ctx, [poller = ctx->udp_poller, port, forward, service](auto ep, auto done) {
+          auto sock = std::make_shared<UDPSocket>(ep, poller, port);
+          if (forward and not sock->Forward(*forward))
+          {
+            done(EADDRINUSE, nullptr);
+            return;
+          }
+          if (not sock->Start())
+          {
+            sock->Stop();
+            done(EADDRINUSE, nullptr);
+            return;
+          }
+          if (service)
+            sock->AddSRV(*service);
+          done(0, std::move(sock));
+        });
+    if (err)
+      return err;
+    auto lock = ctx->acquire();
+    result->socket_id = ctx->add_udp_socket(std::move(sock));
+    return 0;
+  }
+
+  int EXPORT
+  lokinet_udp_establish(
+      char* remoteHost,
+      char* remotePort,
+      char* localAddr,
+      struct lokinet_udp_flow* flow,
+      struct lokinet_context* ctx)
+  {
+    if (remoteHost == nullptr or remotePort == nullptr or flow == nullptr or ctx == nullptr)
+      return EINVAL;
+    std::optional<llarp::SockAddr> local;
+    try
+    {
+      if (localAddr)
+        local = llarp::SockAddr{std::string{localAddr}};
+    }
+    catch (std::exception& ex)
+    {
+      return EINVAL;
+    }
+    // a port number, a well known service name or failing that an srv record to look up
+    uint16_t port = 0;
+    std::string service;
+    char* end = nullptr;
+    if (const auto num = std::strtol(remotePort, &end, 10); *end == 0 and num > 0 and num < 65536)
+      port = num;
+    else if (auto* serv = getservbyname(remotePort, "udp"))
+      port = ntohs(serv->s_port);
+    else
+      service = "_" + std::string{remotePort} + "._udp";
+
+    auto connect = [poller = ctx->udp_poller, local](auto ep, auto host, auto port, auto done) {
+      resolve_udp_remote(ep, host, [ep, poller, local, port, done](auto remote) {
+        if (not remote)
+        {
+          done(EHOSTUNREACH, nullptr);
+          return;
+        }
+        auto localport = ep->AllocateUDPPort();
+        if (not localport)
+        {
+          done(EADDRINUSE, nullptr);
+          return;
+        }
+        auto sock = std::make_shared<UDPSocket>(ep, poller, *localport);
+        sock->Connect(*remote, llarp::ToNet(llarp::huint16_t{port}));
+        if ((local and not sock->Forward(*local)) or not sock->Start())
+        {
+          sock->Stop();
+          done(EADDRINUSE, nullptr);
+          return;
+        }
+        done(0, std::move(sock));
+      });
+    };
+    auto [err, sock] = setup_udp_socket(
+        ctx, [host = std::string{remoteHost}, port, service, connect](auto ep, auto done) {
+          if (service.empty())
+          {
+            connect(ep, host, port, done);
+            return;
+          }
+          ep->LookupServiceAsync(host, service, [ep, host, connect, done](auto records) {
+            const auto best = best_srv(records);
+            if (not best)
+            {
+              done(ENOENT, nullptr);
+              return;
+            }
+            connect(ep, best->target.empty() ? host : best->target, best->port, done);
+          });
+        });
+    if (err)
+      return err;
+
+    std::memset(flow, 0, sizeof(lokinet_udp_flow));
+    const auto remote = var::visit([](const auto& a) { return a.ToString(); }, *sock->Remote());
+    std::copy_n(
+        remote.c_str(), std::min(remote.size(), sizeof(flow->remote_addr) - 1), flow->remote_addr);
+    flow->remote_port = llarp::ToHost(sock->RemotePort()).h;
+    if (local)
+    {
+      const auto host = local->hostString();
+      std::copy_n(
+          host.c_str(), std::min(host.size(), sizeof(flow->local_addr) - 1), flow->local_addr);
+      flow->local_port = local->getPort();
+    }
+    else
+      flow->local_port = llarp::ToHost(sock->LocalPort()).h;
+    auto lock = ctx->acquire();
+    flow->socket_id = ctx->add_udp_socket(std::move(sock));
+    return 0;
+  }
+
+  int EXPORT
+  lokinet_udp_poll(
+      const int* socket_ids,
+      size_t numsockets,
+      const struct timespec* timeout,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (socket_ids == nullptr and numsockets > 0))
+      return EINVAL;
+    std::vector<std::shared_ptr<UDPSocket>> socks;
+    std::shared_ptr<UDPPoller> poller;
+    {
+      auto lock = ctx->acquire();
+      for (size_t idx = 0; idx < numsockets; ++idx)
+      {
+        auto sock = ctx->udp_socket(socket_ids[idx]);
+        if (sock == nullptr)
+          return EBADF;
+        socks.emplace_back(std::move(sock));
+      }
+      poller = ctx->udp_poller;
+    }
+    const bool ready = poller->Wait(timeout, [&socks]() {
+      return std::any_of(
+          socks.begin(), socks.end(), [](const auto& sock) { return sock->Readable(); });
+    });
+    return ready ? 0 : ETIMEDOUT;
+  }
+
+  ssize_t EXPORT
+  lokinet_udp_recvmmsg(
+      int socket_id,
+      struct lokinet_udp_pkt* events,
+      size_t max_events,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (events == nullptr and max_events > 0))
+      return -1;
+    std::shared_ptr<UDPSocket> sock;
+    {
+      auto lock = ctx->acquire();
+      sock = ctx->udp_socket(socket_id);
+    }
+    if (sock == nullptr)
+      return -1;
+    return sock->Recv(events, max_events);
+  }
+
+  ssize_t EXPORT
+  lokinet_udp_sendmmsg(
+      int socket_id,
+      const struct lokinet_udp_pkt* events,
+      size_t num_events,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (events == nullptr and num_events > 0))
+      return -1;
+    std::shared_ptr<UDPSocket> sock;
+    {
+      auto lock = ctx->acquire();
+      sock = ctx->udp_socket(socket_id);
+    }
+    if (sock == nullptr)
+      return -1;
+    return sock->Send(events, num_events);
+  }
+
+  void EXPORT
+  lokinet_udp_close(int socket_id, struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr)
+      return;
+    auto lock = ctx->acquire();
+    auto itr = ctx->udp_sockets.find(socket_id);
+    if (itr == ctx->udp_sockets.end())
+      return;
+    auto sock = std::move(itr->second);
+    ctx->udp_sockets.erase(itr);
+    // the event loop side of the socket has to be torn down on the event loop, if that is not
+    // taking calls keep the socket until it has exited
+    if (not ctx->impl->IsUp() or not ctx->impl->CallSafe([sock]() { sock->Stop(); }))
+      ctx->udp_closed.emplace_back(std::move(sock));
+  }
 }
@@ -3,6 +3,7 @@
 #include <llarp/link/session.hpp>
 #include <llarp/router_id.hpp>
 #include <llarp/util/bencode.hpp>
+#include <llarp/util/bencode_reader.hpp>
 #include <llarp/path/path_types.hpp>
 
 #include <vector>
@@ -28,23 +29,54 @@ namespace llarp
     virtual bool
     DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val) = 0;
 
-    bool
-    BDecode(llarp_buffer_t* buf)
+    /// decode the whole message dict in one pass. the default hands each entry to DecodeKey;
+    /// messages on hot paths override this to read straight from the reader.
+    virtual bool
+    Decode(bencode::Reader& reader)
     {
       // default version if not specified is 0
       uint64_t v = 0;
       // seek for version and set it if we got it
-      if (BEncodeSeekDictVersion(v, buf, 'v'))
+      if (bencode::PeekDictInteger(reader, "v", v))
       {
         version = v;
       }
+      // the message type picked which message decodes the rest, so it is not ours to check
+      struct
+      {
+        ILinkMessage& msg;
+
+        bool
+        DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val)
+        {
+          return key == "a" or msg.DecodeKey(key, val);
+        }
+      } sink{*this};
       // when we hit the code path version is set and we can tell how to decode
-      return bencode_decode_dict(*this, buf);
+      return bencode::DecodeDictKeys(reader, sink);
+    }
+
+    bool
+    BDecode(llarp_buffer_t* buf)
+    {
+      bencode::Reader reader{*buf};
+      if (not Decode(reader))
+        return false;
+      buf->cur += reader.Consumed();
+      return true;
     }
 
     virtual bool
     BEncode(llarp_buffer_t* buf) const = 0;
 
+    /// exactly how many bytes BEncode writes when that is cheap to know, 0 when it is not;
+    /// lets the sender encode straight into the buffer that goes out
+    virtual size_t
+    EncodedSize() const
+    {
+      return 0;
+    }
+
     virtual bool
     HandleMessage(AbstractRouter* router) const = 0;
 
@@ -8,6 +8,7 @@
 #include "relay_status.hpp"
 #include "relay.hpp"
 #include <llarp/router_contact.hpp>
+#include <llarp/util/bencode_reader.hpp>
 #include <llarp/util/buffer.hpp>
 #include <llarp/util/logging/logger.hpp>
 
@@ -35,36 +36,40 @@ namespace llarp
   LinkMessageParser::~LinkMessageParser() = default;
 
   bool
-  LinkMessageParser::operator()(llarp_buffer_t* buffer, llarp_buffer_t* key)
+  LinkMessageParser::ProcessFrom(ILinkSession* src, const llarp_buffer_t& buf)
   {
-    // we are reading the first key
-    if (firstkey)
+    if (!src)
     {
-      llarp_buffer_t strbuf;
-      // check for empty dict
-      if (!key)
-        return false;
+      llarp::LogWarn("no link session");
+      return false;
+    }
+
+    from = src;
+    bencode::Reader reader{buf};
+    // look at the message type first, the message then decodes the whole dict in one go
+    {
+      bencode::Reader peek{reader};
+      std::string_view key, type;
       // we are expecting the first key to be 'a'
-      if (!(*key == "a"))
+      if (not peek.EnterDict() or not peek.ReadString(key) or key != "a")
       {
         llarp::LogWarn("message has no message type");
         return false;
       }
-
-      if (!bencode_read_string(buffer, &strbuf))
+      if (not peek.ReadString(type))
       {
         llarp::LogWarn("could not read value of message type");
         return false;
       }
       // bad key size
-      if (strbuf.sz != 1)
+      if (type.size() != 1)
       {
-        llarp::LogWarn("bad mesage type size: ", strbuf.sz);
+        llarp::LogWarn("bad mesage type size: ", type.size());
         return false;
       }
       // create the message to parse based off message type
-      llarp::LogDebug("inbound message ", *strbuf.cur);
-      switch (*strbuf.cur)
+      llarp::LogDebug("inbound message ", type);
+      switch (type[0])
       {
         case 'i':
           msg = &holder->i;
@@ -90,16 +95,15 @@ namespace llarp
         default:
           return false;
       }
-
-      msg->session = from;
-      firstkey = false;
-      return true;
     }
-    // check for last element
-    if (!key)
-      return MessageDone();
 
-    return msg->DecodeKey(*key, buffer);
+    msg->session = from;
+    if (not msg->Decode(reader))
+    {
+      Reset();
+      return false;
+    }
+    return MessageDone();
   }
 
   bool
@@ -114,21 +118,6 @@ namespace llarp
     return result;
   }
 
-  bool
-  LinkMessageParser::ProcessFrom(ILinkSession* src, const llarp_buffer_t& buf)
-  {
-    if (!src)
-    {
-      llarp::LogWarn("no link session");
-      return false;
-    }
-
-    from = src;
-    firstkey = true;
-    ManagedBuffer copy(buf);
-    return bencode_read_dict(*this, &copy.underlying);
-  }
-
   void
   LinkMessageParser::Reset()
   {
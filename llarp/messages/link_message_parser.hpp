@@ -16,10 +16,8 @@ namespace llarp
     LinkMessageParser(AbstractRouter* router);
     ~LinkMessageParser();
 
-    bool
-    operator()(llarp_buffer_t* buffer, llarp_buffer_t* key);
-
-    /// start processig message from a link session
+    /// decode a message from a link session and handle it; messages may refer to buf while
+    /// they are handled
     bool
     ProcessFrom(ILinkSession* from, const llarp_buffer_t& buf);
 
@@ -37,7 +35,6 @@ namespace llarp
     GetCurrentFrom();
 
    private:
-    bool firstkey;
     AbstractRouter* router;
     ILinkSession* from;
     ILinkMessage* msg;
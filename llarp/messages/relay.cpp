@@ -3,14 +3,93 @@
 #include <llarp/path/path_context.hpp>
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/util/bencode.hpp>
+#include <llarp/util/bencode_reader.hpp>
 
 namespace llarp
 {
+  namespace
+  {
+    constexpr auto RelayKeys = bencode::MakeKeyTable("a", "p", "v", "x", "y");
+    static_assert(RelayKeys.IsSorted());
+
+    /// decode a relay message of the given type, leaving X in the buffer
+    template <typename Relay_t>
+    bool
+    DecodeRelay(Relay_t& msg, char type, bencode::Reader& reader)
+    {
+      return bencode::ReadDict(reader, RelayKeys, [&msg, type](size_t key, bencode::Reader& r) {
+        std::string_view str;
+        switch (key)
+        {
+          case RelayKeys.Index("a"):
+            return r.ReadString(str) and str.size() == 1 and str[0] == type;
+          case RelayKeys.Index("p"):
+            return r.ReadFixed(msg.pathid);
+          case RelayKeys.Index("v"):
+            return r.ReadInteger(msg.version) and msg.version == LLARP_PROTO_VERSION;
+          case RelayKeys.Index("x"):
+            if (not r.ReadString(str) or str.size() > decltype(msg.X)::MaxSize)
+              return false;
+            msg.X.Clear();
+            msg.wireX = str;
+            return true;
+          case RelayKeys.Index("y"):
+            return r.ReadFixed(msg.Y);
+          default:
+            return false;
+        }
+      });
+    }
+
+    template <typename Relay_t>
+    llarp_buffer_t
+    RelayPayload(const Relay_t& msg)
+    {
+      if (msg.wireX.empty())
+        return llarp_buffer_t{msg.X};
+      return llarp_buffer_t{msg.wireX.data(), msg.wireX.size()};
+    }
+
+    // relay messages all look like "d1:a1:u1:p16:<path id>1:vi0e1:x<len>:<X>1:y32:<Y>e", so we
+    // write the constant parts in one go instead of key by key
+    static_assert(LLARP_PROTO_VERSION == 0, "the relay message layout has the version baked in");
+    constexpr std::string_view UpstreamHead = "d1:a1:u1:p16:";
+    constexpr std::string_view DownstreamHead = "d1:a1:d1:p16:";
+    constexpr std::string_view RelayMiddle = "1:vi0e1:x";
+    constexpr std::string_view RelayNonce = "1:y32:";
+    static_assert(PathID_t::SIZE == 16 and TunnelNonce::SIZE == 32);
+
+    template <typename Relay_t>
+    size_t
+    RelayEncodedSize(const Relay_t& msg, std::string_view head)
+    {
+      const size_t payload = msg.wireX.empty() ? msg.X.size() : msg.wireX.size();
+      return head.size() + PathID_t::SIZE + RelayMiddle.size() + BEncodeStringSize(payload)
+          + RelayNonce.size() + TunnelNonce::SIZE + 1;
+    }
+
+    template <typename Relay_t>
+    bool
+    EncodeRelay(const Relay_t& msg, std::string_view head, llarp_buffer_t* buf)
+    {
+      // we know the size up front, so never leave half a message behind
+      if (buf->size_left() < RelayEncodedSize(msg, head))
+        return false;
+      const auto payload = msg.Payload();
+      return BEncodeWriteRaw(head, buf) and buf->write(msg.pathid.begin(), msg.pathid.end())
+          and BEncodeWriteRaw(RelayMiddle, buf)
+          and bencode_write_bytestring(buf, payload.base, payload.sz)
+          and BEncodeWriteRaw(RelayNonce, buf) and buf->write(msg.Y.begin(), msg.Y.end())
+          and bencode_end(buf);
+    }
+  }  // namespace
+
   void
   RelayUpstreamMessage::Clear()
   {
     pathid.Zero();
     X.Clear();
+    wireX = {};
     Y.Zero();
     version = 0;
   }
@@ -18,20 +97,13 @@ namespace llarp
   bool
   RelayUpstreamMessage::BEncode(llarp_buffer_t* buf) const
   {
-    if (!bencode_start_dict(buf))
-      return false;
-    if (!BEncodeWriteDictMsgType(buf, "a", "u"))
-      return false;
+    return EncodeRelay(*this, UpstreamHead, buf);
+  }
 
-    if (!BEncodeWriteDictEntry("p", pathid, buf))
-      return false;
-    if (!BEncodeWriteDictInt("v", LLARP_PROTO_VERSION, buf))
-      return false;
-    if (!BEncodeWriteDictEntry("x", X, buf))
-      return false;
-    if (!BEncodeWriteDictEntry("y", Y, buf))
-      return false;
-    return bencode_end(buf);
+  size_t
+  RelayUpstreamMessage::EncodedSize() const
+  {
+    return RelayEncodedSize(*this, UpstreamHead);
   }
 
   bool
@@ -49,13 +121,25 @@ namespace llarp
     return read;
   }
 
+  llarp_buffer_t
+  RelayUpstreamMessage::Payload() const
+  {
+    return RelayPayload(*this);
+  }
+
+  bool
+  RelayUpstreamMessage::Decode(bencode::Reader& reader)
+  {
+    return DecodeRelay(*this, 'u', reader);
+  }
+
   bool
   RelayUpstreamMessage::HandleMessage(AbstractRouter* r) const
   {
     auto path = r->pathContext().GetByDownstream(session->GetPubKey(), pathid);
     if (path)
     {
-      return path->HandleUpstream(llarp_buffer_t(X), Y, r);
+      return path->HandleUpstream(Payload(), Y, r);
     }
     return false;
   }
@@ -65,6 +149,7 @@ namespace llarp
   {
     pathid.Zero();
     X.Clear();
+    wireX = {};
     Y.Zero();
     version = 0;
   }
@@ -72,20 +157,13 @@ namespace llarp
   bool
   RelayDownstreamMessage::BEncode(llarp_buffer_t* buf) const
   {
-    if (!bencode_start_dict(buf))
-      return false;
-    if (!BEncodeWriteDictMsgType(buf, "a", "d"))
-      return false;
+    return EncodeRelay(*this, DownstreamHead, buf);
+  }
 
-    if (!BEncodeWriteDictEntry("p", pathid, buf))
-      return false;
-    if (!BEncodeWriteDictInt("v", LLARP_PROTO_VERSION, buf))
-      return false;
-    if (!BEncodeWriteDictEntry("x", X, buf))
-      return false;
-    if (!BEncodeWriteDictEntry("y", Y, buf))
-      return false;
-    return bencode_end(buf);
+  size_t
+  RelayDownstreamMessage::EncodedSize() const
+  {
+    return RelayEncodedSize(*this, DownstreamHead);
   }
 
   bool
@@ -103,13 +181,25 @@ namespace llarp
     return read;
   }
 
+  llarp_buffer_t
+  RelayDownstreamMessage::Payload() const
+  {
+    return RelayPayload(*this);
+  }
+
+  bool
+  RelayDownstreamMessage::Decode(bencode::Reader& reader)
+  {
+    return DecodeRelay(*this, 'd', reader);
+  }
+
   bool
   RelayDownstreamMessage::HandleMessage(AbstractRouter* r) const
   {
     auto path = r->pathContext().GetByUpstream(session->GetPubKey(), pathid);
     if (path)
     {
-      return path->HandleDownstream(llarp_buffer_t(X), Y, r);
+      return path->HandleDownstream(Payload(), Y, r);
     }
     llarp::LogWarn("no path for downstream message id=", pathid);
     return false;
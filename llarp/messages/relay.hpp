@@ -5,6 +5,7 @@
 #include "link_message.hpp"
 #include <llarp/path/path_types.hpp>
 
+#include <string_view>
 #include <vector>
 
 namespace llarp
@@ -13,13 +14,26 @@ namespace llarp
   {
     Encrypted<MAX_LINK_MSG_SIZE - 128> X;
     TunnelNonce Y;
+    /// X as it sits in the buffer we decoded from, used instead of X so relaying does not copy
+    /// it; only valid while that buffer is
+    std::string_view wireX;
+
+    /// X or wireX, whichever we have
+    llarp_buffer_t
+    Payload() const;
 
     bool
     DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* buf) override;
 
+    bool
+    Decode(bencode::Reader& reader) override;
+
     bool
     BEncode(llarp_buffer_t* buf) const override;
 
+    size_t
+    EncodedSize() const override;
+
     bool
     HandleMessage(AbstractRouter* router) const override;
 
@@ -42,13 +56,26 @@ namespace llarp
   {
     Encrypted<MAX_LINK_MSG_SIZE - 128> X;
     TunnelNonce Y;
+    /// X as it sits in the buffer we decoded from, used instead of X so relaying does not copy
+    /// it; only valid while that buffer is
+    std::string_view wireX;
+
+    /// X or wireX, whichever we have
+    llarp_buffer_t
+    Payload() const;
 
     bool
     DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* buf) override;
 
+    bool
+    Decode(bencode::Reader& reader) override;
+
     bool
     BEncode(llarp_buffer_t* buf) const override;
 
+    size_t
+    EncodedSize() const override;
+
     bool
     HandleMessage(AbstractRouter* router) const override;
 
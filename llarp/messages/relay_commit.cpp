@@ -12,6 +12,7 @@
 #include <llarp/util/buffer.hpp>
 #include <llarp/util/logging/logger.hpp>
 #include <llarp/util/meta/memfn.hpp>
+#include <llarp/util/tracing.hpp>
 #include <llarp/tooling/path_event.hpp>
 
 #include <functional>
@@ -185,6 +186,9 @@ namespace llarp
     std::shared_ptr<Hop> hop;
 
     const std::optional<IpAddress> fromAddr;
+    // our part of someone else's path build, it is handed between worker and logic thread
+    // along with the rest of this
+    tracing::StageTimer trace;
 
     LRCMFrameDecrypt(Context* ctx, Decrypter_ptr dec, const LR_CommitMessage* commit)
         : decrypter(std::move(dec))
@@ -195,6 +199,7 @@ namespace llarp
               commit->session->GetRemoteRC().IsPublicRouter()
                   ? std::optional<IpAddress>{}
                   : commit->session->GetRemoteEndpoint())
+        , trace("relay_commit")
     {
       hop->info.downstream = commit->session->GetPubKey();
     }
@@ -246,8 +251,10 @@ namespace llarp
     static void
     SendLRCM(std::shared_ptr<LRCMFrameDecrypt> self)
     {
+      self->trace.Mark("logic_wait");
       if (self->context->HasTransitHop(self->hop->info))
       {
+        self->trace.Finish("refused", "duplicate hop");
         llarp::LogError("duplicate transit hop ", self->hop->info);
         LR_StatusMessage::CreateAndSend(
             self->context->Router(),
@@ -267,6 +274,7 @@ namespace llarp
         if (self->context->CheckPathLimitHitByIP(*self->fromAddr))
         {
           // we hit a limit so tell it to slow tf down
+          self->trace.Finish("refused", "ip limit");
           llarp::LogError("client path build hit limit ", *self->fromAddr);
           OnForwardLRCMResult(
               self->context->Router(),
@@ -284,6 +292,7 @@ namespace llarp
       if (not self->context->Router()->PathToRouterAllowed(self->hop->info.upstream))
       {
         // we are not allowed to forward it ... now what?
+        self->trace.Finish("refused", "next hop not allowed");
         llarp::LogError(
             "path to ",
             self->hop->info.upstream,
@@ -309,6 +318,8 @@ namespace llarp
       // forward to next hop
       using std::placeholders::_1;
       auto func = [self](auto status) {
+        self->trace.Mark("forward");
+        self->trace.Finish(status == SendStatus::Success ? "forwarded" : "forward_failed");
         OnForwardLRCMResult(
             self->context->Router(),
             self->hop,
@@ -325,6 +336,7 @@ namespace llarp
     static void
     SendPathConfirm(std::shared_ptr<LRCMFrameDecrypt> self)
     {
+      self->trace.Mark("logic_wait");
       // send path confirmation
       // TODO: other status flags?
       uint64_t status = LR_StatusRecord::SUCCESS;
@@ -351,6 +363,7 @@ namespace llarp
       {
         llarp::LogError("failed to send path confirmation for ", self->hop->info);
       }
+      self->trace.Finish(status == LR_StatusRecord::SUCCESS ? "confirmed" : "refused");
       self->hop = nullptr;
     }
 
@@ -362,6 +375,8 @@ namespace llarp
     {
       auto now = self->context->Router()->Now();
       auto& info = self->hop->info;
+      // time waiting for a worker plus decrypting our frame
+      self->trace.Mark("decrypt");
       if (!buf)
       {
         llarp::LogError("LRCM decrypt failed from ", info.downstream);
@@ -437,6 +452,7 @@ namespace llarp
       // random junk for now
       frames[7].Randomize();
       self->frames = std::move(frames);
+      self->trace.Mark("accept");
       if (self->context->HopIsUs(info.upstream))
       {
         // we are the farthest hop
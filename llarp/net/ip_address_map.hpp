@@ -0,0 +1,322 @@
+#pragma once
+
+#include "net_int.hpp"
+#include <llarp/util/types.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  namespace net
+  {
+    /// a bidirectional mapping between ip addresses in a range we own and remote identities.
+    /// every mapping lives in exactly one node which both hash tables point into, so a packet
+    /// costs a single lookup to get the remote and its kind, and marking it active is a splice.
+    /// mappings are kept in least recently used order so when the range is exhausted the
+    /// oldest one is recycled in constant time.
+    template <typename Ident_t, typename Hash_t = std::hash<Ident_t>>
+    struct IPAddressMap
+    {
+      struct Entry
+      {
+        huint128_t ip;
+        Ident_t ident;
+        /// true if the remote is a service node
+        bool snode = false;
+        /// pinned entries are never recycled and are not on the lru list
+        bool pinned = false;
+        llarp_time_t lastActive = 0s;
+
+       private:
+        friend struct IPAddressMap;
+        /// intrusive lru links, towards more and less recently used entries
+        Entry* newer = nullptr;
+        Entry* older = nullptr;
+      };
+
+      IPAddressMap() = default;
+      IPAddressMap(const IPAddressMap&) = delete;
+      IPAddressMap&
+      operator=(const IPAddressMap&) = delete;
+
+      /// set the range of addresses we can hand out, (first, last)
+      /// first is the address after which we start allocating, typically our own address
+      void
+      SetRange(huint128_t first, huint128_t last)
+      {
+        m_FirstIP = m_NextIP = first;
+        m_MaxIP = last;
+        m_Released.clear();
+      }
+
+      /// how long a mapping has to go unused before it may be recycled. without it anyone who
+      /// can make us map new identities could push out mappings that are still in use.
+      void
+      SetMinIdle(llarp_time_t minIdle)
+      {
+        m_MinIdle = minIdle;
+      }
+
+      huint128_t
+      NextIP() const
+      {
+        return m_NextIP;
+      }
+
+      huint128_t
+      MaxIP() const
+      {
+        return m_MaxIP;
+      }
+
+      size_t
+      Size() const
+      {
+        return m_ByIP.size();
+      }
+
+      bool
+      HasIP(huint128_t ip) const
+      {
+        return m_ByIP.find(ip) != m_ByIP.end();
+      }
+
+      bool
+      HasIdent(const Ident_t& ident) const
+      {
+        return m_ByIdent.find(ident) != m_ByIdent.end();
+      }
+
+      /// get the mapping for an ip or nullptr if it is not mapped
+      Entry*
+      FindByIP(huint128_t ip)
+      {
+        const auto itr = m_ByIP.find(ip);
+        if (itr == m_ByIP.end())
+          return nullptr;
+        return &itr->second;
+      }
+
+      const Entry*
+      FindByIP(huint128_t ip) const
+      {
+        const auto itr = m_ByIP.find(ip);
+        if (itr == m_ByIP.end())
+          return nullptr;
+        return &itr->second;
+      }
+
+      /// get the mapping for an identity or nullptr if it is not mapped
+      Entry*
+      FindByIdent(const Ident_t& ident)
+      {
+        const auto itr = m_ByIdent.find(ident);
+        if (itr == m_ByIdent.end())
+          return nullptr;
+        return itr->second;
+      }
+
+      const Entry*
+      FindByIdent(const Ident_t& ident) const
+      {
+        const auto itr = m_ByIdent.find(ident);
+        if (itr == m_ByIdent.end())
+          return nullptr;
+        return itr->second;
+      }
+
+      /// explicitly map ip to ident, replacing any mapping ident had before
+      /// returns false if ip is already mapped to something
+      bool
+      Map(huint128_t ip, Ident_t ident, bool snode, llarp_time_t now, bool pinned = false)
+      {
+        if (HasIP(ip))
+          return false;
+        RemoveIdent(ident);
+        auto& entry = Insert(ip, std::move(ident), snode, now);
+        if (pinned)
+          Pin(entry);
+        return true;
+      }
+
+      /// mark a mapping as recently used, moving it to the front of the recycle order
+      void
+      MarkActive(Entry& entry, llarp_time_t now)
+      {
+        if (entry.pinned)
+          return;
+        entry.lastActive = std::max(entry.lastActive, now);
+        Unlink(entry);
+        LinkFront(entry);
+      }
+
+      /// mark a mapping as never to be recycled
+      void
+      Pin(Entry& entry)
+      {
+        if (entry.pinned)
+          return;
+        Unlink(entry);
+        entry.pinned = true;
+        entry.lastActive = std::numeric_limits<llarp_time_t>::max();
+      }
+
+      /// get the ip for ident, allocating a free address or recycling the least recently used
+      /// mapping if we ran out. evicted is called with the mapping that is about to be recycled
+      /// before it is replaced. returns nullopt if there is nothing we can hand out, including
+      /// when every mapping was used more recently than the min idle time.
+      template <typename Evicted_t>
+      std::optional<huint128_t>
+      Obtain(const Ident_t& ident, bool snode, llarp_time_t now, Evicted_t&& evicted)
+      {
+        if (auto* entry = FindByIdent(ident))
+        {
+          MarkActive(*entry, now);
+          return entry->ip;
+        }
+        while (not m_Released.empty())
+        {
+          const huint128_t ip = m_Released.back();
+          m_Released.pop_back();
+          if (not HasIP(ip))
+          {
+            Insert(ip, ident, snode, now);
+            return ip;
+          }
+        }
+        while (m_NextIP < m_MaxIP)
+        {
+          const huint128_t ip = ++m_NextIP;
+          if (ip < m_MaxIP and not HasIP(ip))
+          {
+            Insert(ip, ident, snode, now);
+            return ip;
+          }
+        }
+        // we are full, recycle the least recently used address unless it is still in use
+        if (m_Oldest == nullptr or now < m_Oldest->lastActive + m_MinIdle)
+          return std::nullopt;
+        evicted(static_cast<const Entry&>(*m_Oldest));
+        const huint128_t ip = m_Oldest->ip;
+        Erase(ip);
+        Insert(ip, ident, snode, now);
+        return ip;
+      }
+
+      std::optional<huint128_t>
+      Obtain(const Ident_t& ident, bool snode, llarp_time_t now)
+      {
+        return Obtain(ident, snode, now, [](const Entry&) {});
+      }
+
+      /// drop the mapping for ip, the address is handed out again before any recycling happens
+      void
+      RemoveIP(huint128_t ip)
+      {
+        if (Erase(ip) and m_FirstIP < ip and not(m_NextIP < ip))
+          m_Released.emplace_back(ip);
+      }
+
+      void
+      RemoveIdent(const Ident_t& ident)
+      {
+        const auto itr = m_ByIdent.find(ident);
+        if (itr == m_ByIdent.end())
+          return;
+        RemoveIP(itr->second->ip);
+      }
+
+      /// visit every mapping, in no particular order
+      template <typename Visit_t>
+      void
+      ForEach(Visit_t&& visit) const
+      {
+        for (const auto& [ip, entry] : m_ByIP)
+          visit(static_cast<const Entry&>(entry));
+      }
+
+      /// visit unpinned mappings from the most recently used to the least
+      template <typename Visit_t>
+      void
+      ForEachRecent(Visit_t&& visit) const
+      {
+        for (const Entry* entry = m_Newest; entry; entry = entry->older)
+          visit(*entry);
+      }
+
+     private:
+      bool
+      Erase(huint128_t ip)
+      {
+        const auto itr = m_ByIP.find(ip);
+        if (itr == m_ByIP.end())
+          return false;
+        Unlink(itr->second);
+        m_ByIdent.erase(itr->second.ident);
+        m_ByIP.erase(itr);
+        return true;
+      }
+
+      Entry&
+      Insert(huint128_t ip, Ident_t ident, bool snode, llarp_time_t now)
+      {
+        auto& entry = m_ByIP[ip];
+        entry.ip = ip;
+        entry.ident = std::move(ident);
+        entry.snode = snode;
+        entry.lastActive = now;
+        m_ByIdent.emplace(entry.ident, &entry);
+        LinkFront(entry);
+        return entry;
+      }
+
+      void
+      LinkFront(Entry& entry)
+      {
+        entry.older = m_Newest;
+        entry.newer = nullptr;
+        if (m_Newest)
+          m_Newest->newer = &entry;
+        m_Newest = &entry;
+        if (m_Oldest == nullptr)
+          m_Oldest = &entry;
+      }
+
+      void
+      Unlink(Entry& entry)
+      {
+        if (entry.pinned)
+          return;
+        if (entry.newer)
+          entry.newer->older = entry.older;
+        else if (m_Newest == &entry)
+          m_Newest = entry.older;
+        if (entry.older)
+          entry.older->newer = entry.newer;
+        else if (m_Oldest == &entry)
+          m_Oldest = entry.newer;
+        entry.newer = entry.older = nullptr;
+      }
+
+      /// owns all entries, node based so entry addresses are stable
+      std::unordered_map<huint128_t, Entry> m_ByIP;
+      std::unordered_map<Ident_t, Entry*, Hash_t> m_ByIdent;
+      /// ends of the lru list of unpinned entries
+      Entry* m_Newest = nullptr;
+      Entry* m_Oldest = nullptr;
+      /// addresses we had handed out and were explicitly removed
+      std::vector<huint128_t> m_Released;
+      /// address we start allocating after
+      huint128_t m_FirstIP{};
+      /// last address we handed out
+      huint128_t m_NextIP{};
+      /// upper bound of addresses we hand out (exclusive)
+      huint128_t m_MaxIP{};
+      llarp_time_t m_MinIdle = 0s;
+    };
+  }  // namespace net
+}  // namespace llarp
@@ -10,7 +10,10 @@
 #endif
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <map>
+#include <string_view>
 
 constexpr uint32_t ipv6_flowlabel_mask = 0b0000'0000'0000'1111'1111'1111'1111'1111;
 
@@ -128,6 +131,79 @@ namespace llarp
       }
     }
 
+    std::optional<nuint16_t>
+    IPPacket::SrcPort() const
+    {
+      switch (IPProtocol{Header()->protocol})
+      {
+        case IPProtocol::TCP:
+        case IPProtocol::UDP:
+          return nuint16_t{*reinterpret_cast<const uint16_t*>(buf + (Header()->ihl * 4))};
+        default:
+          return std::nullopt;
+      }
+    }
+
+    std::optional<std::pair<const byte_t*, size_t>>
+    IPPacket::UDPPayload() const
+    {
+      if (not IsV4() or sz < sizeof(ip_header) or IPProtocol{Header()->protocol} != IPProtocol::UDP)
+        return std::nullopt;
+      const size_t offset = size_t{Header()->ihl} * 4 + 8;
+      if (sz < offset)
+        return std::nullopt;
+      const size_t udplen = bufbe16toh(buf + offset - 4);
+      if (udplen < 8)
+        return std::nullopt;
+      return std::make_pair(buf + offset, std::min(sz - offset, udplen - 8));
+    }
+
+    uint64_t
+    IPPacket::FlowHash() const
+    {
+      // src, dst, proto, ports
+      std::array<byte_t, 16 + 16 + 1 + 4> key{};
+      size_t keysz = 0;
+      const auto put = [&key, &keysz](const void* ptr, size_t n) {
+        std::memcpy(key.data() + keysz, ptr, n);
+        keysz += n;
+      };
+      uint8_t proto = 0;
+      size_t l4off = 0;
+      bool fragment = false;
+      if (IsV4() and sz >= sizeof(ip_header))
+      {
+        const auto* hdr = Header();
+        put(&hdr->saddr, sizeof(hdr->saddr));
+        put(&hdr->daddr, sizeof(hdr->daddr));
+        proto = hdr->protocol;
+        l4off = hdr->ihl * 4;
+        // more fragments flag or a non zero offset
+        fragment = (ntohs(hdr->frag_off) & 0x3fff) != 0;
+      }
+      else if (IsV6() and sz >= sizeof(ipv6_header))
+      {
+        const auto* hdr = HeaderV6();
+        put(&hdr->srcaddr, sizeof(hdr->srcaddr));
+        put(&hdr->dstaddr, sizeof(hdr->dstaddr));
+        proto = hdr->proto;
+        l4off = sizeof(ipv6_header);
+      }
+      put(&proto, sizeof(proto));
+      switch (IPProtocol{proto})
+      {
+        case IPProtocol::TCP:
+        case IPProtocol::UDP:
+          if (not fragment and l4off and sz >= l4off + 4)
+            put(buf + l4off, 4);
+          break;
+        default:
+          break;
+      }
+      return std::hash<std::string_view>{}(
+          std::string_view{reinterpret_cast<const char*>(key.data()), keysz});
+    }
+
     huint32_t
     IPPacket::srcv4() const
     {
@@ -167,53 +243,54 @@ namespace llarp
     uint16_t
     ipchksum(const byte_t* buf, size_t sz, uint32_t sum)
     {
-      while (sz > 1)
+      // the one's complement sum does not depend on the word size as long as every carry is
+      // added back in, so sum 32 bit words into a 64 bit accumulator that cannot overflow for any
+      // packet size and fold it down at the end. unlike 16 bit loads this vectorizes well.
+      uint64_t acc = sum;
+      while (sz >= sizeof(uint32_t))
       {
-        sum += *(const uint16_t*)buf;
-        sz -= sizeof(uint16_t);
-        buf += sizeof(uint16_t);
+        uint32_t word;
+        std::memcpy(&word, buf, sizeof(word));
+        acc += word;
+        sz -= sizeof(word);
+        buf += sizeof(word);
       }
       if (sz != 0)
       {
-        uint16_t x = 0;
-
-        *(byte_t*)&x = *(const byte_t*)buf;
-        sum += x;
+        // zero pad the tail, keeping 16 bit word alignment
+        uint32_t word = 0;
+        std::memcpy(&word, buf, sz);
+        acc += word;
       }
 
+      // fold 64 -> 32 bits
+      acc = (acc & 0xFFffFFff) + (acc >> 32);
+      acc = (acc & 0xFFffFFff) + (acc >> 32);
+      auto folded = uint32_t(acc);
       // only need to do it 2 times to be sure
       // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
-      sum = (sum & 0xFFff) + (sum >> 16);
-      sum += sum >> 16;
+      folded = (folded & 0xFFff) + (folded >> 16);
+      folded += folded >> 16;
 
-      return uint16_t((~sum) & 0xFFff);
+      return uint16_t((~folded) & 0xFFff);
     }
 
 #define ADD32CS(x) ((uint32_t)(x & 0xFFff) + (uint32_t)(x >> 16))
 #define SUB32CS(x) ((uint32_t)((~x) & 0xFFff) + (uint32_t)((~x) >> 16))
 
-    static nuint16_t
-    deltaIPv4Checksum(
-        nuint16_t old_sum,
-        nuint32_t old_src_ip,
-        nuint32_t old_dst_ip,
-        nuint32_t new_src_ip,
-        nuint32_t new_dst_ip)
+    /// the one's complement difference between an old and a new pair of ipv4 addresses.
+    /// every checksum covering the addresses (ip header, tcp/udp pseudo header) changes by the
+    /// same amount, so we compute it once per packet and apply it to each of them.
+    static uint32_t
+    deltaIPv4Addresses(
+        nuint32_t old_src_ip, nuint32_t old_dst_ip, nuint32_t new_src_ip, nuint32_t new_dst_ip)
     {
-      uint32_t sum = uint32_t(old_sum.n) + ADD32CS(old_src_ip.n) + ADD32CS(old_dst_ip.n)
-          + SUB32CS(new_src_ip.n) + SUB32CS(new_dst_ip.n);
-
-      // only need to do it 2 times to be sure
-      // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
-      sum = (sum & 0xFFff) + (sum >> 16);
-      sum += sum >> 16;
-
-      return nuint16_t{uint16_t(sum & 0xFFff)};
+      return ADD32CS(old_src_ip.n) + ADD32CS(old_dst_ip.n) + SUB32CS(new_src_ip.n)
+          + SUB32CS(new_dst_ip.n);
     }
 
-    static nuint16_t
-    deltaIPv6Checksum(
-        nuint16_t old_sum,
+    static uint32_t
+    deltaIPv6Addresses(
         const uint32_t old_src_ip[4],
         const uint32_t old_dst_ip[4],
         const uint32_t new_src_ip[4],
@@ -229,64 +306,38 @@ namespace llarp
        * that'd suck for 32bit cpus */
 #define ADDN128CS(x) (ADD32CS(x[0]) + ADD32CS(x[1]) + ADD32CS(x[2]) + ADD32CS(x[3]))
 #define SUBN128CS(x) (SUB32CS(x[0]) + SUB32CS(x[1]) + SUB32CS(x[2]) + SUB32CS(x[3]))
-      uint32_t sum = uint32_t(old_sum.n) + ADDN128CS(old_src_ip) + ADDN128CS(old_dst_ip)
-          + SUBN128CS(new_src_ip) + SUBN128CS(new_dst_ip);
+      return ADDN128CS(old_src_ip) + ADDN128CS(old_dst_ip) + SUBN128CS(new_src_ip)
+          + SUBN128CS(new_dst_ip);
 #undef ADDN128CS
 #undef SUBN128CS
-
-      // only need to do it 2 times to be sure
-      // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
-      sum = (sum & 0xFFff) + (sum >> 16);
-      sum += sum >> 16;
-
-      return nuint16_t{uint16_t(sum & 0xFFff)};
     }
 
 #undef ADD32CS
 #undef SUB32CS
 
-    static void
-    deltaChecksumIPv4TCP(
-        byte_t* pld,
-        size_t psz,
-        size_t fragoff,
-        size_t chksumoff,
-        nuint32_t oSrcIP,
-        nuint32_t oDstIP,
-        nuint32_t nSrcIP,
-        nuint32_t nDstIP)
+    /// apply an address delta from deltaIPv{4,6}Addresses to a checksum
+    static nuint16_t
+    deltaChecksum(nuint16_t old_sum, uint32_t delta)
     {
-      if (fragoff > chksumoff || psz < chksumoff - fragoff + 2)
-        return;
+      uint32_t sum = uint32_t(old_sum.n) + delta;
 
-      auto check = (nuint16_t*)(pld + chksumoff - fragoff);
+      // only need to do it 2 times to be sure
+      // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
+      sum = (sum & 0xFFff) + (sum >> 16);
+      sum += sum >> 16;
 
-      *check = deltaIPv4Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
-      // usually, TCP checksum field cannot be 0xFFff,
-      // because one's complement addition cannot result in 0x0000,
-      // and there's inversion in the end;
-      // emulate that.
-      if (check->n == 0xFFff)
-        check->n = 0x0000;
+      return nuint16_t{uint16_t(sum & 0xFFff)};
     }
 
     static void
-    deltaChecksumIPv6TCP(
-        byte_t* pld,
-        size_t psz,
-        size_t fragoff,
-        size_t chksumoff,
-        const uint32_t oSrcIP[4],
-        const uint32_t oDstIP[4],
-        const uint32_t nSrcIP[4],
-        const uint32_t nDstIP[4])
+    deltaChecksumTCP(byte_t* pld, size_t psz, size_t fragoff, size_t chksumoff, uint32_t delta)
     {
       if (fragoff > chksumoff || psz < chksumoff - fragoff + 2)
         return;
 
       auto check = (nuint16_t*)(pld + chksumoff - fragoff);
 
-      *check = deltaIPv6Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
+      *check = deltaChecksum(*check, delta);
       // usually, TCP checksum field cannot be 0xFFff,
       // because one's complement addition cannot result in 0x0000,
       // and there's inversion in the end;
@@ -296,58 +347,20 @@ namespace llarp
     }
 
     static void
-    deltaChecksumIPv4UDP(
-        byte_t* pld,
-        size_t psz,
-        size_t fragoff,
-        nuint32_t oSrcIP,
-        nuint32_t oDstIP,
-        nuint32_t nSrcIP,
-        nuint32_t nDstIP)
-    {
-      if (fragoff > 6 || psz < 6 + 2)
-        return;
-
-      auto check = (nuint16_t*)(pld + 6);
-      if (check->n == 0x0000)
-        return;  // 0 is used to indicate "no checksum", don't change
-
-      *check = deltaIPv4Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
-      // 0 is used to indicate "no checksum"
-      // 0xFFff and 0 are equivalent in one's complement math
-      // 0xFFff + 1 = 0x10000 -> 0x0001 (same as 0 + 1)
-      // infact it's impossible to get 0 with such addition,
-      // when starting from non-0 value.
-      // inside deltachksum we don't invert so it's safe to skip check there
-      // if(check->n == 0x0000)
-      //   check->n = 0xFFff;
-    }
-
-    static void
-    deltaChecksumIPv6UDP(
-        byte_t* pld,
-        size_t psz,
-        size_t fragoff,
-        const uint32_t oSrcIP[4],
-        const uint32_t oDstIP[4],
-        const uint32_t nSrcIP[4],
-        const uint32_t nDstIP[4])
+    deltaChecksumUDP(byte_t* pld, size_t psz, size_t fragoff, uint32_t delta)
     {
       if (fragoff > 6 || psz < 6 + 2)
         return;
 
       auto check = (nuint16_t*)(pld + 6);
       // 0 is used to indicate "no checksum", don't change
-      // even tho this shouldn't happen for IPv6, handle it properly
+      // for IPv6 this shouldn't happen but handle it properly anyways
       // we actually should drop/log 0-checksum packets per spec
       // but that should be done at upper level than this function
-      // it's better to do correct thing there regardless
-      // XXX or maybe we should change this function to be able to return error?
-      // either way that's not a priority
       if (check->n == 0x0000)
         return;
 
-      *check = deltaIPv6Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
+      *check = deltaChecksum(*check, delta);
       // 0 is used to indicate "no checksum"
       // 0xFFff and 0 are equivalent in one's complement math
       // 0xFFff + 1 = 0x10000 -> 0x0001 (same as 0 + 1)
@@ -365,8 +378,8 @@ namespace llarp
 
       auto hdr = Header();
 
-      auto oSrcIP = nuint32_t{hdr->saddr};
-      auto oDstIP = nuint32_t{hdr->daddr};
+      const auto delta =
+          deltaIPv4Addresses(nuint32_t{hdr->saddr}, nuint32_t{hdr->daddr}, nSrcIP, nDstIP);
 
       // L4 checksum
       auto ihs = size_t(hdr->ihl * 4);
@@ -380,21 +393,21 @@ namespace llarp
         switch (hdr->protocol)
         {
           case 6:  // TCP
-            deltaChecksumIPv4TCP(pld, psz, fragoff, 16, oSrcIP, oDstIP, nSrcIP, nDstIP);
+            deltaChecksumTCP(pld, psz, fragoff, 16, delta);
             break;
           case 17:   // UDP
           case 136:  // UDP-Lite - same checksum place, same 0->0xFFff condition
-            deltaChecksumIPv4UDP(pld, psz, fragoff, oSrcIP, oDstIP, nSrcIP, nDstIP);
+            deltaChecksumUDP(pld, psz, fragoff, delta);
             break;
           case 33:  // DCCP
-            deltaChecksumIPv4TCP(pld, psz, fragoff, 6, oSrcIP, oDstIP, nSrcIP, nDstIP);
+            deltaChecksumTCP(pld, psz, fragoff, 6, delta);
             break;
         }
       }
 
       // IPv4 checksum
       auto v4chk = (nuint16_t*)&(hdr->check);
-      *v4chk = deltaIPv4Checksum(*v4chk, oSrcIP, oDstIP, nSrcIP, nDstIP);
+      *v4chk = deltaChecksum(*v4chk, delta);
 
       // write new IP addresses
       hdr->saddr = nSrcIP.n;
@@ -427,6 +440,7 @@ namespace llarp
       hdr->dstaddr = HUIntToIn6(dst);
       const uint32_t* nSrcIP = in6_uint32_ptr(hdr->srcaddr);
       const uint32_t* nDstIP = in6_uint32_ptr(hdr->dstaddr);
+      const auto delta = deltaIPv6Addresses(oSrcIP, oDstIP, nSrcIP, nDstIP);
 
       // TODO IPv6 header options
       auto pld = buf + ihs;
@@ -480,14 +494,14 @@ namespace llarp
       switch (nextproto)
       {
         case 6:  // TCP
-          deltaChecksumIPv6TCP(pld, psz, fragoff, 16, oSrcIP, oDstIP, nSrcIP, nDstIP);
+          deltaChecksumTCP(pld, psz, fragoff, 16, delta);
           break;
         case 17:   // UDP
         case 136:  // UDP-Lite - same checksum place, same 0->0xFFff condition
-          deltaChecksumIPv6UDP(pld, psz, fragoff, oSrcIP, oDstIP, nSrcIP, nDstIP);
+          deltaChecksumUDP(pld, psz, fragoff, delta);
           break;
         case 33:  // DCCP
-          deltaChecksumIPv6TCP(pld, psz, fragoff, 6, oSrcIP, oDstIP, nSrcIP, nDstIP);
+          deltaChecksumTCP(pld, psz, fragoff, 6, delta);
           break;
       }
     }
@@ -194,6 +194,24 @@ namespace llarp
         }
       };
 
+      struct GetSize
+      {
+        size_t
+        operator()(const IPPacket& pkt) const
+        {
+          return pkt.sz;
+        }
+      };
+
+      struct GetFlow
+      {
+        uint64_t
+        operator()(const IPPacket& pkt) const
+        {
+          return pkt.FlowHash();
+        }
+      };
+
       struct CompareSize
       {
         bool
@@ -293,6 +311,20 @@ namespace llarp
       std::optional<nuint16_t>
       DstPort() const;
 
+      /// get source port if applicable
+      std::optional<nuint16_t>
+      SrcPort() const;
+
+      /// the payload of a whole ipv4 udp packet, cut down to the length in the udp header.
+      /// nullopt if this is not one
+      std::optional<std::pair<const byte_t*, size_t>>
+      UDPPayload() const;
+
+      /// hash of the 5-tuple, addresses, protocol and tcp/udp ports if present.
+      /// fragments hash without ports so every fragment of a packet lands in the same flow.
+      uint64_t
+      FlowHash() const;
+
       void
       UpdateIPv4Address(nuint32_t src, nuint32_t dst);
 
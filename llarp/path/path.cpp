@@ -190,10 +190,14 @@ namespace llarp
         ++index;
       }
 
+      // we are on a worker here, the build trace belongs to the logic thread
       if ((currentStatus & LR_StatusRecord::SUCCESS) == LR_StatusRecord::SUCCESS)
       {
         llarp::LogDebug("LR_Status message processed, path build successful");
-        r->loop()->call([r, self = shared_from_this()] { self->HandlePathConfirmMessage(r); });
+        r->loop()->call([r, self = shared_from_this()] {
+          self->buildTrace.Mark("lrsm");
+          self->HandlePathConfirmMessage(r);
+        });
       }
       else
       {
@@ -266,7 +270,8 @@ namespace llarp
         RouterID edge{};
         if (failedAt)
           edge = *failedAt;
-        r->loop()->call([r, self = shared_from_this(), edge]() {
+        r->loop()->call([r, self = shared_from_this(), edge, currentStatus]() {
+          self->buildTrace.Finish("rejected", LRStatusCodeToString(currentStatus));
           self->EnterState(ePathFailed, r->Now());
           if (auto parent = self->m_PathSet.lock())
           {
@@ -284,11 +289,13 @@ namespace llarp
     {
       if (st == ePathFailed)
       {
+        buildTrace.Finish("failed");
         _status = st;
         return;
       }
       if (st == ePathExpired && _status == ePathBuilding)
       {
+        buildTrace.Finish("timeout");
         _status = st;
         if (auto parent = m_PathSet.lock())
         {
@@ -303,6 +310,8 @@ namespace llarp
       else if (st == ePathEstablished && _status == ePathBuilding)
       {
         LogInfo("path ", Name(), " is built, took ", now - buildStarted);
+        buildTrace.Mark("confirm");
+        buildTrace.Finish("built");
       }
       else if (st == ePathTimeout && _status == ePathEstablished)
       {
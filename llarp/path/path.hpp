@@ -16,6 +16,7 @@
 #include <llarp/util/compare_ptr.hpp>
 #include <llarp/util/thread/threading.hpp>
 #include <llarp/util/time.hpp>
+#include <llarp/util/tracing.hpp>
 
 #include <algorithm>
 #include <functional>
@@ -93,6 +94,9 @@ namespace llarp
 
       llarp_time_t buildStarted = 0s;
 
+      /// times the stages of building this path, from key generation until it is confirmed
+      tracing::StageTimer buildTrace;
+
       Path(
           const std::vector<RouterContact>& routers,
           std::weak_ptr<PathSet> parent,
@@ -110,20 +110,6 @@ namespace llarp
       return nullptr;
     }
 
-    template <typename Lock_t, typename Map_t, typename Key_t, typename CheckValue_t>
-    bool
-    MapHas(Map_t& map, const Key_t& k, CheckValue_t check)
-    {
-      Lock_t lock(map.first);
-      auto range = map.second.equal_range(k);
-      for (auto i = range.first; i != range.second; ++i)
-      {
-        if (check(i->second))
-          return true;
-      }
-      return false;
-    }
-
     template <typename Lock_t, typename Map_t, typename Key_t, typename Value_t>
     void
     MapPut(Map_t& map, const Key_t& k, const Value_t& v)
@@ -167,49 +153,24 @@ namespace llarp
     bool
     PathContext::HasTransitHop(const TransitHopInfo& info)
     {
-      return MapHas<SyncTransitMap_t::Lock_t>(
-          m_TransitPaths, info.txID, [info](const std::shared_ptr<TransitHop>& hop) -> bool {
-            return info == hop->info;
-          });
+      const auto hop = m_TransitPaths.Find(info.txID, HopDirection::Downstream, info.downstream);
+      return hop and hop->info == info;
     }
 
     std::optional<std::weak_ptr<TransitHop>>
     PathContext::TransitHopByInfo(const TransitHopInfo& info)
     {
-      // this is ugly as sin
-      auto own = MapGet<
-          SyncTransitMap_t::Lock_t,
-          decltype(m_TransitPaths),
-          PathID_t,
-          std::function<bool(const std::shared_ptr<TransitHop>&)>,
-          std::function<TransitHop*(const std::shared_ptr<TransitHop>&)>,
-          TransitHop*>(
-          m_TransitPaths,
-          info.txID,
-          [info](const auto& hop) -> bool { return hop->info == info; },
-          [](const auto& hop) -> TransitHop* { return hop.get(); });
-      if (own)
-        return own->weak_from_this();
+      const auto hop = m_TransitPaths.Find(info.txID, HopDirection::Downstream, info.downstream);
+      if (hop and hop->info == info)
+        return hop;
       return std::nullopt;
     }
 
     std::optional<std::weak_ptr<TransitHop>>
     PathContext::TransitHopByUpstream(const RouterID& upstream, const PathID_t& id)
     {
-      // this is ugly as sin as well
-      auto own = MapGet<
-          SyncTransitMap_t::Lock_t,
-          decltype(m_TransitPaths),
-          PathID_t,
-          std::function<bool(const std::shared_ptr<TransitHop>&)>,
-          std::function<TransitHop*(const std::shared_ptr<TransitHop>&)>,
-          TransitHop*>(
-          m_TransitPaths,
-          id,
-          [upstream](const auto& hop) -> bool { return hop->info.upstream == upstream; },
-          [](const auto& hop) -> TransitHop* { return hop.get(); });
-      if (own)
-        return own->weak_from_this();
+      if (auto hop = m_TransitPaths.Find(id, HopDirection::Upstream, upstream))
+        return hop;
       return std::nullopt;
     }
 
@@ -227,35 +188,19 @@ namespace llarp
       if (own)
         return own;
 
-      return MapGet<SyncTransitMap_t::Lock_t>(
-          m_TransitPaths,
-          id,
-          [remote](const std::shared_ptr<TransitHop>& hop) -> bool {
-            return hop->info.upstream == remote;
-          },
-          [](const std::shared_ptr<TransitHop>& h) -> HopHandler_ptr { return h; });
+      return m_TransitPaths.Find(id, HopDirection::Upstream, remote);
     }
 
     bool
     PathContext::TransitHopPreviousIsRouter(const PathID_t& path, const RouterID& otherRouter)
     {
-      SyncTransitMap_t::Lock_t lock(m_TransitPaths.first);
-      auto itr = m_TransitPaths.second.find(path);
-      if (itr == m_TransitPaths.second.end())
-        return false;
-      return itr->second->info.downstream == otherRouter;
+      return m_TransitPaths.Find(path, HopDirection::Downstream, otherRouter) != nullptr;
     }
 
     HopHandler_ptr
     PathContext::GetByDownstream(const RouterID& remote, const PathID_t& id)
     {
-      return MapGet<SyncTransitMap_t::Lock_t>(
-          m_TransitPaths,
-          id,
-          [remote](const std::shared_ptr<TransitHop>& hop) -> bool {
-            return hop->info.downstream == remote;
-          },
-          [](const std::shared_ptr<TransitHop>& h) -> HopHandler_ptr { return h; });
+      return m_TransitPaths.Find(id, HopDirection::Downstream, remote);
     }
 
     PathSet_ptr
@@ -287,18 +232,7 @@ namespace llarp
     TransitHop_ptr
     PathContext::GetPathForTransfer(const PathID_t& id)
     {
-      const RouterID us(OurRouterID());
-      auto& map = m_TransitPaths;
-      {
-        SyncTransitMap_t::Lock_t lock(map.first);
-        auto range = map.second.equal_range(id);
-        for (auto i = range.first; i != range.second; ++i)
-        {
-          if (i->second->info.upstream == us)
-            return i->second;
-        }
-      }
-      return nullptr;
+      return m_TransitPaths.Find(id, HopDirection::Upstream, RouterID{OurRouterID()});
     }
 
     void
@@ -318,16 +252,20 @@ namespace llarp
     uint64_t
     PathContext::CurrentTransitPaths()
     {
-      SyncTransitMap_t::Lock_t lock(m_TransitPaths.first);
-      auto& map = m_TransitPaths.second;
-      return map.size() / 2;
+      return m_TransitPaths.Size();
     }
 
     void
     PathContext::PutTransitHop(std::shared_ptr<TransitHop> hop)
     {
-      MapPut<SyncTransitMap_t::Lock_t>(m_TransitPaths, hop->info.txID, hop);
-      MapPut<SyncTransitMap_t::Lock_t>(m_TransitPaths, hop->info.rxID, hop);
+      if (not m_TransitPaths.Insert(hop))
+        LogWarn("not adding transit hop with duplicate path id ", hop->info);
+    }
+
+    void
+    PathContext::ScheduleTransitHopExpiry(const TransitHop_ptr& hop)
+    {
+      m_TransitPaths.ScheduleExpiry(hop, 0s);
     }
 
     void
@@ -336,24 +274,11 @@ namespace llarp
       // decay limits
       m_PathLimits.Decay(now);
 
-      {
-        SyncTransitMap_t::Lock_t lock(m_TransitPaths.first);
-        auto& map = m_TransitPaths.second;
-        auto itr = map.begin();
-        while (itr != map.end())
-        {
-          if (itr->second->Expired(now))
-          {
-            m_Router->outboundMessageHandler().RemovePath(itr->first);
-            itr = map.erase(itr);
-          }
-          else
-          {
-            itr->second->DecayFilters(now);
-            ++itr;
-          }
-        }
-      }
+      m_TransitPaths.Expire(now, [this](const TransitHop_ptr& hop) {
+        m_Router->outboundMessageHandler().RemovePath(hop->info.txID);
+        m_Router->outboundMessageHandler().RemovePath(hop->info.rxID);
+      });
+      m_TransitPaths.ForEach([now](const TransitHop_ptr& hop) { hop->DecayFilters(now); });
       {
         util::Lock lock(m_OurPaths.first);
         auto& map = m_OurPaths.second;
@@ -384,18 +309,7 @@ namespace llarp
       }
       if (h)
         return h;
-      const RouterID us(OurRouterID());
-      auto& map = m_TransitPaths;
-      {
-        SyncTransitMap_t::Lock_t lock(map.first);
-        auto range = map.second.equal_range(id);
-        for (auto i = range.first; i != range.second; ++i)
-        {
-          if (i->second->info.upstream == us)
-            return i->second;
-        }
-      }
-      return nullptr;
+      return m_TransitPaths.Find(id, HopDirection::Upstream, RouterID{OurRouterID()});
     }
 
     void PathContext::RemovePathSet(PathSet_ptr)
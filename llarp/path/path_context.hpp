@@ -6,6 +6,7 @@
 #include "path_types.hpp"
 #include "pathset.hpp"
 #include "transit_hop.hpp"
+#include "transit_hop_table.hpp"
 #include <llarp/routing/handler.hpp>
 #include <llarp/router/i_outbound_message_handler.hpp>
 #include <llarp/util/compare_ptr.hpp>
@@ -65,6 +66,10 @@ namespace llarp
       void
       PutTransitHop(std::shared_ptr<TransitHop> hop);
 
+      /// check a transit hop for expiry on the next tick instead of at its expiry time
+      void
+      ScheduleTransitHopExpiry(const TransitHop_ptr& hop);
+
       HopHandler_ptr
       GetByUpstream(const RouterID& id, const PathID_t& path);
 
@@ -115,25 +120,6 @@ namespace llarp
       void
       RemovePathSet(PathSet_ptr set);
 
-      using TransitHopsMap_t = std::unordered_multimap<PathID_t, TransitHop_ptr>;
-
-      struct SyncTransitMap_t
-      {
-        using Mutex_t = util::NullMutex;
-        using Lock_t = util::NullLock;
-
-        Mutex_t first;  // protects second
-        TransitHopsMap_t second GUARDED_BY(first);
-
-        void
-        ForEach(std::function<void(const TransitHop_ptr&)> visit) EXCLUDES(first)
-        {
-          Lock_t lock(first);
-          for (const auto& item : second)
-            visit(item.second);
-        }
-      };
-
       // maps path id -> pathset owner of path
       using OwnedPathsMap_t = std::unordered_map<PathID_t, Path_ptr>;
 
@@ -169,7 +155,7 @@ namespace llarp
 
      private:
       AbstractRouter* m_Router;
-      SyncTransitMap_t m_TransitPaths;
+      TransitHopTable m_TransitPaths;
       SyncOwnedPathsMap_t m_OurPaths;
       bool m_AllowTransit;
       util::DecayingHashSet<IpAddress> m_PathLimits;
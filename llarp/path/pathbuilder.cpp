@@ -133,6 +133,7 @@ namespace llarp
     if (ctx->pathset->IsStopped())
       return;
 
+    ctx->path->buildTrace.Mark("keygen");
     ctx->router->NotifyRouterEvent<tooling::PathAttemptEvent>(ctx->router->pubkey(), ctx->path);
 
     ctx->router->pathContext().AddOwnPath(ctx->pathset, ctx->path);
@@ -142,8 +143,11 @@ namespace llarp
     auto sentHandler = [router = ctx->router, path = ctx->path](auto status) {
       if (status != SendStatus::Success)
       {
+        path->buildTrace.Finish("send_failed");
         path->EnterState(path::ePathFailed, router->Now());
       }
+      else
+        path->buildTrace.Mark("lrcm_send");
     };
     if (ctx->router->SendToOrQueue(remote, ctx->LRCM, sentHandler))
     {
@@ -440,6 +444,7 @@ namespace llarp
       LogInfo(Name(), " build ", path->ShortName(), ": ", path->HopsString());
 
       path->SetBuildResultHook([self](Path_ptr p) { self->HandlePathBuilt(p); });
+      path->buildTrace = tracing::StageTimer{"path_build"};
       ctx->AsyncGenerateKeys(
           path,
           m_router->loop(),
@@ -15,11 +15,34 @@
 #include <llarp/routing/handler.hpp>
 #include <llarp/util/buffer.hpp>
 #include <llarp/util/endian.hpp>
+#include <llarp/util/metrics.hpp>
 
 namespace llarp
 {
   namespace path
   {
+    namespace
+    {
+      auto& RelayedUpstream = metrics::Registry::Instance().GetCounter(
+          "lokinet_path_relay_messages",
+          "relay messages passed along transit paths",
+          {{"direction", "upstream"}});
+      auto& RelayedDownstream = metrics::Registry::Instance().GetCounter(
+          "lokinet_path_relay_messages",
+          "relay messages passed along transit paths",
+          {{"direction", "downstream"}});
+      auto& RelayedUpstreamBytes = metrics::Registry::Instance().GetCounter(
+          "lokinet_path_relay_bytes",
+          "bytes of relay messages passed along transit paths",
+          {{"direction", "upstream"}});
+      auto& RelayedDownstreamBytes = metrics::Registry::Instance().GetCounter(
+          "lokinet_path_relay_bytes",
+          "bytes of relay messages passed along transit paths",
+          {{"direction", "downstream"}});
+      auto& EndpointMessages = metrics::Registry::Instance().GetCounter(
+          "lokinet_path_endpoint_messages", "upstream messages handled where the path ends");
+    }  // namespace
+
     std::ostream&
     TransitHopInfo::print(std::ostream& stream, int level, int spaces) const
     {
@@ -182,6 +205,7 @@ namespace llarp
           }
           m_LastActivity = r->Now();
         }
+        EndpointMessages.Inc(msgs.size());
         FlushDownstream(r);
         for (const auto& other : m_FlushOthers)
         {
@@ -202,7 +226,9 @@ namespace llarp
               " to ",
               info.upstream);
           r->SendToOrQueue(info.upstream, msg);
+          RelayedUpstreamBytes.Inc(msg.X.size());
         }
+        RelayedUpstream.Inc(msgs.size());
         r->linkManager().PumpLinks();
       }
     }
@@ -220,7 +246,9 @@ namespace llarp
             " to ",
             info.downstream);
         r->SendToOrQueue(info.downstream, msg);
+        RelayedDownstreamBytes.Inc(msg.X.size());
       }
+      RelayedDownstream.Inc(msgs.size());
       r->linkManager().PumpLinks();
     }
 
@@ -463,7 +491,10 @@ namespace llarp
     void
     TransitHop::QueueDestroySelf(AbstractRouter* r)
     {
-      r->loop()->call([self = shared_from_this()] { self->SetSelfDestruct(); });
+      r->loop()->call([self = shared_from_this(), r] {
+        self->SetSelfDestruct();
+        r->pathContext().ScheduleTransitHopExpiry(self);
+      });
     }
   }  // namespace path
 }  // namespace llarp
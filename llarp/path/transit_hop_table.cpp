@@ -0,0 +1,184 @@
+#include "transit_hop_table.hpp"
+#include "transit_hop.hpp"
+
+#include <llarp/crypto/crypto.hpp>
+
+#include <cstring>
+
+namespace llarp
+{
+  namespace path
+  {
+    static constexpr size_t MinSlots = 64;
+
+    TransitHopTable::TransitHopTable() : m_Slots(MinSlots), m_Seed(llarp::randint())
+    {}
+
+    uint64_t
+    TransitHopTable::Hash(const PathID_t& id, HopDirection dir, const RouterID& neighbour) const
+    {
+      uint64_t a, b;
+      std::memcpy(&a, id.data(), sizeof(a));
+      std::memcpy(&b, neighbour.data(), sizeof(b));
+      uint64_t h = m_Seed ^ a ^ (b * 0x9e3779b97f4a7c15ULL) ^ static_cast<uint64_t>(dir);
+      // splitmix64 finalizer
+      h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+      return h ^ (h >> 31);
+    }
+
+    const TransitHopTable::Slot*
+    TransitHopTable::FindSlot(
+        uint64_t hash, const PathID_t& id, HopDirection dir, const RouterID& neighbour) const
+    {
+      const size_t mask = m_Slots.size() - 1;
+      for (size_t idx = hash & mask;; idx = (idx + 1) & mask)
+      {
+        const auto& slot = m_Slots[idx];
+        if (slot.state == SlotState::Empty)
+          return nullptr;
+        if (slot.state == SlotState::Full and slot.hash == hash and slot.dir == dir
+            and slot.id == id and slot.neighbour == neighbour)
+          return &slot;
+      }
+    }
+
+    TransitHop_ptr
+    TransitHopTable::Find(const PathID_t& id, HopDirection dir, const RouterID& neighbour) const
+    {
+      if (const auto* slot = FindSlot(Hash(id, dir, neighbour), id, dir, neighbour))
+        return slot->hop;
+      return nullptr;
+    }
+
+    bool
+    TransitHopTable::Contains(const TransitHop_ptr& hop) const
+    {
+      return Find(hop->info.txID, HopDirection::Downstream, hop->info.downstream) == hop;
+    }
+
+    bool
+    TransitHopTable::Insert(TransitHop_ptr hop)
+    {
+      const auto& info = hop->info;
+      if (Find(info.txID, HopDirection::Downstream, info.downstream))
+        return false;
+      // keep the load factor at or under a half, up to 4 keys per hop
+      if ((m_Used + 4) * 2 > m_Slots.size())
+      {
+        size_t capacity = m_Slots.size();
+        while ((m_Hops * 4 + 4) * 2 > capacity)
+          capacity *= 2;
+        Rehash(capacity);
+      }
+      Put(info.txID, HopDirection::Upstream, info.upstream, hop);
+      Put(info.rxID, HopDirection::Upstream, info.upstream, hop);
+      Put(info.txID, HopDirection::Downstream, info.downstream, hop);
+      Put(info.rxID, HopDirection::Downstream, info.downstream, hop);
+      ++m_Hops;
+      m_Timers.push(Timer{hop->ExpireTime(), hop});
+      return true;
+    }
+
+    void
+    TransitHopTable::Remove(const TransitHop_ptr& hop)
+    {
+      if (not Contains(hop))
+        return;
+      const auto& info = hop->info;
+      Erase(info.txID, HopDirection::Upstream, info.upstream, hop);
+      Erase(info.rxID, HopDirection::Upstream, info.upstream, hop);
+      Erase(info.txID, HopDirection::Downstream, info.downstream, hop);
+      Erase(info.rxID, HopDirection::Downstream, info.downstream, hop);
+      --m_Hops;
+      if (m_Hops == 0)
+        Rehash(MinSlots);
+    }
+
+    void
+    TransitHopTable::ForEach(std::function<void(const TransitHop_ptr&)> visit) const
+    {
+      for (const auto& slot : m_Slots)
+      {
+        // each hop has exactly one of these
+        if (slot.state == SlotState::Full and slot.dir == HopDirection::Downstream
+            and slot.id == slot.hop->info.txID and slot.neighbour == slot.hop->info.downstream)
+          visit(slot.hop);
+      }
+    }
+
+    void
+    TransitHopTable::ScheduleExpiry(const TransitHop_ptr& hop, llarp_time_t at)
+    {
+      m_Timers.push(Timer{at, hop});
+    }
+
+    void
+    TransitHopTable::Expire(llarp_time_t now, std::function<void(const TransitHop_ptr&)> expired)
+    {
+      while (not m_Timers.empty() and m_Timers.top().at <= now)
+      {
+        auto hop = m_Timers.top().hop.lock();
+        m_Timers.pop();
+        if (hop == nullptr or not Contains(hop))
+          continue;
+        if (hop->Expired(now))
+        {
+          expired(hop);
+          Remove(hop);
+        }
+        else if (hop->ExpireTime() > now)
+          m_Timers.push(Timer{hop->ExpireTime(), hop});
+      }
+    }
+
+    void
+    TransitHopTable::Put(
+        const PathID_t& id, HopDirection dir, const RouterID& neighbour, const TransitHop_ptr& hop)
+    {
+      const uint64_t hash = Hash(id, dir, neighbour);
+      if (FindSlot(hash, id, dir, neighbour))
+        return;
+      const size_t mask = m_Slots.size() - 1;
+      for (size_t idx = hash & mask;; idx = (idx + 1) & mask)
+      {
+        auto& slot = m_Slots[idx];
+        if (slot.state == SlotState::Full)
+          continue;
+        if (slot.state == SlotState::Empty)
+          ++m_Used;
+        slot.state = SlotState::Full;
+        slot.dir = dir;
+        slot.hash = hash;
+        slot.id = id;
+        slot.neighbour = neighbour;
+        slot.hop = hop;
+        return;
+      }
+    }
+
+    void
+    TransitHopTable::Erase(
+        const PathID_t& id, HopDirection dir, const RouterID& neighbour, const TransitHop_ptr& hop)
+    {
+      auto* slot = const_cast<Slot*>(FindSlot(Hash(id, dir, neighbour), id, dir, neighbour));
+      if (slot == nullptr or slot->hop != hop)
+        return;
+      slot->state = SlotState::Removed;
+      slot->hop.reset();
+    }
+
+    void
+    TransitHopTable::Rehash(size_t capacity)
+    {
+      std::vector<Slot> old(capacity);
+      std::swap(old, m_Slots);
+      m_Used = 0;
+      for (auto& slot : old)
+      {
+        if (slot.state == SlotState::Full)
+          Put(slot.id, slot.dir, slot.neighbour, slot.hop);
+      }
+    }
+  }  // namespace path
+}  // namespace llarp
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "path_types.hpp"
+#include <llarp/router_id.hpp>
+#include <llarp/util/types.hpp>
+
+#include <functional>
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace llarp
+{
+  namespace path
+  {
+    struct TransitHop;
+    using TransitHop_ptr = std::shared_ptr<TransitHop>;
+
+    /// which neighbour of a transit hop a message came from
+    enum class HopDirection : uint8_t
+    {
+      Upstream,
+      Downstream,
+    };
+
+    /// open addressed table of transit hops keyed by (path id, direction, neighbour).
+    /// every hop is reachable under both of its path ids from both of its neighbours, so a relayed
+    /// message finds its hop with a single exact match and no per candidate comparisons.
+    /// expiry is driven by a timer heap so we only ever look at hops that are due.
+    ///
+    /// only used from the logic thread, reads take no lock at all.
+    struct TransitHopTable
+    {
+      TransitHopTable();
+
+      /// get the hop for a message with path id that came from neighbour, nullptr if none
+      TransitHop_ptr
+      Find(const PathID_t& id, HopDirection dir, const RouterID& neighbour) const;
+
+      /// add a hop, returns false if a hop with its tx id from the same downstream is already there
+      bool
+      Insert(TransitHop_ptr hop);
+
+      /// drop a hop from the table, its expiry timer is discarded when it fires
+      void
+      Remove(const TransitHop_ptr& hop);
+
+      bool
+      Contains(const TransitHop_ptr& hop) const;
+
+      /// number of hops we hold
+      size_t
+      Size() const
+      {
+        return m_Hops;
+      }
+
+      /// visit every hop once
+      void
+      ForEach(std::function<void(const TransitHop_ptr&)> visit) const;
+
+      /// check hop for expiry at the given time on top of its regular expiry time
+      void
+      ScheduleExpiry(const TransitHop_ptr& hop, llarp_time_t at);
+
+      /// remove every hop that expired by now, calling expired for each of them before removal.
+      /// hops whose lifetime got extended are put back on the timer.
+      void
+      Expire(llarp_time_t now, std::function<void(const TransitHop_ptr&)> expired);
+
+     private:
+      enum class SlotState : uint8_t
+      {
+        Empty,
+        Full,
+        Removed,
+      };
+
+      struct Slot
+      {
+        SlotState state = SlotState::Empty;
+        HopDirection dir = HopDirection::Upstream;
+        uint64_t hash = 0;
+        PathID_t id;
+        RouterID neighbour;
+        TransitHop_ptr hop;
+      };
+
+      struct Timer
+      {
+        llarp_time_t at;
+        std::weak_ptr<TransitHop> hop;
+
+        bool
+        operator>(const Timer& other) const
+        {
+          return at > other.at;
+        }
+      };
+
+      uint64_t
+      Hash(const PathID_t& id, HopDirection dir, const RouterID& neighbour) const;
+
+      const Slot*
+      FindSlot(uint64_t hash, const PathID_t& id, HopDirection dir, const RouterID& neighbour)
+          const;
+
+      /// put one key of hop, leaves any existing mapping for that key alone
+      void
+      Put(const PathID_t& id,
+          HopDirection dir,
+          const RouterID& neighbour,
+          const TransitHop_ptr& hop);
+
+      /// remove one key of hop if it maps to hop
+      void
+      Erase(
+          const PathID_t& id,
+          HopDirection dir,
+          const RouterID& neighbour,
+          const TransitHop_ptr& hop);
+
+      void
+      Rehash(size_t capacity);
+
+      std::vector<Slot> m_Slots;
+      /// full slots and tombstones, what probe lengths depend on
+      size_t m_Used = 0;
+      size_t m_Hops = 0;
+      /// random per table so remotes picking path ids cannot line up probe chains
+      const uint64_t m_Seed;
+      std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> m_Timers;
+    };
+  }  // namespace path
+}  // namespace llarp
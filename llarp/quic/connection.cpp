@@ -559,6 +559,10 @@ namespace llarp::quic
 
     send_pkt_info = {};
 
+    // Everything we write in this pass goes to the service endpoint as a single batch, so the
+    // path lookup, queueing and wakeup is paid once rather than per packet.
+    endpoint.start_batch();
+
     auto add_stream_data =
         [&](StreamID stream_id, const ngtcp2_vec* datav, size_t datalen, uint32_t flags = 0) {
           std::array<ngtcp2_ssize, 2> result;
@@ -611,8 +615,9 @@ namespace llarp::quic
         strs.push_back(stream_ptr.get());
 
     // Maximum number of stream data packets to send out at once; if we reach this then we'll
-    // schedule another event loop call of ourselves (so that we don't starve the loop).
-    constexpr int max_stream_packets = 15;
+    // schedule another event loop call of ourselves (so that we don't starve the loop).  Packets
+    // are batched so this can be a good deal higher than the per-packet cost would otherwise allow.
+    constexpr int max_stream_packets = 64;
     int stream_packets = 0;
     while (!strs.empty() && stream_packets < max_stream_packets)
     {
@@ -666,7 +671,10 @@ namespace llarp::quic
 
           LogTrace("Sending stream data packet");
           if (!send_packet(nwrite))
+          {
+            endpoint.send_batch();
             return;
+          }
           ++stream_packets;
           ++it;
           continue;
@@ -735,9 +743,13 @@ namespace llarp::quic
 
       LogTrace("Sending non-stream data packet");
       if (!send_packet(nwrite))
+      {
+        endpoint.send_batch();
         return;
+      }
     }
 
+    endpoint.send_batch();
     schedule_retransmit();
   }
 
@@ -182,6 +182,24 @@ namespace llarp::quic
     size_t header_size = write_packet_header(to.port(), ecn);
     size_t outgoing_len = header_size + data.size();
     assert(outgoing_len <= buf_.size());
+
+    if (batching)
+    {
+      const service::ConvoTag tag = to;
+      if (not batch.empty() and tag != batch_to)
+      {
+        // someone else; send what we have for the previous remote and carry on batching
+        send_batch();
+        batching = true;
+      }
+      batch_to = tag;
+      auto& pkt = batch.emplace_back(service_endpoint.PayloadPool().Acquire(outgoing_len));
+      pkt.resize(outgoing_len);
+      std::memcpy(pkt.data(), buf_.data(), header_size);
+      std::memcpy(pkt.data() + header_size, data.data(), data.size());
+      return {};
+    }
+
     std::memcpy(&buf_[header_size], data.data(), data.size());
     bstring_view outgoing{buf_.data(), outgoing_len};
 
@@ -196,6 +214,38 @@ namespace llarp::quic
     return {};
   }
 
+  void
+  Endpoint::start_batch()
+  {
+    batching = true;
+  }
+
+  void
+  Endpoint::send_batch()
+  {
+    batching = false;
+    if (batch.empty())
+      return;
+    // sending can end up back in here (e.g. talking to ourselves) so swap the batch out first,
+    // and back in after so we keep its capacity for the next one
+    std::vector<std::vector<byte_t>> packets;
+    packets.swap(batch);
+    const auto count = packets.size();
+    if (service_endpoint.SendManyToOrQueue(batch_to, packets, service::ProtocolType::QUIC))
+    {
+      LogTrace("[", batch_to, "]: sent batch of ", count, " packets");
+    }
+    else
+    {
+      LogDebug("Failed to send batch of ", count, " packets to quic endpoint ", batch_to);
+    }
+    if (batch.empty())
+    {
+      packets.clear();
+      batch.swap(packets);
+    }
+  }
+
   void
   Endpoint::send_version_negotiation(const version_info& vi, const Address& source)
   {
@@ -61,6 +61,13 @@ namespace llarp::quic
     std::shared_ptr<uvw::TimerHandle> expiry_timer;
 
     std::vector<std::byte> buf;
+
+    // Whether send_packet currently appends to `batch` instead of sending
+    bool batching = false;
+    // Where the packets in `batch` are going
+    service::ConvoTag batch_to;
+    // Packets (lokinet header included) waiting for send_batch()
+    std::vector<std::vector<byte_t>> batch;
     // Max theoretical size of a UDP packet is 2^16-1 minus IP/UDP header overhead
     static constexpr size_t max_buf_size = 64 * 1024;
     // Max size of a UDP packet that we'll send
@@ -184,6 +191,16 @@ namespace llarp::quic
       return send_packet(to, bstring_view{data.data(), data.size()}, ecn);
     }
 
+    // Starts holding back packets sent with send_packet so that they can be handed to the service
+    // endpoint together by send_batch() rather than one at a time.  Only packets to a single
+    // remote are batched; anything to another remote flushes what we have first.
+    void
+    start_batch();
+
+    // Sends the packets held back since start_batch() as one batch and stops batching.
+    void
+    send_batch();
+
     void
     send_version_negotiation(const version_info& vi, const Address& source);
 
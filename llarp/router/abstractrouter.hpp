@@ -5,6 +5,7 @@
 #include <memory>
 #include <llarp/util/types.hpp>
 #include <llarp/util/status.hpp>
+#include <llarp/util/status_snapshot.hpp>
 #include "i_outbound_message_handler.hpp"
 #include <vector>
 #include <llarp/ev/ev.hpp>
@@ -324,6 +325,10 @@ namespace llarp
     virtual util::StatusObject
     ExtractStatus() const = 0;
 
+    /// cached per subsystem status for rpc clients that poll
+    virtual util::StatusSnapshot&
+    statusSnapshot() = 0;
+
     /// gossip an rc if required
     virtual void
     GossipRCIfNeeded(const RouterContact rc) = 0;
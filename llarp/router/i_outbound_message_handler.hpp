@@ -26,6 +26,12 @@ namespace llarp
   static const size_t MAX_PATH_QUEUE_SIZE = 100;
   static const size_t MAX_OUTBOUND_QUEUE_SIZE = 1000;
   static const size_t MAX_OUTBOUND_MESSAGES_PER_TICK = 500;
+  /// link session send queue depth at which we stop feeding a neighbour
+  static const size_t MAX_SESSION_BACKLOG = 256;
+  /// smallest size class of spare message buffers we keep around
+  static const size_t MIN_POOLED_MESSAGE_SIZE = 256;
+  /// total capacity of spare message buffers we keep around
+  static const size_t MAX_SPARE_MESSAGE_BYTES = 1024 * 1024;
 
   struct IOutboundMessageHandler
   {
@@ -6,6 +6,7 @@
 #include <llarp/link/i_link_manager.hpp>
 #include <llarp/constants/link_layer.hpp>
 #include <llarp/util/meta/memfn.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/status.hpp>
 
 #include <algorithm>
@@ -13,12 +14,27 @@
 
 namespace llarp
 {
-  const PathID_t OutboundMessageHandler::zeroID;
-
   using namespace std::chrono_literals;
 
+  namespace
+  {
+    auto& MessagesQueued = metrics::Registry::Instance().GetCounter(
+        "lokinet_outbound_messages", "outbound link messages by outcome", {{"result", "queued"}});
+    auto& MessagesSent = metrics::Registry::Instance().GetCounter(
+        "lokinet_outbound_messages", "outbound link messages by outcome", {{"result", "sent"}});
+    auto& MessagesDropped = metrics::Registry::Instance().GetCounter(
+        "lokinet_outbound_messages", "outbound link messages by outcome", {{"result", "dropped"}});
+    auto& QueueDepth = metrics::Registry::Instance().GetGauge(
+        "lokinet_outbound_queue_depth", "messages waiting to be sorted into path queues");
+    auto& ScheduledDepth = metrics::Registry::Instance().GetGauge(
+        "lokinet_outbound_scheduled", "messages in path queues waiting for their turn to send");
+  }  // namespace
+
   OutboundMessageHandler::OutboundMessageHandler(size_t maxQueueSize)
-      : outboundQueue(maxQueueSize), recentlyRemovedPaths(5s), removedSomePaths(false)
+      : outboundQueue(maxQueueSize)
+      , recentlyRemovedPaths(5s)
+      , m_Scheduler(MAX_PATH_QUEUE_SIZE, MAX_SESSION_BACKLOG, MAX_LINK_MSG_SIZE)
+      , m_BufferPool(MIN_POOLED_MESSAGE_SIZE, MAX_LINK_MSG_SIZE, MAX_SPARE_MESSAGE_BYTES)
   {}
 
   bool
@@ -32,20 +48,12 @@ namespace llarp
       return true;
     }
     const uint16_t priority = msg.Priority();
-    std::array<byte_t, MAX_LINK_MSG_SIZE> linkmsg_buffer;
-    llarp_buffer_t buf(linkmsg_buffer);
-
-    if (!EncodeBuffer(msg, buf))
-    {
-      return false;
-    }
 
     Message message;
-    message.first.resize(buf.sz);
+    if (!EncodeBuffer(msg, message.first))
+      return false;
     message.second = callback;
 
-    std::copy_n(buf.base, buf.sz, message.first.data());
-
     // if we have a session to the destination, queue the message and return
     if (_linkManager->HasSessionTo(remote))
     {
@@ -66,9 +74,9 @@ namespace llarp
 
       MessageQueueEntry entry;
       entry.priority = priority;
-      entry.message = message;
+      entry.message = std::move(message);
       entry.router = remote;
-      queue_itr->second.push(std::move(entry));
+      queue_itr->second.emplace_back(std::move(entry));
 
       shouldCreateSession = is_new;
     }
@@ -87,7 +95,7 @@ namespace llarp
     m_Killer.TryAccess([this]() {
       recentlyRemovedPaths.Decay();
       ProcessOutboundQueue();
-      SendRoundRobin();
+      SendScheduled();
     });
   }
 
@@ -102,12 +110,9 @@ namespace llarp
        * those path queues would be leaked / never removed.
        */
       recentlyRemovedPaths.Insert(pathid);
-      auto itr = outboundMessageQueues.find(pathid);
-      if (itr != outboundMessageQueues.end())
-      {
-        outboundMessageQueues.erase(itr);
-      }
-      removedSomePaths = true;
+      m_Scheduler.RemovePath(pathid, [this](MessageQueueEntry& entry) {
+        m_BufferPool.Release(std::move(entry.message.first));
+      });
     });
   }
 
@@ -121,7 +126,11 @@ namespace llarp
          {"sent", m_queueStats.sent},
          {"queueWatermark", m_queueStats.queueWatermark},
          {"perTickMax", m_queueStats.perTickMax},
-         {"numTicks", m_queueStats.numTicks}}};
+         {"numTicks", m_queueStats.numTicks},
+         {"scheduled", m_Scheduler.Size()},
+         {"spareBuffers", m_BufferPool.Spare()},
+         {"spareBufferBytes", m_BufferPool.SpareBytes()}}};
+    status["scheduler"] = m_Scheduler.ExtractStatus();
 
     return status;
   }
@@ -133,8 +142,6 @@ namespace llarp
     _linkManager = linkManager;
     _lookupHandler = lookupHandler;
     _loop = std::move(loop);
-
-    outboundMessageQueues.emplace(zeroID, MessageQueue());
   }
 
   static inline SendStatus
@@ -179,44 +186,61 @@ namespace llarp
   }
 
   bool
-  OutboundMessageHandler::EncodeBuffer(const ILinkMessage& msg, llarp_buffer_t& buf)
+  OutboundMessageHandler::EncodeBuffer(const ILinkMessage& msg, std::vector<byte_t>& out)
   {
+    // fixed layout messages such as relayed traffic go straight into the buffer we send from
+    if (const auto size = msg.EncodedSize(); size > 0 and size <= MAX_LINK_MSG_SIZE)
+    {
+      out = m_BufferPool.Acquire(size);
+      out.resize(size);
+      llarp_buffer_t buf(out);
+      if (msg.BEncode(&buf) and buf.cur == buf.base + size)
+        return true;
+      LogWarn("failed to encode outbound ", msg.Name(), " message of ", size, " bytes");
+      m_BufferPool.Release(std::move(out));
+      return false;
+    }
+
+    std::array<byte_t, MAX_LINK_MSG_SIZE> linkmsg_buffer;
+    llarp_buffer_t buf(linkmsg_buffer);
     if (!msg.BEncode(&buf))
     {
       LogWarn("failed to encode outbound message, buffer size left: ", buf.size_left());
       return false;
     }
-    // set size of message
-    buf.sz = buf.cur - buf.base;
-    buf.cur = buf.base;
-
+    out = m_BufferPool.Acquire(buf.cur - buf.base);
+    out.assign(buf.base, buf.cur);
     return true;
   }
 
   bool
-  OutboundMessageHandler::Send(const RouterID& remote, const Message& msg)
+  OutboundMessageHandler::Send(const RouterID& remote, Message&& msg)
   {
     const llarp_buffer_t buf(msg.first);
-    auto callback = msg.second;
+    auto callback = std::move(msg.second);
     m_queueStats.sent++;
-    return _linkManager->SendTo(remote, buf, [=](ILinkSession::DeliveryStatus status) {
-      if (status == ILinkSession::DeliveryStatus::eDeliverySuccess)
-        DoCallback(callback, SendStatus::Success);
-      else
-      {
-        DoCallback(callback, SendStatus::Congestion);
-      }
-    });
+    MessagesSent.Inc();
+    // the link layer copies what it sends so the buffer is ours again once this returns
+    const bool sent =
+        _linkManager->SendTo(remote, buf, [=](ILinkSession::DeliveryStatus status) {
+          if (status == ILinkSession::DeliveryStatus::eDeliverySuccess)
+            DoCallback(callback, SendStatus::Success);
+          else
+          {
+            DoCallback(callback, SendStatus::Congestion);
+          }
+        });
+    m_BufferPool.Release(std::move(msg.first));
+    return sent;
   }
 
-  bool
-  OutboundMessageHandler::SendIfSession(const RouterID& remote, const Message& msg)
+  void
+  OutboundMessageHandler::Drop(Message&& msg, SendStatus status)
   {
-    if (_linkManager->HasSessionTo(remote))
-    {
-      return Send(remote, msg);
-    }
-    return false;
+    m_queueStats.dropped++;
+    MessagesDropped.Inc();
+    DoCallback(std::move(msg.second), status);
+    m_BufferPool.Release(std::move(msg.first));
   }
 
   bool
@@ -225,23 +249,22 @@ namespace llarp
   {
     MessageQueueEntry entry;
     entry.message = std::move(msg);
-
-    // copy callback in case we need to call it, so we can std::move(entry)
-    auto callback_copy = entry.message.second;
     entry.router = remote;
     entry.pathid = pathid;
     entry.priority = priority;
     if (outboundQueue.tryPushBack(std::move(entry)) != llarp::thread::QueueReturn::Success)
     {
-      m_queueStats.dropped++;
-      DoCallback(callback_copy, SendStatus::Congestion);
+      // the queue leaves entry alone when it is full
+      Drop(std::move(entry.message), SendStatus::Congestion);
     }
     else
     {
       m_queueStats.queued++;
+      MessagesQueued.Inc();
 
       uint32_t queueSize = outboundQueue.size();
       m_queueStats.queueWatermark = std::max(queueSize, m_queueStats.queueWatermark);
+      QueueDepth.Set(queueSize);
     }
 
     return true;
@@ -258,105 +281,30 @@ namespace llarp
       // so check here if the pathid was recently removed.
       if (recentlyRemovedPaths.Contains(entry.pathid))
       {
-        return;
-      }
-
-      auto [queue_itr, is_new] = outboundMessageQueues.emplace(entry.pathid, MessageQueue());
-
-      if (is_new && !entry.pathid.IsZero())
-      {
-        roundRobinOrder.push(entry.pathid);
+        m_BufferPool.Release(std::move(entry.message.first));
+        continue;
       }
 
-      MessageQueue& path_queue = queue_itr->second;
-
-      if (path_queue.size() < MAX_PATH_QUEUE_SIZE || entry.pathid.IsZero())
+      if (not m_Scheduler.Push(entry))
       {
-        path_queue.push(std::move(entry));
-      }
-      else
-      {
-        DoCallback(entry.message.second, SendStatus::Congestion);
-        m_queueStats.dropped++;
+        Drop(std::move(entry.message), SendStatus::Congestion);
       }
     }
+    QueueDepth.Set(0);
   }
 
   void
-  OutboundMessageHandler::SendRoundRobin()
+  OutboundMessageHandler::SendScheduled()
   {
     m_queueStats.numTicks++;
 
-    // send routing messages first priority
-    auto& routing_mq = outboundMessageQueues[zeroID];
-    while (not routing_mq.empty())
-    {
-      const MessageQueueEntry& entry = routing_mq.top();
-      Send(entry.router, entry.message);
-      routing_mq.pop();
-    }
-
-    size_t empty_count = 0;
-    size_t num_queues = roundRobinOrder.size();
-
-    // if any paths have been removed since last tick, remove any stale
-    // entries from the round-robin ordering
-    if (removedSomePaths)
-    {
-      for (size_t i = 0; i < num_queues; i++)
-      {
-        PathID_t pathid = std::move(roundRobinOrder.front());
-        roundRobinOrder.pop();
-
-        if (outboundMessageQueues.find(pathid) != outboundMessageQueues.end())
-        {
-          roundRobinOrder.push(std::move(pathid));
-        }
-      }
-    }
-    removedSomePaths = false;
-
-    num_queues = roundRobinOrder.size();
-    size_t sent_count = 0;
-    if (num_queues == 0)  // if no queues, return
-    {
-      return;
-    }
-
-    // send messages for each pathid in roundRobinOrder, stopping when
-    // either every path's queue is empty or a set maximum amount of
-    // messages have been sent.
-    while (sent_count < MAX_OUTBOUND_MESSAGES_PER_TICK)
-    {
-      PathID_t pathid = std::move(roundRobinOrder.front());
-      roundRobinOrder.pop();
-
-      auto& message_queue = outboundMessageQueues[pathid];
-      if (message_queue.size() > 0)
-      {
-        const MessageQueueEntry& entry = message_queue.top();
-
-        Send(entry.router, entry.message);
-        message_queue.pop();
-
-        empty_count = 0;
-        sent_count++;
-      }
-      else
-      {
-        empty_count++;
-      }
-
-      roundRobinOrder.push(std::move(pathid));
-
-      // if num_queues empty queues in a row, all queues empty.
-      if (empty_count == num_queues)
-      {
-        break;
-      }
-    }
+    const size_t sent_count = m_Scheduler.Schedule(
+        MAX_OUTBOUND_MESSAGES_PER_TICK,
+        [this](MessageQueueEntry& entry) { Send(entry.router, std::move(entry.message)); },
+        [this](const RouterID& router) { return _linkManager->SendQueueBacklog(router); });
 
     m_queueStats.perTickMax = std::max((uint32_t)sent_count, m_queueStats.perTickMax);
+    ScheduledDepth.Set(m_Scheduler.Size());
   }
 
   void
@@ -377,19 +325,19 @@ namespace llarp
       pendingSessionMessageQueues.erase(itr);
     }
 
-    while (!movedMessages.empty())
+    // highest priority first, in the order they were queued otherwise
+    std::stable_sort(movedMessages.begin(), movedMessages.end());
+    for (auto& entry : movedMessages)
     {
-      const MessageQueueEntry& entry = movedMessages.top();
-
       if (status == SendStatus::Success)
       {
-        Send(entry.router, entry.message);
+        Send(entry.router, std::move(entry.message));
       }
       else
       {
-        DoCallback(entry.message.second, status);
+        DoCallback(std::move(entry.message.second), status);
+        m_BufferPool.Release(std::move(entry.message.first));
       }
-      movedMessages.pop();
     }
   }
 
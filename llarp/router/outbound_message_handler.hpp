@@ -1,17 +1,18 @@
 #pragma once
 
 #include "i_outbound_message_handler.hpp"
+#include "outbound_scheduler.hpp"
 
 #include <llarp/ev/ev.hpp>
+#include <llarp/util/buffer_pool.hpp>
 #include <llarp/util/thread/queue.hpp>
 #include <llarp/util/decaying_hashset.hpp>
 #include <llarp/path/path_types.hpp>
 #include <llarp/router_id.hpp>
 
-#include <list>
 #include <unordered_map>
 #include <utility>
-#include <queue>
+#include <vector>
 
 struct llarp_buffer_t;
 
@@ -38,7 +39,7 @@ namespace llarp
      * outbound message queue to be processed on Tick().
      *
      * When this class' Tick() is called, that queue is emptied and the messages there
-     * are placed in their paths' respective individual queues.
+     * are handed to the scheduler.
      *
      * Returns false if encoding the message into a buffer fails, true otherwise.
      * A return value of true merely means we successfully processed the queue request,
@@ -50,20 +51,14 @@ namespace llarp
 
     /* Called once per event loop tick.
      *
-     * Processes messages on the shared message queue into their paths' respective
-     * individual queues.
-     *
-     * Removes the individual queues for paths which have died / expired, as informed by
-     * QueueRemoveEmptyPath.
-     *
-     * Sends all routing messages that have been queued, indicated by pathid 0 when queued.
-     * Sends messages from path queues until all are empty or a set cap has been reached.
+     * Hands messages on the shared message queue to the scheduler, then sends what it
+     * lets out until it is empty or a set cap has been reached.
      */
     void
     Tick() override;
 
     /* Called from outside this class to inform it that a path has died / expired
-     * and its queue should be discarded.
+     * and its queued messages should be discarded.
      */
     void
     RemovePath(const PathID_t& pathid) override;
@@ -92,6 +87,12 @@ namespace llarp
       {
         return other.priority < priority;
       }
+
+      size_t
+      Size() const
+      {
+        return message.first.size();
+      }
     };
 
     struct MessageQueueStats
@@ -105,7 +106,8 @@ namespace llarp
       uint32_t numTicks = 0;
     };
 
-    using MessageQueue = std::priority_queue<MessageQueueEntry>;
+    /// messages waiting on a session, sorted by priority when the session is up
+    using MessageQueue = std::vector<MessageQueueEntry>;
 
     /* If a session is not yet created with the destination router for a message,
      * a special queue is created for that router and an attempt is made to
@@ -124,22 +126,21 @@ namespace llarp
     void
     QueueSessionCreation(const RouterID& remote);
 
+    /// bencode msg into out, a buffer from the pool sized for it
     bool
-    EncodeBuffer(const ILinkMessage& msg, llarp_buffer_t& buf);
+    EncodeBuffer(const ILinkMessage& msg, std::vector<byte_t>& out);
 
-    /* sends the message along to the link layer, and hopefully out to the network
+    /* sends the message along to the link layer, and hopefully out to the network,
+     * then gives its buffer back to the pool
      *
      * returns the result of the call to LinkManager::SendTo()
      */
     bool
-    Send(const RouterID& remote, const Message& msg);
+    Send(const RouterID& remote, Message&& msg);
 
-    /* Sends the message along to the link layer if we have a session to the remote
-     *
-     * returns the result of the Send() call, or false if no session.
-     */
-    bool
-    SendIfSession(const RouterID& remote, const Message& msg);
+    /* drops a message without sending it, invoking its callback with status */
+    void
+    Drop(Message&& msg, SendStatus status);
 
     /* queues a message to the shared outbound message queue.
      *
@@ -147,28 +148,26 @@ namespace llarp
      * callback is invoked with a congestion status.
      *
      * When this class' Tick() is called, that queue is emptied and the messages there
-     * are placed in their paths' respective individual queues.
+     * are handed to the scheduler.
      */
     bool
     QueueOutboundMessage(
         const RouterID& remote, Message&& msg, const PathID_t& pathid, uint16_t priority = 0);
 
-    /* Processes messages on the shared message queue into their paths' respective
-     * individual queues.
+    /* Hands messages on the shared message queue to the scheduler, dropping those for
+     * paths that were removed or whose path queue is full.
      */
     void
     ProcessOutboundQueue();
 
     /*
-     * Sends all routing messages that have been queued, indicated by pathid 0 when queued.
-     *
-     * Sends messages from path queues until all are empty or a set cap has been reached.
-     * This will send one message from each queue in a round-robin fashion such that they
-     * all have roughly equal access to bandwidth.  A notion of priority may be introduced
-     * at a later time, but for now only routing messages get priority.
+     * Sends messages in the order the scheduler lets them out until it is empty or a set
+     * cap has been reached.  Control messages go before dht messages which go before path
+     * traffic; within each, neighbours and the paths to them get equal shares of bytes, and
+     * neighbours whose sessions are backed up are skipped until they drain.
      */
     void
-    SendRoundRobin();
+    SendScheduled();
 
     /* Invoked when an outbound session establish attempt has concluded.
      *
@@ -183,15 +182,15 @@ namespace llarp
 
     llarp::thread::Queue<MessageQueueEntry> outboundQueue;
     llarp::util::DecayingHashSet<PathID_t> recentlyRemovedPaths;
-    bool removedSomePaths;
 
     mutable util::Mutex _mutex;  // protects pendingSessionMessageQueues
 
     std::unordered_map<RouterID, MessageQueue> pendingSessionMessageQueues GUARDED_BY(_mutex);
 
-    std::unordered_map<PathID_t, MessageQueue> outboundMessageQueues;
+    OutboundScheduler<MessageQueueEntry> m_Scheduler;
 
-    std::queue<PathID_t> roundRobinOrder;
+    /// encoded messages are copied into these, they go back once handed to the link layer
+    util::BufferPool m_BufferPool;
 
     ILinkManager* _linkManager;
     I_RCLookupHandler* _lookupHandler;
@@ -199,10 +198,6 @@ namespace llarp
 
     util::ContentionKiller m_Killer;
 
-    // paths cannot have pathid "0", so it can be used as the "pathid"
-    // for non-traffic (control) messages, so they can be prioritized.
-    static const PathID_t zeroID;
-
     MessageQueueStats m_queueStats;
   };
 
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <llarp/path/path_types.hpp>
+#include <llarp/router_id.hpp>
+#include <llarp/util/status.hpp>
+
+#include <array>
+#include <deque>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace llarp
+{
+  /// strict priority classes outbound link messages are sent in, lower goes first
+  enum class OutboundClass : uint8_t
+  {
+    /// link intros and path builds
+    Control = 0,
+    /// dht and everything else that does not say otherwise
+    DHT = 1,
+    /// relayed path traffic
+    Data = 2
+  };
+
+  /// map ILinkMessage::Priority() onto a class
+  inline OutboundClass
+  OutboundClassOf(uint16_t priority)
+  {
+    if (priority == 0)
+      return OutboundClass::Data;
+    if (priority < 5)
+      return OutboundClass::DHT;
+    return OutboundClass::Control;
+  }
+
+  /// schedules outbound link messages. classes are served in strict priority order, within a
+  /// class neighbour routers share the link by byte based deficit round robin and the paths going
+  /// to each neighbour share that router's turn the same way, so one bursty path can only use up
+  /// its own share. below the control class a neighbour whose session already has a deep send
+  /// queue is skipped until it drains.
+  ///
+  /// Entry_t needs router, pathid and priority members and a Size() in bytes.
+  template <typename Entry_t>
+  struct OutboundScheduler
+  {
+    static constexpr size_t NumClasses = 3;
+
+    /// maxPathQueue caps messages queued per path, maxBacklog is the session send queue depth
+    /// at which we hold off a neighbour, quantum is bytes per flow per round
+    OutboundScheduler(size_t maxPathQueue, size_t maxBacklog, size_t quantum)
+        : m_MaxPathQueue{maxPathQueue}, m_MaxBacklog{maxBacklog}, m_Quantum{int64_t(quantum)}
+    {}
+
+    /// queue an entry, returns false and leaves it alone if its path queue is full
+    bool
+    Push(Entry_t& entry)
+    {
+      const auto cls = size_t(OutboundClassOf(entry.priority));
+      auto& sched = m_Classes[cls];
+      if (not entry.pathid.IsZero()
+          and QueuedOn(sched, entry.router, entry.pathid) >= m_MaxPathQueue)
+      {
+        ++sched.dropped;
+        return false;
+      }
+      auto& router = sched.routers[entry.router];
+      auto& path = router.paths[entry.pathid];
+      if (not path.listed)
+      {
+        path.listed = true;
+        router.active.push_back(entry.pathid);
+      }
+      if (not router.listed)
+      {
+        router.listed = true;
+        sched.active.push_back(entry.router);
+      }
+      path.queue.emplace_back(std::move(entry));
+      ++sched.queued;
+      ++m_Size;
+      return true;
+    }
+
+    /// drop everything queued on a path, each dropped entry is passed to visit
+    template <typename Visit_t>
+    void
+    RemovePath(const PathID_t& pathid, Visit_t visit)
+    {
+      for (auto& sched : m_Classes)
+      {
+        for (auto& [id, router] : sched.routers)
+        {
+          auto itr = router.paths.find(pathid);
+          if (itr == router.paths.end())
+            continue;
+          for (auto& entry : itr->second.queue)
+            visit(entry);
+          m_Size -= itr->second.queue.size();
+          // the flow stays listed empty and is cleaned up on its next turn
+          itr->second.queue.clear();
+        }
+      }
+    }
+
+    /// send up to maxMessages entries in scheduled order through send(entry), backlog(router)
+    /// gives the send queue depth of our session to a neighbour. returns how many were sent.
+    template <typename Send_t, typename Backlog_t>
+    size_t
+    Schedule(size_t maxMessages, Send_t send, Backlog_t backlog)
+    {
+      size_t sent = 0;
+      for (size_t cls = 0; cls < NumClasses and sent < maxMessages; ++cls)
+      {
+        const bool backpressure = cls != size_t(OutboundClass::Control);
+        sent += ScheduleClass(m_Classes[cls], maxMessages - sent, backpressure, send, backlog);
+      }
+      return sent;
+    }
+
+    /// number of entries queued
+    size_t
+    Size() const
+    {
+      return m_Size;
+    }
+
+    util::StatusObject
+    ExtractStatus() const
+    {
+      static constexpr std::array<const char*, NumClasses> names{"control", "dht", "data"};
+      util::StatusObject obj{};
+      for (size_t cls = 0; cls < NumClasses; ++cls)
+      {
+        const auto& sched = m_Classes[cls];
+        obj[names[cls]] = util::StatusObject{
+            {"neighbours", sched.active.size()},
+            {"queued", sched.queued},
+            {"sent", sched.sent},
+            {"dropped", sched.dropped},
+            {"deferred", sched.deferred}};
+      }
+      return obj;
+    }
+
+   private:
+    struct PathFlow
+    {
+      std::deque<Entry_t> queue;
+      int64_t deficit = 0;
+      bool listed = false;
+    };
+
+    struct RouterFlow
+    {
+      std::unordered_map<PathID_t, PathFlow> paths;
+      /// paths with something queued, in round robin order
+      std::deque<PathID_t> active;
+      int64_t deficit = 0;
+      bool listed = false;
+    };
+
+    struct ClassSchedule
+    {
+      std::unordered_map<RouterID, RouterFlow> routers;
+      /// neighbours with something queued, in round robin order
+      std::deque<RouterID> active;
+      uint64_t queued = 0;
+      uint64_t sent = 0;
+      uint64_t dropped = 0;
+      /// turns a neighbour skipped because its session was backed up
+      uint64_t deferred = 0;
+    };
+
+    static size_t
+    QueuedOn(const ClassSchedule& sched, const RouterID& router, const PathID_t& pathid)
+    {
+      const auto itr = sched.routers.find(router);
+      if (itr == sched.routers.end())
+        return 0;
+      const auto path = itr->second.paths.find(pathid);
+      return path == itr->second.paths.end() ? 0 : path->second.queue.size();
+    }
+
+    template <typename Send_t, typename Backlog_t>
+    size_t
+    ScheduleClass(
+        ClassSchedule& sched,
+        size_t maxMessages,
+        bool backpressure,
+        Send_t& send,
+        Backlog_t& backlog)
+    {
+      size_t sent = 0;
+      // neighbours in a row we could not send anything to, once that is all of them we are done
+      size_t idle = 0;
+      while (sent < maxMessages and not sched.active.empty() and idle < sched.active.size())
+      {
+        const RouterID id = sched.active.front();
+        auto& router = sched.routers[id];
+        if (router.active.empty())
+        {
+          sched.active.pop_front();
+          sched.routers.erase(id);
+          continue;
+        }
+        if (router.deficit <= 0)
+        {
+          sched.active.pop_front();
+          sched.active.push_back(id);
+          // a new round for this neighbour, hold it back if the link is not keeping up
+          if (backpressure and backlog(id) >= m_MaxBacklog)
+          {
+            ++sched.deferred;
+            ++idle;
+            continue;
+          }
+          router.deficit += m_Quantum;
+          // it has something to send on its next turn
+          idle = 0;
+          continue;
+        }
+        auto* entry = NextFromRouter(router);
+        if (entry == nullptr)
+          continue;
+        const auto sz = int64_t(entry->Size());
+        router.deficit -= sz;
+        send(*entry);
+        PopFromRouter(router);
+        ++sched.sent;
+        --m_Size;
+        ++sent;
+        idle = 0;
+      }
+      return sent;
+    }
+
+    /// next entry of the path whose turn it is within a neighbour, nullptr if the neighbour has
+    /// nothing left
+    Entry_t*
+    NextFromRouter(RouterFlow& router)
+    {
+      while (not router.active.empty())
+      {
+        const PathID_t id = router.active.front();
+        auto& path = router.paths[id];
+        if (path.queue.empty())
+        {
+          router.active.pop_front();
+          router.paths.erase(id);
+          continue;
+        }
+        if (path.deficit <= 0)
+        {
+          path.deficit += m_Quantum;
+          router.active.pop_front();
+          router.active.push_back(id);
+          continue;
+        }
+        return &path.queue.front();
+      }
+      return nullptr;
+    }
+
+    void
+    PopFromRouter(RouterFlow& router)
+    {
+      auto& path = router.paths[router.active.front()];
+      path.deficit -= int64_t(path.queue.front().Size());
+      path.queue.pop_front();
+    }
+
+    const size_t m_MaxPathQueue;
+    const size_t m_MaxBacklog;
+    const int64_t m_Quantum;
+    std::array<ClassSchedule, NumClasses> m_Classes;
+    size_t m_Size = 0;
+  };
+}  // namespace llarp
@@ -20,7 +20,9 @@
 #include <llarp/util/logging/logger_syslog.hpp>
 #include <llarp/util/logging/logger.hpp>
 #include <llarp/util/meta/memfn.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/str.hpp>
+#include <llarp/util/tracing.hpp>
 #include <llarp/ev/ev.hpp>
 #include <llarp/tooling/peer_stats_event.hpp>
 
@@ -46,6 +48,16 @@ static constexpr std::chrono::milliseconds ROUTER_TICK_INTERVAL = 250ms;
 
 namespace llarp
 {
+  namespace
+  {
+    auto& WorkQueued = metrics::Registry::Instance().GetCounter(
+        "lokinet_worker_jobs", "crypto jobs handed to the worker threads");
+    auto& WorkWait = metrics::Registry::Instance().GetHistogram(
+        "lokinet_worker_wait_seconds", "how long crypto jobs waited for a worker thread");
+    auto& WorkRun = metrics::Registry::Instance().GetHistogram(
+        "lokinet_worker_run_seconds", "how long crypto jobs ran for");
+  }  // namespace
+
   Router::Router(EventLoop_ptr loop, std::shared_ptr<vpn::Platform> vpnPlatform)
       : ready(false)
       , m_lmq(std::make_shared<oxenmq::OxenMQ>())
@@ -58,6 +70,8 @@ namespace llarp
       , inbound_link_msg_parser(this)
       , _hiddenServiceContext(this)
       , m_RPCServer(new rpc::RpcServer(m_lmq, this))
+      // how stale the status we hand to rpc pollers may get
+      , m_StatusSnapshot(1s)
 #ifdef LOKINET_HIVE
       , _randomStartDelay(std::chrono::milliseconds((llarp::randint() % 1250) + 2000))
 #else
@@ -71,6 +85,17 @@ namespace llarp
     _running.store(false);
     _lastTick = llarp::time_now_ms();
     m_NextExploreAt = Clock_t::now();
+
+    // the same parts as ExtractStatus, each cached on its own
+    m_StatusSnapshot.Add("running", [this]() { return util::StatusObject(_running.load()); });
+    m_StatusSnapshot.Add(
+        "numNodesKnown", [this]() { return util::StatusObject(_nodedb->NumLoaded()); });
+    m_StatusSnapshot.Add("dht", [this]() { return _dht->impl->ExtractStatus(); });
+    m_StatusSnapshot.Add("services", [this]() { return _hiddenServiceContext.ExtractStatus(); });
+    m_StatusSnapshot.Add("exit", [this]() { return _exitContext.ExtractStatus(); });
+    m_StatusSnapshot.Add("links", [this]() { return _linkManager.ExtractStatus(); });
+    m_StatusSnapshot.Add(
+        "outboundMessages", [this]() { return _outboundMessageHandler.ExtractStatus(); });
   }
 
   Router::~Router()
@@ -360,6 +385,9 @@ namespace llarp
     if (_onDown)
       _onDown();
     LogInfo("closing router");
+    // get queued log records out while the io they may need is still around
+    LogContext::Instance().ImmediateFlush();
+    m_MetricsServer.reset();
     _loop->stop();
     _running.store(false);
   }
@@ -681,6 +709,12 @@ namespace llarp
         conf.logging.m_logFile,
         conf.router.m_nickname,
         util::memFn(&AbstractRouter::QueueDiskIO, this));
+    for (const auto& [subsystem, level] : conf.logging.m_subsystemLevels)
+      LogContext::Instance().SetSubsystemLevel(subsystem, level);
+    if (conf.logging.m_logAsync)
+      LogContext::Instance().EnableAsync(conf.logging.m_crashDumpRecords);
+
+    tracing::Tracer::Instance().SetSampleRate(conf.api.m_traceSampleRate);
 
     return true;
   }
@@ -948,6 +982,7 @@ namespace llarp
     dht()->impl->Nodes()->DelNode(k);
 
     LogInfo("Session to ", remote, " fully closed");
+    m_StatusSnapshot.Invalidate("links");
     if (IsServiceNode())
       return;
     if (const auto maybe = nodedb()->Get(remote); maybe.has_value())
@@ -990,6 +1025,7 @@ namespace llarp
       m_peerDb->modifyPeerStats(id, [&](PeerStats& stats) { stats.numConnectionSuccesses++; });
     }
     NotifyRouterEvent<tooling::LinkSessionEstablishedEvent>(pubkey(), id, inbound);
+    m_StatusSnapshot.Invalidate("links");
     return _outboundSessionMaker.OnSessionEstablished(session);
   }
 
@@ -1043,6 +1079,11 @@ namespace llarp
       m_RPCServer->AsyncServeRPC(rpcBindAddr);
       LogInfo("Bound RPC server to ", rpcBindAddr);
     }
+    if (const auto& bind = m_Config->api.m_metricsBindAddr; bind and not m_MetricsServer)
+    {
+      m_MetricsServer = std::make_unique<rpc::MetricsServer>(*bind);
+      m_MetricsServer->Start();
+    }
 
     return true;
   }
@@ -1395,6 +1436,13 @@ namespace llarp
   void
   Router::QueueWork(std::function<void(void)> func)
   {
+    WorkQueued.Inc();
+    func = [func = std::move(func), queuedAt = std::chrono::steady_clock::now()]() {
+      const auto startedAt = std::chrono::steady_clock::now();
+      WorkWait.Observe(startedAt - queuedAt);
+      func();
+      WorkRun.Observe(std::chrono::steady_clock::now() - startedAt);
+    };
     if (m_isServiceNode)
       _loop->call_soon(std::move(func));
     else
@@ -26,6 +26,7 @@
 #include <llarp/routing/handler.hpp>
 #include <llarp/routing/message_parser.hpp>
 #include <llarp/rpc/lokid_rpc_client.hpp>
+#include <llarp/rpc/metrics_server.hpp>
 #include <llarp/rpc/rpc_server.hpp>
 #include <llarp/service/context.hpp>
 #include <stdexcept>
@@ -33,6 +34,7 @@
 #include <llarp/util/fs.hpp>
 #include <llarp/util/mem.hpp>
 #include <llarp/util/status.hpp>
+#include <llarp/util/status_snapshot.hpp>
 #include <llarp/util/str.hpp>
 #include <llarp/util/time.hpp>
 
@@ -103,6 +105,12 @@ namespace llarp
     util::StatusObject
     ExtractStatus() const override;
 
+    util::StatusSnapshot&
+    statusSnapshot() override
+    {
+      return m_StatusSnapshot;
+    }
+
     const std::shared_ptr<NodeDB>&
     nodedb() const override
     {
@@ -285,6 +293,8 @@ namespace llarp
     bool enableRPCServer = false;
     oxenmq::address rpcBindAddr = DefaultRPCBindAddr;
     std::unique_ptr<rpc::RpcServer> m_RPCServer;
+    std::unique_ptr<rpc::MetricsServer> m_MetricsServer;
+    util::StatusSnapshot m_StatusSnapshot;
 
     const llarp_time_t _randomStartDelay;
 
@@ -1,8 +1,11 @@
 #include "path_transfer_message.hpp"
 
 #include "handler.hpp"
+#include <llarp/util/bencode.hpp>
 #include <llarp/util/buffer.hpp>
 
+#include <string_view>
+
 namespace llarp
 {
   namespace routing
@@ -24,28 +27,26 @@ namespace llarp
       return read;
     }
 
+    namespace
+    {
+      // "d1:A1:T1:P16:<path id>1:Si<S>e1:T<frame>1:Vi0e1:Y32:<Y>e", the constant parts are
+      // written in one go instead of key by key
+      static_assert(LLARP_PROTO_VERSION == 0, "the path transfer layout has the version baked in");
+      constexpr std::string_view TransferHead = "d1:A1:T1:P16:";
+      constexpr std::string_view TransferSeqno = "1:S";
+      constexpr std::string_view TransferFrame = "1:T";
+      constexpr std::string_view TransferNonce = "1:Vi0e1:Y32:";
+      static_assert(PathID_t::SIZE == 16 and TunnelNonce::SIZE == 32);
+    }  // namespace
+
     bool
     PathTransferMessage::BEncode(llarp_buffer_t* buf) const
     {
-      if (!bencode_start_dict(buf))
-        return false;
-      if (!BEncodeWriteDictMsgType(buf, "A", "T"))
-        return false;
-      if (!BEncodeWriteDictEntry("P", P, buf))
-        return false;
-
-      if (!BEncodeWriteDictInt("S", S, buf))
-        return false;
-
-      if (!BEncodeWriteDictEntry("T", T, buf))
-        return false;
-
-      if (!BEncodeWriteDictInt("V", LLARP_PROTO_VERSION, buf))
-        return false;
-      if (!BEncodeWriteDictEntry("Y", Y, buf))
-        return false;
-
-      return bencode_end(buf);
+      return BEncodeWriteRaw(TransferHead, buf) and buf->write(P.begin(), P.end())
+          and BEncodeWriteRaw(TransferSeqno, buf) and bencode_write_uint64(buf, S)
+          and BEncodeWriteRaw(TransferFrame, buf) and T.BEncode(buf)
+          and BEncodeWriteRaw(TransferNonce, buf) and buf->write(Y.begin(), Y.end())
+          and bencode_end(buf);
     }
 
     bool
@@ -4,6 +4,8 @@
 #include <llarp/util/bencode.hpp>
 #include <llarp/util/endian.hpp>
 
+#include <string_view>
+
 namespace llarp
 {
   namespace routing
@@ -23,22 +25,32 @@ namespace llarp
       return true;
     }
 
+    namespace
+    {
+      // "d1:A1:I1:Pi<protocol>e1:Si<S>e1:Vi<version>e1:Xl<packets>ee", written without going
+      // through the per key helpers since every exit packet goes through here
+      constexpr std::string_view TrafficHead = "d1:A1:I1:P";
+      constexpr std::string_view TrafficSeqno = "1:S";
+      constexpr std::string_view TrafficVersion = "1:V";
+      constexpr std::string_view TrafficPackets = "1:Xl";
+      constexpr std::string_view TrafficTail = "ee";
+    }  // namespace
+
     bool
     TransferTrafficMessage::BEncode(llarp_buffer_t* buf) const
     {
-      if (!bencode_start_dict(buf))
-        return false;
-      if (!BEncodeWriteDictMsgType(buf, "A", "I"))
-        return false;
-      if (!BEncodeWriteDictInt("P", protocol, buf))
-        return false;
-      if (!BEncodeWriteDictInt("S", S, buf))
-        return false;
-      if (!BEncodeWriteDictInt("V", version, buf))
-        return false;
-      if (!BEncodeWriteDictList("X", X, buf))
+      if (not(BEncodeWriteRaw(TrafficHead, buf)
+              and bencode_write_uint64(buf, static_cast<uint64_t>(protocol))
+              and BEncodeWriteRaw(TrafficSeqno, buf) and bencode_write_uint64(buf, S)
+              and BEncodeWriteRaw(TrafficVersion, buf) and bencode_write_uint64(buf, version)
+              and BEncodeWriteRaw(TrafficPackets, buf)))
         return false;
-      return bencode_end(buf);
+      for (const auto& packet : X)
+      {
+        if (not bencode_write_bytestring(buf, packet.data(), packet.size()))
+          return false;
+      }
+      return BEncodeWriteRaw(TrafficTail, buf);
     }
 
     bool
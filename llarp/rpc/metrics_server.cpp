@@ -0,0 +1,153 @@
+#include "metrics_server.hpp"
+
+#include <llarp/util/logging/logger.hpp>
+#include <llarp/util/metrics.hpp>
+#include <llarp/util/thread/threading.hpp>
+
+#include <uvw/async.h>
+#include <uvw/loop.h>
+#include <uvw/tcp.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace llarp::rpc
+{
+  namespace
+  {
+    /// anything a scraper sends fits in this, cut off whoever sends more
+    constexpr size_t MaxRequestSize = 8192;
+
+    std::string
+    MakeResponse(std::string_view status, std::string_view contentType, std::string_view body)
+    {
+      std::string resp;
+      resp += "HTTP/1.1 ";
+      resp += status;
+      resp += "\r\nContent-Type: ";
+      resp += contentType;
+      resp += "\r\nContent-Length: ";
+      resp += std::to_string(body.size());
+      resp += "\r\nConnection: close\r\n\r\n";
+      resp += body;
+      return resp;
+    }
+
+    /// the response to a whole request head
+    std::string
+    HandleRequest(std::string_view head)
+    {
+      const auto lineEnd = head.find("\r\n");
+      const auto requestLine = head.substr(0, lineEnd);
+      const auto methodEnd = requestLine.find(' ');
+      if (methodEnd == std::string_view::npos)
+        return MakeResponse("400 Bad Request", "text/plain", "bad request\n");
+      if (requestLine.substr(0, methodEnd) != "GET")
+        return MakeResponse("405 Method Not Allowed", "text/plain", "only GET is supported\n");
+      auto path = requestLine.substr(methodEnd + 1);
+      path = path.substr(0, path.find(' '));
+      path = path.substr(0, path.find('?'));
+      if (path != "/metrics" and path != "/")
+        return MakeResponse("404 Not Found", "text/plain", "try /metrics\n");
+      return MakeResponse(
+          "200 OK",
+          "application/openmetrics-text; version=1.0.0; charset=utf-8",
+          metrics::Registry::Instance().OpenMetrics());
+    }
+
+    void
+    Reply(uvw::TCPHandle& client, std::string resp)
+    {
+      // one request per connection, stop reading and hang up once the reply is out
+      client.stop();
+      const auto sz = resp.size();
+      auto data = std::make_unique<char[]>(sz);
+      std::memcpy(data.get(), resp.data(), sz);
+      client.once<uvw::WriteEvent>([](auto&, uvw::TCPHandle& c) { c.close(); });
+      client.write(std::move(data), sz);
+    }
+
+    void
+    Accept(uvw::TCPHandle& server)
+    {
+      auto client = server.loop().resource<uvw::TCPHandle>();
+      server.accept(*client);
+      client->data(std::make_shared<std::string>());
+      client->on<uvw::DataEvent>([](uvw::DataEvent& event, uvw::TCPHandle& c) {
+        auto request = c.data<std::string>();
+        request->append(event.data.get(), event.length);
+        if (request->find("\r\n\r\n") != std::string::npos)
+          Reply(c, HandleRequest(*request));
+        else if (request->size() > MaxRequestSize)
+          Reply(c, MakeResponse("431 Request Header Fields Too Large", "text/plain", ""));
+      });
+      client->on<uvw::EndEvent>([](auto&, uvw::TCPHandle& c) { c.close(); });
+      client->on<uvw::ErrorEvent>([](auto&, uvw::TCPHandle& c) { c.close(); });
+      client->read();
+    }
+  }  // namespace
+
+  MetricsServer::MetricsServer(SockAddr bindAddr) : m_BindAddr{std::move(bindAddr)}
+  {}
+
+  MetricsServer::~MetricsServer()
+  {
+    Stop();
+  }
+
+  void
+  MetricsServer::Start()
+  {
+    if (m_Loop)
+      return;
+    m_Loop = uvw::Loop::create();
+    if (not m_Loop)
+      throw std::runtime_error{"failed to make libuv loop for metrics server"};
+
+    auto server = m_Loop->resource<uvw::TCPHandle>();
+    const char* failed = nullptr;
+    auto errHandler =
+        server->once<uvw::ErrorEvent>([&failed](auto& evt, auto&) { failed = evt.what(); });
+    server->bind(*m_BindAddr.operator const sockaddr*());
+    server->on<uvw::ListenEvent>([](const uvw::ListenEvent&, uvw::TCPHandle& srv) { Accept(srv); });
+    server->listen();
+    server->erase(errHandler);
+    if (failed)
+    {
+      server->close();
+      m_Loop->run();
+      m_Loop.reset();
+      throw std::runtime_error{
+          "failed to listen for metrics on " + m_BindAddr.toString() + ": " + failed};
+    }
+
+    m_Stop = m_Loop->resource<uvw::AsyncHandle>();
+    m_Stop->on<uvw::AsyncEvent>([](const auto&, uvw::AsyncHandle& handle) {
+      handle.loop().walk([](auto&& h) {
+        if constexpr (!std::is_pointer_v<std::remove_reference_t<decltype(h)>>)
+          h.close();
+      });
+    });
+
+    m_Thread = std::thread{[loop = m_Loop]() {
+      util::SetThreadName("llarp-metrics");
+      loop->run();
+    }};
+    LogInfo("serving metrics on http://", m_BindAddr, "/metrics");
+  }
+
+  void
+  MetricsServer::Stop()
+  {
+    if (not m_Loop)
+      return;
+    m_Stop->send();
+    if (m_Thread.joinable())
+      m_Thread.join();
+    m_Loop->close();
+    m_Stop.reset();
+    m_Loop.reset();
+  }
+}  // namespace llarp::rpc
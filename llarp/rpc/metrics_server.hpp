@@ -0,0 +1,38 @@
+#pragma once
+
+#include <llarp/net/sock_addr.hpp>
+
+#include <memory>
+#include <thread>
+
+namespace uvw
+{
+  class Loop;
+  class AsyncHandle;
+}  // namespace uvw
+
+namespace llarp::rpc
+{
+  /// serves the metrics registry as OpenMetrics over plain http; it has a libuv loop and thread
+  /// of its own so a scrape never waits on or wakes the router's event loop
+  class MetricsServer
+  {
+   public:
+    explicit MetricsServer(SockAddr bindAddr);
+
+    ~MetricsServer();
+
+    /// bind and start serving, throws if we cannot listen on the address
+    void
+    Start();
+
+    void
+    Stop();
+
+   private:
+    const SockAddr m_BindAddr;
+    std::shared_ptr<uvw::Loop> m_Loop;
+    std::shared_ptr<uvw::AsyncHandle> m_Stop;
+    std::thread m_Thread;
+  };
+}  // namespace llarp::rpc
@@ -11,6 +11,8 @@
 #include <llarp/service/auth.hpp>
 #include <llarp/service/name.hpp>
 #include <llarp/router/abstractrouter.hpp>
+#include <llarp/util/metrics.hpp>
+#include <llarp/util/tracing.hpp>
 
 namespace llarp::rpc
 {
@@ -118,21 +120,105 @@ namespace llarp::rpc
               msg.send_reply(CreateJSONResponse(result));
             })
         .add_request_command(
-            "status",
+            "metrics",
+            [](oxenmq::Message& msg) {
+              // answered right here on the rpc thread, the metrics don't need the event loop
+              msg.send_reply(CreateJSONResponse(metrics::Registry::Instance().OpenMetrics()));
+            })
+        .add_request_command(
+            "traces",
+            [](oxenmq::Message& msg) {
+              msg.send_reply(CreateJSONResponse(tracing::Tracer::Instance().ExtractStatus()));
+            })
+        .add_request_command(
+            "trace_export",
+            [](oxenmq::Message& msg) {
+              msg.send_reply(CreateJSONResponse(tracing::Tracer::Instance().ChromeTrace()));
+            })
+        .add_request_command(
+            "loglevel",
             [&](oxenmq::Message& msg) {
-              m_Router->loop()->call([defer = msg.send_later(), r = m_Router]() {
-                std::string data;
-                if (r->IsRunning())
+              HandleJSONRequest(msg, [](nlohmann::json obj, ReplyFunction_t reply) {
+                std::optional<LogLevel> level;
+                if (auto itr = obj.find("level"); itr != obj.end() and not itr->is_null())
                 {
-                  data = CreateJSONResponse(r->ExtractStatus());
+                  level = LogLevelFromString(itr->get<std::string>());
+                  if (not level)
+                  {
+                    reply(CreateJSONError("invalid log level"));
+                    return;
+                  }
                 }
-                else
+                auto& log = LogContext::Instance();
+                // with a subsystem only that subsystem changes, and no level puts it back on the
+                // global one
+                if (auto itr = obj.find("subsystem"); itr != obj.end())
+                {
+                  const auto subsystem = itr->get<std::string>();
+                  log.SetSubsystemLevel(subsystem, level);
+                  reply(CreateJSONResponse(util::StatusObject{
+                      {"subsystem", subsystem},
+                      {"level", LogLevelToName(log.GetSubsystemLevel(subsystem))}}));
+                  return;
+                }
+                if (not level)
                 {
-                  data = CreateJSONError("router not yet ready");
+                  reply(CreateJSONError("level not provided"));
+                  return;
                 }
-                defer.reply(data);
+                SetLogLevel(*level);
+                reply(CreateJSONResponse(
+                    util::StatusObject{{"level", LogLevelToName(GetLogLevel())}}));
               });
             })
+        .add_request_command(
+            "status",
+            [&](oxenmq::Message& msg) {
+              // served from the router's status snapshot, "subtree" is a json pointer into the
+              // status and "since" leaves out what has not changed after that version
+              auto serve = [r = m_Router](nlohmann::json obj, ReplyFunction_t reply) {
+                if (not r->IsRunning())
+                {
+                  reply(CreateJSONError("router not yet ready"));
+                  return;
+                }
+                std::string subtree;
+                if (auto itr = obj.find("subtree"); itr != obj.end())
+                  subtree = itr->get<std::string>();
+                uint64_t since = 0;
+                if (auto itr = obj.find("since"); itr != obj.end())
+                  since = itr->get<uint64_t>();
+
+                auto get = [r, subtree, since, reply]() {
+                  if (auto maybe = r->statusSnapshot().Get(subtree, since))
+                    reply(CreateJSONResponse(*maybe));
+                  else
+                    reply(CreateJSONError("no such status path"));
+                };
+                auto& snapshot = r->statusSnapshot();
+                const auto subsystem = util::StatusSnapshot::Subsystem(subtree);
+                const auto now = time_now_ms();
+                // only go to the event loop when part of what was asked for needs rebuilding
+                if (not snapshot.Stale(subsystem, now))
+                {
+                  get();
+                  return;
+                }
+                r->loop()->call([r, subsystem = std::string{subsystem}, now, get]() {
+                  r->statusSnapshot().Refresh(subsystem, now);
+                  get();
+                });
+              };
+              // plain status requests carry no data at all
+              if (msg.data.empty())
+              {
+                serve(nlohmann::json::object(), [defer = msg.send_later()](std::string result) {
+                  defer.reply(result);
+                });
+                return;
+              }
+              HandleJSONRequest(msg, serve);
+            })
         .add_request_command(
             "quic_connect",
             [&](oxenmq::Message& msg) {
@@ -316,14 +402,15 @@ namespace llarp::rpc
                     return;
                   }
                   ep->ObtainSNodeSession(routerID, [routerID, ep, reply](auto session) {
-                    if (session and session->IsReady())
+                    if (not session or not session->IsReady())
+                      reply(CreateJSONError("failed to obtain snode session"));
+                    else if (const auto ip = ep->GetIPForIdent(PubKey{routerID}))
                     {
-                      const auto ip = net::TruncateV6(ep->GetIPForIdent(PubKey{routerID}));
-                      util::StatusObject status{{"ip", ip.ToString()}};
+                      util::StatusObject status{{"ip", net::TruncateV6(*ip).ToString()}};
                       reply(CreateJSONResponse(status));
                     }
                     else
-                      reply(CreateJSONError("failed to obtain snode session"));
+                      reply(CreateJSONError("no address left for snode session"));
                   });
                 });
               });
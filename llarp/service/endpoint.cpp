@@ -190,6 +190,35 @@ namespace llarp
       return true;
     }
 
+    void
+    Endpoint::CallWhenReady(std::function<void(bool)> hook, llarp_time_t timeout)
+    {
+      if (IsReady())
+        hook(true);
+      else
+        m_ReadyHooks.emplace_back(Now() + timeout, std::move(hook));
+    }
+
+    void
+    Endpoint::RunReadyHooks(llarp_time_t now)
+    {
+      if (m_ReadyHooks.empty())
+        return;
+      const bool ready = IsReady();
+      // hooks may add more hooks
+      auto hooks = std::move(m_ReadyHooks);
+      m_ReadyHooks.clear();
+      for (auto& [expiresAt, hook] : hooks)
+      {
+        if (ready)
+          hook(true);
+        else if (now >= expiresAt)
+          hook(false);
+        else
+          m_ReadyHooks.emplace_back(expiresAt, std::move(hook));
+      }
+    }
+
     bool
     Endpoint::HasPendingRouterLookup(const RouterID remote) const
     {
@@ -298,6 +327,8 @@ namespace llarp
       EndpointUtil::ExpireSNodeSessions(now, m_state->m_SNodeSessions);
       // expire pending tx
       EndpointUtil::ExpirePendingTx(now, m_state->m_PendingLookups);
+      // finish traces nothing is going to report back on
+      EndpointUtil::ExpireSessionTraces(m_state->m_SessionTraces, m_state->m_PendingLookups);
       // expire pending router lookups
       EndpointUtil::ExpirePendingRouterLookups(now, m_state->m_PendingRouters);
 
@@ -308,6 +339,8 @@ namespace llarp
           now, m_state->m_RemoteSessions, m_state->m_DeadSessions, Sessions());
       // expire convotags
       EndpointUtil::ExpireConvoSessions(now, Sessions());
+      // our intros can come and go without a publish
+      RunReadyHooks(now);
 
       if (NumInStatus(path::ePathEstablished) > 1)
       {
@@ -758,6 +791,7 @@ namespace llarp
       if (m_OnReady)
         m_OnReady->NotifyAsync(NotifyParams());
       m_OnReady = nullptr;
+      RunReadyHooks(now);
     }
 
     std::optional<std::vector<RouterContact>>
@@ -790,7 +824,8 @@ namespace llarp
     constexpr auto MaxOutboundContextPerRemote = 1;
 
     void
-    Endpoint::PutNewOutboundContext(const service::IntroSet& introset, llarp_time_t left)
+    Endpoint::PutNewOutboundContext(
+        const service::IntroSet& introset, llarp_time_t left, tracing::StageTimer trace)
     {
       const Address addr{introset.addressKeys.Addr()};
 
@@ -798,7 +833,8 @@ namespace llarp
 
       if (remoteSessions.count(addr) < MaxOutboundContextPerRemote)
       {
-        remoteSessions.emplace(addr, std::make_shared<OutboundContext>(introset, this));
+        remoteSessions.emplace(
+            addr, std::make_shared<OutboundContext>(introset, this, std::move(trace)));
         LogInfo("Created New outbound context for ", addr.ToString());
       }
 
@@ -1368,6 +1404,8 @@ namespace llarp
         // inform all if we have no more pending lookups for this address
         if (pendingForAddr == 0)
         {
+          if (auto node = m_state->m_SessionTraces.extract(addr))
+            node.mapped().Finish("lookup_failed");
           auto range = lookups.equal_range(addr);
           auto itr = range.first;
           while (itr != range.second)
@@ -1378,12 +1416,21 @@ namespace llarp
         }
         return false;
       }
+      tracing::StageTimer trace;
+      if (auto node = m_state->m_SessionTraces.extract(addr))
+      {
+        trace = std::move(node.mapped());
+        trace.Mark("introset_lookup");
+      }
       // check for established outbound context
 
       if (m_state->m_RemoteSessions.count(addr) > 0)
+      {
+        trace.Finish("existing");
         return true;
+      }
 
-      PutNewOutboundContext(*introset, timeLeft);
+      PutNewOutboundContext(*introset, timeLeft, std::move(trace));
       return true;
     }
 
@@ -1452,6 +1499,8 @@ namespace llarp
         return true;
 
       const auto paths = GetManyPathsWithUniqueEndpoints(this, NumParallelLookups);
+      if (not paths.empty())
+        m_state->m_SessionTraces.try_emplace(remote, "hs_session");
 
       using namespace std::placeholders;
       const dht::Key_t location = remote.ToKey();
@@ -1516,8 +1565,11 @@ namespace llarp
       using namespace std::placeholders;
       if (nodeSessions.count(snode) == 0)
       {
+        const auto maybe_ip = ObtainIPForAddr(snode);
+        if (not maybe_ip)
+          return false;
         const auto src = xhtonl(net::TruncateV6(GetIfAddr()));
-        const auto dst = xhtonl(net::TruncateV6(ObtainIPForAddr(snode)));
+        const auto dst = xhtonl(net::TruncateV6(*maybe_ip));
 
         auto session = std::make_shared<exit::SNodeSession>(
             snode,
@@ -1817,74 +1869,11 @@ namespace llarp
       {
         // inbound conversation
         LogTrace("Have inbound convo");
-        auto transfer = std::make_shared<routing::PathTransferMessage>();
-        ProtocolFrame& f = transfer->T;
-        f.R = 0;
-        std::shared_ptr<path::Path> p;
         if (const auto maybe = GetBestConvoTagFor(remote))
         {
-          // the remote guy's intro
-          Introduction replyIntro;
-          SharedSecret K;
-          const auto tag = *maybe;
-
-          if (not GetCachedSessionKeyFor(tag, K))
-          {
-            LogError(Name(), " no cached key for inbound session from ", remote, " T=", tag);
-            return false;
-          }
-          if (not GetReplyIntroFor(tag, replyIntro))
-          {
-            LogError(Name(), "no reply intro for inbound session from ", remote, " T=", tag);
-            return false;
-          }
-          // get path for intro
-          auto p = GetPathByRouter(replyIntro.router);
-
-          if (not p)
-          {
-            LogWarn(
-                Name(),
-                " has no path for intro router ",
-                RouterID{replyIntro.router},
-                " for inbound convo T=",
-                tag);
-            return false;
-          }
-
-          f.T = tag;
-          // TODO: check expiration of our end
-          auto m = std::make_shared<ProtocolMessage>(f.T);
-          m->PutBuffer(data);
-          f.N.Randomize();
-          f.C.Zero();
-          f.R = 0;
-          transfer->Y.Randomize();
-          m->proto = t;
-          m->introReply = p->intro;
-          m->sender = m_Identity.pub;
-          if (auto maybe = GetSeqNoForConvo(f.T))
-          {
-            m->seqno = *maybe;
-          }
-          else
-          {
-            LogWarn(Name(), " could not set sequence number, no session T=", f.T);
-            return false;
-          }
-          f.S = m->seqno;
-          f.F = p->intro.pathID;
-          transfer->P = replyIntro.pathID;
-          auto self = this;
-          Router()->QueueWork([transfer, p, m, K, self]() {
-            if (not transfer->T.EncryptAndSign(*m, K, self->m_Identity))
-            {
-              LogError("failed to encrypt and sign for sessionn T=", transfer->T.T);
-              return;
-            }
-            self->m_SendQueue.tryPushBack(SendEvent_t{transfer, p});
-          });
-          return true;
+          std::vector<std::vector<byte_t>> payloads;
+          payloads.emplace_back(data.copy());
+          return SendToInboundConvo(*maybe, payloads, t);
         }
         else
         {
@@ -1942,6 +1931,132 @@ namespace llarp
       return true;
     }
 
+    bool
+    Endpoint::SendToInboundConvo(
+        ConvoTag tag, std::vector<std::vector<byte_t>>& payloads, ProtocolType t)
+    {
+      // the remote guy's intro
+      Introduction replyIntro;
+      SharedSecret K;
+
+      if (not GetCachedSessionKeyFor(tag, K))
+      {
+        LogError(Name(), " no cached key for inbound session T=", tag);
+        return false;
+      }
+      if (not GetReplyIntroFor(tag, replyIntro))
+      {
+        LogError(Name(), "no reply intro for inbound session T=", tag);
+        return false;
+      }
+      // get path for intro
+      auto p = GetPathByRouter(replyIntro.router);
+
+      if (not p)
+      {
+        LogWarn(
+            Name(),
+            " has no path for intro router ",
+            RouterID{replyIntro.router},
+            " for inbound convo T=",
+            tag);
+        return false;
+      }
+
+      using Transfer_t = std::pair<
+          std::shared_ptr<routing::PathTransferMessage>,
+          std::shared_ptr<ProtocolMessage>>;
+      std::vector<Transfer_t> transfers;
+      transfers.reserve(payloads.size());
+      for (auto& payload : payloads)
+      {
+        auto transfer = std::make_shared<routing::PathTransferMessage>();
+        ProtocolFrame& f = transfer->T;
+        f.T = tag;
+        // TODO: check expiration of our end
+        auto m = std::make_shared<ProtocolMessage>(f.T);
+        m->payload = std::move(payload);
+        f.N.Randomize();
+        f.C.Zero();
+        f.R = 0;
+        transfer->Y.Randomize();
+        m->proto = t;
+        m->introReply = p->intro;
+        m->sender = m_Identity.pub;
+        if (auto maybe = GetSeqNoForConvo(f.T))
+        {
+          m->seqno = *maybe;
+        }
+        else
+        {
+          LogWarn(Name(), " could not set sequence number, no session T=", f.T);
+          return false;
+        }
+        f.S = m->seqno;
+        f.F = p->intro.pathID;
+        transfer->P = replyIntro.pathID;
+        transfers.emplace_back(std::move(transfer), std::move(m));
+      }
+      auto self = this;
+      Router()->QueueWork([transfers = std::move(transfers), p, K, self]() {
+        bool queued = false;
+        for (const auto& [transfer, m] : transfers)
+        {
+          if (not transfer->T.EncryptAndSign(*m, K, self->m_Identity))
+          {
+            LogError("failed to encrypt and sign for sessionn T=", transfer->T.T);
+          }
+          else
+            queued |= self->m_SendQueue.tryPushBack(SendEvent_t{transfer, p})
+                == thread::QueueReturn::Success;
+          self->PayloadPool().Release(std::move(m->payload));
+        }
+        // only now is there something for the loop to send
+        if (queued)
+          self->Loop()->wakeup();
+      });
+      return true;
+    }
+
+    bool
+    Endpoint::SendManyToOrQueue(
+        ConvoTag tag, std::vector<std::vector<byte_t>>& payloads, ProtocolType t)
+    {
+      if (payloads.empty())
+        return true;
+      const auto maybe = GetEndpointWithConvoTag(tag);
+      const auto* remote = maybe ? std::get_if<Address>(&*maybe) : nullptr;
+      // snodes and ourselves take them one at a time
+      if (remote == nullptr or *remote == m_Identity.pub.Addr())
+        return EndpointBase::SendManyToOrQueue(tag, payloads, t);
+
+      std::optional<ConvoTag> inbound;
+      if (HasInboundConvo(*remote))
+        inbound = GetBestConvoTagFor(*remote);
+
+      std::shared_ptr<OutboundContext> outbound;
+      if (not inbound and WantsOutboundSession(*remote))
+      {
+        auto range = m_state->m_RemoteSessions.equal_range(*remote);
+        for (auto itr = range.first; itr != range.second and not outbound; ++itr)
+        {
+          if (itr->second->ReadyToSend())
+            outbound = itr->second;
+        }
+      }
+      // no session to send on yet, the single path knows how to queue them up until there is
+      if (not inbound and not outbound)
+        return EndpointBase::SendManyToOrQueue(tag, payloads, t);
+
+      bool sent = true;
+      if (inbound)
+        sent = SendToInboundConvo(*inbound, payloads, t);
+      else
+        outbound->AsyncEncryptAndSendTo(payloads, t);
+      payloads.clear();
+      return sent;
+    }
+
     bool
     Endpoint::SendToOrQueue(
         const std::variant<Address, RouterID>& addr, const llarp_buffer_t& data, ProtocolType t)
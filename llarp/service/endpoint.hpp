@@ -69,6 +69,11 @@ namespace llarp
       bool
       IsReady() const;
 
+      /// call hook(true) once we are ready, right away if we already are. hook(false) if we are
+      /// still not ready once timeout has passed
+      void
+      CallWhenReady(std::function<void(bool)> hook, llarp_time_t timeout);
+
       void
       QueueRecvData(RecvDataEvent ev) override;
 
@@ -195,7 +200,8 @@ namespace llarp
       void
       SetAuthInfoForEndpoint(Address remote, AuthInfo info);
 
-      virtual huint128_t ObtainIPForAddr(std::variant<Address, RouterID>) = 0;
+      /// get the ip mapped to an address, mapping it if needed, nullopt if we have none to give
+      virtual std::optional<huint128_t> ObtainIPForAddr(std::variant<Address, RouterID>) = 0;
 
       /// get a key for ip address
       virtual std::optional<std::variant<service::Address, RouterID>>
@@ -387,7 +393,10 @@ namespace llarp
       GetConvoTagsForService(const Address& si, std::set<ConvoTag>& tag) const override;
 
       void
-      PutNewOutboundContext(const IntroSet& introset, llarp_time_t timeLeftToAlign);
+      PutNewOutboundContext(
+          const IntroSet& introset,
+          llarp_time_t timeLeftToAlign,
+          tracing::StageTimer trace = {});
 
       std::optional<uint64_t>
       GetSeqNoForConvo(const ConvoTag& tag);
@@ -430,6 +439,12 @@ namespace llarp
       bool
       SendToOrQueue(ConvoTag tag, const llarp_buffer_t& payload, ProtocolType t) override;
 
+      // Same as above for a run of payloads, which share the convo lookup, the path and a single
+      // trip to the worker threads to be encrypted
+      bool
+      SendManyToOrQueue(
+          ConvoTag tag, std::vector<std::vector<byte_t>>& payloads, ProtocolType t) override;
+
       // Send a to (or queues for sending) to either an address or router id
       bool
       SendToOrQueue(
@@ -470,9 +485,17 @@ namespace llarp
       PrefetchServicesByTag(const Tag& tag);
 
      private:
+      /// run the ready hooks if we are ready, give up on the ones that have waited too long
+      void
+      RunReadyHooks(llarp_time_t now);
+
       void
       HandleVerifyGotRouter(dht::GotRouterMessage_constptr msg, RouterID id, bool valid);
 
+      // Sends payloads over an inbound convo, using the reply intro the remote gave us
+      bool
+      SendToInboundConvo(ConvoTag tag, std::vector<std::vector<byte_t>>& payloads, ProtocolType t);
+
       bool
       OnLookup(
           const service::Address& addr,
@@ -505,6 +528,8 @@ namespace llarp
       hooks::Backend_ptr m_OnUp;
       hooks::Backend_ptr m_OnDown;
       hooks::Backend_ptr m_OnReady;
+      /// waiting on CallWhenReady and when they give up
+      std::vector<std::pair<llarp_time_t, std::function<void(bool)>>> m_ReadyHooks;
       bool m_PublishIntroSet = true;
       std::unique_ptr<EndpointState> m_state;
       std::shared_ptr<IAuthPolicy> m_AuthPolicy;
@@ -10,6 +10,7 @@
 #include <llarp/util/compare_ptr.hpp>
 #include <llarp/util/decaying_hashtable.hpp>
 #include <llarp/util/status.hpp>
+#include <llarp/util/tracing.hpp>
 #include "lns_tracker.hpp"
 
 #include <memory>
@@ -47,6 +48,7 @@ namespace llarp
       SNodeSessions m_SNodeSessions;
 
       std::unordered_multimap<Address, PathEnsureHook> m_PendingServiceLookups;
+      SessionTraces m_SessionTraces;
       std::unordered_map<Address, llarp_time_t> m_LastServiceLookupTimes;
 
       std::unordered_map<RouterID, uint32_t> m_ServiceLookupFails;
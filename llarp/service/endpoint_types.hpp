@@ -5,6 +5,7 @@
 #include "session.hpp"
 #include <llarp/util/compare_ptr.hpp>
 #include <llarp/util/thread/queue.hpp>
+#include <llarp/util/tracing.hpp>
 
 #include <deque>
 #include <memory>
@@ -39,6 +40,10 @@ namespace llarp
 
     using PendingLookups = std::unordered_map<uint64_t, std::unique_ptr<IServiceLookup>>;
 
+    /// traces of sessions being set up, from the introset lookup until the outbound context
+    /// takes over
+    using SessionTraces = std::unordered_map<Address, tracing::StageTimer>;
+
     using Sessions = std::unordered_multimap<Address, std::shared_ptr<OutboundContext>>;
 
     using SNodeSessions = std::unordered_map<RouterID, std::shared_ptr<exit::BaseSession>>;
@@ -5,6 +5,8 @@
 #include "lookup.hpp"
 #include <llarp/util/logging/logger.hpp>
 
+#include <algorithm>
+
 namespace llarp
 {
   namespace service
@@ -56,6 +58,24 @@ namespace llarp
       }
     }
 
+    void
+    EndpointUtil::ExpireSessionTraces(SessionTraces& traces, const PendingLookups& lookups)
+    {
+      for (auto itr = traces.begin(); itr != traces.end();)
+      {
+        const auto& addr = itr->first;
+        if (std::any_of(lookups.begin(), lookups.end(), [&addr](const auto& item) {
+              return item.second->IsFor(addr);
+            }))
+        {
+          ++itr;
+          continue;
+        }
+        itr->second.Finish("abandoned");
+        itr = traces.erase(itr);
+      }
+    }
+
     void
     EndpointUtil::ExpirePendingRouterLookups(llarp_time_t now, PendingRouters& routers)
     {
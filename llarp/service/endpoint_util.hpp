@@ -14,6 +14,10 @@ namespace llarp
       static void
       ExpirePendingTx(llarp_time_t now, PendingLookups& lookups);
 
+      /// finish the traces of lookups that went away without reporting back
+      static void
+      ExpireSessionTraces(SessionTraces& traces, const PendingLookups& lookups);
+
       static void
       ExpirePendingRouterLookups(llarp_time_t now, PendingRouters& routers);
 
@@ -56,12 +56,14 @@ namespace llarp
 
     constexpr auto OutboundContextNumPaths = 2;
 
-    OutboundContext::OutboundContext(const IntroSet& introset, Endpoint* parent)
+    OutboundContext::OutboundContext(
+        const IntroSet& introset, Endpoint* parent, tracing::StageTimer trace)
         : path::Builder{parent->Router(), OutboundContextNumPaths, parent->numHops}
         , SendContext{introset.addressKeys, {}, this, parent}
         , location{introset.addressKeys.Addr().ToKey()}
         , addr{introset.addressKeys.Addr()}
         , currentIntroSet{introset}
+        , m_SessionTrace{std::move(trace)}
 
     {
       updatingIntroSet = false;
@@ -93,6 +95,9 @@ namespace llarp
         // if we have not made a handshake to the remote endpoint do so
         if (not IntroGenerated())
         {
+          if (not m_MarkedPathBuild)
+            m_SessionTrace.Mark("path_build");
+          m_MarkedPathBuild = true;
           KeepAlive();
         }
       }
@@ -251,6 +256,7 @@ namespace llarp
           t);
 
       ex->hook = [self = shared_from_this(), path](auto frame) {
+        self->m_SessionTrace.Mark("key_exchange");
         if (not self->Send(std::move(frame), path))
           return;
         self->m_Endpoint->Loop()->call_later(
@@ -391,6 +397,12 @@ namespace llarp
       if (not m_NextIntro.router.IsZero())
         m_Endpoint->EnsureRouterIsKnown(m_NextIntro.router);
 
+      if (m_SessionTrace and ReadyToSend())
+      {
+        m_SessionTrace.Mark("intro_sent");
+        m_SessionTrace.Finish("ready");
+      }
+
       if (ReadyToSend() and not m_ReadyHooks.empty())
       {
         const auto path = GetPathByRouter(remoteIntro.router);
@@ -433,6 +445,7 @@ namespace llarp
       {
         m_router->loop()->call_later(timeout, [this]() {
           LogWarn(Name(), " did not obtain session in time");
+          m_SessionTrace.Finish("timeout");
           for (const auto& hook : m_ReadyHooks)
             hook(nullptr);
           m_ReadyHooks.clear();
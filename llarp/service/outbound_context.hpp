@@ -3,6 +3,7 @@
 #include <llarp/path/pathbuilder.hpp>
 #include "sendcontext.hpp"
 #include <llarp/util/status.hpp>
+#include <llarp/util/tracing.hpp>
 
 #include <unordered_map>
 #include <unordered_set>
@@ -19,7 +20,9 @@ namespace llarp
                              public SendContext,
                              public std::enable_shared_from_this<OutboundContext>
     {
-      OutboundContext(const IntroSet& introSet, Endpoint* parent);
+      /// trace is the session setup so far, we carry it on until the session is ready
+      OutboundContext(
+          const IntroSet& introSet, Endpoint* parent, tracing::StageTimer trace = {});
 
       ~OutboundContext() override;
 
@@ -170,6 +173,9 @@ namespace llarp
       bool sentIntro = false;
       std::vector<std::function<void(OutboundContext*)>> m_ReadyHooks;
       llarp_time_t m_LastIntrosetUpdateAt = 0s;
+      tracing::StageTimer m_SessionTrace;
+      /// the path build stage ends at the first intro swap, later ones are not a new stage
+      bool m_MarkedPathBuild = false;
     };
   }  // namespace service
 
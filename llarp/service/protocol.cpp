@@ -198,6 +198,59 @@ namespace llarp
       return read;
     }
 
+    namespace
+    {
+      constexpr auto FrameKeys =
+          bencode::MakeKeyTable("A", "C", "D", "F", "N", "R", "S", "T", "V", "Z");
+      static_assert(FrameKeys.IsSorted());
+    }  // namespace
+
+    bool
+    ProtocolFrame::Decode(bencode::Reader& reader)
+    {
+      return bencode::ReadDict(reader, FrameKeys, [this](size_t key, bencode::Reader& r) {
+        std::string_view str;
+        switch (key)
+        {
+          case FrameKeys.Index("A"):
+            return r.ReadString(str) and str == "H";
+          case FrameKeys.Index("C"):
+            return r.ReadFixed(C);
+          case FrameKeys.Index("D"):
+            if (not r.ReadString(str) or str.size() > Encrypted_t::MaxSize)
+              return false;
+            D = llarp_buffer_t{str.data(), str.size()};
+            return true;
+          case FrameKeys.Index("F"):
+            return r.ReadFixed(F);
+          case FrameKeys.Index("N"):
+            return r.ReadFixed(N);
+          case FrameKeys.Index("R"):
+            return r.ReadInteger(R);
+          case FrameKeys.Index("S"):
+            return r.ReadInteger(S);
+          case FrameKeys.Index("T"):
+            return r.ReadFixed(T);
+          case FrameKeys.Index("V"):
+            return r.ReadInteger(version) and version == LLARP_PROTO_VERSION;
+          case FrameKeys.Index("Z"):
+            return r.ReadFixed(Z);
+          default:
+            return false;
+        }
+      });
+    }
+
+    bool
+    ProtocolFrame::BDecode(llarp_buffer_t* buf)
+    {
+      bencode::Reader reader{*buf};
+      if (not Decode(reader))
+        return false;
+      buf->cur += reader.Consumed();
+      return true;
+    }
+
     bool
     ProtocolFrame::DecryptPayloadInto(const SharedSecret& sharedkey, ProtocolMessage& msg) const
     {
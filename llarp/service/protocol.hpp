@@ -10,6 +10,7 @@
 #include "intro.hpp"
 #include "handler.hpp"
 #include <llarp/util/bencode.hpp>
+#include <llarp/util/bencode_reader.hpp>
 #include <llarp/util/time.hpp>
 #include <llarp/path/pathset.hpp>
 
@@ -140,10 +141,11 @@ namespace llarp
       BEncode(llarp_buffer_t* buf) const override;
 
       bool
-      BDecode(llarp_buffer_t* buf)
-      {
-        return bencode_decode_dict(*this, buf);
-      }
+      BDecode(llarp_buffer_t* buf);
+
+      /// decode a frame in one pass; D is copied as the frame usually outlives the buffer
+      bool
+      Decode(bencode::Reader& reader);
 
       void
       Clear() override
@@ -30,10 +30,13 @@ namespace llarp
     {
       if (not path->IsReady())
         return false;
+      auto transfer = std::make_shared<routing::PathTransferMessage>(*msg, remoteIntro.pathID);
+      if (m_SendQueue.tryPushBack(std::make_pair(std::move(transfer), path))
+          != thread::QueueReturn::Success)
+        return false;
+      // wake the flush once it has something to send
       m_FlushWakeup->Trigger();
-      return m_SendQueue.tryPushBack(std::make_pair(
-                 std::make_shared<routing::PathTransferMessage>(*msg, remoteIntro.pathID), path))
-          == thread::QueueReturn::Success;
+      return true;
     }
 
     void
@@ -73,14 +76,10 @@ namespace llarp
 
     /// send on an established convo tag
     void
-    SendContext::EncryptAndSendTo(const llarp_buffer_t& payload, ProtocolType t)
+    SendContext::EncryptAndSendTo(std::vector<std::vector<byte_t>>& payloads, ProtocolType t)
     {
       SharedSecret shared;
-      auto f = std::make_shared<ProtocolFrame>();
-      f->R = 0;
-      f->N.Randomize();
-      f->T = currentConvoTag;
-      f->S = ++sequenceNo;
+      const auto tag = currentConvoTag;
 
       auto path = m_PathSet->GetPathByRouter(remoteIntro.router);
       if (!path)
@@ -90,38 +89,57 @@ namespace llarp
         return;
       }
 
-      if (!m_DataHandler->GetCachedSessionKeyFor(f->T, shared))
+      if (!m_DataHandler->GetCachedSessionKeyFor(tag, shared))
       {
         LogWarn(
-            m_PathSet->Name(), " could not send, has no cached session key on session T=", f->T);
+            m_PathSet->Name(), " could not send, has no cached session key on session T=", tag);
         return;
       }
 
-      auto m = std::make_shared<ProtocolMessage>();
-      m_DataHandler->PutIntroFor(f->T, remoteIntro);
-      m_DataHandler->PutReplyIntroFor(f->T, path->intro);
-      m->proto = t;
-      if (auto maybe = m_Endpoint->GetSeqNoForConvo(f->T))
-      {
-        m->seqno = *maybe;
-      }
-      else
+      m_DataHandler->PutIntroFor(tag, remoteIntro);
+      m_DataHandler->PutReplyIntroFor(tag, path->intro);
+
+      using Frame_t = std::pair<std::shared_ptr<ProtocolFrame>, std::shared_ptr<ProtocolMessage>>;
+      std::vector<Frame_t> frames;
+      frames.reserve(payloads.size());
+      for (auto& payload : payloads)
       {
-        LogWarn(m_PathSet->Name(), " could not get sequence number for session T=", f->T);
-        return;
-      }
-      m->introReply = path->intro;
-      f->F = m->introReply.pathID;
-      m->sender = m_Endpoint->GetIdentity().pub;
-      m->tag = f->T;
-      m->PutBuffer(payload);
-      m_Endpoint->Router()->QueueWork([f, m, shared, path, this] {
-        if (not f->EncryptAndSign(*m, shared, m_Endpoint->GetIdentity()))
+        auto f = std::make_shared<ProtocolFrame>();
+        f->R = 0;
+        f->N.Randomize();
+        f->T = tag;
+        f->S = ++sequenceNo;
+
+        auto m = std::make_shared<ProtocolMessage>();
+        m->proto = t;
+        if (auto maybe = m_Endpoint->GetSeqNoForConvo(tag))
+        {
+          m->seqno = *maybe;
+        }
+        else
         {
-          LogError(m_PathSet->Name(), " failed to sign message");
+          LogWarn(m_PathSet->Name(), " could not get sequence number for session T=", tag);
           return;
         }
-        Send(f, path);
+        m->introReply = path->intro;
+        f->F = m->introReply.pathID;
+        m->sender = m_Endpoint->GetIdentity().pub;
+        m->tag = tag;
+        m->payload = std::move(payload);
+        frames.emplace_back(std::move(f), std::move(m));
+      }
+      // one trip to the workers for the lot, they go back out in the order we were given them
+      m_Endpoint->Router()->QueueWork([frames = std::move(frames), shared, path, this] {
+        for (const auto& [f, m] : frames)
+        {
+          if (not f->EncryptAndSign(*m, shared, m_Endpoint->GetIdentity()))
+          {
+            LogError(m_PathSet->Name(), " failed to sign message");
+          }
+          else
+            Send(f, path);
+          m_Endpoint->PayloadPool().Release(std::move(m->payload));
+        }
       });
     }
 
@@ -145,7 +163,9 @@ namespace llarp
     {
       if (IntroSent())
       {
-        EncryptAndSendTo(data, protocol);
+        std::vector<std::vector<byte_t>> payloads;
+        payloads.emplace_back(data.copy());
+        EncryptAndSendTo(payloads, protocol);
         return;
       }
       // have we generated the initial intro but not sent it yet? bail here so we don't cause
@@ -170,6 +190,23 @@ namespace llarp
         AsyncGenIntro(data, protocol);
       }
     }
+
+    void
+    SendContext::AsyncEncryptAndSendTo(
+        std::vector<std::vector<byte_t>>& payloads, ProtocolType protocol)
+    {
+      if (IntroSent())
+      {
+        EncryptAndSendTo(payloads, protocol);
+        return;
+      }
+      // the handshake has to go out first, let the single packet path deal with that
+      for (auto& payload : payloads)
+      {
+        AsyncEncryptAndSendTo(llarp_buffer_t{payload}, protocol);
+        m_Endpoint->PayloadPool().Release(std::move(payload));
+      }
+    }
   }  // namespace service
 
 }  // namespace llarp
@@ -25,6 +25,10 @@ namespace llarp
       void
       AsyncEncryptAndSendTo(const llarp_buffer_t& payload, ProtocolType t);
 
+      /// send a run of payloads in order, once the session is up they are encrypted together
+      void
+      AsyncEncryptAndSendTo(std::vector<std::vector<byte_t>>& payloads, ProtocolType t);
+
       /// queue send a fully encrypted hidden service frame
       /// via a path
       bool
@@ -84,7 +88,7 @@ namespace llarp
       IntroSent() const = 0;
 
       void
-      EncryptAndSendTo(const llarp_buffer_t& payload, ProtocolType t);
+      EncryptAndSendTo(std::vector<std::vector<byte_t>>& payloads, ProtocolType t);
 
       virtual void
       AsyncGenIntro(const llarp_buffer_t& payload, ProtocolType t) = 0;
@@ -10,11 +10,14 @@ namespace tooling
   {
     std::vector<llarp::path::PathHopConfig> hops;
     llarp::PathID_t pathid;
+    /// id of the path's build trace, 0 if it is not traced
+    uint64_t traceID;
 
     PathAttemptEvent(const llarp::RouterID& routerID, std::shared_ptr<const llarp::path::Path> path)
         : RouterEvent("PathAttemptEvent", routerID, false)
         , hops(path->hops)
         , pathid(path->hops[0].rxID)
+        , traceID(path->buildTrace.ID())
     {}
 
     std::string
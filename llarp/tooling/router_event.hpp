@@ -2,6 +2,7 @@
 
 #include <llarp/router_id.hpp>
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include <memory>
@@ -49,6 +50,9 @@ namespace tooling
     llarp::RouterID routerID;
 
     bool triggered = false;
+
+    /// when the event happened, so timings don't depend on how often the hive is polled
+    const std::chrono::steady_clock::time_point timestamp = std::chrono::steady_clock::now();
   };
 
   using RouterEventPtr = std::unique_ptr<RouterEvent>;
@@ -21,6 +21,12 @@ namespace tooling
     opts.isSNode = isSNode;
 
     Context_ptr context = std::make_shared<HiveContext>(this);
+    if (network)
+    {
+      const auto queueSize = std::max(llarp::event_loop_queue_size, config->router.m_JobQueueSize);
+      context->loop =
+          std::make_shared<llarp::vnet::Loop>(llarp::EventLoop::create(queueSize), network);
+    }
     context->Configure(config);
     context->Setup(opts);
 
@@ -4,6 +4,7 @@
 
 #include <llarp.hpp>
 #include <config/config.hpp>
+#include <ev/ev_vnet.hpp>
 #include <tooling/hive_context.hpp>
 
 #include <vector>
@@ -88,6 +89,9 @@ namespace tooling
 
     std::vector<std::thread> routerMainThreads;
 
+    /// when set routers added after are put on this virtual network instead of real sockets
+    std::shared_ptr<llarp::vnet::Network> network;
+
     std::mutex eventQueueMutex;
     std::deque<RouterEventPtr> eventQueue;
   };
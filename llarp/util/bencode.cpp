@@ -1,8 +1,10 @@
 #include "bencode.hpp"
 #include <llarp/util/logging/logger.hpp>
+#include <algorithm>
 #include <cstdlib>
 #include <cinttypes>
 #include <cstdio>
+#include <cstring>
 
 bool
 bencode_read_integer(struct llarp_buffer_t* buffer, uint64_t* result)
@@ -64,27 +66,47 @@ bencode_read_string(llarp_buffer_t* buffer, llarp_buffer_t* result)
   return true;
 }
 
+namespace
+{
+  /// decimal digits of i at the end of out, returns where they start. we write a lot of these so
+  /// we keep printf out of it.
+  char*
+  format_uint64(uint64_t i, char* end)
+  {
+    do
+    {
+      *--end = '0' + (i % 10);
+      i /= 10;
+    } while (i);
+    return end;
+  }
+}  // namespace
+
 bool
 bencode_write_bytestring(llarp_buffer_t* buff, const void* data, size_t sz)
 {
-  if (!buff->writef("%zu:", sz))
-  {
+  char numbuf[21];
+  char* const end = numbuf + sizeof(numbuf);
+  char* const digits = format_uint64(sz, end - 1);
+  end[-1] = ':';
+  if (buff->size_left() < static_cast<size_t>(end - digits) + sz)
     return false;
-  }
-  return buff->write(reinterpret_cast<const char*>(data), reinterpret_cast<const char*>(data) + sz);
+  buff->cur = std::copy(digits, end, buff->cur);
+  if (sz)
+    std::memcpy(buff->cur, data, sz);
+  buff->cur += sz;
+  return true;
 }
 
 bool
 bencode_write_uint64(llarp_buffer_t* buff, uint64_t i)
 {
-  if (!buff->writef("i%" PRIu64, i))
-  {
-    return false;
-  }
-
-  static const char letter[1] = {'e'};
-  assert(std::distance(std::begin(letter), std::end(letter)) == 1);
-  return buff->write(std::begin(letter), std::end(letter));
+  char numbuf[22];
+  char* const end = numbuf + sizeof(numbuf);
+  char* const digits = format_uint64(i, end - 1) - 1;
+  digits[0] = 'i';
+  end[-1] = 'e';
+  return buff->write(digits, end);
 }
 
 bool
@@ -9,6 +9,7 @@
 #include <type_traits>
 #include <fstream>
 #include <set>
+#include <string_view>
 #include <vector>
 
 namespace llarp
@@ -17,6 +18,33 @@ namespace llarp
   bool
   BEncodeReadList(List_t& result, llarp_buffer_t* buf);
 
+  /// how many decimal digits it takes to write i
+  constexpr size_t
+  BEncodeDigits(uint64_t i)
+  {
+    size_t digits = 1;
+    while (i >= 10)
+    {
+      i /= 10;
+      ++digits;
+    }
+    return digits;
+  }
+
+  /// how many bytes bencode_write_bytestring writes for sz bytes of data
+  constexpr size_t
+  BEncodeStringSize(size_t sz)
+  {
+    return BEncodeDigits(sz) + 1 + sz;
+  }
+
+  /// write bytes that are bencoded already, such as the constant keys of a fixed layout message
+  inline bool
+  BEncodeWriteRaw(std::string_view encoded, llarp_buffer_t* buf)
+  {
+    return buf->write(encoded.begin(), encoded.end());
+  }
+
   inline bool
   BEncodeWriteDictMsgType(llarp_buffer_t* buf, const char* k, const char* t)
   {
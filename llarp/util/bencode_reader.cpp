@@ -0,0 +1,172 @@
+#include "bencode_reader.hpp"
+
+namespace llarp::bencode
+{
+  namespace
+  {
+    bool
+    IsDigit(char ch)
+    {
+      return ch >= '0' and ch <= '9';
+    }
+  }  // namespace
+
+  bool
+  Reader::ReadString(std::string_view& str)
+  {
+    size_t pos = m_Pos;
+    if (pos >= m_Data.size() or not IsDigit(m_Data[pos]))
+      return false;
+    // no leading zeros, so every string has exactly one encoding
+    if (m_Data[pos] == '0' and pos + 1 < m_Data.size() and m_Data[pos + 1] != ':')
+      return false;
+    uint64_t len = 0;
+    while (pos < m_Data.size() and IsDigit(m_Data[pos]))
+    {
+      len = len * 10 + (m_Data[pos++] - '0');
+      if (len > m_Data.size())
+        return false;
+    }
+    if (pos >= m_Data.size() or m_Data[pos++] != ':')
+      return false;
+    if (len > m_Data.size() - pos)
+      return false;
+    str = m_Data.substr(pos, len);
+    m_Pos = pos + len;
+    return true;
+  }
+
+  bool
+  Reader::ReadInteger(uint64_t& i)
+  {
+    size_t pos = m_Pos;
+    if (pos >= m_Data.size() or m_Data[pos++] != 'i')
+      return false;
+    if (pos >= m_Data.size() or not IsDigit(m_Data[pos]))
+      return false;
+    if (m_Data[pos] == '0' and pos + 1 < m_Data.size() and m_Data[pos + 1] != 'e')
+      return false;
+    uint64_t val = 0;
+    while (pos < m_Data.size() and IsDigit(m_Data[pos]))
+    {
+      const uint64_t digit = m_Data[pos++] - '0';
+      if (val > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+        return false;
+      val = val * 10 + digit;
+    }
+    if (pos >= m_Data.size() or m_Data[pos++] != 'e')
+      return false;
+    i = val;
+    m_Pos = pos;
+    return true;
+  }
+
+  bool
+  Reader::EnterList()
+  {
+    if (Peek() != 'l')
+      return false;
+    ++m_Pos;
+    return true;
+  }
+
+  bool
+  Reader::EnterDict()
+  {
+    if (Peek() != 'd')
+      return false;
+    ++m_Pos;
+    return true;
+  }
+
+  bool
+  Reader::ReadEnd()
+  {
+    if (Peek() != 'e')
+      return false;
+    ++m_Pos;
+    return true;
+  }
+
+  bool
+  Reader::Skip()
+  {
+    return Skip(0);
+  }
+
+  bool
+  Reader::ReadRaw(std::string_view& raw)
+  {
+    const auto start = m_Pos;
+    if (not Skip())
+      return false;
+    raw = m_Data.substr(start, m_Pos - start);
+    return true;
+  }
+
+  bool
+  Reader::Skip(size_t depth)
+  {
+    if (depth > MaxDepth)
+      return false;
+    switch (Peek())
+    {
+      case 'i': {
+        // unlike ReadInteger this has to take negative numbers too
+        size_t pos = m_Pos + 1;
+        if (pos < m_Data.size() and m_Data[pos] == '-')
+          ++pos;
+        const size_t digits = pos;
+        while (pos < m_Data.size() and IsDigit(m_Data[pos]))
+          ++pos;
+        if (pos == digits or pos >= m_Data.size() or m_Data[pos] != 'e')
+          return false;
+        // no leading zeros and no "-0"
+        if (m_Data[digits] == '0' and (pos - digits > 1 or digits != m_Pos + 1))
+          return false;
+        m_Pos = pos + 1;
+        return true;
+      }
+      case 'l':
+        ++m_Pos;
+        while (not ReadEnd())
+        {
+          if (not Skip(depth + 1))
+            return false;
+        }
+        return true;
+      case 'd': {
+        ++m_Pos;
+        std::string_view key;
+        while (not ReadEnd())
+        {
+          if (not ReadString(key) or not Skip(depth + 1))
+            return false;
+        }
+        return true;
+      }
+      default: {
+        std::string_view str;
+        return ReadString(str);
+      }
+    }
+  }
+
+  bool
+  PeekDictInteger(Reader reader, std::string_view key, uint64_t& i)
+  {
+    if (not reader.EnterDict())
+      return false;
+    std::string_view k;
+    while (not reader.ReadEnd())
+    {
+      if (not reader.ReadString(k))
+        return false;
+      if (k == key)
+        return reader.ReadInteger(i);
+      if (not reader.Skip())
+        return false;
+    }
+    return false;
+  }
+}  // namespace llarp::bencode
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "buffer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace llarp::bencode
+{
+  /// how deep lists and dicts may nest before we give up on the input
+  constexpr size_t MaxDepth = 32;
+
+  /// single pass cursor over bencoded data. every read checks the input is well formed and hands
+  /// back views into the data instead of copies, so the data must outlive whatever is read.
+  class Reader
+  {
+   public:
+    explicit Reader(std::string_view data) : m_Data{data}
+    {}
+
+    /// reads from the current position of buf to its end
+    explicit Reader(const llarp_buffer_t& buf)
+        : m_Data{reinterpret_cast<const char*>(buf.cur), buf.size_left()}
+    {}
+
+    /// how many bytes we have read so far
+    size_t
+    Consumed() const
+    {
+      return m_Pos;
+    }
+
+    bool
+    Empty() const
+    {
+      return m_Pos >= m_Data.size();
+    }
+
+    /// the next byte without reading it, 0 when there is nothing left
+    char
+    Peek() const
+    {
+      return Empty() ? 0 : m_Data[m_Pos];
+    }
+
+    bool
+    ReadString(std::string_view& str);
+
+    bool
+    ReadInteger(uint64_t& i);
+
+    template <typename Int_t>
+    bool
+    ReadInteger(Int_t& i)
+    {
+      static_assert(std::is_unsigned_v<Int_t>);
+      uint64_t read_i;
+      if (not ReadInteger(read_i) or read_i > std::numeric_limits<Int_t>::max())
+        return false;
+      i = static_cast<Int_t>(read_i);
+      return true;
+    }
+
+    /// read a string that has to be exactly as long as out, e.g. an AlignedBuffer
+    template <typename Fixed_t>
+    bool
+    ReadFixed(Fixed_t& out)
+    {
+      std::string_view str;
+      if (not ReadString(str) or str.size() != out.size())
+        return false;
+      std::copy(str.begin(), str.end(), out.begin());
+      return true;
+    }
+
+    bool
+    EnterList();
+
+    bool
+    EnterDict();
+
+    /// consume the 'e' ending the list or dict we are in, false when it does not end here
+    bool
+    ReadEnd();
+
+    /// skip over the next value, checking it is well formed
+    bool
+    Skip();
+
+    /// skip over the next value and hand back all of its encoding
+    bool
+    ReadRaw(std::string_view& raw);
+
+   private:
+    bool
+    Skip(size_t depth);
+
+    std::string_view m_Data;
+    size_t m_Pos = 0;
+  };
+
+  /// the keys a message type knows about, sorted so lookups can bisect. meant to be constexpr so
+  /// decoders can switch over Index("k") at compile time.
+  template <size_t N>
+  struct KeyTable
+  {
+    std::array<std::string_view, N> keys;
+
+    constexpr bool
+    IsSorted() const
+    {
+      for (size_t idx = 1; idx < N; ++idx)
+      {
+        if (not(keys[idx - 1] < keys[idx]))
+          return false;
+      }
+      return true;
+    }
+
+    /// index of key, N when we do not know it
+    constexpr size_t
+    Find(std::string_view key) const
+    {
+      size_t lo = 0, hi = N;
+      while (lo < hi)
+      {
+        const size_t mid = (lo + hi) / 2;
+        if (keys[mid] < key)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      return lo < N and keys[lo] == key ? lo : N;
+    }
+
+    /// index of a key we know is in the table, does not compile when it is not
+    constexpr size_t
+    Index(std::string_view key) const
+    {
+      const auto idx = Find(key);
+      if (idx == N)
+        throw std::logic_error{"key not in table"};
+      return idx;
+    }
+  };
+
+  template <typename... Keys>
+  constexpr KeyTable<sizeof...(Keys)>
+  MakeKeyTable(Keys... keys)
+  {
+    return {{std::string_view{keys}...}};
+  }
+
+  /// read a dict whose keys all come from table, calling handler(index, reader) to read the value
+  /// of each. unknown and repeated keys fail the decode.
+  template <size_t N, typename Handler>
+  bool
+  ReadDict(Reader& reader, const KeyTable<N>& table, Handler&& handler)
+  {
+    static_assert(N <= 64, "too many keys to track which we have seen");
+    if (not reader.EnterDict())
+      return false;
+    uint64_t seen = 0;
+    std::string_view key;
+    while (not reader.ReadEnd())
+    {
+      if (not reader.ReadString(key))
+        return false;
+      const auto idx = table.Find(key);
+      if (idx == N or seen & (uint64_t{1} << idx))
+        return false;
+      seen |= uint64_t{1} << idx;
+      if (not handler(idx, reader))
+        return false;
+    }
+    return true;
+  }
+
+  /// find the integer value of key in the dict the reader is at without moving the reader
+  bool
+  PeekDictInteger(Reader reader, std::string_view key, uint64_t& i);
+
+  /// feed every entry of a dict to sink.DecodeKey for types that still decode through
+  /// llarp_buffer_t. each value is checked before the sink sees it and the sink only gets the
+  /// bytes of that value.
+  template <typename Sink>
+  bool
+  DecodeDictKeys(Reader& reader, Sink& sink)
+  {
+    if (not reader.EnterDict())
+      return false;
+    std::string_view key, value;
+    while (not reader.ReadEnd())
+    {
+      if (not reader.ReadString(key) or not reader.ReadRaw(value))
+        return false;
+      const llarp_buffer_t keybuf{key.data(), key.size()};
+      llarp_buffer_t valbuf{value.data(), value.size()};
+      if (not sink.DecodeKey(keybuf, &valbuf))
+        return false;
+    }
+    return true;
+  }
+}  // namespace llarp::bencode
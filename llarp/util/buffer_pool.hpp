@@ -0,0 +1,113 @@
+#pragma once
+
+#include "types.hpp"
+#include <llarp/util/thread/annotations.hpp>
+#include <llarp/util/thread/threading.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// keeps byte buffers we are done with around for reuse so steady traffic does not go to the
+    /// allocator for every message. spares are kept in power of two size classes from minSize up
+    /// to maxSize so small messages do not pin maxSize bytes each, and the spares held are bounded
+    /// by their total capacity rather than their count.
+    struct BufferPool
+    {
+      BufferPool(size_t minSize, size_t maxSize, size_t maxSpareBytes)
+          : m_MinSize{minSize}, m_MaxSize{maxSize}, m_MaxSpareBytes{maxSpareBytes}
+      {
+        for (size_t sz = m_MinSize; sz < m_MaxSize; sz *= 2)
+          m_ClassSizes.push_back(sz);
+        m_ClassSizes.push_back(m_MaxSize);
+        m_Free.resize(m_ClassSizes.size());
+      }
+
+      BufferPool(const BufferPool&) = delete;
+      BufferPool&
+      operator=(const BufferPool&) = delete;
+
+      /// get a cleared buffer with capacity for at least size bytes
+      std::vector<byte_t>
+      Acquire(size_t size = 0) EXCLUDES(m_Mutex)
+      {
+        std::vector<byte_t> buf;
+        if (size > m_MaxSize)
+        {
+          buf.reserve(size);
+          return buf;
+        }
+        size_t idx = 0;
+        while (m_ClassSizes[idx] < size)
+          ++idx;
+        {
+          // a bigger class will do if the one we want has no spares
+          Lock lock(m_Mutex);
+          for (auto cls = idx; cls < m_Free.size(); ++cls)
+          {
+            if (auto& spares = m_Free[cls]; not spares.empty())
+            {
+              buf = std::move(spares.back());
+              spares.pop_back();
+              m_SpareBytes -= buf.capacity();
+              return buf;
+            }
+          }
+        }
+        buf.reserve(m_ClassSizes[idx]);
+        return buf;
+      }
+
+      /// give a buffer back, it is freed if it is outside our size classes or we already hold
+      /// enough spare bytes
+      void
+      Release(std::vector<byte_t> buf) EXCLUDES(m_Mutex)
+      {
+        const auto cap = buf.capacity();
+        if (cap < m_MinSize or cap > m_MaxSize)
+          return;
+        // file it under the biggest class it can serve
+        size_t idx = m_ClassSizes.size() - 1;
+        while (m_ClassSizes[idx] > cap)
+          --idx;
+        buf.clear();
+        Lock lock(m_Mutex);
+        if (m_SpareBytes + cap > m_MaxSpareBytes)
+          return;
+        m_SpareBytes += cap;
+        m_Free[idx].emplace_back(std::move(buf));
+      }
+
+      /// number of spare buffers held
+      size_t
+      Spare() const EXCLUDES(m_Mutex)
+      {
+        Lock lock(m_Mutex);
+        size_t n = 0;
+        for (const auto& spares : m_Free)
+          n += spares.size();
+        return n;
+      }
+
+      /// total capacity of the spare buffers held
+      size_t
+      SpareBytes() const EXCLUDES(m_Mutex)
+      {
+        Lock lock(m_Mutex);
+        return m_SpareBytes;
+      }
+
+     private:
+      const size_t m_MinSize;
+      const size_t m_MaxSize;
+      const size_t m_MaxSpareBytes;
+      std::vector<size_t> m_ClassSizes;
+      mutable Mutex m_Mutex;
+      std::vector<std::vector<std::vector<byte_t>>> m_Free GUARDED_BY(m_Mutex);
+      size_t m_SpareBytes GUARDED_BY(m_Mutex) = 0;
+    };
+  }  // namespace util
+}  // namespace llarp
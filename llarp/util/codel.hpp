@@ -7,10 +7,13 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <functional>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace llarp
 {
@@ -50,9 +53,9 @@ namespace llarp
         return m_QueueIdx;
       }
 
-      template <typename... Args>
+      template <typename Pred, typename... Args>
       bool
-      EmplaceIf(std::function<bool(T&)> pred, Args&&... args) EXCLUDES(m_QueueMutex)
+      EmplaceIf(Pred&& pred, Args&&... args) EXCLUDES(m_QueueMutex)
       {
         Lock_t lock(m_QueueMutex);
         if (m_QueueIdx == MaxSize)
@@ -162,6 +165,256 @@ namespace llarp
       GetTime _getTime;
       PutTime _putTime;
       GetNow _getNow;
-    };  // namespace util
-  }     // namespace util
+    };
+
+    /// codel control law state, decides per dequeued item if it sat around for too long.
+    /// target is the sojourn time we tolerate, interval is how long we tolerate it being exceeded
+    /// before we start dropping.
+    struct CoDelControl
+    {
+      static constexpr llarp_time_t DefaultTarget = 5ms;
+      static constexpr llarp_time_t DefaultInterval = 100ms;
+
+      explicit CoDelControl(
+          llarp_time_t target = DefaultTarget, llarp_time_t interval = DefaultInterval)
+          : m_Target(target), m_Interval(interval)
+      {}
+
+      /// returns true if an item that waited for sojourn should be dropped at now
+      bool
+      ShouldDrop(llarp_time_t sojourn, llarp_time_t now)
+      {
+        if (sojourn < m_Target)
+        {
+          m_FirstAboveTime = 0s;
+          m_Dropping = false;
+          return false;
+        }
+        if (m_FirstAboveTime == 0s)
+        {
+          m_FirstAboveTime = now + m_Interval;
+          return false;
+        }
+        if (now < m_FirstAboveTime)
+          return false;
+        if (m_Dropping and now < m_DropNext)
+          return false;
+        m_DropCount = m_Dropping ? m_DropCount + 1 : 1;
+        m_Dropping = true;
+        const auto backoff = m_Interval / std::sqrt(static_cast<double>(m_DropCount));
+        m_DropNext = now + std::chrono::duration_cast<llarp_time_t>(backoff);
+        return true;
+      }
+
+     private:
+      llarp_time_t m_Target;
+      llarp_time_t m_Interval;
+      llarp_time_t m_FirstAboveTime = 0s;
+      llarp_time_t m_DropNext = 0s;
+      size_t m_DropCount = 0;
+      bool m_Dropping = false;
+    };
+
+    /// lock free ring for exactly one producer thread and one consumer thread.
+    /// the producer only ever touches the tail and the consumer only ever touches the head, so
+    /// neither side blocks the other and the consumer visits items without anything held.
+    template <typename T>
+    struct SPSCRing
+    {
+      /// capacity is rounded up to a power of 2
+      explicit SPSCRing(size_t capacity) : m_Slots(RoundUp(capacity)), m_Mask(m_Slots.size() - 1)
+      {}
+
+      SPSCRing(const SPSCRing&) = delete;
+      SPSCRing&
+      operator=(const SPSCRing&) = delete;
+
+      size_t
+      Capacity() const
+      {
+        return m_Slots.size();
+      }
+
+      /// approximate number of queued items, exact from either the producer or the consumer
+      size_t
+      Size() const
+      {
+        return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire);
+      }
+
+      /// producer side, build an item in the next free slot and publish it if commit(item)
+      /// returns true. returns false if we are full or commit refused the item.
+      template <typename Commit, typename... Args>
+      bool
+      EmplaceIf(Commit&& commit, Args&&... args)
+      {
+        const size_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_Head.load(std::memory_order_acquire) == m_Slots.size())
+          return false;
+        auto& slot = m_Slots[tail & m_Mask];
+        slot.emplace(std::forward<Args>(args)...);
+        if (not commit(*slot))
+        {
+          slot.reset();
+          return false;
+        }
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+      }
+
+      /// consumer side, visit everything that was queued when we were called until visit returns
+      /// false, the item it returned false for stays queued. the slots are handed back to the
+      /// producer in one go at the end.
+      template <typename Visit>
+      void
+      Consume(Visit visit)
+      {
+        size_t head = m_Head.load(std::memory_order_relaxed);
+        const size_t tail = m_Tail.load(std::memory_order_acquire);
+        if (head == tail)
+          return;
+        for (; head != tail; ++head)
+        {
+          auto& slot = m_Slots[head & m_Mask];
+          if (not visit(*slot))
+            break;
+          slot.reset();
+        }
+        m_Head.store(head, std::memory_order_release);
+      }
+
+     private:
+      static size_t
+      RoundUp(size_t n)
+      {
+        size_t sz = 1;
+        while (sz < n)
+          sz <<= 1;
+        return sz;
+      }
+
+      std::vector<std::optional<T>> m_Slots;
+      const size_t m_Mask;
+      /// head is only written by the consumer and tail by the producer, each on its own cache line
+      alignas(64) std::atomic<size_t> m_Head{0};
+      alignas(64) std::atomic<size_t> m_Tail{0};
+    };
+
+    /// lock free codel queue for exactly one producer thread and one consumer thread, a
+    /// SPSCRing with codel applied on the way out
+    template <typename T, typename GetTime, typename PutTime, typename GetNow = GetNowSyscall>
+    struct SPSCCoDelQueue
+    {
+      static constexpr size_t DefaultCapacity = 1024;
+
+      SPSCCoDelQueue(
+          std::string name,
+          PutTime put,
+          GetNow now,
+          size_t capacity = DefaultCapacity,
+          llarp_time_t target = CoDelControl::DefaultTarget,
+          llarp_time_t interval = CoDelControl::DefaultInterval)
+          : m_Ring(capacity)
+          , m_CoDel(target, interval)
+          , m_name(std::move(name))
+          , _putTime(std::move(put))
+          , _getNow(std::move(now))
+      {}
+
+      SPSCCoDelQueue(const SPSCCoDelQueue&) = delete;
+      SPSCCoDelQueue&
+      operator=(const SPSCCoDelQueue&) = delete;
+
+      /// how many items we can hold, capacity is rounded up to a power of 2
+      size_t
+      Capacity() const
+      {
+        return m_Ring.Capacity();
+      }
+
+      /// approximate number of queued items, exact from either the producer or the consumer
+      size_t
+      Size() const
+      {
+        return m_Ring.Size();
+      }
+
+      /// how many items we have dropped because they sat in the queue for too long
+      uint64_t
+      Dropped() const
+      {
+        return m_Dropped.load(std::memory_order_relaxed);
+      }
+
+      /// producer side, returns false if we are full or pred rejected the item
+      template <typename Pred, typename... Args>
+      bool
+      EmplaceIf(Pred&& pred, Args&&... args)
+      {
+        return m_Ring.EmplaceIf(
+            [this, &pred](T& item) {
+              if (not pred(item))
+                return false;
+              _putTime(item);
+              return true;
+            },
+            std::forward<Args>(args)...);
+      }
+
+      /// producer side, returns false if we are full
+      template <typename... Args>
+      bool
+      Emplace(Args&&... args)
+      {
+        return m_Ring.EmplaceIf(
+            [this](T& item) {
+              _putTime(item);
+              return true;
+            },
+            std::forward<Args>(args)...);
+      }
+
+      /// consumer side, visit everything that was queued when we were called
+      template <typename Visit>
+      void
+      Process(Visit v)
+      {
+        Process(v, [](T&) -> bool { return false; });
+      }
+
+      /// consumer side, visit everything that was queued when we were called, stopping early
+      /// when the filter returns true. the clock is read once for the whole batch.
+      template <typename Visit, typename Filter>
+      void
+      Process(Visit visitor, Filter f)
+      {
+        if (m_Ring.Size() == 0)
+          return;
+        const llarp_time_t now = _getNow();
+        m_Ring.Consume([&](T& item) {
+          if (f(item))
+            return false;
+          const llarp_time_t sojourn = now - _getTime(item);
+          if (m_CoDel.ShouldDrop(sojourn, now))
+          {
+            LogDebug(m_name, " dropping item after ", sojourn);
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+          }
+          else
+            visitor(item);
+          return true;
+        });
+      }
+
+     private:
+      SPSCRing<T> m_Ring;
+      /// only touched by the consumer
+      CoDelControl m_CoDel;
+      alignas(64) std::atomic<uint64_t> m_Dropped{0};
+      std::string m_name;
+      GetTime _getTime;
+      PutTime _putTime;
+      GetNow _getNow;
+    };
+  }  // namespace util
 }  // namespace llarp
@@ -0,0 +1,273 @@
+#pragma once
+
+#include "codel.hpp"
+#include "status.hpp"
+
+#include <deque>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// flow queueing codel (rfc 8290). items are hashed into a fixed set of flows, each with its
+    /// own fifo and codel state, which are served by deficit round robin with flows that just
+    /// became active going first. a bulk flow can only build a standing queue for itself and
+    /// sparse interactive flows skip ahead of it.
+    ///
+    /// there is exactly one producer thread and one consumer thread. the producer only appends to
+    /// a lock free SPSCRing; classification, scheduling and the visitor all run on the consumer
+    /// side with nothing held.
+    template <
+        typename T,
+        typename GetTime,
+        typename PutTime,
+        typename GetFlow,
+        typename GetSize,
+        typename GetNow = GetNowSyscall>
+    struct FQCoDelQueue
+    {
+      static constexpr size_t DefaultCapacity = 1024;
+      static constexpr size_t DefaultFlows = 1024;
+      /// bytes a flow may send per round
+      static constexpr size_t DefaultQuantum = 1514;
+
+      /// perturb seeds which flows share a bucket, random unless given
+      FQCoDelQueue(
+          std::string name,
+          PutTime put,
+          GetNow now,
+          size_t capacity = DefaultCapacity,
+          size_t flows = DefaultFlows,
+          size_t quantum = DefaultQuantum,
+          llarp_time_t target = CoDelControl::DefaultTarget,
+          llarp_time_t interval = CoDelControl::DefaultInterval,
+          std::optional<uint64_t> perturb = std::nullopt)
+          : m_Capacity(capacity)
+          , m_Quantum(quantum)
+          , m_Perturb(perturb ? *perturb : std::random_device{}())
+          , m_Flows(flows, Flow{target, interval})
+          , m_Staged(capacity)
+          , m_name(std::move(name))
+          , _putTime(std::move(put))
+          , _getNow(std::move(now))
+      {}
+
+      FQCoDelQueue(const FQCoDelQueue&) = delete;
+      FQCoDelQueue&
+      operator=(const FQCoDelQueue&) = delete;
+
+      /// number of items queued, consumer side only
+      size_t
+      Size() const
+      {
+        return m_Queued;
+      }
+
+      /// producer side, returns false if we are full or pred rejected the item
+      template <typename Pred, typename... Args>
+      bool
+      EmplaceIf(Pred&& pred, Args&&... args)
+      {
+        return m_Staged.EmplaceIf(
+            [this, &pred](T& item) {
+              if (not pred(item))
+                return false;
+              _putTime(item);
+              return true;
+            },
+            std::forward<Args>(args)...);
+      }
+
+      /// producer side, returns false if we are full
+      template <typename... Args>
+      bool
+      Emplace(Args&&... args)
+      {
+        return m_Staged.EmplaceIf(
+            [this](T& item) {
+              _putTime(item);
+              return true;
+            },
+            std::forward<Args>(args)...);
+      }
+
+      /// consumer side, visit everything that is queued in fair order
+      template <typename Visit>
+      void
+      Process(Visit v)
+      {
+        Process(v, [](T&) -> bool { return false; });
+      }
+
+      /// consumer side, visit everything that is queued in fair order, stopping early when the
+      /// filter returns true. the clock is read once for the whole batch.
+      template <typename Visit, typename Filter>
+      void
+      Process(Visit visitor, Filter f)
+      {
+        m_Staged.Consume([this](T& item) {
+          Enqueue(std::move(item));
+          return true;
+        });
+
+        const llarp_time_t now = _getNow();
+        while (not(m_NewFlows.empty() and m_OldFlows.empty()))
+        {
+          const bool isNew = not m_NewFlows.empty();
+          auto& list = isNew ? m_NewFlows : m_OldFlows;
+          const size_t idx = list.front();
+          auto& flow = m_Flows[idx];
+          if (flow.deficit <= 0)
+          {
+            flow.deficit += m_Quantum;
+            list.pop_front();
+            m_OldFlows.push_back(idx);
+            continue;
+          }
+          if (flow.queue.empty())
+          {
+            list.pop_front();
+            // a new flow that emptied goes around once more so it cannot cut in line forever
+            if (isNew)
+              m_OldFlows.push_back(idx);
+            else
+              flow.listed = false;
+            continue;
+          }
+          auto& item = flow.queue.front();
+          const llarp_time_t sojourn = now - _getTime(item);
+          if (flow.codel.ShouldDrop(sojourn, now))
+          {
+            LogDebug(m_name, " dropping item from flow ", idx, " after ", sojourn);
+            ++flow.dropped;
+            Pop(flow);
+            continue;
+          }
+          if (f(item))
+            return;
+          const size_t sz = _getSize(item);
+          flow.deficit -= static_cast<int64_t>(sz);
+          flow.bytes += sz;
+          ++flow.sent;
+          visitor(item);
+          Pop(flow);
+        }
+      }
+
+      /// totals and per flow counters for every flow that ever saw traffic, consumer side only
+      util::StatusObject
+      ExtractStatus() const
+      {
+        util::StatusObject flows{};
+        uint64_t dropped = 0;
+        for (size_t idx = 0; idx < m_Flows.size(); ++idx)
+        {
+          const auto& flow = m_Flows[idx];
+          dropped += flow.dropped;
+          if (flow.sent == 0 and flow.dropped == 0 and flow.queue.empty())
+            continue;
+          flows[std::to_string(idx)] = util::StatusObject{
+              {"queued", flow.queue.size()},
+              {"sent", flow.sent},
+              {"bytes", flow.bytes},
+              {"dropped", flow.dropped},
+              {"active", flow.listed}};
+        }
+        return util::StatusObject{
+            {"queued", m_Queued},
+            {"dropped", dropped},
+            {"overflowDropped", m_OverflowDropped},
+            {"flows", flows}};
+      }
+
+     private:
+      struct Flow
+      {
+        Flow(llarp_time_t target, llarp_time_t interval) : codel(target, interval)
+        {}
+
+        std::deque<T> queue;
+        CoDelControl codel;
+        int64_t deficit = 0;
+        /// true while on either the new or the old list
+        bool listed = false;
+        uint64_t sent = 0;
+        uint64_t bytes = 0;
+        uint64_t dropped = 0;
+      };
+
+      void
+      Enqueue(T item)
+      {
+        const size_t idx = Bucket(_getFlow(item));
+        auto& flow = m_Flows[idx];
+        flow.queue.emplace_back(std::move(item));
+        ++m_Queued;
+        if (not flow.listed)
+        {
+          flow.listed = true;
+          flow.deficit = m_Quantum;
+          m_NewFlows.push_back(idx);
+        }
+        if (m_Queued > m_Capacity)
+          DropFromFattest();
+      }
+
+      void
+      Pop(Flow& flow)
+      {
+        flow.queue.pop_front();
+        --m_Queued;
+      }
+
+      /// over capacity, take the oldest item from the longest queue
+      void
+      DropFromFattest()
+      {
+        Flow* fattest = nullptr;
+        for (auto& flow : m_Flows)
+        {
+          if (fattest == nullptr or fattest->queue.size() < flow.queue.size())
+            fattest = &flow;
+        }
+        ++fattest->dropped;
+        ++m_OverflowDropped;
+        Pop(*fattest);
+      }
+
+      size_t
+      Bucket(uint64_t hash) const
+      {
+        // splitmix64 finalizer, perturbed per queue so remotes cannot aim for one bucket
+        hash ^= m_Perturb;
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+        return hash % m_Flows.size();
+      }
+
+      const size_t m_Capacity;
+      const int64_t m_Quantum;
+      const uint64_t m_Perturb;
+      std::vector<Flow> m_Flows;
+      /// indexes into m_Flows
+      std::deque<size_t> m_NewFlows;
+      std::deque<size_t> m_OldFlows;
+      size_t m_Queued = 0;
+      uint64_t m_OverflowDropped = 0;
+      /// where the producer leaves items for the consumer to classify
+      SPSCRing<T> m_Staged;
+      std::string m_name;
+      GetTime _getTime;
+      PutTime _putTime;
+      GetFlow _getFlow;
+      GetSize _getSize;
+      GetNow _getNow;
+    };
+  }  // namespace util
+}  // namespace llarp
@@ -0,0 +1,281 @@
+#include "async_logger.hpp"
+#include "logger.hpp"
+
+#include <llarp/util/thread/threading.hpp>
+
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <iterator>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace llarp
+{
+  namespace
+  {
+    /// how long the background thread sleeps when nobody pokes it
+    constexpr auto PollInterval = 10ms;
+
+    std::atomic<uint64_t> NextLoggerID{1};
+
+    /// the logger whose history we dump when we crash
+    std::atomic<const AsyncLogger*> CrashLogger{nullptr};
+
+    void
+    WriteAll(int fd, const char* data, size_t sz)
+    {
+      while (sz > 0)
+      {
+#ifdef _WIN32
+        const auto n = ::_write(fd, data, static_cast<unsigned int>(sz));
+#else
+        const auto n = ::write(fd, data, sz);
+#endif
+        if (n <= 0)
+          return;
+        data += n;
+        sz -= n;
+      }
+    }
+
+#ifndef _WIN32
+    constexpr int CrashSignals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+    struct sigaction OldCrashActions[std::size(CrashSignals)];
+
+    void
+    HandleCrash(int sig)
+    {
+      if (const auto* logger = CrashLogger.load())
+      {
+        constexpr std::string_view header = "\nlokinet crashed, last log records:\n";
+        WriteAll(2, header.data(), header.size());
+        logger->DumpHistory(2);
+      }
+      // put back whatever handled this before us and let it have the signal
+      for (size_t idx = 0; idx < std::size(CrashSignals); ++idx)
+      {
+        if (CrashSignals[idx] == sig)
+          ::sigaction(sig, &OldCrashActions[idx], nullptr);
+      }
+      ::raise(sig);
+    }
+#endif
+  }  // namespace
+
+  AsyncLogger::AsyncLogger(LogContext& ctx, size_t historySize)
+      : m_Context{ctx}
+      , m_ID{NextLoggerID++}
+      , m_HistorySize{historySize}
+      , m_History{std::make_unique<std::array<char, HistoryLineSize>[]>(historySize)}
+      , m_HistoryLen{std::make_unique<size_t[]>(historySize)}
+  {
+    m_Thread = std::thread{[this]() { Run(); }};
+  }
+
+  AsyncLogger::~AsyncLogger()
+  {
+    const AsyncLogger* self = this;
+    CrashLogger.compare_exchange_strong(self, nullptr);
+    {
+      std::lock_guard<std::mutex> lock{m_WakeupMutex};
+      m_Stop = true;
+    }
+    m_Wakeup.notify_one();
+    if (m_Thread.joinable())
+      m_Thread.join();
+    Drain();
+  }
+
+  AsyncLogger::RingHolder::~RingHolder()
+  {
+    if (ring)
+      ring->abandoned = true;
+  }
+
+  AsyncLogger::Ring&
+  AsyncLogger::ThisThreadRing()
+  {
+    thread_local RingHolder holder;
+    if (holder.loggerID != m_ID or not holder.ring)
+    {
+      if (holder.ring)
+        holder.ring->abandoned = true;
+      holder.ring = std::make_shared<Ring>(thread_id_string());
+      holder.loggerID = m_ID;
+      std::lock_guard<std::mutex> lock{m_RingsMutex};
+      m_Rings.push_back(holder.ring);
+    }
+    return *holder.ring;
+  }
+
+  void
+  AsyncLogger::Flush()
+  {
+    // formatting a record might log, which must not wait on itself
+    if (std::this_thread::get_id() == m_Thread.get_id())
+      return;
+    std::unique_lock<std::mutex> lock{m_WakeupMutex};
+    if (m_Stop)
+      return;
+    const auto ticket = ++m_FlushRequested;
+    m_Wakeup.notify_one();
+    m_Flushed.wait(lock, [this, ticket]() { return m_FlushDone >= ticket; });
+  }
+
+  void
+  AsyncLogger::Run()
+  {
+    util::SetThreadName("llarp-logger");
+    std::unique_lock<std::mutex> lock{m_WakeupMutex};
+    while (true)
+    {
+      m_Wakeup.wait_for(
+          lock, PollInterval, [this]() { return m_Stop or m_FlushRequested != m_FlushDone; });
+      const bool stop = m_Stop;
+      const auto flushing = m_FlushRequested;
+      lock.unlock();
+      Drain();
+      lock.lock();
+      m_FlushDone = flushing;
+      m_Flushed.notify_all();
+      if (stop)
+        return;
+    }
+  }
+
+  size_t
+  AsyncLogger::Drain()
+  {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+      std::lock_guard<std::mutex> lock{m_RingsMutex};
+      rings = m_Rings;
+    }
+
+    struct Pending
+    {
+      Ring* ring;
+      Record* record;
+    };
+    std::vector<Pending> batch;
+    std::vector<size_t> ends(rings.size());
+    for (size_t idx = 0; idx < rings.size(); ++idx)
+    {
+      auto& ring = *rings[idx];
+      const size_t head = ring.head.load(std::memory_order_relaxed);
+      ends[idx] = ring.tail.load(std::memory_order_acquire);
+      for (size_t pos = head; pos != ends[idx]; ++pos)
+        batch.push_back({&ring, &ring.records[pos % RingSize]});
+    }
+
+    // every ring is in order on its own, merge them so the log reads in the order things happened
+    std::stable_sort(batch.begin(), batch.end(), [](const auto& lhs, const auto& rhs) {
+      return lhs.record->at < rhs.record->at;
+    });
+    std::ostringstream ss;
+    if (not batch.empty())
+    {
+      std::lock_guard<std::mutex> lock{m_WriteMutex};
+      for (const auto& pending : batch)
+      {
+        auto& rec = *pending.record;
+        ss.str("");
+        rec.format(ss, rec.args);
+        rec.destroy(rec.args);
+        WriteNow(rec.level, rec.fname, rec.lineno, rec.at, pending.ring->threadID, ss.str());
+      }
+    }
+
+    // only now can the producers reuse the slots
+    for (size_t idx = 0; idx < rings.size(); ++idx)
+      rings[idx]->head.store(ends[idx], std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock{m_RingsMutex};
+    m_Rings.erase(
+        std::remove_if(
+            m_Rings.begin(),
+            m_Rings.end(),
+            [](const auto& ring) {
+              return ring->abandoned
+                  and ring->head.load(std::memory_order_relaxed)
+                  == ring->tail.load(std::memory_order_acquire);
+            }),
+        m_Rings.end());
+    return batch.size();
+  }
+
+  void
+  AsyncLogger::WriteNow(
+      LogLevel lvl,
+      const char* fname,
+      int lineno,
+      std::chrono::steady_clock::time_point at,
+      const std::string& threadID,
+      const std::string& msg)
+  {
+    const LogRecordOrigin origin{
+        threadID,
+        std::chrono::duration_cast<Duration_t>(std::chrono::steady_clock::now() - at)};
+
+    CurrentLogOrigin = &origin;
+    if (m_Context.logStream)
+      m_Context.logStream->AppendLog(lvl, fname, lineno, m_Context.nodeName, msg);
+    CurrentLogOrigin = nullptr;
+
+    if (m_HistorySize == 0)
+      return;
+    const size_t slot = m_HistoryNext.load(std::memory_order_relaxed) % m_HistorySize;
+    auto& line = m_History[slot];
+    // "[NFO] llarp/router/router.cpp:123 msg\n" cut to fit the slot
+    const int prefix = std::snprintf(
+        line.data(),
+        line.size(),
+        "[%s] %s:%d ",
+        LogLevelToString(lvl).c_str(),
+        fname,
+        lineno);
+    size_t len = std::min<size_t>(prefix > 0 ? prefix : 0, line.size() - 1);
+    const size_t body = std::min(msg.size(), line.size() - 1 - len);
+    std::memcpy(line.data() + len, msg.data(), body);
+    len += body;
+    line[len++] = '\n';
+    m_HistoryLen[slot] = len;
+    m_HistoryNext.fetch_add(1, std::memory_order_release);
+  }
+
+  void
+  AsyncLogger::DumpHistory(int fd) const
+  {
+    if (m_HistorySize == 0)
+      return;
+    const size_t next = m_HistoryNext.load(std::memory_order_acquire);
+    const size_t first = next > m_HistorySize ? next - m_HistorySize : 0;
+    for (size_t idx = first; idx < next; ++idx)
+    {
+      const size_t slot = idx % m_HistorySize;
+      WriteAll(fd, m_History[slot].data(), m_HistoryLen[slot]);
+    }
+  }
+
+  void
+  AsyncLogger::InstallCrashHandler()
+  {
+    CrashLogger = this;
+#ifndef _WIN32
+    static std::once_flag installed;
+    std::call_once(installed, []() {
+      struct sigaction action;
+      std::memset(&action, 0, sizeof(action));
+      action.sa_handler = &HandleCrash;
+      sigemptyset(&action.sa_mask);
+      for (size_t idx = 0; idx < std::size(CrashSignals); ++idx)
+        ::sigaction(CrashSignals[idx], &action, &OldCrashActions[idx]);
+    });
+#endif
+  }
+}  // namespace llarp
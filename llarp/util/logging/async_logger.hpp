@@ -0,0 +1,302 @@
+#pragma once
+
+#include "logger_internal.hpp"
+#include "loglevel.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  struct LogContext;
+
+  template <size_t sz>
+  struct AlignedBuffer;
+  template <typename UInt_t>
+  struct huint_t;
+  template <typename UInt_t>
+  struct nuint_t;
+  struct SockAddr;
+
+  namespace log_detail
+  {
+    template <typename T, typename = void>
+    struct is_aligned_buffer : std::false_type
+    {};
+
+    template <typename T>
+    struct is_aligned_buffer<T, std::void_t<decltype(T::SIZE)>>
+        : std::is_base_of<AlignedBuffer<T::SIZE>, T>
+    {};
+
+    template <typename T>
+    struct is_duration : std::false_type
+    {};
+
+    template <typename Rep, typename Period>
+    struct is_duration<std::chrono::duration<Rep, Period>> : std::true_type
+    {};
+
+    template <typename T>
+    struct is_net_int : std::false_type
+    {};
+
+    template <typename UInt_t>
+    struct is_net_int<huint_t<UInt_t>> : std::true_type
+    {};
+
+    template <typename UInt_t>
+    struct is_net_int<nuint_t<UInt_t>> : std::true_type
+    {};
+
+    /// types we keep a copy of and print later, they own everything they print; anything else
+    /// might point at memory that is gone by then so it is printed right away
+    template <typename T>
+    constexpr bool by_value_v = std::is_arithmetic_v<T> or std::is_enum_v<T>
+        or is_duration<T>::value or is_aligned_buffer<T>::value or is_net_int<T>::value
+        or std::is_same_v<T, SockAddr>;
+
+    /// const char arrays, in practice string literals, live for the whole program so we keep
+    /// the pointer; mutable arrays and char pointers might not and are copied
+    template <typename T>
+    constexpr bool is_literal_v = std::is_array_v<std::remove_reference_t<T>>
+        and std::is_same_v<std::remove_extent_t<std::remove_reference_t<T>>, const char>;
+
+    template <typename T>
+    using capture_t = std::conditional_t<
+        by_value_v<std::decay_t<T>> or is_literal_v<T>,
+        std::decay_t<T>,
+        std::string>;
+
+    template <typename T>
+    capture_t<T>
+    Capture(T&& arg)
+    {
+      using Plain_t = std::decay_t<T>;
+      if constexpr (by_value_v<Plain_t> or is_literal_v<T> or std::is_same_v<Plain_t, std::string>)
+        return std::forward<T>(arg);
+      else if constexpr (std::is_array_v<std::remove_reference_t<T>>)
+        return std::string{arg};
+      else if constexpr (std::is_same_v<Plain_t, std::string_view>)
+        return std::string{arg};
+      else if constexpr (std::is_same_v<Plain_t, const char*> or std::is_same_v<Plain_t, char*>)
+        return arg ? std::string{arg} : std::string{"(null)"};
+      else
+      {
+        std::ostringstream ss;
+        LogAppend(ss, std::forward<T>(arg));
+        return ss.str();
+      }
+    }
+
+    template <typename... TArgs>
+    std::string
+    FormatAll(TArgs&&... args)
+    {
+      std::ostringstream ss;
+      if constexpr (sizeof...(args) > 0)
+        LogAppend(ss, std::forward<TArgs>(args)...);
+      return ss.str();
+    }
+  }  // namespace log_detail
+
+  /// formats log statements off the thread that made them. every thread puts its records in a
+  /// ring of its own that one background thread drains, formats and hands to the log stream, so
+  /// the logging thread only pays for copying its arguments, and not even that for literals.
+  class AsyncLogger
+  {
+   public:
+    /// records each thread can have waiting, past that the thread waits for room
+    static constexpr size_t RingSize = 512;
+    /// room for captured arguments in a record, bigger argument lists are formatted up front
+    static constexpr size_t ArgsSize = 192;
+    /// longest formatted line kept for a crash dump
+    static constexpr size_t HistoryLineSize = 512;
+
+    /// historySize is how many formatted records we keep around for a crash dump
+    AsyncLogger(LogContext& ctx, size_t historySize);
+
+    /// formats whatever is still waiting before it returns
+    ~AsyncLogger();
+
+    template <typename... TArgs>
+    void
+    Push(LogLevel lvl, const char* fname, int lineno, TArgs&&... args)
+    {
+      using Captured_t = std::tuple<log_detail::capture_t<TArgs>...>;
+      if constexpr (sizeof(Captured_t) <= ArgsSize and alignof(Captured_t) <= RecordAlign)
+        Emplace<Captured_t>(lvl, fname, lineno, log_detail::Capture(std::forward<TArgs>(args))...);
+      else
+        Emplace<std::tuple<std::string>>(
+            lvl, fname, lineno, log_detail::FormatAll(std::forward<TArgs>(args)...));
+    }
+
+    /// block until everything pushed before the call went to the log stream
+    void
+    Flush();
+
+    /// run func while the background thread is not writing to the log stream, to swap it out
+    template <typename Func>
+    void
+    WhileNotWriting(Func&& func)
+    {
+      std::lock_guard<std::mutex> lock{m_WriteMutex};
+      func();
+    }
+
+    /// write the last records we formatted to fd, oldest first, using only async signal safe
+    /// calls so a crash handler can use it
+    void
+    DumpHistory(int fd) const;
+
+    /// dump the history to stderr when we crash
+    void
+    InstallCrashHandler();
+
+   private:
+    static constexpr size_t RecordAlign = alignof(std::max_align_t);
+
+    struct Record
+    {
+      LogLevel level;
+      int lineno;
+      const char* fname;
+      std::chrono::steady_clock::time_point at;
+      void (*format)(std::ostringstream&, void*);
+      void (*destroy)(void*);
+      alignas(RecordAlign) std::byte args[ArgsSize];
+    };
+
+    struct Ring
+    {
+      explicit Ring(std::string id) : threadID{std::move(id)}
+      {}
+
+      alignas(64) std::atomic<size_t> head{0};
+      alignas(64) std::atomic<size_t> tail{0};
+      const std::string threadID;
+      /// set once the owning thread exits, we drop the ring after draining it
+      std::atomic<bool> abandoned{false};
+      std::array<Record, RingSize> records;
+    };
+
+    /// owned by a thread_local, tells the logger when its thread goes away
+    struct RingHolder
+    {
+      std::shared_ptr<Ring> ring;
+      uint64_t loggerID = 0;
+
+      ~RingHolder();
+    };
+
+    Ring&
+    ThisThreadRing();
+
+    template <typename Tuple_t, typename... Captured>
+    void
+    Emplace(LogLevel lvl, const char* fname, int lineno, Captured&&... captured)
+    {
+      Ring& ring = ThisThreadRing();
+      const auto at = std::chrono::steady_clock::now();
+      const size_t tail = ring.tail.load(std::memory_order_relaxed);
+      size_t waiting = tail - ring.head.load(std::memory_order_acquire);
+      while (waiting >= RingSize)
+      {
+        // only the background thread itself can empty its ring, waiting on it would never end
+        if (std::this_thread::get_id() == m_Thread.get_id())
+          return;
+        // we are outrunning the background thread, slow down to its pace rather than drop
+        // records or print them out of order
+        m_Wakeup.notify_one();
+        std::this_thread::yield();
+        waiting = tail - ring.head.load(std::memory_order_acquire);
+      }
+      Record& rec = ring.records[tail % RingSize];
+      rec.level = lvl;
+      rec.lineno = lineno;
+      rec.fname = fname;
+      rec.at = at;
+      new (rec.args) Tuple_t{std::forward<Captured>(captured)...};
+      rec.format = &Format<Tuple_t>;
+      rec.destroy = &Destroy<Tuple_t>;
+      ring.tail.store(tail + 1, std::memory_order_release);
+      // the background thread polls, only poke it when a ring is filling up
+      if (waiting == RingSize / 2)
+        m_Wakeup.notify_one();
+    }
+
+    template <typename Tuple_t>
+    static void
+    Format(std::ostringstream& ss, void* ptr)
+    {
+      std::apply(
+          [&ss](auto&... args) {
+            if constexpr (sizeof...(args) > 0)
+              LogAppend(ss, args...);
+          },
+          *static_cast<Tuple_t*>(ptr));
+    }
+
+    template <typename Tuple_t>
+    static void
+    Destroy(void* ptr)
+    {
+      static_cast<Tuple_t*>(ptr)->~Tuple_t();
+    }
+
+    /// hand a formatted record to the log stream and remember it for a crash dump
+    void
+    WriteNow(
+        LogLevel lvl,
+        const char* fname,
+        int lineno,
+        std::chrono::steady_clock::time_point at,
+        const std::string& threadID,
+        const std::string& msg);
+
+    void
+    Run();
+
+    /// format everything waiting in every ring, returns how many records that was
+    size_t
+    Drain();
+
+    LogContext& m_Context;
+    /// generation of this logger, so threads notice a new one replacing an old one
+    const uint64_t m_ID;
+
+    std::mutex m_RingsMutex;
+    std::vector<std::shared_ptr<Ring>> m_Rings;
+
+    /// held while records go out to the log stream
+    std::mutex m_WriteMutex;
+
+    std::mutex m_WakeupMutex;
+    std::condition_variable m_Wakeup;
+    std::condition_variable m_Flushed;
+    uint64_t m_FlushRequested = 0;
+    uint64_t m_FlushDone = 0;
+    bool m_Stop = false;
+
+    const size_t m_HistorySize;
+    std::unique_ptr<std::array<char, HistoryLineSize>[]> m_History;
+    std::unique_ptr<size_t[]> m_HistoryLen;
+    std::atomic<size_t> m_HistoryNext{0};
+
+    std::thread m_Thread;
+  };
+}  // namespace llarp
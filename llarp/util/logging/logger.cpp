@@ -12,7 +12,9 @@
 
 #include <llarp/util/str.hpp>
 
+#include <algorithm>
 #include <stdexcept>
+#include <string_view>
 
 namespace llarp
 {
@@ -58,19 +60,128 @@ namespace llarp
   LogContext::DropToRuntimeLevel()
   {
     curLevel = runtimeLevel;
+    UpdateThreshold();
   }
 
   void
   LogContext::RevertRuntimeLevel()
   {
     curLevel = startupLevel;
+    UpdateThreshold();
+  }
+
+  namespace
+  {
+    /// "iwp" for "llarp/iwp/session.cpp", empty if the tag is not a path under a subsystem
+    std::string_view
+    SubsystemOf(std::string_view fname)
+    {
+      constexpr std::string_view prefix = "llarp/";
+      if (fname.substr(0, prefix.size()) == prefix)
+        fname.remove_prefix(prefix.size());
+      const auto slash = fname.find('/');
+      if (slash == std::string_view::npos)
+        return {};
+      return fname.substr(0, slash);
+    }
+  }  // namespace
+
+  bool
+  LogContext::ShouldLog(LogLevel lvl, const char* fname) const
+  {
+    const auto* levels = m_SubsystemLevels.load(std::memory_order_acquire);
+    if (levels == nullptr)
+      return lvl >= curLevel;
+    const auto itr = levels->find(SubsystemOf(fname));
+    return lvl >= (itr == levels->end() ? curLevel : itr->second);
+  }
+
+  void
+  LogContext::SetSubsystemLevel(const std::string& subsystem, std::optional<LogLevel> level)
+  {
+    std::lock_guard<std::mutex> lock{m_LevelsMutex};
+    const auto* current = m_SubsystemLevels.load(std::memory_order_relaxed);
+    auto levels = current ? std::make_unique<SubsystemLevels_t>(*current)
+                          : std::make_unique<SubsystemLevels_t>();
+    if (level)
+      (*levels)[subsystem] = *level;
+    else if (auto itr = levels->find(subsystem); itr != levels->end())
+      levels->erase(itr);
+    if (levels->empty())
+      m_SubsystemLevels.store(nullptr, std::memory_order_release);
+    else
+    {
+      m_SubsystemLevels.store(levels.get(), std::memory_order_release);
+      m_LevelsVersions.emplace_back(std::move(levels));
+    }
+    UpdateThreshold();
+  }
+
+  LogLevel
+  LogContext::GetSubsystemLevel(const std::string& subsystem) const
+  {
+    if (const auto* levels = m_SubsystemLevels.load(std::memory_order_acquire))
+    {
+      if (auto itr = levels->find(subsystem); itr != levels->end())
+        return itr->second;
+    }
+    return curLevel;
+  }
+
+  void
+  LogContext::UpdateThreshold()
+  {
+    LogLevel lowest = curLevel;
+    if (const auto* levels = m_SubsystemLevels.load(std::memory_order_acquire))
+    {
+      for (const auto& [subsystem, level] : *levels)
+        lowest = std::min(lowest, level);
+    }
+    LogThreshold = lowest;
+  }
+
+  void
+  LogContext::EnableAsync(size_t historySize)
+  {
+    std::lock_guard<std::mutex> lock{m_AsyncMutex};
+    if (m_Async)
+      return;
+    m_Async = std::make_unique<AsyncLogger>(*this, historySize);
+    if (historySize > 0)
+      m_Async->InstallCrashHandler();
+    async.store(m_Async.get(), std::memory_order_release);
+  }
+
+  ILogStream_ptr
+  LogContext::ReplaceStream(ILogStream_ptr stream)
+  {
+    auto* writer = async.load(std::memory_order_acquire);
+    if (writer == nullptr)
+    {
+      std::swap(logStream, stream);
+      return stream;
+    }
+    // whatever is still queued belongs to the old stream
+    writer->Flush();
+    writer->WhileNotWriting([this, &stream]() { std::swap(logStream, stream); });
+    return stream;
   }
 
   log_timestamp::log_timestamp() : log_timestamp("%c %Z")
   {}
 
+  namespace
+  {
+    /// how long ago the record being printed was made, zero unless it was queued
+    Duration_t
+    RecordAge()
+    {
+      return CurrentLogOrigin ? CurrentLogOrigin->age : 0ms;
+    }
+  }  // namespace
+
   log_timestamp::log_timestamp(const char* fmt)
-      : format{fmt}, now{llarp::time_now_ms()}, delta{llarp::uptime()}
+      : format{fmt}, now{llarp::time_now_ms() - RecordAge()}, delta{llarp::uptime() - RecordAge()}
   {}
 
   void
@@ -78,6 +189,7 @@ namespace llarp
   {
     LogContext::Instance().curLevel = lvl;
     LogContext::Instance().runtimeLevel = lvl;
+    LogContext::Instance().UpdateThreshold();
   }
 
   LogLevel
@@ -89,7 +201,10 @@ namespace llarp
   void
   LogContext::ImmediateFlush()
   {
-    logStream->ImmediateFlush();
+    if (auto* writer = async.load(std::memory_order_acquire))
+      writer->Flush();
+    if (logStream)
+      logStream->ImmediateFlush();
   }
 
   void
@@ -132,8 +247,7 @@ namespace llarp
           LogInfo("Switching logger to file ", file);
           std::cout << std::flush;
 
-          LogContext::Instance().logStream =
-              std::make_unique<FileLogStream>(io, logfile, 100ms, true);
+          ReplaceStream(std::make_unique<FileLogStream>(io, logfile, 100ms, true));
         }
         else
         {
@@ -145,8 +259,7 @@ namespace llarp
         LogInfo("Switching logger to JSON with file: ", file);
         std::cout << std::flush;
 
-        LogContext::Instance().logStream =
-            std::make_unique<JSONLogStream>(io, logfile, 100ms, logfile != stdout);
+        ReplaceStream(std::make_unique<JSONLogStream>(io, logfile, 100ms, logfile != stdout));
         break;
       case LogType::Syslog:
         if (logfile)
@@ -161,7 +274,7 @@ namespace llarp
 #else
         LogInfo("Switching logger to syslog");
         std::cout << std::flush;
-        LogContext::Instance().logStream = std::make_unique<SysLogStream>();
+        ReplaceStream(std::make_unique<SysLogStream>());
 #endif
         break;
     }
@@ -170,12 +283,12 @@ namespace llarp
   LogSilencer::LogSilencer() : LogSilencer(LogContext::Instance())
   {}
 
-  LogSilencer::LogSilencer(LogContext& ctx) : parent(ctx), stream(std::move(ctx.logStream))
+  LogSilencer::LogSilencer(LogContext& ctx) : parent(ctx), stream{parent.ReplaceStream(nullptr)}
   {}
 
   LogSilencer::~LogSilencer()
   {
-    parent.logStream = std::move(stream);
+    parent.ReplaceStream(std::move(stream));
   }
 
 }  // namespace llarp
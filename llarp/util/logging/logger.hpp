@@ -1,7 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 #include <llarp/util/time.hpp>
+#include "async_logger.hpp"
 #include "logstream.hpp"
 #include "logger_internal.hpp"
 
@@ -17,6 +24,16 @@ namespace llarp
   LogType
   LogTypeFromString(const std::string&);
 
+  /// the lowest level any subsystem logs at, kept up to date by LogContext so a disabled log
+  /// statement costs one load and one branch
+  inline std::atomic<LogLevel> LogThreshold{eLogInfo};
+
+  inline bool
+  LogEnabled(LogLevel lvl) noexcept
+  {
+    return lvl >= LogThreshold.load(std::memory_order_relaxed);
+  }
+
   struct LogContext
   {
     using IOFunc_t = std::function<void(void)>;
@@ -27,10 +44,40 @@ namespace llarp
     LogLevel runtimeLevel = eLogWarn;
     ILogStream_ptr logStream;
     std::string nodeName = "lokinet";
+    /// formats records on a background thread when set, see EnableAsync. once set it stays
+    /// until we are destroyed
+    std::atomic<AsyncLogger*> async{nullptr};
 
     static LogContext&
     Instance();
 
+    /// true if a record at lvl from the source file tagged fname should go out
+    bool
+    ShouldLog(LogLevel lvl, const char* fname) const;
+
+    /// log one subsystem at its own level, the subsystem being the directory under llarp/ its
+    /// code lives in (e.g. "iwp", "path", "dns"); nullopt puts it back on the global level
+    void
+    SetSubsystemLevel(const std::string& subsystem, std::optional<LogLevel> level);
+
+    /// level a subsystem logs at right now
+    LogLevel
+    GetSubsystemLevel(const std::string& subsystem) const;
+
+    /// format log records on a background thread from now on, keeping the last historySize of
+    /// them to dump to stderr if we crash
+    void
+    EnableAsync(size_t historySize);
+
+    /// put stream in place of the current log stream and hand back the old one, waiting for the
+    /// background thread to finish with it first
+    ILogStream_ptr
+    ReplaceStream(ILogStream_ptr stream);
+
+    /// recompute LogThreshold, call after touching curLevel directly
+    void
+    UpdateThreshold();
+
     void
     DropToRuntimeLevel();
 
@@ -56,6 +103,20 @@ namespace llarp
         const std::string& file,
         const std::string& nickname,
         std::function<void(IOFunc_t)> io);
+
+   private:
+    /// ordered so we can look up a string_view without making a string
+    using SubsystemLevels_t = std::map<std::string, LogLevel, std::less<>>;
+
+    /// null while no subsystem has its own level. writers swap in a whole new map under
+    /// m_LevelsMutex and keep the old ones in m_LevelsVersions, readers hold no reference to
+    /// them. levels are only set a handful of times in a run.
+    std::atomic<const SubsystemLevels_t*> m_SubsystemLevels{nullptr};
+    std::vector<std::unique_ptr<const SubsystemLevels_t>> m_LevelsVersions;
+    std::mutex m_LevelsMutex;
+
+    std::unique_ptr<AsyncLogger> m_Async;
+    std::mutex m_AsyncMutex;
   };
 
   /// RAII type to turn logging off
@@ -83,8 +144,13 @@ namespace llarp
   _log(LogLevel lvl, const char* fname, int lineno, TArgs&&... args) noexcept
   {
     auto& log = LogContext::Instance();
-    if (log.curLevel > lvl || log.logStream == nullptr)
+    if (not log.ShouldLog(lvl, fname) || log.logStream == nullptr)
       return;
+    if (auto* async = log.async.load(std::memory_order_acquire))
+    {
+      async->Push(lvl, fname, lineno, std::forward<TArgs>(args)...);
+      return;
+    }
     std::ostringstream ss;
     if constexpr (sizeof...(args) > 0)
       LogAppend(ss, std::forward<TArgs>(args)...);
@@ -95,22 +161,34 @@ namespace llarp
   _log_noop() noexcept
   {}
 
+  /// what the log macros expand to, one call so a log statement is a single expression that
+  /// also works written as llarp::LogInfo(...); the level is there so it is found from anywhere
+  inline void
+  LogStatement(LogLevel, bool) noexcept
+  {}
+
 }  // namespace llarp
 
-#define LogDebug(...) _log(llarp::eLogDebug, LOG_TAG, __LINE__, __VA_ARGS__)
-#define LogInfo(...) _log(llarp::eLogInfo, LOG_TAG, __LINE__, __VA_ARGS__)
-#define LogWarn(...) _log(llarp::eLogWarn, LOG_TAG, __LINE__, __VA_ARGS__)
-#define LogError(...) _log(llarp::eLogError, LOG_TAG, __LINE__, __VA_ARGS__)
+// the level check is inlined at the call site so a disabled statement never evaluates its
+// arguments; names are left unqualified (found through the level's namespace) so
+// llarp::LogInfo(...) keeps working
+#define LLARP_LOG_IF(lvl, tag, line, ...) \
+  LogStatement(lvl, LogEnabled(lvl) and (_log(lvl, tag, line, __VA_ARGS__), true))
+
+#define LogDebug(...) LLARP_LOG_IF(llarp::eLogDebug, LOG_TAG, __LINE__, __VA_ARGS__)
+#define LogInfo(...) LLARP_LOG_IF(llarp::eLogInfo, LOG_TAG, __LINE__, __VA_ARGS__)
+#define LogWarn(...) LLARP_LOG_IF(llarp::eLogWarn, LOG_TAG, __LINE__, __VA_ARGS__)
+#define LogError(...) LLARP_LOG_IF(llarp::eLogError, LOG_TAG, __LINE__, __VA_ARGS__)
 
-#define LogDebugTag(tag, ...) _log(llarp::eLogDebug, tag, __LINE__, __VA_ARGS__)
-#define LogInfoTag(tag, ...) _log(llarp::eLogInfo, tag, __LINE__, __VA_ARGS__)
-#define LogWarnTag(tag, ...) _log(llarp::eLogWarn, tag, __LINE__, __VA_ARGS__)
-#define LogErrorTag(tag, ...) _log(llarp::eLogError, tag, __LINE__, __VA_ARGS__)
+#define LogDebugTag(tag, ...) LLARP_LOG_IF(llarp::eLogDebug, tag, __LINE__, __VA_ARGS__)
+#define LogInfoTag(tag, ...) LLARP_LOG_IF(llarp::eLogInfo, tag, __LINE__, __VA_ARGS__)
+#define LogWarnTag(tag, ...) LLARP_LOG_IF(llarp::eLogWarn, tag, __LINE__, __VA_ARGS__)
+#define LogErrorTag(tag, ...) LLARP_LOG_IF(llarp::eLogError, tag, __LINE__, __VA_ARGS__)
 
-#define LogDebugExplicit(tag, line, ...) _log(llarp::eLogDebug, tag, line, __VA_ARGS__)
-#define LogInfoExplicit(tag, line, ...) _log(llarp::eLogInfo, tag, line __VA_ARGS__)
-#define LogWarnExplicit(tag, line, ...) _log(llarp::eLogWarn, tag, line, __VA_ARGS__)
-#define LogErrorExplicit(tag, line, ...) _log(llarp::eLogError, tag, line, __VA_ARGS__)
+#define LogDebugExplicit(tag, line, ...) LLARP_LOG_IF(llarp::eLogDebug, tag, line, __VA_ARGS__)
+#define LogInfoExplicit(tag, line, ...) LLARP_LOG_IF(llarp::eLogInfo, tag, line, __VA_ARGS__)
+#define LogWarnExplicit(tag, line, ...) LLARP_LOG_IF(llarp::eLogWarn, tag, line, __VA_ARGS__)
+#define LogErrorExplicit(tag, line, ...) LLARP_LOG_IF(llarp::eLogError, tag, line, __VA_ARGS__)
 
 // null-op Trace logging if this is a release build
 #ifdef NDEBUG
@@ -118,9 +196,9 @@ namespace llarp
 #define LogTraceTag(tag, ...) _log_noop()
 #define LogTraceExplicit(tag, line, ...) _log_noop()
 #else
-#define LogTrace(...) _log(llarp::eLogTrace, LOG_TAG, __LINE__, __VA_ARGS__)
-#define LogTraceTag(tag, ...) _log(llarp::eLogTrace, tag, __LINE__, __VA_ARGS__)
-#define LogTraceExplicit(tag, line, ...) _log(llarp::eLogTrace, tag, line, __VA_ARGS__)
+#define LogTrace(...) LLARP_LOG_IF(llarp::eLogTrace, LOG_TAG, __LINE__, __VA_ARGS__)
+#define LogTraceTag(tag, ...) LLARP_LOG_IF(llarp::eLogTrace, tag, __LINE__, __VA_ARGS__)
+#define LogTraceExplicit(tag, line, ...) LLARP_LOG_IF(llarp::eLogTrace, tag, line, __VA_ARGS__)
 #endif
 
 #ifndef LOG_TAG
@@ -32,9 +32,23 @@ namespace llarp
       LogAppend(ss, std::forward<TArgs>(args)...);
   }
 
+  /// where a record being formatted on the background logging thread came from
+  struct LogRecordOrigin
+  {
+    const std::string& threadID;
+    /// how long ago the record was made
+    Duration_t age;
+  };
+
+  /// set while the background logging thread formats a record, so log streams print the thread
+  /// and time of the statement rather than their own
+  inline thread_local const LogRecordOrigin* CurrentLogOrigin = nullptr;
+
   inline std::string
   thread_id_string()
   {
+    if (CurrentLogOrigin)
+      return CurrentLogOrigin->threadID;
     auto tid = std::this_thread::get_id();
     std::hash<std::thread::id> h;
     uint16_t id = h(tid) % 1000;
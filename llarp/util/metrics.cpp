@@ -0,0 +1,251 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace llarp::metrics
+{
+  uint64_t
+  Counter::Value() const
+  {
+    uint64_t total = 0;
+    for (const auto& shard : m_Shards)
+      total += shard.value.load(std::memory_order_relaxed);
+    return total;
+  }
+
+  Histogram::Histogram(std::vector<double> bounds) : m_Bounds{std::move(bounds)}
+  {
+    if (not std::is_sorted(m_Bounds.begin(), m_Bounds.end()))
+      throw std::invalid_argument{"histogram bounds are not in order"};
+    for (auto& shard : m_Shards)
+    {
+      shard.buckets = std::make_unique<std::atomic<uint64_t>[]>(m_Bounds.size() + 1);
+      for (size_t idx = 0; idx <= m_Bounds.size(); ++idx)
+        shard.buckets[idx].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void
+  Histogram::Observe(double val)
+  {
+    const size_t idx =
+        std::lower_bound(m_Bounds.begin(), m_Bounds.end(), val) - m_Bounds.begin();
+    auto& shard = m_Shards[ThreadShard()];
+    shard.buckets[idx].fetch_add(1, std::memory_order_relaxed);
+    // no fetch_add for doubles until c++20, the shard is all but ours so this rarely loops
+    double sum = shard.sum.load(std::memory_order_relaxed);
+    while (not shard.sum.compare_exchange_weak(sum, sum + val, std::memory_order_relaxed))
+      ;
+  }
+
+  Histogram::Snapshot
+  Histogram::Collect() const
+  {
+    Snapshot snap;
+    snap.buckets.resize(m_Bounds.size() + 1);
+    for (const auto& shard : m_Shards)
+    {
+      for (size_t idx = 0; idx <= m_Bounds.size(); ++idx)
+        snap.buckets[idx] += shard.buckets[idx].load(std::memory_order_relaxed);
+      snap.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    for (size_t idx = 1; idx < snap.buckets.size(); ++idx)
+      snap.buckets[idx] += snap.buckets[idx - 1];
+    snap.count = snap.buckets.back();
+    return snap;
+  }
+
+  std::vector<double>
+  Histogram::LatencyBounds()
+  {
+    return {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5,
+            1,      2.5,     5,      10};
+  }
+
+  Registry&
+  Registry::Instance()
+  {
+    static Registry registry;
+    return registry;
+  }
+
+  Registry::Series&
+  Registry::GetSeries(const std::string& name, const std::string& help, Type type, Labels labels)
+  {
+    auto itr = std::find_if(m_Families.begin(), m_Families.end(), [&name](const auto& family) {
+      return family->name == name;
+    });
+    if (itr == m_Families.end())
+    {
+      m_Families.emplace_back(new Family{name, help, type, {}});
+      itr = std::prev(m_Families.end());
+    }
+    else if ((*itr)->type != type)
+      throw std::invalid_argument{"metric " + name + " registered with another type"};
+
+    auto& series = (*itr)->series;
+    for (auto& s : series)
+    {
+      if (s.labels == labels)
+        return s;
+    }
+    series.emplace_back();
+    series.back().labels = std::move(labels);
+    return series.back();
+  }
+
+  Counter&
+  Registry::GetCounter(const std::string& name, const std::string& help, Labels labels)
+  {
+    std::lock_guard<std::mutex> lock{m_Access};
+    auto& series = GetSeries(name, help, Type::Counter, std::move(labels));
+    if (not series.counter)
+      series.counter = std::make_unique<Counter>();
+    return *series.counter;
+  }
+
+  Gauge&
+  Registry::GetGauge(const std::string& name, const std::string& help, Labels labels)
+  {
+    std::lock_guard<std::mutex> lock{m_Access};
+    auto& series = GetSeries(name, help, Type::Gauge, std::move(labels));
+    if (not series.gauge)
+      series.gauge = std::make_unique<Gauge>();
+    return *series.gauge;
+  }
+
+  Histogram&
+  Registry::GetHistogram(
+      const std::string& name,
+      const std::string& help,
+      std::vector<double> bounds,
+      Labels labels)
+  {
+    std::lock_guard<std::mutex> lock{m_Access};
+    auto& series = GetSeries(name, help, Type::Histogram, std::move(labels));
+    if (not series.histogram)
+      series.histogram = std::make_unique<Histogram>(std::move(bounds));
+    return *series.histogram;
+  }
+
+  namespace
+  {
+    void
+    WriteEscaped(std::ostream& out, const std::string& str)
+    {
+      for (const char ch : str)
+      {
+        if (ch == '\\')
+          out << "\\\\";
+        else if (ch == '"')
+          out << "\\\"";
+        else if (ch == '\n')
+          out << "\\n";
+        else
+          out << ch;
+      }
+    }
+
+    /// write {a="b",...} with an optional extra label tacked on the end, nothing if empty
+    void
+    WriteLabels(
+        std::ostream& out,
+        const Labels& labels,
+        const std::pair<std::string, std::string>* extra = nullptr)
+    {
+      if (labels.empty() and extra == nullptr)
+        return;
+      out << '{';
+      bool first = true;
+      auto write = [&](const auto& label) {
+        if (not first)
+          out << ',';
+        first = false;
+        out << label.first << "=\"";
+        WriteEscaped(out, label.second);
+        out << '"';
+      };
+      for (const auto& label : labels)
+        write(label);
+      if (extra)
+        write(*extra);
+      out << '}';
+    }
+
+    std::string
+    FormatBound(double bound)
+    {
+      std::ostringstream out;
+      out << bound;
+      return out.str();
+    }
+  }  // namespace
+
+  std::string
+  Registry::OpenMetrics() const
+  {
+    std::ostringstream out;
+    // sums should survive the round trip through text
+    out.precision(std::numeric_limits<double>::max_digits10);
+    std::lock_guard<std::mutex> lock{m_Access};
+    for (const auto& family : m_Families)
+    {
+      const auto& name = family->name;
+      switch (family->type)
+      {
+        case Type::Counter:
+          out << "# TYPE " << name << " counter\n";
+          break;
+        case Type::Gauge:
+          out << "# TYPE " << name << " gauge\n";
+          break;
+        case Type::Histogram:
+          out << "# TYPE " << name << " histogram\n";
+          break;
+      }
+      out << "# HELP " << name << ' ';
+      WriteEscaped(out, family->help);
+      out << '\n';
+
+      for (const auto& series : family->series)
+      {
+        if (series.counter)
+        {
+          out << name << "_total";
+          WriteLabels(out, series.labels);
+          out << ' ' << series.counter->Value() << '\n';
+        }
+        else if (series.gauge)
+        {
+          out << name;
+          WriteLabels(out, series.labels);
+          out << ' ' << series.gauge->Value() << '\n';
+        }
+        else if (series.histogram)
+        {
+          const auto snap = series.histogram->Collect();
+          const auto& bounds = series.histogram->Bounds();
+          for (size_t idx = 0; idx < snap.buckets.size(); ++idx)
+          {
+            const std::pair<std::string, std::string> le{
+                "le", idx < bounds.size() ? FormatBound(bounds[idx]) : "+Inf"};
+            out << name << "_bucket";
+            WriteLabels(out, series.labels, &le);
+            out << ' ' << snap.buckets[idx] << '\n';
+          }
+          out << name << "_sum";
+          WriteLabels(out, series.labels);
+          out << ' ' << snap.sum << '\n';
+          out << name << "_count";
+          WriteLabels(out, series.labels);
+          out << ' ' << snap.count << '\n';
+        }
+      }
+    }
+    out << "# EOF\n";
+    return out.str();
+  }
+}  // namespace llarp::metrics
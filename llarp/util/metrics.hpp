@@ -0,0 +1,185 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llarp::metrics
+{
+  /// label name/value pairs that tell apart the series of one metric
+  using Labels = std::vector<std::pair<std::string, std::string>>;
+
+  /// how many ways every metric is split, threads are spread over these so they hardly ever
+  /// write to the same cache line
+  constexpr size_t NumShards = 16;
+
+  /// the shard the calling thread writes to
+  inline size_t
+  ThreadShard()
+  {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t shard = next.fetch_add(1, std::memory_order_relaxed) % NumShards;
+    return shard;
+  }
+
+  /// a count that only goes up
+  class Counter
+  {
+   public:
+    void
+    Inc(uint64_t n = 1)
+    {
+      m_Shards[ThreadShard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /// sum of every shard, only consistent with itself once writers are quiet
+    uint64_t
+    Value() const;
+
+   private:
+    struct alignas(64) Shard
+    {
+      std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, NumShards> m_Shards;
+  };
+
+  /// a value that is set to whatever it currently is, like a queue depth
+  class Gauge
+  {
+   public:
+    void
+    Set(int64_t val)
+    {
+      m_Value.store(val, std::memory_order_relaxed);
+    }
+
+    void
+    Add(int64_t delta)
+    {
+      m_Value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    int64_t
+    Value() const
+    {
+      return m_Value.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<int64_t> m_Value{0};
+  };
+
+  /// a distribution of observed values over fixed buckets
+  class Histogram
+  {
+   public:
+    /// bounds are the inclusive upper edges of the buckets in ascending order, values above the
+    /// last one land in an implicit +Inf bucket
+    explicit Histogram(std::vector<double> bounds);
+
+    void
+    Observe(double val);
+
+    template <typename Rep, typename Period>
+    void
+    Observe(std::chrono::duration<Rep, Period> dlt)
+    {
+      Observe(std::chrono::duration<double>{dlt}.count());
+    }
+
+    struct Snapshot
+    {
+      /// cumulative count of observations at or under each bound, +Inf last
+      std::vector<uint64_t> buckets;
+      double sum = 0;
+      uint64_t count = 0;
+    };
+
+    Snapshot
+    Collect() const;
+
+    const std::vector<double>&
+    Bounds() const
+    {
+      return m_Bounds;
+    }
+
+    /// bounds for timing things that take somewhere between 100us and 10s
+    static std::vector<double>
+    LatencyBounds();
+
+   private:
+    struct alignas(64) Shard
+    {
+      std::atomic<double> sum{0};
+      std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+    };
+    const std::vector<double> m_Bounds;
+    std::array<Shard, NumShards> m_Shards;
+  };
+
+  /// every metric in the process; registering takes a lock, updating a metric never does
+  class Registry
+  {
+   public:
+    static Registry&
+    Instance();
+
+    /// get the counter called name with these labels, making it the first time it is asked for,
+    /// the reference stays good for the life of the process
+    Counter&
+    GetCounter(const std::string& name, const std::string& help, Labels labels = {});
+
+    Gauge&
+    GetGauge(const std::string& name, const std::string& help, Labels labels = {});
+
+    Histogram&
+    GetHistogram(
+        const std::string& name,
+        const std::string& help,
+        std::vector<double> bounds = Histogram::LatencyBounds(),
+        Labels labels = {});
+
+    /// render everything in the OpenMetrics text format, safe to call from any thread
+    std::string
+    OpenMetrics() const;
+
+   private:
+    enum class Type
+    {
+      Counter,
+      Gauge,
+      Histogram
+    };
+
+    struct Series
+    {
+      Labels labels;
+      std::unique_ptr<Counter> counter;
+      std::unique_ptr<Gauge> gauge;
+      std::unique_ptr<Histogram> histogram;
+    };
+
+    struct Family
+    {
+      std::string name;
+      std::string help;
+      Type type;
+      std::vector<Series> series;
+    };
+
+    Series&
+    GetSeries(const std::string& name, const std::string& help, Type type, Labels labels);
+
+    mutable std::mutex m_Access;
+    /// kept in registration order so the output is stable between scrapes
+    std::vector<std::unique_ptr<Family>> m_Families;
+  };
+}  // namespace llarp::metrics
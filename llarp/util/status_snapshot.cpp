@@ -0,0 +1,140 @@
+#include "status_snapshot.hpp"
+
+namespace llarp::util
+{
+  StatusSnapshot::StatusSnapshot(Duration_t maxAge) : m_MaxAge{maxAge}
+  {}
+
+  void
+  StatusSnapshot::Add(std::string name, Extractor_t extract)
+  {
+    std::lock_guard<std::mutex> lock{m_Access};
+    auto& entry = m_Entries.emplace_back();
+    entry.name = std::move(name);
+    entry.extract = std::move(extract);
+  }
+
+  void
+  StatusSnapshot::Invalidate(std::string_view subsystem)
+  {
+    std::lock_guard<std::mutex> lock{m_Access};
+    for (auto& entry : m_Entries)
+    {
+      if (entry.name == subsystem)
+        entry.dirty = true;
+    }
+  }
+
+  bool
+  StatusSnapshot::IsStale(const Entry& entry, Duration_t now) const
+  {
+    return entry.dirty or now >= entry.updated + m_MaxAge;
+  }
+
+  bool
+  StatusSnapshot::Stale(std::string_view subsystem, Duration_t now) const
+  {
+    std::lock_guard<std::mutex> lock{m_Access};
+    for (const auto& entry : m_Entries)
+    {
+      if ((subsystem.empty() or entry.name == subsystem) and IsStale(entry, now))
+        return true;
+    }
+    return false;
+  }
+
+  void
+  StatusSnapshot::Refresh(std::string_view subsystem, Duration_t now)
+  {
+    std::vector<size_t> stale;
+    {
+      std::lock_guard<std::mutex> lock{m_Access};
+      for (size_t idx = 0; idx < m_Entries.size(); ++idx)
+      {
+        auto& entry = m_Entries[idx];
+        if ((subsystem.empty() or entry.name == subsystem) and IsStale(entry, now))
+        {
+          stale.push_back(idx);
+          // cleared now so anything invalidating it while we extract is not lost
+          entry.dirty = false;
+        }
+      }
+    }
+    // the extractors can take a while, readers keep getting the old copy meanwhile
+    std::vector<StatusObject> fresh;
+    fresh.reserve(stale.size());
+    for (const auto idx : stale)
+      fresh.emplace_back(m_Entries[idx].extract());
+
+    std::lock_guard<std::mutex> lock{m_Access};
+    for (size_t n = 0; n < stale.size(); ++n)
+    {
+      auto& entry = m_Entries[stale[n]];
+      entry.updated = now;
+      if (entry.version > 0 and entry.status == fresh[n])
+        continue;
+      entry.status = std::move(fresh[n]);
+      entry.version = ++m_Version;
+    }
+  }
+
+  uint64_t
+  StatusSnapshot::Version() const
+  {
+    std::lock_guard<std::mutex> lock{m_Access};
+    return m_Version;
+  }
+
+  std::string_view
+  StatusSnapshot::Subsystem(std::string_view path)
+  {
+    if (path.empty() or path.front() != '/')
+      return {};
+    path.remove_prefix(1);
+    return path.substr(0, path.find('/'));
+  }
+
+  std::optional<StatusObject>
+  StatusSnapshot::Get(std::string_view path, uint64_t since) const
+  {
+    std::optional<StatusObject::json_pointer> pointer;
+    if (not path.empty())
+    {
+      try
+      {
+        pointer.emplace(std::string{path});
+      }
+      catch (StatusObject::exception&)
+      {
+        return std::nullopt;
+      }
+    }
+    const auto subsystem = Subsystem(path);
+
+    StatusObject status = StatusObject::object();
+    std::lock_guard<std::mutex> lock{m_Access};
+    bool found = subsystem.empty();
+    for (const auto& entry : m_Entries)
+    {
+      if (not subsystem.empty() and entry.name != subsystem)
+        continue;
+      found = true;
+      if (entry.version > since)
+        status[entry.name] = entry.status;
+    }
+    if (not found)
+      return std::nullopt;
+
+    // a subsystem left out as unchanged has nothing to look into
+    if (pointer and not subsystem.empty() and status.contains(std::string{subsystem}))
+    {
+      if (not status.contains(*pointer))
+        return std::nullopt;
+      StatusObject part;
+      part[*pointer] = std::move(status[*pointer]);
+      status = std::move(part);
+    }
+    status["version"] = m_Version;
+    return status;
+  }
+}  // namespace llarp::util
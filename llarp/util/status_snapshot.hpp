@@ -0,0 +1,77 @@
+#pragma once
+
+#include "status.hpp"
+#include "types.hpp"
+
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace llarp::util
+{
+  /// keeps the last status of each subsystem so rpc clients that poll for status read a cached
+  /// copy instead of having everything rebuilt on the event loop each time. a subsystem is
+  /// rebuilt once it is older than the max age or was invalidated, and only gets a new version
+  /// when its status actually changed, so pollers can ask for just what changed.
+  class StatusSnapshot
+  {
+   public:
+    using Extractor_t = std::function<StatusObject()>;
+
+    explicit StatusSnapshot(Duration_t maxAge);
+
+    /// add a subsystem whose status ends up under name; add them all before using the snapshot
+    void
+    Add(std::string name, Extractor_t extract);
+
+    /// have the next refresh rebuild subsystem however old it is, from any thread
+    void
+    Invalidate(std::string_view subsystem);
+
+    /// whether refreshing subsystem, or every subsystem when empty, would rebuild anything
+    bool
+    Stale(std::string_view subsystem, Duration_t now) const;
+
+    /// rebuild the stale parts of subsystem, or of every subsystem when empty. has to be called
+    /// where the extractors may read their state, i.e. on the event loop.
+    void
+    Refresh(std::string_view subsystem, Duration_t now);
+
+    /// the last version handed out, bumped whenever a subsystem changes
+    uint64_t
+    Version() const;
+
+    /// the cached status plus its "version". path is a json pointer such as "/links/outbound" to
+    /// only get that part of it, since leaves out subsystems that have not changed after that
+    /// version. nullopt when path is not in the status.
+    std::optional<StatusObject>
+    Get(std::string_view path = {}, uint64_t since = 0) const;
+
+    /// the subsystem a json pointer points into, empty for the root
+    static std::string_view
+    Subsystem(std::string_view path);
+
+   private:
+    struct Entry
+    {
+      std::string name;
+      Extractor_t extract;
+      StatusObject status;
+      uint64_t version = 0;
+      Duration_t updated{0};
+      bool dirty = true;
+    };
+
+    /// call with m_Access held
+    bool
+    IsStale(const Entry& entry, Duration_t now) const;
+
+    const Duration_t m_MaxAge;
+    mutable std::mutex m_Access;
+    std::vector<Entry> m_Entries;
+    uint64_t m_Version = 0;
+  };
+}  // namespace llarp::util
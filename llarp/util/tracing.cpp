@@ -0,0 +1,216 @@
+#include "tracing.hpp"
+#include "metrics.hpp"
+
+#include <llarp/util/logging/logger_internal.hpp>
+
+#include <algorithm>
+
+namespace llarp::tracing
+{
+  Tracer::Tracer() : m_Epoch{Clock_t::now()}
+  {}
+
+  Tracer&
+  Tracer::Instance()
+  {
+    static Tracer tracer;
+    return tracer;
+  }
+
+  Trace
+  Tracer::Start(const char* kind)
+  {
+    Trace trace;
+    trace.id = m_NextID.fetch_add(1, std::memory_order_relaxed);
+    const auto rate = m_SampleRate.load(std::memory_order_relaxed);
+    trace.sampled = rate > 0 and trace.id % rate == 0;
+    trace.kind = kind;
+    return trace;
+  }
+
+  void
+  Tracer::SetSampleRate(uint32_t oneIn)
+  {
+    m_SampleRate = oneIn;
+  }
+
+  metrics::Histogram&
+  Tracer::StageHistogram(const char* kind, const char* stage)
+  {
+    struct Seen
+    {
+      const char* kind;
+      const char* stage;
+      metrics::Histogram* histogram;
+    };
+    // there is only the one tracer and histograms live as long as the registry, so a thread's
+    // pointers stay good
+    thread_local std::vector<Seen> seen;
+    for (const auto& s : seen)
+    {
+      if (s.kind == kind and s.stage == stage)
+        return *s.histogram;
+    }
+    auto& histogram = FindOrAddStage(kind, stage);
+    seen.push_back({kind, stage, &histogram});
+    return histogram;
+  }
+
+  metrics::Histogram&
+  Tracer::FindOrAddStage(const char* kind, const char* stage)
+  {
+    // the same literal can have a different address in another translation unit
+    std::lock_guard<std::mutex> lock{m_Access};
+    for (const auto& s : m_Stages)
+    {
+      if (s.kind == kind and s.stage == stage)
+        return *s.histogram;
+    }
+    auto& histogram = metrics::Registry::Instance().GetHistogram(
+        "lokinet_trace_stage_seconds",
+        "Time spent in each stage of traced operations",
+        metrics::Histogram::LatencyBounds(),
+        {{"trace", kind}, {"stage", stage}});
+    m_Stages.push_back({kind, stage, &histogram});
+    return histogram;
+  }
+
+  void
+  Tracer::Record(
+      const Trace& trace,
+      const char* stage,
+      Clock_t::time_point start,
+      Clock_t::time_point end,
+      std::string detail)
+  {
+    if (not trace)
+      return;
+    StageHistogram(trace.kind, stage).Observe(end - start);
+    if (not trace.sampled)
+      return;
+    Span span{trace.id, trace.kind, stage, thread_id_string(), start, end, std::move(detail)};
+    std::lock_guard<std::mutex> lock{m_Access};
+    if (m_Spans.size() < Capacity)
+      m_Spans.emplace_back(std::move(span));
+    else
+      m_Spans[m_NextSpan] = std::move(span);
+    m_NextSpan = (m_NextSpan + 1) % Capacity;
+  }
+
+  std::vector<Span>
+  Tracer::Spans() const
+  {
+    std::lock_guard<std::mutex> lock{m_Access};
+    if (m_Spans.size() < Capacity)
+      return m_Spans;
+    std::vector<Span> spans;
+    spans.reserve(m_Spans.size());
+    spans.insert(spans.end(), m_Spans.begin() + m_NextSpan, m_Spans.end());
+    spans.insert(spans.end(), m_Spans.begin(), m_Spans.begin() + m_NextSpan);
+    return spans;
+  }
+
+  namespace
+  {
+    /// upper bound of the bucket the q quantile falls in
+    double
+    Quantile(const metrics::Histogram::Snapshot& snap, const std::vector<double>& bounds, double q)
+    {
+      if (snap.count == 0)
+        return 0;
+      const auto rank = q * snap.count;
+      for (size_t idx = 0; idx < bounds.size(); ++idx)
+      {
+        if (snap.buckets[idx] >= rank)
+          return bounds[idx];
+      }
+      // past the last bound, the best we can say is the last bound
+      return bounds.empty() ? 0 : bounds.back();
+    }
+  }  // namespace
+
+  util::StatusObject
+  Tracer::ExtractStatus() const
+  {
+    util::StatusObject stages = util::StatusObject::array();
+    size_t spans = 0;
+    {
+      std::lock_guard<std::mutex> lock{m_Access};
+      spans = m_Spans.size();
+      for (const auto& s : m_Stages)
+      {
+        const auto snap = s.histogram->Collect();
+        const auto& bounds = s.histogram->Bounds();
+        stages.push_back(util::StatusObject{
+            {"trace", s.kind},
+            {"stage", s.stage},
+            {"count", snap.count},
+            {"mean", snap.count ? snap.sum / snap.count : 0.0},
+            {"p50", Quantile(snap, bounds, 0.5)},
+            {"p90", Quantile(snap, bounds, 0.9)},
+            {"p99", Quantile(snap, bounds, 0.99)}});
+      }
+    }
+    return util::StatusObject{
+        {"sampleRate", m_SampleRate.load()}, {"spans", spans}, {"stages", stages}};
+  }
+
+  util::StatusObject
+  Tracer::ChromeTrace() const
+  {
+    const auto micros = [](Clock_t::duration dur) {
+      return std::chrono::duration_cast<std::chrono::microseconds>(dur).count();
+    };
+    util::StatusObject events = util::StatusObject::array();
+    std::vector<uint64_t> named;
+    for (const auto& span : Spans())
+    {
+      if (std::find(named.begin(), named.end(), span.traceID) == named.end())
+      {
+        named.push_back(span.traceID);
+        events.push_back(util::StatusObject{
+            {"name", "thread_name"},
+            {"ph", "M"},
+            {"pid", 1},
+            {"tid", span.traceID},
+            {"args", {{"name", std::string{span.kind} + " " + std::to_string(span.traceID)}}}});
+      }
+      util::StatusObject args{{"thread", span.thread}};
+      if (not span.detail.empty())
+        args["detail"] = span.detail;
+      events.push_back(util::StatusObject{
+          {"name", span.stage},
+          {"cat", span.kind},
+          {"ph", "X"},
+          {"pid", 1},
+          {"tid", span.traceID},
+          {"ts", micros(span.start - m_Epoch)},
+          {"dur", micros(span.end - span.start)},
+          {"args", std::move(args)}});
+    }
+    return util::StatusObject{{"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"}};
+  }
+
+  StageTimer::StageTimer(const char* kind)
+      : m_Trace{Tracer::Instance().Start(kind)}, m_Started{Clock_t::now()}, m_Last{m_Started}
+  {}
+
+  void
+  StageTimer::Mark(const char* stage, std::string detail)
+  {
+    if (not m_Trace)
+      return;
+    const auto now = Clock_t::now();
+    Tracer::Instance().Record(m_Trace, stage, m_Last, now, std::move(detail));
+    m_Last = now;
+  }
+
+  void
+  StageTimer::Finish(const char* outcome, std::string detail)
+  {
+    if (not m_Trace)
+      return;
+    Tracer::Instance().Record(m_Trace, outcome, m_Started, Clock_t::now(), std::move(detail));
+    m_Trace = Trace{};
+  }
+}  // namespace llarp::tracing
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "status.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace llarp::metrics
+{
+  class Histogram;
+}
+
+namespace llarp::tracing
+{
+  using Clock_t = std::chrono::steady_clock;
+
+  /// one traced operation, such as a path build; cheap to copy between threads
+  struct Trace
+  {
+    /// 0 when not traced
+    uint64_t id = 0;
+    /// sampled traces also keep their spans around for export
+    bool sampled = false;
+    /// what is being traced, e.g. "path_build"
+    const char* kind = "";
+
+    explicit operator bool() const
+    {
+      return id != 0;
+    }
+  };
+
+  /// a finished stage of a sampled trace
+  struct Span
+  {
+    uint64_t traceID;
+    const char* kind;
+    const char* stage;
+    std::string thread;
+    Clock_t::time_point start;
+    Clock_t::time_point end;
+    std::string detail;
+  };
+
+  /// collects how long each stage of multi step operations takes. every trace feeds the per
+  /// stage latency histograms, one in every SampleRate traces also keeps its spans in a ring so
+  /// single slow operations can be looked at in a trace viewer.
+  class Tracer
+  {
+   public:
+    /// how many spans we keep, the oldest get overwritten
+    static constexpr size_t Capacity = 4096;
+
+    static Tracer&
+    Instance();
+
+    Trace
+    Start(const char* kind);
+
+    /// a stage of a trace ran from start to end, stage must be a string literal. only sampled
+    /// traces take a lock, to keep their span
+    void
+    Record(
+        const Trace& trace,
+        const char* stage,
+        Clock_t::time_point start,
+        Clock_t::time_point end,
+        std::string detail = {});
+
+    /// keep the spans of one in every oneIn traces, 0 keeps none
+    void
+    SetSampleRate(uint32_t oneIn);
+
+    /// the spans in the ring, oldest first
+    std::vector<Span>
+    Spans() const;
+
+    /// count and latency quantiles of every stage seen so far
+    util::StatusObject
+    ExtractStatus() const;
+
+    /// the spans in the chrome trace event format, for chrome://tracing or ui.perfetto.dev;
+    /// every trace gets a track of its own
+    util::StatusObject
+    ChromeTrace() const;
+
+   private:
+    Tracer();
+
+    struct Stage
+    {
+      std::string kind;
+      std::string stage;
+      metrics::Histogram* histogram;
+    };
+
+    /// kind and stage are literals so their pointers name the stage; each thread remembers the
+    /// ones it has seen and only looks in m_Stages under the lock the first time
+    metrics::Histogram&
+    StageHistogram(const char* kind, const char* stage);
+
+    metrics::Histogram&
+    FindOrAddStage(const char* kind, const char* stage);
+
+    const Clock_t::time_point m_Epoch;
+    std::atomic<uint64_t> m_NextID{1};
+    std::atomic<uint32_t> m_SampleRate{16};
+
+    mutable std::mutex m_Access;
+    std::vector<Span> m_Spans;
+    size_t m_NextSpan = 0;
+    std::vector<Stage> m_Stages;
+  };
+
+  /// walks a trace through consecutive stages, each starting where the one before ended. not
+  /// thread safe, the owner hands it between threads along with the work.
+  class StageTimer
+  {
+   public:
+    /// not tracing anything, every call is a no-op
+    StageTimer() = default;
+
+    explicit StageTimer(const char* kind);
+
+    /// end the stage that ran since the last mark and start the next
+    void
+    Mark(const char* stage, std::string detail = {});
+
+    /// end the trace, recording its whole run as a stage named after how it ended
+    void
+    Finish(const char* outcome, std::string detail = {});
+
+    uint64_t
+    ID() const
+    {
+      return m_Trace.id;
+    }
+
+    explicit operator bool() const
+    {
+      return bool{m_Trace};
+    }
+
+   private:
+    Trace m_Trace;
+    Clock_t::time_point m_Started;
+    Clock_t::time_point m_Last;
+  };
+}  // namespace llarp::tracing
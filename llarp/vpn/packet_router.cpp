@@ -1,81 +1,148 @@
 #include "packet_router.hpp"
 
+#include <algorithm>
+
 namespace llarp::vpn
 {
   struct UDPPacketHandler : public Layer4Handler
   {
-    PacketHandlerFunc m_BaseHandler;
-    std::unordered_map<nuint16_t, PacketHandlerFunc> m_LocalPorts;
+    /// the router's own base handler, so udp nobody claims lands in the same batch group as
+    /// everything else that goes there
+    const PacketHandler& m_BaseHandler;
+    /// we only ever have a handful of local ports so a flat list beats hashing
+    std::vector<std::pair<nuint16_t, PacketHandler>> m_LocalPorts;
 
-    explicit UDPPacketHandler(PacketHandlerFunc baseHandler) : m_BaseHandler{std::move(baseHandler)}
+    explicit UDPPacketHandler(const PacketHandler& baseHandler) : m_BaseHandler{baseHandler}
     {}
 
     void
-    AddSubHandler(nuint16_t localport, PacketHandlerFunc handler) override
+    AddSubHandler(nuint16_t localport, PacketHandler handler) override
     {
-      m_LocalPorts.emplace(localport, std::move(handler));
+      const auto itr =
+          std::find_if(m_LocalPorts.begin(), m_LocalPorts.end(), [localport](const auto& item) {
+            return item.first == localport;
+          });
+      if (itr == m_LocalPorts.end())
+        m_LocalPorts.emplace_back(localport, std::move(handler));
     }
 
-    void
-    HandleIPPacket(llarp::net::IPPacket pkt) override
+    const PacketHandler&
+    Resolve(const llarp::net::IPPacket& pkt) const override
     {
       const uint8_t* ptr = pkt.buf + (pkt.Header()->ihl * 4) + 2;
       const nuint16_t dstPort{*reinterpret_cast<const uint16_t*>(ptr)};
-      if (auto itr = m_LocalPorts.find(dstPort); itr != m_LocalPorts.end())
+      for (const auto& [port, handler] : m_LocalPorts)
       {
-        itr->second(std::move(pkt));
+        if (port == dstPort)
+          return handler;
       }
-      else
-        m_BaseHandler(std::move(pkt));
+      return m_BaseHandler;
     }
   };
 
   struct GenericLayer4Handler : public Layer4Handler
   {
-    PacketHandlerFunc m_BaseHandler;
+    PacketHandler m_BaseHandler;
 
-    explicit GenericLayer4Handler(PacketHandlerFunc baseHandler)
-        : m_BaseHandler{std::move(baseHandler)}
+    explicit GenericLayer4Handler(PacketHandler baseHandler) : m_BaseHandler{std::move(baseHandler)}
     {}
 
-    void
-    HandleIPPacket(llarp::net::IPPacket pkt) override
+    const PacketHandler&
+    Resolve(const llarp::net::IPPacket&) const override
     {
-      m_BaseHandler(std::move(pkt));
+      return m_BaseHandler;
     }
   };
 
-  PacketRouter::PacketRouter(PacketHandlerFunc baseHandler) : m_BaseHandler{std::move(baseHandler)}
+  void
+  PacketHandler::HandleBatch(std::vector<llarp::net::IPPacket>& pkts) const
+  {
+    if (batch)
+    {
+      batch(pkts);
+      return;
+    }
+    for (auto& pkt : pkts)
+      single(std::move(pkt));
+  }
+
+  PacketRouter::PacketRouter(PacketHandlerFunc baseHandler, PacketBatchHandlerFunc baseBatch)
+      : m_BaseHandler{std::move(baseHandler), std::move(baseBatch)}
   {}
 
+  const PacketHandler&
+  PacketRouter::Resolve(const llarp::net::IPPacket& pkt) const
+  {
+    if (const auto& handler = m_IPProtoHandler[pkt.Header()->protocol])
+      return handler->Resolve(pkt);
+    return m_BaseHandler;
+  }
+
   void
   PacketRouter::HandleIPPacket(llarp::net::IPPacket pkt)
   {
-    const auto proto = pkt.Header()->protocol;
-    if (const auto itr = m_IPProtoHandler.find(proto); itr != m_IPProtoHandler.end())
+    Resolve(pkt)(std::move(pkt));
+  }
+
+  void
+  PacketRouter::HandleIPPackets(std::vector<llarp::net::IPPacket>& pkts)
+  {
+    if (pkts.empty())
+      return;
+    // the usual case is everything going to the same place, which needs no regrouping
+    const auto* first = &Resolve(pkts.front());
+    auto itr = pkts.begin() + 1;
+    while (itr != pkts.end() and &Resolve(*itr) == first)
+      ++itr;
+    if (itr == pkts.end())
+    {
+      first->HandleBatch(pkts);
+      return;
+    }
+
+    size_t numGroups = 0;
+    for (auto& pkt : pkts)
     {
-      itr->second->HandleIPPacket(std::move(pkt));
+      const auto* handler = &Resolve(pkt);
+      // there are only ever a few distinct handlers so a linear search is fine
+      size_t idx = 0;
+      while (idx < numGroups and m_BatchGroups[idx].handler != handler)
+        ++idx;
+      if (idx == numGroups)
+      {
+        if (numGroups == m_BatchGroups.size())
+          m_BatchGroups.emplace_back();
+        m_BatchGroups[idx].handler = handler;
+        ++numGroups;
+      }
+      m_BatchGroups[idx].pkts.emplace_back(std::move(pkt));
+    }
+    for (size_t idx = 0; idx < numGroups; ++idx)
+    {
+      auto& group = m_BatchGroups[idx];
+      group.handler->HandleBatch(group.pkts);
+      group.pkts.clear();
     }
-    else
-      m_BaseHandler(std::move(pkt));
   }
 
   void
-  PacketRouter::AddUDPHandler(huint16_t localport, PacketHandlerFunc func)
+  PacketRouter::AddUDPHandler(
+      huint16_t localport, PacketHandlerFunc func, PacketBatchHandlerFunc batch)
   {
     constexpr byte_t udp_proto = 0x11;
 
-    if (m_IPProtoHandler.find(udp_proto) == m_IPProtoHandler.end())
-    {
-      m_IPProtoHandler.emplace(udp_proto, std::make_unique<UDPPacketHandler>(m_BaseHandler));
-    }
-    m_IPProtoHandler[udp_proto]->AddSubHandler(ToNet(localport), func);
+    auto& handler = m_IPProtoHandler[udp_proto];
+    if (not handler)
+      handler = std::make_unique<UDPPacketHandler>(m_BaseHandler);
+    handler->AddSubHandler(ToNet(localport), PacketHandler{std::move(func), std::move(batch)});
   }
 
   void
-  PacketRouter::AddIProtoHandler(uint8_t proto, PacketHandlerFunc func)
+  PacketRouter::AddIProtoHandler(
+      uint8_t proto, PacketHandlerFunc func, PacketBatchHandlerFunc batch)
   {
-    m_IPProtoHandler[proto] = std::make_unique<GenericLayer4Handler>(std::move(func));
+    m_IPProtoHandler[proto] =
+        std::make_unique<GenericLayer4Handler>(PacketHandler{std::move(func), std::move(batch)});
   }
 
 }  // namespace llarp::vpn
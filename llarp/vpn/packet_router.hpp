@@ -1,42 +1,97 @@
 #pragma once
 #include <llarp/net/net_int.hpp>
 #include <llarp/net/ip_packet.hpp>
+#include <array>
 #include <functional>
-#include <unordered_map>
+#include <memory>
+#include <vector>
 
 namespace llarp::vpn
 {
   using PacketHandlerFunc = std::function<void(llarp::net::IPPacket)>;
+  /// takes a whole group of packets at once, may move out of them
+  using PacketBatchHandlerFunc = std::function<void(std::vector<llarp::net::IPPacket>&)>;
+
+  /// somewhere packets go, one at a time or a group at a time
+  struct PacketHandler
+  {
+    PacketHandlerFunc single;
+    /// optional, without it a group is fed to single one packet at a time
+    PacketBatchHandlerFunc batch;
+
+    void
+    operator()(llarp::net::IPPacket pkt) const
+    {
+      single(std::move(pkt));
+    }
+
+    void
+    HandleBatch(std::vector<llarp::net::IPPacket>& pkts) const;
+  };
 
   struct Layer4Handler
   {
     virtual ~Layer4Handler() = default;
 
-    virtual void
-    HandleIPPacket(llarp::net::IPPacket pkt) = 0;
+    /// get the handler this packet should be passed to
+    virtual const PacketHandler&
+    Resolve(const llarp::net::IPPacket& pkt) const = 0;
 
-    virtual void AddSubHandler(nuint16_t, PacketHandlerFunc){};
+    void
+    HandleIPPacket(llarp::net::IPPacket pkt)
+    {
+      Resolve(pkt)(std::move(pkt));
+    }
+
+    virtual void AddSubHandler(nuint16_t, PacketHandler){};
   };
 
   class PacketRouter
   {
-    PacketHandlerFunc m_BaseHandler;
-    std::unordered_map<uint8_t, std::unique_ptr<Layer4Handler>> m_IPProtoHandler;
+    PacketHandler m_BaseHandler;
+    /// indexed by ip protocol, empty slots go to the base handler
+    std::array<std::unique_ptr<Layer4Handler>, 256> m_IPProtoHandler;
+
+    struct BatchGroup
+    {
+      const PacketHandler* handler = nullptr;
+      std::vector<llarp::net::IPPacket> pkts;
+    };
+    /// scratch space for HandleIPPackets, kept around so batches do not allocate.
+    /// only the first few are in use during a batch, in order of first appearance.
+    std::vector<BatchGroup> m_BatchGroups;
+
+    const PacketHandler&
+    Resolve(const llarp::net::IPPacket& pkt) const;
 
    public:
     /// baseHandler will be called if no other handlers matches a packet
-    explicit PacketRouter(PacketHandlerFunc baseHandler);
+    explicit PacketRouter(
+        PacketHandlerFunc baseHandler, PacketBatchHandlerFunc baseBatch = nullptr);
+
+    /// our layer 4 handlers refer back to m_BaseHandler so we stay put
+    PacketRouter(const PacketRouter&) = delete;
+    PacketRouter&
+    operator=(const PacketRouter&) = delete;
 
     /// feed in an ip packet for handling
     void
     HandleIPPacket(llarp::net::IPPacket pkt);
 
+    /// feed in a batch of ip packets for handling.
+    /// packets are grouped by the handler they go to and each handler gets its whole group in
+    /// one call, packets going to the same handler keep their relative order.
+    /// pkts is left with moved from packets.
+    void
+    HandleIPPackets(std::vector<llarp::net::IPPacket>& pkts);
+
     /// add a non udp packet handler using ip protocol proto
     void
-    AddIProtoHandler(uint8_t proto, PacketHandlerFunc func);
+    AddIProtoHandler(uint8_t proto, PacketHandlerFunc func, PacketBatchHandlerFunc batch = nullptr);
 
     /// helper that adds a udp packet handler for UDP destinted for localport
     void
-    AddUDPHandler(huint16_t localport, PacketHandlerFunc func);
+    AddUDPHandler(
+        huint16_t localport, PacketHandlerFunc func, PacketBatchHandlerFunc batch = nullptr);
   };
 }  // namespace llarp::vpn
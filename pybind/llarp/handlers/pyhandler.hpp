@@ -66,9 +66,10 @@ namespace llarp
         return false;
       }
 
-      llarp::huint128_t ObtainIPForAddr(std::variant<service::Address, RouterID>) override
+      std::optional<llarp::huint128_t> ObtainIPForAddr(
+          std::variant<service::Address, RouterID>) override
       {
-        return {0};
+        return std::nullopt;
       }
 
       std::optional<std::variant<service::Address, RouterID>> ObtainAddrForIP(
@@ -22,7 +22,8 @@ namespace tooling
         .def_readonly("triggered", &RouterEvent::triggered);
 
     py::class_<PathAttemptEvent, RouterEvent>(mod, "PathAttemptEvent")
-        .def_readonly("hops", &PathAttemptEvent::hops);
+        .def_readonly("hops", &PathAttemptEvent::hops)
+        .def_readonly("traceID", &PathAttemptEvent::traceID);
 
     py::class_<PathRequestReceivedEvent, RouterEvent>(mod, "PathRequestReceivedEvent")
         .def_readonly("prevHop", &PathRequestReceivedEvent::prevHop)
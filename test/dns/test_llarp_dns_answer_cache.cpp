@@ -0,0 +1,143 @@
+#include <catch2/catch.hpp>
+#include <dns/answer_cache.hpp>
+#include <dns/dns.hpp>
+#include <dns/message.hpp>
+#include <dns/wire.hpp>
+#include <net/ip.hpp>
+#include <net/net_int.hpp>
+#include <util/buffer.hpp>
+
+using namespace std::literals;
+using llarp::dns::AnswerCache;
+
+namespace
+{
+  llarp::dns::Message
+  MakeQuery(std::string name, uint16_t id)
+  {
+    llarp::dns::MessageHeader hdr{};
+    hdr.id = id;
+    llarp::dns::Message msg{hdr};
+    llarp::dns::Question q;
+    q.qname = std::move(name);
+    q.qtype = llarp::dns::qTypeA;
+    q.qclass = llarp::dns::qClassIN;
+    msg.questions.emplace_back(std::move(q));
+    return msg;
+  }
+
+  uint16_t
+  WireID(const std::vector<byte_t>& wire)
+  {
+    return (uint16_t{wire[0]} << 8) | wire[1];
+  }
+}  // namespace
+
+TEST_CASE("dns answer cache serves replies with the asker's id", "[dns]")
+{
+  AnswerCache cache;
+  auto reply = MakeQuery("foo.loki.", 1);
+  reply.AddINReply(llarp::huint128_t{0x0a000001}, false, 300);
+  auto wire = reply.ToBuffer();
+  cache.Put(reply, wire, 1s);
+  CHECK(cache.Size() == 1);
+
+  const auto query = MakeQuery("FOO.loki.", 0x1234);
+  const auto* cached = cache.Get(query.questions[0], 0x1234, 1s + 500ms);
+  REQUIRE(cached != nullptr);
+  CHECK(WireID(cached->wire) == 0x1234);
+  CHECK(cached->wire.size() == wire.sz);
+  CHECK(std::equal(cached->wire.begin() + 2, cached->wire.end(), wire.buf.get() + 2));
+  REQUIRE(cached->addrs.size() == 1);
+  CHECK(cached->addrs[0] == llarp::net::ExpandV4(llarp::huint32_t{0x0a000001}));
+
+  // the ttl counts down with the time it spent in the cache
+  cached = cache.Get(query.questions[0], 0x1234, 101s);
+  REQUIRE(cached != nullptr);
+  llarp::dns::MessageView view;
+  REQUIRE(view.Parse(llarp_buffer_t{cached->wire}));
+  std::vector<uint32_t> ttls;
+  CHECK(view.ForEachAnswer([&ttls](const auto& rr) { ttls.push_back(rr.ttl); }));
+  CHECK(ttls == std::vector<uint32_t>{200});
+
+  // gone once the ttl is up
+  CHECK(cache.Get(query.questions[0], 1, 1s + 300s) == nullptr);
+  CHECK(cache.Size() == 0);
+}
+
+TEST_CASE("dns answer cache negative and uncacheable replies", "[dns]")
+{
+  AnswerCache cache;
+
+  auto nx = MakeQuery("nope.loki.", 1);
+  nx.AddNXReply();
+  cache.Put(nx, nx.ToBuffer(), 0s);
+  CHECK(cache.Get(nx.questions[0], 2, AnswerCache::NegativeTTL - 1ms) != nullptr);
+  CHECK(cache.Get(nx.questions[0], 2, AnswerCache::NegativeTTL) == nullptr);
+
+  auto servfail = MakeQuery("broken.loki.", 1);
+  servfail.AddServFail();
+  cache.Put(servfail, servfail.ToBuffer(), 0s);
+  CHECK(cache.Get(servfail.questions[0], 2, 0s) == nullptr);
+
+  // one second ttls are for answers that change all the time
+  auto shortlived = MakeQuery("random.snode.", 1);
+  shortlived.AddINReply(llarp::huint128_t{0x0a000002}, false);
+  cache.Put(shortlived, shortlived.ToBuffer(), 0s);
+  CHECK(cache.Get(shortlived.questions[0], 2, 0s) == nullptr);
+}
+
+TEST_CASE("dns answer cache stays bounded", "[dns]")
+{
+  AnswerCache cache{2};
+  for (int i = 0; i < 3; ++i)
+  {
+    auto reply = MakeQuery("host" + std::to_string(i) + ".loki.", 1);
+    reply.AddINReply(llarp::huint128_t{uint32_t(0x0a000001 + i)}, false, 60 + i);
+    cache.Put(reply, reply.ToBuffer(), 0s);
+  }
+  CHECK(cache.Size() == 2);
+  // the one closest to expiring made room
+  CHECK(cache.Get(MakeQuery("host0.loki.", 1).questions[0], 1, 0s) == nullptr);
+  CHECK(cache.Get(MakeQuery("host2.loki.", 1).questions[0], 1, 0s) != nullptr);
+}
+
+TEST_CASE("dns answer cache looks up questions off the wire", "[dns]")
+{
+  AnswerCache cache;
+  auto reply = MakeQuery("bar.loki.", 1);
+  reply.AddINReply(llarp::huint128_t{0x0a000003}, false, 60);
+  cache.Put(reply, reply.ToBuffer(), 0s);
+
+  auto query = MakeQuery("Bar.Loki.", 0x4321).ToBuffer();
+  llarp::dns::MessageView view;
+  REQUIRE(view.Parse(query));
+  const auto* cached = cache.Get(*view.FirstQuestion(), view.Header().id, 1s);
+  REQUIRE(cached != nullptr);
+  CHECK(WireID(cached->wire) == 0x4321);
+}
+
+TEST_CASE("dns answer cache forgets replies about an address", "[dns]")
+{
+  AnswerCache cache;
+  const auto ip = llarp::net::ExpandV4(llarp::huint32_t{0x0a000004});
+  auto a = MakeQuery("old.loki.", 1);
+  a.AddINReply(ip, false, 60);
+  cache.Put(a, a.ToBuffer(), 0s);
+  auto aaaa = MakeQuery("old.loki.", 1);
+  aaaa.questions[0].qtype = llarp::dns::qTypeAAAA;
+  aaaa.AddINReply(ip, true, 60);
+  cache.Put(aaaa, aaaa.ToBuffer(), 0s);
+  auto ptr = MakeQuery("4.0.0.10.in-addr.arpa.", 1);
+  ptr.questions[0].qtype = llarp::dns::qTypePTR;
+  ptr.AddAReply("old.loki.", 60);
+  cache.Put(ptr, ptr.ToBuffer(), 0s);
+  auto other = MakeQuery("other.loki.", 1);
+  other.AddINReply(llarp::net::ExpandV4(llarp::huint32_t{0x0a000005}), false, 60);
+  cache.Put(other, other.ToBuffer(), 0s);
+  REQUIRE(cache.Size() == 4);
+
+  cache.RemoveAddress(ip);
+  CHECK(cache.Size() == 1);
+  CHECK(cache.Get(other.questions[0], 1, 0s) != nullptr);
+}
@@ -0,0 +1,131 @@
+#include <catch2/catch.hpp>
+#include <dns/dns.hpp>
+#include <dns/message.hpp>
+#include <dns/wire.hpp>
+#include <net/net_int.hpp>
+#include <util/buffer.hpp>
+
+#include <array>
+#include <vector>
+
+using llarp::dns::MessageView;
+using llarp::dns::RRView;
+
+namespace
+{
+  // query for www.example.loki A with a CNAME answer to foo.example.loki, both names in the
+  // answer are compressed against the question
+  const std::vector<byte_t> cnamePacket{
+      0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+      // question: www.example.loki A IN
+      3, 'w', 'w', 'w', 7, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 4, 'l', 'o', 'k', 'i', 0,
+      0x00, 0x01, 0x00, 0x01,
+      // answer: name points at the question, CNAME IN ttl 300
+      0xc0, 0x0c, 0x00, 0x05, 0x00, 0x01, 0x00, 0x00, 0x01, 0x2c,
+      // rdata: foo + pointer to example.loki
+      0x00, 0x06, 3, 'f', 'o', 'o', 0xc0, 0x10};
+}  // namespace
+
+TEST_CASE("dns message view reads compressed names in place", "[dns]")
+{
+  MessageView view;
+  REQUIRE(view.Parse(llarp_buffer_t{cnamePacket}));
+  CHECK(view.Header().id == 0x1234);
+  CHECK(view.Header().qd_count == 1);
+
+  const auto q = view.FirstQuestion();
+  REQUIRE(q);
+  CHECK(q->qtype == llarp::dns::qTypeA);
+  CHECK(q->name.ToString() == "www.example.loki.");
+  CHECK(q->name.HasTLD(".loki"));
+  CHECK_FALSE(q->name.HasTLD(".snode"));
+  CHECK(q->name.IsName("www.example.loki"));
+  CHECK(q->name.IsName("www.example.loki."));
+  CHECK_FALSE(q->name.IsName("www.example"));
+  CHECK_FALSE(q->name.IsName("www.example.loki.net"));
+
+  size_t answers = 0;
+  CHECK(view.ForEachAnswer([&answers](const RRView& rr) {
+    ++answers;
+    CHECK(rr.name.ToString() == "www.example.loki.");
+    CHECK(rr.ttl == 300);
+    CHECK(rr.HasCNameForTLD(".loki"));
+    CHECK(rr.RDataName().ToString() == "foo.example.loki.");
+  }));
+  CHECK(answers == 1);
+
+  const auto msg = view.ToMessage();
+  REQUIRE(msg);
+  REQUIRE(msg->questions.size() == 1);
+  CHECK(msg->questions[0].qname == "www.example.loki.");
+  REQUIRE(msg->answers.size() == 1);
+  CHECK(msg->answers[0].rr_name == "www.example.loki.");
+  CHECK(msg->answers[0].rData.size() == 6);
+}
+
+TEST_CASE("dns message view rejects malformed packets", "[dns]")
+{
+  MessageView view;
+  // too short for a header
+  CHECK_FALSE(view.Parse(llarp_buffer_t{std::vector<byte_t>(11)}));
+
+  // a question cut off in its name
+  std::vector<byte_t> truncated{cnamePacket.begin(), cnamePacket.begin() + 20};
+  CHECK_FALSE(view.Parse(llarp_buffer_t{truncated}));
+
+  // a name pointing at itself
+  auto loop = cnamePacket;
+  loop[12] = 0xc0;
+  loop[13] = 0x0c;
+  CHECK_FALSE(view.Parse(llarp_buffer_t{loop}));
+
+  // answers are only looked at when asked for
+  std::vector<byte_t> badAnswer{cnamePacket.begin(), cnamePacket.end() - 4};
+  REQUIRE(view.Parse(llarp_buffer_t{badAnswer}));
+  CHECK_FALSE(view.ForEachAnswer([](const RRView&) {}));
+  CHECK_FALSE(view.ToMessage());
+}
+
+TEST_CASE("dns wire writer compresses names", "[dns]")
+{
+  llarp::dns::MessageHeader hdr{};
+  hdr.id = 7;
+  llarp::dns::Message msg{hdr};
+  llarp::dns::Question q;
+  q.qname = "host.example.loki.";
+  q.qtype = llarp::dns::qTypeA;
+  q.qclass = llarp::dns::qClassIN;
+  msg.questions.emplace_back(q);
+  msg.AddINReply(llarp::huint128_t{0x0a000001}, false, 60);
+
+  std::array<byte_t, 512> tmp;
+  llarp_buffer_t buf{tmp};
+  REQUIRE(msg.Encode(&buf));
+  const size_t sz = buf.cur - buf.base;
+  // header, question with its name written out, answer whose name is a pointer to it
+  CHECK(sz == 12 + (19 + 4) + (2 + 10 + 4));
+  CHECK(tmp[12 + 23] == 0xc0);
+  CHECK(tmp[12 + 24] == 0x0c);
+
+  MessageView view;
+  REQUIRE(view.Parse(llarp_buffer_t{tmp.data(), sz}));
+  const auto decoded = view.ToMessage();
+  REQUIRE(decoded);
+  CHECK(decoded->hdr_id == 7);
+  CHECK(decoded->questions[0] == q);
+  REQUIRE(decoded->answers.size() == 1);
+  CHECK(decoded->answers[0].rr_name == q.qname);
+  CHECK(decoded->answers[0].ttl == 60);
+
+  // a second name that shares a suffix only writes the new label
+  std::array<byte_t, 64> out;
+  llarp_buffer_t outbuf{out};
+  llarp::dns::WireWriter writer{outbuf};
+  REQUIRE(writer.Name("example.loki"));
+  REQUIRE(writer.Name("www.example.loki."));
+  CHECK(writer.Size() == 14 + 6);
+  const llarp::dns::NameView second{out.data(), writer.Size(), 14};
+  CHECK(second.ToString() == "www.example.loki.");
+  // labels over 63 bytes do not fit
+  CHECK_FALSE(writer.Name(std::string(64, 'a') + ".loki"));
+}
@@ -0,0 +1,121 @@
+#include <catch2/catch.hpp>
+#include <ev/ev_vnet.hpp>
+#include <net/sock_addr.hpp>
+#include <util/buffer.hpp>
+
+#include <atomic>
+#include <future>
+#include <string_view>
+#include <thread>
+
+using namespace std::literals;
+
+namespace vnet = llarp::vnet;
+
+namespace
+{
+  /// a virtual loop running on its own thread for the length of a test
+  struct RunningLoop
+  {
+    std::shared_ptr<llarp::EventLoop> loop;
+    std::thread thread;
+
+    explicit RunningLoop(std::shared_ptr<vnet::Network> net)
+        : loop{std::make_shared<vnet::Loop>(llarp::EventLoop::create(), std::move(net))}
+    {}
+
+    void
+    Start()
+    {
+      thread = std::thread{[l = loop]() { l->run(); }};
+    }
+
+    void
+    Stop()
+    {
+      if (not thread.joinable())
+        return;
+      loop->stop();
+      thread.join();
+    }
+
+    ~RunningLoop()
+    {
+      Stop();
+    }
+  };
+}  // namespace
+
+TEST_CASE("vnet delivers datagrams after the link latency", "[ev][vnet]")
+{
+  auto net = std::make_shared<vnet::Network>();
+  vnet::LinkParams params;
+  params.latency = 50ms;
+  net->SetDefaultLink(params);
+
+  RunningLoop ctx{net};
+  std::promise<std::pair<llarp::SockAddr, std::string>> got;
+  auto recv = ctx.loop->make_udp([&got](auto&, llarp::SockAddr from, llarp::OwnedBuffer buf) {
+    got.set_value({from, std::string{reinterpret_cast<const char*>(buf.buf.get()), buf.sz}});
+  });
+  auto send = ctx.loop->make_udp([](auto&, auto, auto) {});
+  const llarp::SockAddr to{"127.0.0.1:1090"};
+  const llarp::SockAddr from{"127.0.0.1:1091"};
+  REQUIRE(recv->listen(to));
+  REQUIRE(send->listen(from));
+  // nobody gets to bind twice
+  REQUIRE_FALSE(ctx.loop->make_udp([](auto&, auto, auto) {})->listen(to));
+  ctx.Start();
+
+  const auto started = std::chrono::steady_clock::now();
+  ctx.loop->call_soon([&]() { send->send(to, llarp_buffer_t{"hello"sv}); });
+  auto result = got.get_future();
+  REQUIRE(result.wait_for(5s) == std::future_status::ready);
+  CHECK(std::chrono::steady_clock::now() - started >= 50ms);
+  const auto [src, data] = result.get();
+  CHECK(src == from);
+  CHECK(data == "hello");
+
+  const auto stats = net->Stats();
+  CHECK(stats.sent == 1);
+  CHECK(stats.delivered == 1);
+  CHECK(stats.bytesDelivered == 5);
+  ctx.Stop();
+}
+
+TEST_CASE("vnet drops on lossy links and unbound addresses", "[ev][vnet]")
+{
+  auto net = std::make_shared<vnet::Network>();
+  const llarp::SockAddr lossy{"127.0.0.1:2000"};
+  const llarp::SockAddr fine{"127.0.0.1:2001"};
+  const llarp::SockAddr nobody{"127.0.0.1:2002"};
+
+  RunningLoop ctx{net};
+  std::promise<void> got;
+  std::atomic<bool> leaked{false};
+  auto recvLossy = ctx.loop->make_udp([&leaked](auto&, auto, auto) { leaked = true; });
+  auto recvFine =
+      ctx.loop->make_udp([&got](auto&, auto, llarp::OwnedBuffer) { got.set_value(); });
+  auto send = ctx.loop->make_udp([](auto&, auto, auto) {});
+  REQUIRE(recvLossy->listen(lossy));
+  REQUIRE(recvFine->listen(fine));
+  ctx.Start();
+
+  ctx.loop->call_soon([&]() {
+    // sending before listening binds us somewhere
+    send->send(nobody, llarp_buffer_t{"anyone?"sv});
+    vnet::LinkParams params;
+    params.loss = 1.0;
+    net->SetLink(llarp::SockAddr{"127.0.0.1:49152"}, lossy, params);
+    send->send(lossy, llarp_buffer_t{"lost"sv});
+    send->send(fine, llarp_buffer_t{"found"sv});
+  });
+  REQUIRE(got.get_future().wait_for(5s) == std::future_status::ready);
+  CHECK_FALSE(leaked);
+
+  const auto stats = net->Stats();
+  CHECK(stats.sent == 3);
+  CHECK(stats.dropped == 2);
+  CHECK(stats.delivered == 1);
+  ctx.Stop();
+}
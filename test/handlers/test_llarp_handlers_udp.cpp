@@ -0,0 +1,103 @@
+#include <handlers/udp_handlers.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace llarp;
+
+static nuint16_t
+Port(uint16_t port)
+{
+  return ToNet(huint16_t{port});
+}
+
+static net::IPPacket
+UDPTo(uint16_t dstport, const std::string& payload)
+{
+  return net::IPPacket::UDP(
+      nuint32_t{0}, Port(1234), nuint32_t{0}, Port(dstport), llarp_buffer_t{payload});
+}
+
+TEST_CASE("UDP port handlers allocate free ephemeral ports", "[UDPPortHandlers]")
+{
+  handlers::UDPPortHandlers udp;
+  const auto first = Port(handlers::UDPPortHandlers::FirstEphemeralPort);
+
+  SECTION("ports are handed out in order")
+  {
+    CHECK(udp.Allocate() == first);
+    CHECK(udp.Allocate() == Port(handlers::UDPPortHandlers::FirstEphemeralPort + 1));
+  }
+  SECTION("ports with a handler are skipped")
+  {
+    REQUIRE(udp.Add(first, [](auto, auto) {}));
+    CHECK(udp.Allocate() == Port(handlers::UDPPortHandlers::FirstEphemeralPort + 1));
+  }
+  SECTION("a port is refused while something has it")
+  {
+    REQUIRE(udp.Add(first, [](auto, auto) {}));
+    CHECK(not udp.Add(first, [](auto, auto) {}));
+    udp.Remove(first);
+    CHECK(udp.Add(first, [](auto, auto) {}));
+  }
+  SECTION("nothing left once every ephemeral port is taken")
+  {
+    for (uint32_t port = handlers::UDPPortHandlers::FirstEphemeralPort; port <= 65535; ++port)
+      REQUIRE(udp.Add(Port(port), [](auto, auto) {}));
+    CHECK(not udp.Allocate());
+    udp.Remove(Port(60000));
+    CHECK(udp.Allocate() == Port(60000));
+  }
+}
+
+TEST_CASE("UDP port handlers dispatch by destination port", "[UDPPortHandlers]")
+{
+  handlers::UDPPortHandlers udp;
+  service::ConvoTag tag;
+  tag.Randomize();
+
+  std::vector<std::string> got53, got80;
+  service::ConvoTag seen;
+  const auto record = [](std::vector<std::string>& got) {
+    return [&got](service::ConvoTag, net::IPPacket pkt) {
+      const auto [ptr, sz] = *pkt.UDPPayload();
+      got.emplace_back(reinterpret_cast<const char*>(ptr), sz);
+    };
+  };
+  REQUIRE(udp.Add(Port(53), record(got53)));
+  REQUIRE(udp.Add(Port(80), record(got80)));
+
+  SECTION("each packet goes to the handler for its port")
+  {
+    CHECK(udp.Dispatch(tag, UDPTo(53, "dns").ConstBuffer()));
+    CHECK(udp.Dispatch(tag, UDPTo(80, "http").ConstBuffer()));
+    CHECK(udp.Dispatch(tag, UDPTo(53, "more dns").ConstBuffer()));
+    CHECK(got53 == std::vector<std::string>{"dns", "more dns"});
+    CHECK(got80 == std::vector<std::string>{"http"});
+  }
+  SECTION("the convo tag is passed along")
+  {
+    REQUIRE(udp.Add(Port(443), [&seen](auto from, auto) { seen = from; }));
+    CHECK(udp.Dispatch(tag, UDPTo(443, "hi").ConstBuffer()));
+    CHECK(seen == tag);
+  }
+  SECTION("packets nobody handles are refused")
+  {
+    CHECK(not udp.Dispatch(tag, UDPTo(8080, "nobody").ConstBuffer()));
+    udp.Remove(Port(53));
+    CHECK(not udp.Dispatch(tag, UDPTo(53, "gone").ConstBuffer()));
+    CHECK(got53.empty());
+  }
+  SECTION("packets that are not udp are refused")
+  {
+    auto pkt = UDPTo(53, "not udp");
+    pkt.Header()->protocol = static_cast<uint8_t>(net::IPProtocol::TCP);
+    CHECK(not udp.Dispatch(tag, pkt.ConstBuffer()));
+    auto truncated = UDPTo(53, "");
+    truncated.sz = 24;
+    CHECK(not udp.Dispatch(tag, truncated.ConstBuffer()));
+    CHECK(got53.empty());
+  }
+}
@@ -0,0 +1,85 @@
+#include <iwp/congestion.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::iwp::CongestionControl;
+using namespace std::literals;
+
+static constexpr size_t Segment = 1024;
+
+TEST_CASE("iwp congestion rtt estimation", "[iwp]")
+{
+  CongestionControl cc{Segment, 400ms};
+  // no sample yet, be conservative
+  CHECK(cc.RTO() == 400ms);
+
+  cc.OnRTTSample(100ms);
+  CHECK(cc.SRTT() == 100ms);
+  CHECK(cc.RTTVar() == 50ms);
+  CHECK(cc.RTO() == 300ms);
+
+  // backoff doubles until the next sample and never goes over the max
+  cc.OnRTOExpired(1s);
+  CHECK(cc.RTO() == 400ms);
+
+  for (int i = 0; i < 100; ++i)
+    cc.OnRTTSample(20ms);
+  CHECK(cc.SRTT() < 25ms);
+  CHECK(cc.RTO() == llarp::iwp::MinRTO);
+}
+
+TEST_CASE("iwp congestion window", "[iwp]")
+{
+  CongestionControl cc{Segment, 400ms};
+  cc.OnRTTSample(50ms);
+  const auto initial = cc.Window();
+  CHECK(cc.CanSend(0, Segment * 1000));
+  CHECK(cc.CanSend(initial - Segment, Segment));
+  CHECK_FALSE(cc.CanSend(initial, Segment));
+
+  // slow start grows by what got acked
+  cc.OnAck(Segment * 4, 1s);
+  CHECK(cc.Window() == initial + Segment * 4);
+
+  // one reduction per round trip
+  const auto before = cc.Window();
+  cc.OnLoss(2s);
+  const auto reduced = cc.Window();
+  CHECK(reduced < before);
+  CHECK(cc.SlowStartThreshold() == reduced);
+  cc.OnLoss(2s + 10ms);
+  CHECK(cc.Window() == reduced);
+
+  // out of slow start it grows back towards where it was
+  llarp_time_t now = 3s;
+  for (int i = 0; i < 200; ++i)
+  {
+    now += 50ms;
+    cc.OnAck(cc.Window(), now);
+  }
+  CHECK(cc.Window() > before);
+}
+
+TEST_CASE("iwp congestion pacing", "[iwp]")
+{
+  CongestionControl cc{Segment, 400ms};
+  cc.OnRTTSample(100ms);
+
+  llarp_time_t now = 1s;
+  size_t sent = 0;
+  while (cc.PacingAllows(now))
+  {
+    cc.OnSent(Segment, false);
+    ++sent;
+  }
+  // we get a burst and then have to wait
+  CHECK(sent > 1);
+  CHECK(sent < cc.Window() / Segment);
+  const auto next = cc.NextSendAt();
+  CHECK(next > now);
+  CHECK(cc.PacingAllows(next));
+
+  cc.OnSent(Segment, true);
+  CHECK(cc.LossRate() > 0);
+  CHECK(cc.ExtractStatus()["retransmits"] == 1);
+}
@@ -0,0 +1,42 @@
+#include <iwp/message_buffer.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::iwp::InboundMessage;
+using namespace std::literals;
+
+TEST_CASE("iwp inbound message with larger fragments", "[iwp]")
+{
+  static constexpr size_t fragsz = 1344;
+  static constexpr uint16_t msgsz = 4000;
+  InboundMessage msg{0, msgsz, llarp::ShortHash{}, 0s, fragsz};
+
+  const std::vector<byte_t> data(fragsz, 'x');
+  msg.HandleData(0, llarp_buffer_t{data}, 1s);
+  CHECK(msg.AcksBitmask() == 0b1);
+  CHECK_FALSE(msg.IsCompleted());
+
+  // offsets that are not on a fragment boundary are dropped
+  msg.HandleData(1024, llarp_buffer_t{data.data(), 100}, 1s);
+  CHECK(msg.AcksBitmask() == 0b1);
+
+  msg.HandleData(fragsz * 2, llarp_buffer_t{data.data(), msgsz - fragsz * 2}, 1s);
+  CHECK(msg.AcksBitmask() == 0b101);
+  CHECK_FALSE(msg.IsCompleted());
+
+  msg.HandleData(fragsz, llarp_buffer_t{data}, 1s);
+  CHECK(msg.AcksBitmask() == 0b111);
+  CHECK(msg.IsCompleted());
+}
+
+TEST_CASE("iwp inbound message with default fragments", "[iwp]")
+{
+  static constexpr uint16_t msgsz = llarp::iwp::FragmentSize * 2;
+  InboundMessage msg{0, msgsz, llarp::ShortHash{}, 0s};
+
+  const std::vector<byte_t> data(llarp::iwp::FragmentSize, 'x');
+  msg.HandleData(llarp::iwp::FragmentSize, llarp_buffer_t{data}, 1s);
+  CHECK(msg.AcksBitmask() == 0b10);
+  msg.HandleData(0, llarp_buffer_t{data}, 1s);
+  CHECK(msg.IsCompleted());
+}
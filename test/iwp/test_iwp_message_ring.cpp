@@ -0,0 +1,83 @@
+#include <iwp/message_ring.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+
+using llarp::iwp::MessageRing;
+
+TEST_CASE("iwp message ring lookups", "[iwp]")
+{
+  MessageRing<int> ring{1024};
+  CHECK(ring.Empty());
+  CHECK(ring.Find(5) == nullptr);
+
+  REQUIRE(ring.Emplace(5, 50) != nullptr);
+  REQUIRE(ring.Emplace(6, 60) != nullptr);
+  // an id can only be in there once
+  CHECK(ring.Emplace(5, 51) == nullptr);
+  CHECK(ring.Size() == 2);
+  CHECK(*ring.Find(5) == 50);
+  CHECK(*ring.Find(6) == 60);
+
+  const auto taken = ring.Take(5);
+  CHECK(taken.has_value());
+  CHECK(*taken == 50);
+  CHECK(ring.Find(5) == nullptr);
+  CHECK_FALSE(ring.Take(5).has_value());
+
+  ring.Erase(6);
+  CHECK(ring.Empty());
+}
+
+TEST_CASE("iwp message ring grows with the id window", "[iwp]")
+{
+  MessageRing<std::unique_ptr<uint64_t>> ring{256};
+  for (uint64_t id = 1000; id < 1200; ++id)
+    REQUIRE(ring.Emplace(id, std::make_unique<uint64_t>(id)) != nullptr);
+  CHECK(ring.Size() == 200);
+
+  size_t visited = 0;
+  ring.ForEach([&](uint64_t id, const auto& msg) {
+    CHECK(*msg == id);
+    ++visited;
+  });
+  CHECK(visited == 200);
+
+  for (uint64_t id = 1000; id < 1200; ++id)
+    ring.Erase(id);
+  CHECK(ring.Empty());
+}
+
+TEST_CASE("iwp message ring keeps taking ids past a stuck message", "[iwp]")
+{
+  MessageRing<uint64_t> ring{64};
+  REQUIRE(ring.Emplace(0, 0) != nullptr);
+  // ids move on while message 0 never completes, wrapping the largest ring many times over
+  for (uint64_t id = 1; id < 1000; ++id)
+  {
+    REQUIRE(ring.Emplace(id, id) != nullptr);
+    if (id > 8)
+      ring.Erase(id - 8);
+  }
+  CHECK(ring.Size() == 9);
+  REQUIRE(ring.Find(0) != nullptr);
+  for (uint64_t id = 992; id < 1000; ++id)
+  {
+    REQUIRE(ring.Find(id) != nullptr);
+    CHECK(*ring.Find(id) == id);
+  }
+  CHECK(ring.Emplace(0, 1) == nullptr);
+
+  size_t visited = 0;
+  ring.ForEach([&](uint64_t id, uint64_t msg) {
+    CHECK(msg == id);
+    ++visited;
+  });
+  CHECK(visited == 9);
+
+  CHECK(ring.Take(0) == 0);
+  for (uint64_t id = 992; id < 1000; ++id)
+    CHECK(ring.Take(id) == id);
+  CHECK(ring.Empty());
+}
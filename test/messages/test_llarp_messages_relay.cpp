@@ -0,0 +1,32 @@
+#include <messages/relay.hpp>
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace llarp;
+
+TEST_CASE("Relay messages encode in their fixed layout", "[RelayMessage]")
+{
+  RelayDownstreamMessage msg;
+  msg.pathid.Fill('p');
+  msg.X = Encrypted<MAX_LINK_MSG_SIZE - 128>{nullptr, 3};
+  msg.X.Fill('x');
+  msg.Y.Fill('y');
+
+  std::vector<byte_t> storage(MAX_LINK_MSG_SIZE);
+  llarp_buffer_t buf{storage};
+  REQUIRE(msg.BEncode(&buf));
+  const std::string encoded{buf.base, buf.cur};
+  CHECK(
+      encoded
+      == "d1:a1:d1:p16:" + std::string(16, 'p') + "1:vi0e1:x3:xxx1:y32:" + std::string(32, 'y')
+          + "e");
+  CHECK(msg.EncodedSize() == encoded.size());
+
+  // too little room fails before anything is written
+  std::vector<byte_t> small(encoded.size() - 1);
+  llarp_buffer_t smallbuf{small};
+  CHECK_FALSE(msg.BEncode(&smallbuf));
+  CHECK(smallbuf.cur == smallbuf.base);
+}
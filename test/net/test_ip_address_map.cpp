@@ -0,0 +1,76 @@
+#include <net/ip_address_map.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+using namespace std::literals;
+
+using AddrMap_t = llarp::net::IPAddressMap<std::string>;
+
+TEST_CASE("IPAddressMap allocates sequentially in range", "[IPAddressMap]")
+{
+  AddrMap_t addrmap;
+  addrmap.SetRange(llarp::huint128_t{10}, llarp::huint128_t{13});
+  REQUIRE(addrmap.Map(llarp::huint128_t{10}, "us", false, 0s, true));
+  CHECK(addrmap.Obtain("alice", false, 1s) == llarp::huint128_t{11});
+  CHECK(addrmap.Obtain("bob", true, 1s) == llarp::huint128_t{12});
+  CHECK(addrmap.Obtain("alice", false, 2s) == llarp::huint128_t{11});
+  CHECK(addrmap.Size() == 3);
+
+  const auto* bob = addrmap.FindByIP(llarp::huint128_t{12});
+  REQUIRE(bob);
+  CHECK(bob->ident == "bob");
+  CHECK(bob->snode);
+  CHECK(addrmap.FindByIdent("alice")->lastActive == 2s);
+  CHECK(not addrmap.Map(llarp::huint128_t{12}, "carol", false, 2s));
+}
+
+TEST_CASE("IPAddressMap recycles least recently active", "[IPAddressMap]")
+{
+  AddrMap_t addrmap;
+  addrmap.SetRange(llarp::huint128_t{10}, llarp::huint128_t{13});
+  addrmap.Map(llarp::huint128_t{10}, "us", false, 0s, true);
+  addrmap.Obtain("alice", false, 1s);
+  addrmap.Obtain("bob", false, 2s);
+  addrmap.MarkActive(*addrmap.FindByIdent("alice"), 3s);
+
+  std::string evicted;
+  const auto ip =
+      addrmap.Obtain("carol", false, 4s, [&evicted](const auto& entry) { evicted = entry.ident; });
+  CHECK(evicted == "bob");
+  CHECK(ip == llarp::huint128_t{12});
+  CHECK(not addrmap.HasIdent("bob"));
+  CHECK(addrmap.FindByIP(llarp::huint128_t{12})->ident == "carol");
+  // pinned entries are never recycled
+  addrmap.Obtain("dave", false, 5s, [&evicted](const auto& entry) { evicted = entry.ident; });
+  CHECK(evicted == "alice");
+  CHECK(addrmap.HasIP(llarp::huint128_t{10}));
+}
+
+TEST_CASE("IPAddressMap reuses removed addresses", "[IPAddressMap]")
+{
+  AddrMap_t addrmap;
+  addrmap.SetRange(llarp::huint128_t{10}, llarp::huint128_t{13});
+  addrmap.Obtain("alice", false, 1s);
+  addrmap.Obtain("bob", false, 2s);
+  addrmap.RemoveIdent("alice");
+  CHECK(not addrmap.HasIP(llarp::huint128_t{11}));
+
+  bool evicted = false;
+  const auto ip = addrmap.Obtain("carol", false, 3s, [&evicted](const auto&) { evicted = true; });
+  CHECK(not evicted);
+  CHECK(ip == llarp::huint128_t{11});
+}
+
+TEST_CASE("IPAddressMap does not recycle mappings still in use", "[IPAddressMap]")
+{
+  AddrMap_t addrmap;
+  addrmap.SetRange(llarp::huint128_t{10}, llarp::huint128_t{12});
+  addrmap.SetMinIdle(10s);
+  addrmap.Obtain("alice", false, 1s);
+
+  CHECK(not addrmap.Obtain("mallory", false, 5s));
+  CHECK(addrmap.FindByIP(llarp::huint128_t{11})->ident == "alice");
+  CHECK(addrmap.Obtain("bob", false, 11s) == llarp::huint128_t{11});
+}
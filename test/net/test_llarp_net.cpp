@@ -1,11 +1,15 @@
 #include <net/net_int.hpp>
 #include <net/ip.hpp>
 #include <net/ip_range.hpp>
+#include <net/ip_packet.hpp>
 #include <net/net.hpp>
 #include <oxenmq/hex.h>
 
 #include <catch2/catch.hpp>
 
+#include <array>
+#include <cstring>
+
 TEST_CASE("In6Addr")
 {
   llarp::huint128_t ip;
@@ -125,3 +129,109 @@ TEST_CASE("uint128_t")
         REQUIRE(be == llarp::uint128_t{0xffeeddc3bbaa9988ULL, 0x776655443f221100ULL});
     }
 }
+
+/// one's complement checksum of a udp datagram inside an ipv4 packet including the pseudo header
+static uint16_t
+udp_checksum(const llarp::net::IPPacket& pkt)
+{
+  const auto* hdr = pkt.Header();
+  const size_t udplen = pkt.sz - 20;
+  std::array<byte_t, 12> pseudo{};
+  std::memcpy(pseudo.data(), &hdr->saddr, 4);
+  std::memcpy(pseudo.data() + 4, &hdr->daddr, 4);
+  pseudo[9] = hdr->protocol;
+  pseudo[10] = udplen >> 8;
+  pseudo[11] = udplen & 0xff;
+  const uint16_t partial = ~llarp::net::ipchksum(pseudo.data(), pseudo.size());
+  return llarp::net::ipchksum(pkt.buf + 20, udplen, partial);
+}
+
+TEST_CASE("IP checksum")
+{
+  SECTION("known header")
+  {
+    const std::string hdr = oxenmq::from_hex("450000730000400040110000c0a80001c0a800c7");
+    const auto sum =
+        llarp::net::ipchksum(reinterpret_cast<const byte_t*>(hdr.data()), hdr.size());
+    REQUIRE(ntohs(sum) == 0xb861);
+  }
+  SECTION("odd length")
+  {
+    const std::array<byte_t, 5> data{0x01, 0x02, 0x03, 0x04, 0x05};
+    // 0x0102 + 0x0304 + 0x0500 = 0x0906
+    REQUIRE(ntohs(llarp::net::ipchksum(data.data(), data.size())) == uint16_t(~0x0906));
+  }
+  SECTION("address rewrite keeps checksums valid")
+  {
+    const std::string payload = "lokinet checksum test payload!";
+    auto pkt = llarp::net::IPPacket::UDP(
+        llarp::nuint32_t{htonl(0x0a000001)},
+        llarp::nuint16_t{htons(1234)},
+        llarp::nuint32_t{htonl(0x0a000002)},
+        llarp::nuint16_t{htons(53)},
+        llarp_buffer_t{payload});
+    REQUIRE(pkt.sz == 28 + payload.size());
+    // fill in the udp checksum which IPPacket::UDP leaves empty
+    auto* udpsum = reinterpret_cast<uint16_t*>(pkt.buf + 26);
+    *udpsum = udp_checksum(pkt);
+    REQUIRE(*udpsum != 0);
+    REQUIRE(udp_checksum(pkt) == 0);
+
+    pkt.UpdateIPv4Address(
+        llarp::nuint32_t{htonl(0xac100a05)}, llarp::nuint32_t{htonl(0x0a0000ff)});
+    REQUIRE(pkt.srcv4() == llarp::huint32_t{0xac100a05});
+    REQUIRE(pkt.dstv4() == llarp::huint32_t{0x0a0000ff});
+    REQUIRE(llarp::net::ipchksum(pkt.buf, 20) == 0);
+    REQUIRE(udp_checksum(pkt) == 0);
+
+    pkt.ZeroAddresses();
+    REQUIRE(llarp::net::ipchksum(pkt.buf, 20) == 0);
+    REQUIRE(udp_checksum(pkt) == 0);
+  }
+}
+
+TEST_CASE("UDP payload framing")
+{
+  const std::string payload = "lokinet udp payload";
+  auto pkt = llarp::net::IPPacket::UDP(
+      llarp::nuint32_t{htonl(0x0a000001)},
+      llarp::nuint16_t{htons(1234)},
+      llarp::nuint32_t{htonl(0x0a000002)},
+      llarp::nuint16_t{htons(53)},
+      llarp_buffer_t{payload});
+  REQUIRE(pkt.SrcPort() == llarp::nuint16_t{htons(1234)});
+  REQUIRE(pkt.DstPort() == llarp::nuint16_t{htons(53)});
+
+  SECTION("payload is what went in")
+  {
+    const auto maybe = pkt.UDPPayload();
+    REQUIRE(maybe);
+    const auto [ptr, sz] = *maybe;
+    REQUIRE(std::string{reinterpret_cast<const char*>(ptr), sz} == payload);
+  }
+  SECTION("trailing bytes past the udp length are not payload")
+  {
+    pkt.buf[pkt.sz] = 'x';
+    pkt.sz += 1;
+    const auto maybe = pkt.UDPPayload();
+    REQUIRE(maybe);
+    REQUIRE(maybe->second == payload.size());
+  }
+  SECTION("a short packet only gives what it has")
+  {
+    pkt.sz -= 4;
+    const auto maybe = pkt.UDPPayload();
+    REQUIRE(maybe);
+    REQUIRE(maybe->second == payload.size() - 4);
+  }
+  SECTION("no payload without a whole udp header")
+  {
+    pkt.sz = 24;
+    REQUIRE(not pkt.UDPPayload());
+  }
+  SECTION("no payload for other protocols")
+  {
+    pkt.Header()->protocol = static_cast<uint8_t>(llarp::net::IPProtocol::TCP);
+    REQUIRE(not pkt.UDPPayload());
+  }
+}
@@ -0,0 +1,106 @@
+#include <path/transit_hop.hpp>
+#include <path/transit_hop_table.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::path::HopDirection;
+using llarp::path::TransitHop;
+using llarp::path::TransitHop_ptr;
+using llarp::path::TransitHopTable;
+using namespace std::literals;
+
+static TransitHop_ptr
+MakeHop(char up, char down, llarp_time_t started = 0s)
+{
+  auto hop = std::make_shared<TransitHop>();
+  hop->info.txID.Randomize();
+  hop->info.rxID.Randomize();
+  hop->info.upstream.Fill(up);
+  hop->info.downstream.Fill(down);
+  hop->started = started;
+  return hop;
+}
+
+TEST_CASE("TransitHopTable lookups", "[path]")
+{
+  TransitHopTable table;
+  const auto hop = MakeHop('u', 'd');
+  REQUIRE(table.Insert(hop));
+  REQUIRE_FALSE(table.Insert(hop));
+  REQUIRE(table.Size() == 1);
+
+  llarp::RouterID up, down;
+  up.Fill('u');
+  down.Fill('d');
+
+  for (const auto& id : {hop->info.txID, hop->info.rxID})
+  {
+    CHECK(table.Find(id, HopDirection::Upstream, up) == hop);
+    CHECK(table.Find(id, HopDirection::Downstream, down) == hop);
+    // right id from the wrong side
+    CHECK(table.Find(id, HopDirection::Upstream, down) == nullptr);
+    CHECK(table.Find(id, HopDirection::Downstream, up) == nullptr);
+  }
+
+  table.Remove(hop);
+  CHECK(table.Size() == 0);
+  CHECK(table.Find(hop->info.txID, HopDirection::Upstream, up) == nullptr);
+}
+
+TEST_CASE("TransitHopTable grows and visits each hop once", "[path]")
+{
+  TransitHopTable table;
+  std::vector<TransitHop_ptr> hops;
+  for (int i = 0; i < 1000; ++i)
+  {
+    hops.emplace_back(MakeHop(char('a' + i % 7), char('k' + i % 5)));
+    REQUIRE(table.Insert(hops.back()));
+  }
+  REQUIRE(table.Size() == hops.size());
+
+  size_t visited = 0;
+  table.ForEach([&visited](const TransitHop_ptr&) { ++visited; });
+  CHECK(visited == hops.size());
+
+  for (size_t i = 0; i < hops.size(); i += 2)
+    table.Remove(hops[i]);
+  for (size_t i = 0; i < hops.size(); ++i)
+  {
+    const auto& info = hops[i]->info;
+    const auto found = table.Find(info.rxID, HopDirection::Upstream, info.upstream);
+    CHECK(found == (i % 2 ? hops[i] : nullptr));
+  }
+}
+
+TEST_CASE("TransitHopTable expiry", "[path]")
+{
+  TransitHopTable table;
+  const auto early = MakeHop('u', 'd', 0s);
+  const auto late = MakeHop('u', 'd', 1min);
+  const auto destroyed = MakeHop('u', 'd', 1min);
+  REQUIRE(table.Insert(early));
+  REQUIRE(table.Insert(late));
+  REQUIRE(table.Insert(destroyed));
+
+  std::vector<TransitHop_ptr> expired;
+  const auto onExpired = [&expired](const TransitHop_ptr& hop) { expired.push_back(hop); };
+
+  table.Expire(early->ExpireTime() - 1ms, onExpired);
+  CHECK(expired.empty());
+
+  destroyed->destroy = true;
+  table.ScheduleExpiry(destroyed, 0s);
+  table.Expire(early->ExpireTime(), onExpired);
+  REQUIRE(expired.size() == 2);
+  CHECK(table.Size() == 1);
+  CHECK(table.Contains(late));
+
+  // lifetime got extended after we put it on the timer
+  late->lifetime += 1min;
+  expired.clear();
+  table.Expire(late->started + llarp::path::default_lifetime, onExpired);
+  CHECK(expired.empty());
+  table.Expire(late->ExpireTime(), onExpired);
+  CHECK(expired.size() == 1);
+  CHECK(table.Size() == 0);
+}
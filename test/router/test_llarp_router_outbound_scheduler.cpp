@@ -0,0 +1,164 @@
+#include <router/outbound_scheduler.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <vector>
+
+using llarp::OutboundClass;
+using llarp::OutboundScheduler;
+using llarp::PathID_t;
+using llarp::RouterID;
+
+namespace
+{
+  struct Entry
+  {
+    RouterID router;
+    PathID_t pathid;
+    uint16_t priority;
+    size_t size;
+
+    size_t
+    Size() const
+    {
+      return size;
+    }
+  };
+
+  RouterID
+  MakeRouter(byte_t n)
+  {
+    RouterID id;
+    id.Fill(n);
+    return id;
+  }
+
+  PathID_t
+  MakePath(byte_t n)
+  {
+    PathID_t id;
+    id.Fill(n);
+    return id;
+  }
+
+  using Scheduler = OutboundScheduler<Entry>;
+
+  constexpr size_t Quantum = 1000;
+
+  void
+  Push(Scheduler& sched, byte_t router, byte_t path, uint16_t priority, size_t size = 500)
+  {
+    Entry e{MakeRouter(router), MakePath(path), priority, size};
+    REQUIRE(sched.Push(e));
+  }
+}  // namespace
+
+TEST_CASE("outbound message classes", "[router]")
+{
+  CHECK(llarp::OutboundClassOf(0) == OutboundClass::Data);
+  CHECK(llarp::OutboundClassOf(1) == OutboundClass::DHT);
+  CHECK(llarp::OutboundClassOf(5) == OutboundClass::Control);
+  CHECK(llarp::OutboundClassOf(6) == OutboundClass::Control);
+}
+
+TEST_CASE("outbound scheduler strict priority", "[router]")
+{
+  Scheduler sched{100, 10, Quantum};
+  Push(sched, 1, 1, 0);
+  Push(sched, 1, 0, 1);
+  Push(sched, 1, 0, 5);
+
+  std::vector<uint16_t> order;
+  const auto sent = sched.Schedule(
+      10,
+      [&](Entry& e) { order.push_back(e.priority); },
+      [](const RouterID&) { return size_t{0}; });
+  CHECK(sent == 3);
+  const std::vector<uint16_t> expected{5, 1, 0};
+  CHECK(order == expected);
+  CHECK(sched.Size() == 0);
+}
+
+TEST_CASE("outbound scheduler shares bytes between paths", "[router]")
+{
+  Scheduler sched{1000, 10, Quantum};
+  // one path bursts with big messages, the other trickles small ones
+  for (int i = 0; i < 100; ++i)
+    Push(sched, 1, 1, 0, 1000);
+  for (int i = 0; i < 100; ++i)
+    Push(sched, 1, 2, 0, 100);
+
+  std::map<PathID_t, size_t> bytes;
+  sched.Schedule(
+      60,
+      [&](Entry& e) { bytes[e.pathid] += e.size; },
+      [](const RouterID&) { return size_t{0}; });
+  // the bursty path gets no more than its share of the link
+  CHECK(bytes[MakePath(1)] <= bytes[MakePath(2)] + Quantum);
+  CHECK(bytes[MakePath(2)] > 0);
+}
+
+TEST_CASE("outbound scheduler shares between neighbours", "[router]")
+{
+  Scheduler sched{1000, 10, Quantum};
+  // router 1 has lots of paths, router 2 only one
+  for (byte_t path = 1; path <= 10; ++path)
+    for (int i = 0; i < 10; ++i)
+      Push(sched, 1, path, 0);
+  for (int i = 0; i < 100; ++i)
+    Push(sched, 2, 100, 0);
+
+  std::map<RouterID, size_t> sent;
+  sched.Schedule(
+      40, [&](Entry& e) { ++sent[e.router]; }, [](const RouterID&) { return size_t{0}; });
+  CHECK(sent[MakeRouter(1)] == 20);
+  CHECK(sent[MakeRouter(2)] == 20);
+}
+
+TEST_CASE("outbound scheduler backpressure", "[router]")
+{
+  Scheduler sched{100, 10, Quantum};
+  Push(sched, 1, 1, 0);
+  Push(sched, 2, 2, 0);
+  Push(sched, 1, 0, 5);
+
+  std::vector<RouterID> to;
+  // router 1 is backed up so only its control message goes out
+  const auto sent = sched.Schedule(
+      10,
+      [&](Entry& e) { to.push_back(e.router); },
+      [](const RouterID& r) -> size_t { return r == MakeRouter(1) ? 10 : 0; });
+  CHECK(sent == 2);
+  const std::vector<RouterID> expected{MakeRouter(1), MakeRouter(2)};
+  CHECK(to == expected);
+  CHECK(sched.Size() == 1);
+  CHECK(sched.ExtractStatus()["data"]["deferred"] > 0);
+
+  // once it drains it gets to send again
+  sched.Schedule(
+      10, [&](Entry& e) { to.push_back(e.router); }, [](const RouterID&) { return size_t{0}; });
+  CHECK(sched.Size() == 0);
+  CHECK(to.back() == MakeRouter(1));
+}
+
+TEST_CASE("outbound scheduler path limits and removal", "[router]")
+{
+  Scheduler sched{2, 10, Quantum};
+  Push(sched, 1, 1, 0);
+  Push(sched, 1, 1, 0);
+  Entry e{MakeRouter(1), MakePath(1), 0, 500};
+  CHECK_FALSE(sched.Push(e));
+  // routing messages are not limited
+  for (int i = 0; i < 5; ++i)
+    Push(sched, 1, 0, 1);
+
+  size_t removed = 0;
+  sched.RemovePath(MakePath(1), [&](Entry&) { ++removed; });
+  CHECK(removed == 2);
+  CHECK(sched.Size() == 5);
+
+  const auto sent = sched.Schedule(
+      10, [](Entry& e) { CHECK(e.pathid.IsZero()); }, [](const RouterID&) { return size_t{0}; });
+  CHECK(sent == 5);
+}
@@ -0,0 +1,35 @@
+#include <routing/path_transfer_message.hpp>
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+using PathTransferMessage = llarp::routing::PathTransferMessage;
+
+TEST_CASE("PathTransferMessage encodes in its fixed layout", "[PathTransferMessage]")
+{
+  PathTransferMessage msg;
+  msg.P.Fill('p');
+  msg.S = 7;
+  msg.T.N.Fill('n');
+  msg.Y.Fill('y');
+
+  std::vector<byte_t> frame(1024);
+  llarp_buffer_t framebuf{frame};
+  REQUIRE(msg.T.BEncode(&framebuf));
+  const std::string encodedFrame{framebuf.base, framebuf.cur};
+
+  std::vector<byte_t> storage(2048);
+  llarp_buffer_t buf{storage};
+  REQUIRE(msg.BEncode(&buf));
+  const std::string encoded{buf.base, buf.cur};
+  // the keys in order, as the key by key encoder wrote them
+  CHECK(
+      encoded
+      == "d1:A1:T1:P16:" + std::string(16, 'p') + "1:Si7e1:T" + encodedFrame + "1:Vi0e1:Y32:"
+          + std::string(32, 'y') + "e");
+
+  std::vector<byte_t> small(encoded.size() - 1);
+  llarp_buffer_t smallbuf{small};
+  CHECK_FALSE(msg.BEncode(&smallbuf));
+}
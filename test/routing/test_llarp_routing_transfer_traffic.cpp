@@ -1,4 +1,5 @@
 #include <routing/transfer_traffic_message.hpp>
+#include <util/bencode.hpp>
 
 #include <catch2/catch.hpp>
 
@@ -21,4 +22,29 @@ TEST_CASE("TransferTrafficMessage", "[TransferTrafficMessage]")
     llarp_buffer_t buf(tmp);
     REQUIRE(msg.PutBuffer(buf, 1));
   }
+
+  SECTION("Encode and decode")
+  {
+    msg.Clear();
+    msg.S = 7;
+    msg.version = LLARP_PROTO_VERSION;
+    std::array<byte_t, 3> packet = {{'a', 'b', 'c'}};
+    REQUIRE(msg.PutBuffer(llarp_buffer_t{packet}, 2));
+
+    std::array<byte_t, 128> tmp = {{0}};
+    llarp_buffer_t buf(tmp);
+    REQUIRE(msg.BEncode(&buf));
+    const std::string encoded{buf.base, buf.cur};
+    // the packet is prefixed with its 8 byte big endian counter
+    const std::string expected{"d1:A1:I1:Pi1e1:Si7e1:Vi0e1:Xl11:\0\0\0\0\0\0\0\2abcee", 45};
+    CHECK(encoded == expected);
+
+    buf.sz = buf.cur - buf.base;
+    buf.cur = buf.base;
+    TransferTrafficMessage decoded;
+    REQUIRE(llarp::bencode_decode_dict(decoded, &buf));
+    CHECK(decoded.S == 7);
+    REQUIRE(decoded.X.size() == 1);
+    CHECK(decoded.X[0] == msg.X[0]);
+  }
 }
@@ -0,0 +1,123 @@
+#include <endpoint_base.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using namespace llarp;
+
+/// endpoint that writes down everything it is asked to send
+struct RecordingEndpoint : public EndpointBase
+{
+  std::vector<std::vector<byte_t>> sent;
+
+  void
+  SRVRecordsChanged() override
+  {}
+
+  std::optional<SendStat>
+  GetStatFor(AddressVariant_t) const override
+  {
+    return std::nullopt;
+  }
+
+  std::unordered_set<AddressVariant_t>
+  AllRemoteEndpoints() const override
+  {
+    return {};
+  }
+
+  AddressVariant_t
+  LocalAddress() const override
+  {
+    return RouterID{};
+  }
+
+  quic::TunnelManager*
+  GetQUICTunnel() override
+  {
+    return nullptr;
+  }
+
+  std::optional<AddressVariant_t>
+  GetEndpointWithConvoTag(service::ConvoTag) const override
+  {
+    return std::nullopt;
+  }
+
+  std::optional<service::ConvoTag>
+  GetBestConvoTagFor(AddressVariant_t) const override
+  {
+    return std::nullopt;
+  }
+
+  bool
+  EnsurePathTo(
+      AddressVariant_t,
+      std::function<void(std::optional<service::ConvoTag>)>,
+      llarp_time_t) override
+  {
+    return false;
+  }
+
+  void
+  LookupNameAsync(std::string, std::function<void(std::optional<AddressVariant_t>)>) override
+  {}
+
+  const EventLoop_ptr&
+  Loop() override
+  {
+    return m_Loop;
+  }
+
+  bool
+  SendToOrQueue(service::ConvoTag, const llarp_buffer_t& payload, service::ProtocolType) override
+  {
+    sent.emplace_back(payload.copy());
+    return true;
+  }
+
+  void
+  LookupServiceAsync(
+      std::string, std::string, std::function<void(std::vector<dns::SRVData>)>) override
+  {}
+
+  void
+  MarkAddressOutbound(AddressVariant_t) override
+  {}
+
+ private:
+  EventLoop_ptr m_Loop;
+};
+
+TEST_CASE("batched sends arrive complete and in order", "[EndpointBase]")
+{
+  RecordingEndpoint ep;
+  service::ConvoTag tag;
+  tag.Randomize();
+
+  std::vector<std::vector<byte_t>> batch;
+  std::vector<std::vector<byte_t>> expected;
+  for (byte_t i = 0; i < 10; ++i)
+  {
+    auto& payload = batch.emplace_back(ep.PayloadPool().Acquire());
+    payload.assign(100 + i, i);
+    expected.push_back(payload);
+  }
+  const auto capacity = batch.capacity();
+
+  REQUIRE(ep.SendManyToOrQueue(tag, batch, service::ProtocolType::TrafficV4));
+  CHECK(ep.sent == expected);
+
+  SECTION("the batch is emptied but keeps its capacity")
+  {
+    CHECK(batch.empty());
+    CHECK(batch.capacity() == capacity);
+  }
+
+  SECTION("the payload buffers go back to the pool")
+  {
+    CHECK(ep.PayloadPool().Spare() == expected.size());
+    CHECK(ep.PayloadPool().Acquire().capacity() >= 1500);
+  }
+}
@@ -0,0 +1,196 @@
+#include <util/logging/logger.hpp>
+#include <net/net_int.hpp>
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace llarp;
+
+namespace
+{
+  /// keeps every line it is handed along with the thread it said it came from
+  struct CaptureStream : public ILogStream
+  {
+    std::mutex access;
+    std::vector<std::string> lines;
+    std::vector<std::string> threads;
+
+    void
+    PreLog(std::stringstream&, LogLevel, const char*, int, const std::string&) const override
+    {}
+
+    void
+    Print(LogLevel, const char*, const std::string& msg) override
+    {
+      std::lock_guard<std::mutex> lock{access};
+      lines.push_back(msg);
+      threads.push_back(thread_id_string());
+    }
+
+    void
+    PostLog(std::stringstream&) const override
+    {}
+
+    void
+    ImmediateFlush() override
+    {}
+
+    void
+    Tick(llarp_time_t) override
+    {}
+  };
+
+  CaptureStream&
+  Capture(LogContext& ctx)
+  {
+    auto stream = std::make_unique<CaptureStream>();
+    auto& ref = *stream;
+    ctx.logStream = std::move(stream);
+    return ref;
+  }
+}  // namespace
+
+TEST_CASE("Async logger keeps every thread's records in order", "[log]")
+{
+  LogContext ctx;
+  auto& stream = Capture(ctx);
+  AsyncLogger logger{ctx, 0};
+
+  constexpr int perThread = 2000;
+  std::vector<std::thread> threads;
+  std::vector<std::string> ids(4);
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([&logger, &ids, t] {
+      ids[t] = thread_id_string();
+      for (int n = 0; n < perThread; ++n)
+        logger.Push(eLogInfo, "test", __LINE__, "thread ", t, " record ", n);
+    });
+  for (auto& thread : threads)
+    thread.join();
+  logger.Flush();
+
+  REQUIRE(stream.lines.size() == 4 * perThread);
+  std::vector<int> next(4, 0);
+  for (size_t idx = 0; idx < stream.lines.size(); ++idx)
+  {
+    int t = -1, n = -1;
+    REQUIRE(std::sscanf(stream.lines[idx].c_str(), "thread %d record %d", &t, &n) == 2);
+    REQUIRE(t >= 0);
+    REQUIRE(t < 4);
+    CHECK(n == next[t]++);
+    CHECK(stream.threads[idx] == ids[t]);
+  }
+}
+
+TEST_CASE("Async logger formats borrowed arguments right away", "[log]")
+{
+  LogContext ctx;
+  auto& stream = Capture(ctx);
+  AsyncLogger logger{ctx, 0};
+
+  std::string changing = "before";
+  const std::string_view view{changing};
+  logger.Push(eLogWarn, "test", __LINE__, view, " ", changing.c_str(), " ", 42, " ", 1.5);
+  changing = "AFTER!";
+  logger.Flush();
+
+  REQUIRE(stream.lines.size() == 1);
+  CHECK(stream.lines[0] == "before before 42 1.5");
+}
+
+TEST_CASE("Async logger keeps literals and values without formatting them", "[log]")
+{
+  static_assert(std::is_same_v<log_detail::capture_t<const char(&)[6]>, const char*>);
+  static_assert(std::is_same_v<log_detail::capture_t<char(&)[6]>, std::string>);
+  static_assert(std::is_same_v<log_detail::capture_t<const char*&>, std::string>);
+  static_assert(std::is_same_v<log_detail::capture_t<huint32_t&>, huint32_t>);
+  static_assert(std::is_same_v<log_detail::capture_t<std::chrono::milliseconds>,
+                               std::chrono::milliseconds>);
+
+  LogContext ctx;
+  auto& stream = Capture(ctx);
+  AsyncLogger logger{ctx, 0};
+
+  char scratch[] = "mutable";
+  const huint32_t addr{0x0a000001};
+  logger.Push(eLogInfo, "test", __LINE__, "addr ", addr, " ", scratch);
+  scratch[0] = 'M';
+  logger.Flush();
+
+  REQUIRE(stream.lines.size() == 1);
+  CHECK(stream.lines[0] == "addr 10.0.0.1 mutable");
+}
+
+TEST_CASE("Async logger dumps its recent history", "[log]")
+{
+  LogContext ctx;
+  Capture(ctx);
+  AsyncLogger logger{ctx, 3};
+  for (int n = 0; n < 5; ++n)
+    logger.Push(eLogError, "llarp/test.cpp", 7, "line ", n);
+  logger.Flush();
+
+  std::FILE* file = std::tmpfile();
+  REQUIRE(file);
+  logger.DumpHistory(fileno(file));
+  std::rewind(file);
+  std::string dumped;
+  char buf[256];
+  while (const auto n = std::fread(buf, 1, sizeof(buf), file))
+    dumped.append(buf, n);
+  std::fclose(file);
+
+  CHECK(dumped == "[ERR] llarp/test.cpp:7 line 2\n[ERR] llarp/test.cpp:7 line 3\n"
+                  "[ERR] llarp/test.cpp:7 line 4\n");
+}
+
+TEST_CASE("Async logger lets go of a stream before it is replaced", "[log]")
+{
+  LogContext ctx;
+  auto& first = Capture(ctx);
+  ctx.EnableAsync(0);
+  auto* logger = ctx.async.load();
+  REQUIRE(logger);
+
+  constexpr int total = 2000;
+  std::thread writer{[logger] {
+    for (int n = 0; n < total; ++n)
+      logger->Push(eLogInfo, "test", __LINE__, "record ", n);
+  }};
+  auto replacement = std::make_unique<CaptureStream>();
+  auto& second = *replacement;
+  auto old = ctx.ReplaceStream(std::move(replacement));
+  writer.join();
+  ctx.ImmediateFlush();
+
+  CHECK(old.get() == &first);
+  CHECK(first.lines.size() + second.lines.size() == total);
+}
+
+TEST_CASE("Subsystem log levels", "[log]")
+{
+  LogContext ctx;
+  ctx.curLevel = eLogWarn;
+  ctx.UpdateThreshold();
+  CHECK_FALSE(LogEnabled(eLogDebug));
+  CHECK_FALSE(ctx.ShouldLog(eLogInfo, "llarp/iwp/session.cpp"));
+
+  ctx.SetSubsystemLevel("iwp", eLogDebug);
+  CHECK(LogEnabled(eLogDebug));
+  CHECK(ctx.ShouldLog(eLogDebug, "llarp/iwp/session.cpp"));
+  CHECK_FALSE(ctx.ShouldLog(eLogTrace, "llarp/iwp/session.cpp"));
+  CHECK_FALSE(ctx.ShouldLog(eLogDebug, "llarp/path/path.cpp"));
+  CHECK(ctx.ShouldLog(eLogWarn, "llarp/path/path.cpp"));
+  CHECK(ctx.GetSubsystemLevel("iwp") == eLogDebug);
+
+  ctx.SetSubsystemLevel("iwp", std::nullopt);
+  CHECK_FALSE(LogEnabled(eLogDebug));
+  CHECK_FALSE(ctx.ShouldLog(eLogDebug, "llarp/iwp/session.cpp"));
+  CHECK(ctx.GetSubsystemLevel("iwp") == eLogWarn);
+
+  LogContext::Instance().UpdateThreshold();
+}
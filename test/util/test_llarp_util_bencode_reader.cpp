@@ -0,0 +1,141 @@
+#include <util/bencode_reader.hpp>
+#include <messages/relay.hpp>
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace llarp;
+using namespace std::literals;
+
+TEST_CASE("Bencode reader reads well formed values", "[bencode]")
+{
+  bencode::Reader reader{"d1:ai42e1:bl3:foo0:e1:cdee"sv};
+  REQUIRE(reader.EnterDict());
+
+  std::string_view key, str;
+  uint64_t i = 0;
+  REQUIRE(reader.ReadString(key));
+  CHECK(key == "a"sv);
+  REQUIRE(reader.ReadInteger(i));
+  CHECK(i == 42);
+
+  REQUIRE(reader.ReadString(key));
+  CHECK(key == "b"sv);
+  REQUIRE(reader.EnterList());
+  REQUIRE(reader.ReadString(str));
+  CHECK(str == "foo"sv);
+  REQUIRE(reader.ReadString(str));
+  CHECK(str.empty());
+  REQUIRE(reader.ReadEnd());
+
+  REQUIRE(reader.ReadString(key));
+  CHECK(key == "c"sv);
+  std::string_view raw;
+  REQUIRE(reader.ReadRaw(raw));
+  CHECK(raw == "de"sv);
+  REQUIRE(reader.ReadEnd());
+  CHECK(reader.Empty());
+}
+
+TEST_CASE("Bencode reader refuses malformed values", "[bencode]")
+{
+  const std::vector<std::string_view> bad{
+      "",
+      "i",
+      "ie",
+      "i01e",
+      "i-0e",
+      "i12",
+      "5:abc",
+      "05:abcde",
+      "99999999999999999999:x",
+      "l",
+      "li1e",
+      "d1:a",
+      "d1:ai1e",
+      "x",
+  };
+  for (const auto& data : bad)
+  {
+    INFO(data);
+    bencode::Reader reader{data};
+    CHECK_FALSE(reader.Skip());
+  }
+
+  std::string deep(bencode::MaxDepth + 2, 'l');
+  deep.append(bencode::MaxDepth + 2, 'e');
+  bencode::Reader reader{std::string_view{deep}};
+  CHECK_FALSE(reader.Skip());
+
+  uint64_t i = 0;
+  bencode::Reader big{"i18446744073709551616e"sv};
+  CHECK_FALSE(big.ReadInteger(i));
+  bencode::Reader negative{"i-1e"sv};
+  CHECK_FALSE(negative.ReadInteger(i));
+  CHECK(negative.Skip());
+}
+
+TEST_CASE("Bencode key tables dispatch at compile time", "[bencode]")
+{
+  constexpr auto keys = bencode::MakeKeyTable("a", "b", "d");
+  static_assert(keys.IsSorted());
+  static_assert(keys.Index("d") == 2);
+  static_assert(keys.Find("c") == 3);
+  static_assert(not bencode::MakeKeyTable("b", "a").IsSorted());
+
+  uint64_t a = 0;
+  std::string_view d;
+  bencode::Reader reader{"d1:ai7e1:d3:xyze"sv};
+  CHECK(bencode::ReadDict(reader, keys, [&](size_t key, bencode::Reader& r) {
+    switch (key)
+    {
+      case keys.Index("a"):
+        return r.ReadInteger(a);
+      case keys.Index("d"):
+        return r.ReadString(d);
+      default:
+        return false;
+    }
+  }));
+  CHECK(a == 7);
+  CHECK(d == "xyz"sv);
+
+  const auto skipAll = [](size_t, bencode::Reader& r) { return r.Skip(); };
+  bencode::Reader unknown{"d1:ci1ee"sv};
+  CHECK_FALSE(bencode::ReadDict(unknown, keys, skipAll));
+  bencode::Reader repeated{"d1:ai1e1:ai2ee"sv};
+  CHECK_FALSE(bencode::ReadDict(repeated, keys, skipAll));
+}
+
+TEST_CASE("Relay messages refer to the buffer they are decoded from", "[bencode]")
+{
+  RelayUpstreamMessage msg;
+  msg.pathid.Randomize();
+  msg.X = Encrypted<MAX_LINK_MSG_SIZE - 128>{nullptr, 512};
+  msg.X.Randomize();
+  msg.Y.Randomize();
+
+  std::vector<byte_t> storage(MAX_LINK_MSG_SIZE);
+  llarp_buffer_t buf{storage};
+  REQUIRE(msg.BEncode(&buf));
+  buf.sz = buf.cur - buf.base;
+  buf.cur = buf.base;
+
+  RelayUpstreamMessage decoded;
+  REQUIRE(decoded.BDecode(&buf));
+  CHECK(buf.size_left() == 0);
+  CHECK(decoded.pathid == msg.pathid);
+  CHECK(decoded.Y == msg.Y);
+  CHECK(decoded.X.size() == 0);
+  REQUIRE(decoded.wireX.size() == msg.X.size());
+  CHECK(reinterpret_cast<const byte_t*>(decoded.wireX.data()) > storage.data());
+  CHECK(reinterpret_cast<const byte_t*>(decoded.wireX.data()) < storage.data() + storage.size());
+  const auto payload = decoded.Payload();
+  CHECK(std::equal(payload.base, payload.base + payload.sz, msg.X.data()));
+
+  // a downstream message does not decode as an upstream one
+  RelayDownstreamMessage down;
+  buf.cur = buf.base;
+  CHECK_FALSE(down.BDecode(&buf));
+}
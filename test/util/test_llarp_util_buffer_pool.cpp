@@ -0,0 +1,51 @@
+#include <util/buffer_pool.hpp>
+#include <catch2/catch.hpp>
+
+TEST_CASE("BufferPool hands back buffers from the smallest fitting size class", "[buffer-pool]")
+{
+  llarp::util::BufferPool pool{256, 1500, 1 << 20};
+  auto small = pool.Acquire(100);
+  REQUIRE(small.capacity() >= 256);
+  REQUIRE(small.capacity() < 512);
+  auto big = pool.Acquire(1400);
+  REQUIRE(big.capacity() >= 1400);
+  const auto bigCap = big.capacity();
+
+  pool.Release(std::move(small));
+  pool.Release(std::move(big));
+  REQUIRE(pool.Spare() == 2);
+
+  // a small request must not take the big spare
+  auto again = pool.Acquire(200);
+  REQUIRE(again.capacity() < 512);
+  REQUIRE(again.empty());
+  again = pool.Acquire(1000);
+  REQUIRE(again.capacity() == bigCap);
+  REQUIRE(pool.Spare() == 0);
+  REQUIRE(pool.SpareBytes() == 0);
+}
+
+TEST_CASE("BufferPool bounds the spare bytes it holds", "[buffer-pool]")
+{
+  llarp::util::BufferPool pool{256, 1024, 2048};
+  for (int i = 0; i < 4; ++i)
+    pool.Release(pool.Acquire(1024));
+  REQUIRE(pool.SpareBytes() <= 2048);
+
+  std::vector<std::vector<byte_t>> bufs;
+  for (int i = 0; i < 4; ++i)
+    bufs.emplace_back(pool.Acquire(1024));
+  for (auto& buf : bufs)
+    pool.Release(std::move(buf));
+  REQUIRE(pool.Spare() == 2);
+  REQUIRE(pool.SpareBytes() <= 2048);
+
+  SECTION("grown buffers are not kept")
+  {
+    std::vector<byte_t> huge;
+    huge.resize(4096);
+    const auto before = pool.Spare();
+    pool.Release(std::move(huge));
+    REQUIRE(pool.Spare() == before);
+  }
+}
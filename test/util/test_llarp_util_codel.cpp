@@ -0,0 +1,272 @@
+#include <util/codel.hpp>
+#include <util/fq_codel.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+namespace
+{
+  struct Item
+  {
+    int value = 0;
+    llarp_time_t timestamp = 0s;
+    uint64_t flow = 0;
+  };
+
+  struct GetTime
+  {
+    llarp_time_t
+    operator()(const Item& item) const
+    {
+      return item.timestamp;
+    }
+  };
+
+  struct FakeClock
+  {
+    llarp_time_t* now;
+
+    llarp_time_t
+    operator()() const
+    {
+      return *now;
+    }
+  };
+
+  struct PutTime
+  {
+    llarp_time_t* now;
+
+    void
+    operator()(Item& item) const
+    {
+      item.timestamp = *now;
+    }
+  };
+
+  struct GetFlow
+  {
+    uint64_t
+    operator()(const Item& item) const
+    {
+      return item.flow;
+    }
+  };
+
+  struct GetSize
+  {
+    size_t
+    operator()(const Item&) const
+    {
+      return 1000;
+    }
+  };
+
+  using Queue_t = llarp::util::SPSCCoDelQueue<Item, GetTime, PutTime, FakeClock>;
+  using FQueue_t = llarp::util::FQCoDelQueue<Item, GetTime, PutTime, GetFlow, GetSize, FakeClock>;
+
+  /// fixed so which flows share a bucket does not change between runs
+  constexpr uint64_t TestPerturb = 1;
+}  // namespace
+
+TEST_CASE("SPSCCoDelQueue basics", "[codel]")
+{
+  llarp_time_t now = 1s;
+  Queue_t queue{"test", PutTime{&now}, FakeClock{&now}, 3};
+  REQUIRE(queue.Capacity() == 4);
+
+  for (int i = 0; i < 4; ++i)
+    REQUIRE(queue.Emplace(Item{i}));
+  CHECK_FALSE(queue.Emplace(Item{4}));
+  CHECK(queue.Size() == 4);
+
+  SECTION("visits in order")
+  {
+    std::vector<int> got;
+    queue.Process([&](Item& item) { got.push_back(item.value); });
+    CHECK(got == std::vector<int>({0, 1, 2, 3}));
+    CHECK(queue.Size() == 0);
+    CHECK(queue.Emplace(Item{5}));
+  }
+
+  SECTION("filter stops early")
+  {
+    std::vector<int> got;
+    queue.Process(
+        [&](Item& item) { got.push_back(item.value); },
+        [](Item& item) { return item.value == 2; });
+    CHECK(got == std::vector<int>({0, 1}));
+    CHECK(queue.Size() == 2);
+  }
+
+  SECTION("emplace if")
+  {
+    queue.Process([](Item&) {});
+    CHECK_FALSE(queue.EmplaceIf([](Item& item) { return item.value > 0; }, Item{0}));
+    CHECK(queue.EmplaceIf([](Item& item) { return item.value > 0; }, Item{1}));
+    CHECK(queue.Size() == 1);
+  }
+}
+
+TEST_CASE("SPSCCoDelQueue drops under standing delay", "[codel]")
+{
+  llarp_time_t now = 1s;
+  Queue_t queue{"test", PutTime{&now}, FakeClock{&now}, 16, 5ms, 100ms};
+
+  size_t visited = 0;
+  const auto visit = [&](Item&) { ++visited; };
+
+  // delay above target but not for a whole interval yet, nothing is dropped
+  queue.Emplace(Item{});
+  now += 10ms;
+  queue.Process(visit);
+  CHECK(visited == 1);
+  CHECK(queue.Dropped() == 0);
+
+  // still above target an interval later, we start dropping
+  queue.Emplace(Item{});
+  queue.Emplace(Item{});
+  now += 200ms;
+  queue.Process(visit);
+  CHECK(queue.Dropped() == 1);
+  CHECK(visited == 2);
+
+  // delay back under target, everything goes through again
+  queue.Emplace(Item{});
+  queue.Process(visit);
+  CHECK(visited == 3);
+  CHECK(queue.Dropped() == 1);
+}
+
+TEST_CASE("SPSCCoDelQueue across threads", "[codel]")
+{
+  llarp_time_t now = 1s;
+  Queue_t queue{"test", PutTime{&now}, FakeClock{&now}, 64};
+  constexpr int count = 100000;
+
+  std::thread producer{[&]() {
+    for (int i = 0; i < count;)
+    {
+      if (queue.Emplace(Item{i}))
+        ++i;
+      else
+        std::this_thread::yield();
+    }
+  }};
+
+  int expect = 0;
+  while (expect < count)
+  {
+    queue.Process([&](Item& item) {
+      REQUIRE(item.value == expect);
+      ++expect;
+    });
+  }
+  producer.join();
+  CHECK(queue.Dropped() == 0);
+}
+
+TEST_CASE("FQCoDelQueue interleaves flows", "[codel]")
+{
+  llarp_time_t now = 1s;
+  FQueue_t queue{
+      "test",
+      PutTime{&now},
+      FakeClock{&now},
+      64,
+      64,
+      FQueue_t::DefaultQuantum,
+      llarp::util::CoDelControl::DefaultTarget,
+      llarp::util::CoDelControl::DefaultInterval,
+      TestPerturb};
+
+  // a bulk flow queues up first, then a single packet from an interactive flow
+  for (int i = 0; i < 10; ++i)
+    REQUIRE(queue.Emplace(Item{i, 0s, 1}));
+  REQUIRE(queue.Emplace(Item{100, 0s, 2}));
+
+  std::vector<int> got;
+  queue.Process([&](Item& item) { got.push_back(item.value); });
+  REQUIRE(got.size() == 11);
+  // the quantum lets the bulk flow send 2 items before the other flow gets its turn
+  const auto itr = std::find(got.begin(), got.end(), 100);
+  CHECK(itr - got.begin() <= 2);
+  // each flow stays in order
+  got.erase(itr);
+  CHECK(std::is_sorted(got.begin(), got.end()));
+  CHECK(queue.Size() == 0);
+
+  const auto status = queue.ExtractStatus();
+  CHECK(status["queued"] == 0);
+  CHECK(status["dropped"] == 0);
+  CHECK(status["flows"].size() == 2);
+}
+
+TEST_CASE("FQCoDelQueue drops from the fattest flow when full", "[codel]")
+{
+  llarp_time_t now = 1s;
+  FQueue_t queue{
+      "test",
+      PutTime{&now},
+      FakeClock{&now},
+      4,
+      64,
+      FQueue_t::DefaultQuantum,
+      llarp::util::CoDelControl::DefaultTarget,
+      llarp::util::CoDelControl::DefaultInterval,
+      TestPerturb};
+
+  for (int i = 0; i < 4; ++i)
+    REQUIRE(queue.Emplace(Item{i, 0s, 1}));
+  // staging is full until the consumer runs
+  CHECK_FALSE(queue.Emplace(Item{4, 0s, 1}));
+  queue.Process([](Item&) {});
+
+  std::vector<int> got;
+  for (int i = 0; i < 4; ++i)
+    REQUIRE(queue.Emplace(Item{i, 0s, 1}));
+  queue.Process([&](Item& item) { got.push_back(item.value); }, [](Item&) { return true; });
+  CHECK(got.empty());
+  CHECK(queue.Size() == 4);
+
+  REQUIRE(queue.Emplace(Item{100, 0s, 2}));
+  queue.Process([&](Item& item) { got.push_back(item.value); });
+  // the oldest item of the bulk flow made room for the new flow
+  CHECK(got.size() == 4);
+  CHECK(std::find(got.begin(), got.end(), 0) == got.end());
+  CHECK(std::find(got.begin(), got.end(), 100) != got.end());
+  CHECK(queue.ExtractStatus()["overflowDropped"] == 1);
+}
+
+TEST_CASE("FQCoDelQueue across threads", "[codel]")
+{
+  llarp_time_t now = 1s;
+  FQueue_t queue{"test", PutTime{&now}, FakeClock{&now}, 64};
+  constexpr int count = 100000;
+
+  std::thread producer{[&]() {
+    for (int i = 0; i < count;)
+    {
+      if (queue.Emplace(Item{i}))
+        ++i;
+      else
+        std::this_thread::yield();
+    }
+  }};
+
+  int expect = 0;
+  while (expect < count)
+  {
+    queue.Process([&](Item& item) {
+      REQUIRE(item.value == expect);
+      ++expect;
+    });
+  }
+  producer.join();
+  CHECK(queue.ExtractStatus()["dropped"] == 0);
+}
@@ -0,0 +1,74 @@
+#include <util/metrics.hpp>
+#include <catch2/catch.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace llarp::metrics;
+
+TEST_CASE("Metrics counter sums every thread", "[metrics]")
+{
+  Counter counter;
+  std::vector<std::thread> threads;
+  for (int idx = 0; idx < 8; ++idx)
+    threads.emplace_back([&counter] {
+      for (int n = 0; n < 1000; ++n)
+        counter.Inc();
+    });
+  for (auto& thread : threads)
+    thread.join();
+  REQUIRE(counter.Value() == 8000);
+  counter.Inc(5);
+  REQUIRE(counter.Value() == 8005);
+}
+
+TEST_CASE("Metrics histogram buckets are cumulative", "[metrics]")
+{
+  Histogram histogram{{1, 2, 5}};
+  histogram.Observe(0.5);
+  histogram.Observe(1);
+  histogram.Observe(3);
+  histogram.Observe(100);
+  const auto snap = histogram.Collect();
+  REQUIRE(snap.buckets == std::vector<uint64_t>({2, 2, 3, 4}));
+  REQUIRE(snap.count == 4);
+  REQUIRE(snap.sum == Approx(104.5));
+
+  REQUIRE_THROWS(Histogram({2, 1}));
+}
+
+TEST_CASE("Metrics registry hands back the same series", "[metrics]")
+{
+  auto& registry = Registry::Instance();
+  auto& first = registry.GetCounter("test_registry_same", "help", {{"a", "1"}});
+  auto& again = registry.GetCounter("test_registry_same", "help", {{"a", "1"}});
+  auto& other = registry.GetCounter("test_registry_same", "help", {{"a", "2"}});
+  REQUIRE(&first == &again);
+  REQUIRE(&first != &other);
+  REQUIRE_THROWS(registry.GetGauge("test_registry_same", "help"));
+}
+
+TEST_CASE("Metrics registry renders OpenMetrics", "[metrics]")
+{
+  auto& registry = Registry::Instance();
+  registry.GetCounter("test_render_counter", "a \"counter\"", {{"kind", "x"}}).Inc(3);
+  registry.GetGauge("test_render_gauge", "a gauge").Set(-2);
+  registry.GetHistogram("test_render_histogram", "a histogram", {0.5, 1}).Observe(0.75);
+
+  const auto text = registry.OpenMetrics();
+  const auto has = [&text](const std::string& line) {
+    return text.find(line + "\n") != std::string::npos;
+  };
+  CHECK(has("# TYPE test_render_counter counter"));
+  CHECK(has("# HELP test_render_counter a \\\"counter\\\""));
+  CHECK(has("test_render_counter_total{kind=\"x\"} 3"));
+  CHECK(has("# TYPE test_render_gauge gauge"));
+  CHECK(has("test_render_gauge -2"));
+  CHECK(has("test_render_histogram_bucket{le=\"0.5\"} 0"));
+  CHECK(has("test_render_histogram_bucket{le=\"1\"} 1"));
+  CHECK(has("test_render_histogram_bucket{le=\"+Inf\"} 1"));
+  CHECK(has("test_render_histogram_sum 0.75"));
+  CHECK(has("test_render_histogram_count 1"));
+  REQUIRE(text.size() >= 6);
+  CHECK(text.substr(text.size() - 6) == "# EOF\n");
+}
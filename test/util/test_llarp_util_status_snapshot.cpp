@@ -0,0 +1,77 @@
+#include <util/status_snapshot.hpp>
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using namespace std::literals;
+
+TEST_CASE("Status snapshot only rebuilds stale subsystems", "[status]")
+{
+  int peers = 1, builds = 0;
+  util::StatusSnapshot snapshot{1s};
+  snapshot.Add("links", [&]() {
+    ++builds;
+    return util::StatusObject{{"peers", peers}};
+  });
+
+  REQUIRE(snapshot.Stale("", 0s));
+  snapshot.Refresh("", 0s);
+  CHECK(builds == 1);
+  CHECK(snapshot.Version() == 1);
+  CHECK_FALSE(snapshot.Stale("links", 500ms));
+
+  // rebuilt once old enough, but the same status keeps its version
+  snapshot.Refresh("", 500ms);
+  CHECK(builds == 1);
+  snapshot.Refresh("", 1s);
+  CHECK(builds == 2);
+  CHECK(snapshot.Version() == 1);
+
+  // invalidating does not wait for the max age
+  peers = 2;
+  snapshot.Invalidate("links");
+  REQUIRE(snapshot.Stale("links", 1s));
+  snapshot.Refresh("links", 1s);
+  CHECK(builds == 3);
+  CHECK(snapshot.Version() == 2);
+  const auto status = snapshot.Get();
+  REQUIRE(status);
+  CHECK(status->at("links").at("peers") == 2);
+  CHECK(status->at("version") == 2);
+}
+
+TEST_CASE("Status snapshot hands out subtrees and deltas", "[status]")
+{
+  int paths = 0;
+  util::StatusSnapshot snapshot{1s};
+  snapshot.Add("running", []() { return util::StatusObject(true); });
+  snapshot.Add("services", [&]() {
+    return util::StatusObject{{"default", {{"paths", paths}, {"ready", true}}}};
+  });
+  snapshot.Refresh("", 0s);
+  const auto before = snapshot.Version();
+
+  paths = 3;
+  snapshot.Invalidate("services");
+  snapshot.Refresh("", 0s);
+
+  const auto delta = snapshot.Get("", before);
+  REQUIRE(delta);
+  CHECK_FALSE(delta->contains("running"));
+  CHECK(delta->at("services").at("default").at("paths") == 3);
+
+  const auto subtree = snapshot.Get("/services/default/paths");
+  REQUIRE(subtree);
+  CHECK(subtree->at("services").at("default").size() == 1);
+  CHECK(subtree->at("services").at("default").at("paths") == 3);
+
+  // nothing changed since the current version so only the version comes back
+  const auto unchanged = snapshot.Get("/services", snapshot.Version());
+  REQUIRE(unchanged);
+  CHECK(unchanged->size() == 1);
+
+  CHECK_FALSE(snapshot.Get("/services/other"));
+  CHECK_FALSE(snapshot.Get("/nope"));
+  CHECK_FALSE(snapshot.Get("services"));
+  CHECK(util::StatusSnapshot::Subsystem("/services/default") == "services"sv);
+  CHECK(util::StatusSnapshot::Subsystem("").empty());
+}
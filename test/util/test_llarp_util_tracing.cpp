@@ -0,0 +1,118 @@
+#include <util/tracing.hpp>
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace llarp::tracing;
+
+TEST_CASE("Stage timer records consecutive stages", "[tracing]")
+{
+  auto& tracer = Tracer::Instance();
+  tracer.SetSampleRate(1);
+
+  StageTimer timer{"test_stages"};
+  REQUIRE(timer);
+  const auto id = timer.ID();
+  timer.Mark("first");
+  timer.Mark("second", "some detail");
+  timer.Finish("done");
+  CHECK_FALSE(timer);
+  // a finished trace records nothing more
+  timer.Mark("late");
+
+  std::vector<Span> spans;
+  for (const auto& span : tracer.Spans())
+  {
+    if (span.traceID == id)
+      spans.push_back(span);
+  }
+  REQUIRE(spans.size() == 3);
+  CHECK(std::string{spans[0].stage} == "first");
+  CHECK(std::string{spans[1].stage} == "second");
+  CHECK(spans[1].detail == "some detail");
+  CHECK(spans[0].end == spans[1].start);
+  CHECK(std::string{spans[2].stage} == "done");
+  CHECK(spans[2].start == spans[0].start);
+  CHECK(spans[2].end >= spans[1].end);
+}
+
+TEST_CASE("Unsampled traces only feed the histograms", "[tracing]")
+{
+  auto& tracer = Tracer::Instance();
+  tracer.SetSampleRate(0);
+  const auto before = tracer.Spans().size();
+  for (int n = 0; n < 3; ++n)
+  {
+    StageTimer timer{"test_unsampled"};
+    timer.Mark("only");
+  }
+  CHECK(tracer.Spans().size() == before);
+
+  const auto status = tracer.ExtractStatus();
+  const auto& stages = status["stages"];
+  const auto itr = std::find_if(stages.begin(), stages.end(), [](const auto& stage) {
+    return stage["trace"] == "test_unsampled" and stage["stage"] == "only";
+  });
+  REQUIRE(itr != stages.end());
+  CHECK((*itr)["count"] == 3);
+
+  StageTimer untraced;
+  untraced.Mark("nothing");
+  CHECK_FALSE(untraced);
+}
+
+TEST_CASE("Stages recorded from many threads share a histogram", "[tracing]")
+{
+  auto& tracer = Tracer::Instance();
+  tracer.SetSampleRate(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([] {
+      for (int n = 0; n < 100; ++n)
+      {
+        StageTimer timer{"test_threads"};
+        timer.Mark("work");
+      }
+    });
+  for (auto& thread : threads)
+    thread.join();
+
+  const auto status = tracer.ExtractStatus();
+  const auto& stages = status["stages"];
+  const auto count = std::count_if(stages.begin(), stages.end(), [](const auto& stage) {
+    return stage["trace"] == "test_threads" and stage["stage"] == "work";
+  });
+  REQUIRE(count == 1);
+  const auto itr = std::find_if(stages.begin(), stages.end(), [](const auto& stage) {
+    return stage["trace"] == "test_threads" and stage["stage"] == "work";
+  });
+  CHECK((*itr)["count"] == 400);
+}
+
+TEST_CASE("Chrome trace export", "[tracing]")
+{
+  auto& tracer = Tracer::Instance();
+  tracer.SetSampleRate(1);
+  StageTimer timer{"test_export"};
+  const auto id = timer.ID();
+  timer.Mark("stage");
+
+  const auto trace = tracer.ChromeTrace();
+  bool named = false, found = false;
+  for (const auto& event : trace["traceEvents"])
+  {
+    if (event["tid"] != id)
+      continue;
+    if (event["ph"] == "M")
+      named = event["args"]["name"] == "test_export " + std::to_string(id);
+    else if (event["ph"] == "X")
+    {
+      found = event["name"] == "stage" and event["cat"] == "test_export";
+      CHECK(event["dur"] >= 0);
+    }
+  }
+  CHECK(named);
+  CHECK(found);
+}
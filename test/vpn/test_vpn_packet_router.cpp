@@ -0,0 +1,102 @@
+#include <vpn/packet_router.hpp>
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace llarp;
+
+namespace
+{
+  net::IPPacket
+  MakeUDP(uint16_t dstport, char payload)
+  {
+    const std::string data(4, payload);
+    return net::IPPacket::UDP(
+        nuint32_t{0x0100000a},
+        ToNet(huint16_t{1234}),
+        nuint32_t{0x0200000a},
+        ToNet(huint16_t{dstport}),
+        llarp_buffer_t{data});
+  }
+
+  char
+  Payload(const net::IPPacket& pkt)
+  {
+    return pkt.buf[pkt.sz - 1];
+  }
+}  // namespace
+
+TEST_CASE("Packet router hands each handler its group in one call", "[vpn]")
+{
+  std::vector<std::string> calls;
+  std::string single;
+  vpn::PacketRouter router{[&](net::IPPacket pkt) { single += Payload(pkt); }};
+  router.AddUDPHandler(
+      huint16_t{53},
+      [&](net::IPPacket pkt) { single += Payload(pkt); },
+      [&](std::vector<net::IPPacket>& pkts) {
+        std::string call = "dns:";
+        for (const auto& pkt : pkts)
+          call += Payload(pkt);
+        calls.push_back(call);
+      });
+  router.AddUDPHandler(
+      huint16_t{1090}, nullptr, [&](std::vector<net::IPPacket>& pkts) {
+        std::string call = "quic:";
+        for (const auto& pkt : pkts)
+          call += Payload(pkt);
+        calls.push_back(call);
+      });
+
+  std::vector<net::IPPacket> pkts{
+      MakeUDP(1090, 'a'),
+      MakeUDP(53, 'b'),
+      MakeUDP(1090, 'c'),
+      MakeUDP(80, 'd'),
+      MakeUDP(53, 'e'),
+      MakeUDP(80, 'f')};
+  router.HandleIPPackets(pkts);
+
+  // groups go in order of first appearance and keep the order of their packets
+  REQUIRE(calls.size() == 2);
+  CHECK(calls[0] == "quic:ac");
+  CHECK(calls[1] == "dns:be");
+  // the base handler has no batch entry point so it gets its packets one at a time
+  CHECK(single == "df");
+
+  // a batch that all goes to one place is handed over as is
+  calls.clear();
+  std::vector<net::IPPacket> same{MakeUDP(53, 'x'), MakeUDP(53, 'y')};
+  router.HandleIPPackets(same);
+  REQUIRE(calls.size() == 1);
+  CHECK(calls[0] == "dns:xy");
+}
+
+TEST_CASE("Packet router keeps unclaimed udp in the base handler's group", "[vpn]")
+{
+  std::vector<std::string> calls;
+  vpn::PacketRouter router{
+      [](net::IPPacket) { FAIL("base handler has a batch entry point"); },
+      [&](std::vector<net::IPPacket>& pkts) {
+        std::string call = "base:";
+        for (const auto& pkt : pkts)
+          call += Payload(pkt);
+        calls.push_back(call);
+      }};
+  router.AddUDPHandler(huint16_t{53}, nullptr, [&](std::vector<net::IPPacket>& pkts) {
+    std::string call = "dns:";
+    for (const auto& pkt : pkts)
+      call += Payload(pkt);
+    calls.push_back(call);
+  });
+
+  auto tcp = MakeUDP(80, 'c');
+  tcp.Header()->protocol = static_cast<uint8_t>(net::IPProtocol::TCP);
+  std::vector<net::IPPacket> pkts{MakeUDP(80, 'a'), MakeUDP(53, 'b'), tcp, MakeUDP(443, 'd')};
+  router.HandleIPPackets(pkts);
+
+  REQUIRE(calls.size() == 2);
+  CHECK(calls[0] == "base:acd");
+  CHECK(calls[1] == "dns:b");
+}